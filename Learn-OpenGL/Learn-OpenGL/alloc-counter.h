@@ -0,0 +1,98 @@
+#ifndef ALLOC_COUNTER_H
+#define ALLOC_COUNTER_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Counts heap allocations made through operator new, per thread.
+//
+// The counting replaces the global operator new and delete, which a program
+// may only do once: define ALLOC_COUNTER_IMPLEMENTATION in exactly one .cpp
+// before including this header. Without it the counters stay at 0.
+//
+//     alloccounter::Snapshot before = alloccounter::snapshot();
+//     renderFrame();
+//     printf("%llu allocations\n", alloccounter::since(before).allocations);
+//
+// malloc and friends are not counted, the C++ containers and strings all go
+// through operator new.
+namespace alloccounter {
+    struct Snapshot {
+        unsigned long long allocations = 0;
+        unsigned long long frees = 0;
+        unsigned long long bytes = 0;
+    };
+
+    inline Snapshot& counters() {
+        thread_local Snapshot s;
+        return s;
+    }
+
+    // this thread's totals so far
+    inline Snapshot snapshot() {
+        return counters();
+    }
+
+    inline Snapshot since(const Snapshot& before) {
+        Snapshot now = counters();
+        now.allocations -= before.allocations;
+        now.frees -= before.frees;
+        now.bytes -= before.bytes;
+        return now;
+    }
+
+    inline bool enabled();
+}
+
+#ifdef ALLOC_COUNTER_IMPLEMENTATION
+
+#include <cstdlib>
+#include <new>
+
+inline bool alloccounter::enabled() {
+    return true;
+}
+
+void* operator new(std::size_t size) {
+    alloccounter::Snapshot& s = alloccounter::counters();
+    s.allocations++;
+    s.bytes += size;
+    void* memory = std::malloc(size > 0 ? size : 1);
+    if (memory == NULL) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* memory) noexcept {
+    if (memory != NULL) {
+        alloccounter::counters().frees++;
+        std::free(memory);
+    }
+}
+
+void operator delete[](void* memory) noexcept {
+    operator delete(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    operator delete(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept {
+    operator delete(memory);
+}
+
+#else
+
+inline bool alloccounter::enabled() {
+    return false;
+}
+
+#endif
+
+#endif
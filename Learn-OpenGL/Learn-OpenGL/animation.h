@@ -0,0 +1,285 @@
+#ifndef ANIMATION_H
+#define ANIMATION_H
+
+#include "maths.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Batch evaluator for the "map sin into [a, b]" formula from cheatsheet/maths.md:
+//
+//     value = (b - a) / 2 * sin(omega * t + phase) + (a + b) / 2
+//
+// Parameters are stored as SoA arrays so that 8 (AVX2) or 4 (SSE) tracks are
+// evaluated per iteration. The sine is a polynomial approximation, see fastSin.
+namespace animation {
+
+// Range reduction constants: pi split in two so k * PI_HI is exact for |k| < 2^16
+const float INV_PI = 0.318309886183790671538f;
+const float PI_HI = 3.140625f;
+const float PI_LO = 9.67653589793e-4f;
+
+// Taylor coefficients up to x^11. On the reduced range [-pi/2, pi/2] the
+// truncation error is below 6e-8, so the total error is dominated by float
+// rounding (about 2e-7 absolute) as long as |x| stays below ~4000.
+// Larger arguments lose precision in float before the sine is even taken,
+// so keep t wrapped (e.g. fmod by the animation period) for long runs.
+const float SIN_C3 = -1.66666666666666667e-1f;
+const float SIN_C5 = 8.33333333333333333e-3f;
+const float SIN_C7 = -1.98412698412698413e-4f;
+const float SIN_C9 = 2.75573192239858907e-6f;
+const float SIN_C11 = -2.50521083854417188e-8f;
+
+inline float fastSin(float x) {
+    // round to nearest without going through libm
+    float q = x * INV_PI;
+    int k = (int)(q < 0.0f ? q - 0.5f : q + 0.5f);
+    float kf = (float)k;
+    float r = (x - kf * PI_HI) - kf * PI_LO;
+    float r2 = r * r;
+    float p = r + r * r2 * (SIN_C3 + r2 * (SIN_C5 + r2 * (SIN_C7 + r2 * (SIN_C9 + r2 * SIN_C11))));
+    // sin(r + k * pi) = (-1)^k * sin(r)
+    return (k & 1) ? -p : p;
+}
+
+#if defined(MATHS_AVX2)
+inline __m256 fastSin8(__m256 x) {
+    __m256i k = _mm256_cvtps_epi32(_mm256_mul_ps(x, _mm256_set1_ps(INV_PI)));
+    __m256 kf = _mm256_cvtepi32_ps(k);
+    __m256 r = _mm256_sub_ps(_mm256_sub_ps(x, _mm256_mul_ps(kf, _mm256_set1_ps(PI_HI))), _mm256_mul_ps(kf, _mm256_set1_ps(PI_LO)));
+    __m256 r2 = _mm256_mul_ps(r, r);
+    __m256 p = _mm256_add_ps(_mm256_mul_ps(r2, _mm256_set1_ps(SIN_C11)), _mm256_set1_ps(SIN_C9));
+    p = _mm256_add_ps(_mm256_mul_ps(r2, p), _mm256_set1_ps(SIN_C7));
+    p = _mm256_add_ps(_mm256_mul_ps(r2, p), _mm256_set1_ps(SIN_C5));
+    p = _mm256_add_ps(_mm256_mul_ps(r2, p), _mm256_set1_ps(SIN_C3));
+    p = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(r, r2), p), r);
+    // move the parity bit of k into the sign bit
+    __m256 sign = _mm256_castsi256_ps(_mm256_slli_epi32(k, 31));
+    return _mm256_xor_ps(p, sign);
+}
+#endif
+
+#if defined(MATHS_SSE)
+inline __m128 fastSin4(__m128 x) {
+    __m128i k = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(INV_PI)));
+    __m128 kf = _mm_cvtepi32_ps(k);
+    __m128 r = _mm_sub_ps(_mm_sub_ps(x, _mm_mul_ps(kf, _mm_set1_ps(PI_HI))), _mm_mul_ps(kf, _mm_set1_ps(PI_LO)));
+    __m128 r2 = _mm_mul_ps(r, r);
+    __m128 p = _mm_add_ps(_mm_mul_ps(r2, _mm_set1_ps(SIN_C11)), _mm_set1_ps(SIN_C9));
+    p = _mm_add_ps(_mm_mul_ps(r2, p), _mm_set1_ps(SIN_C7));
+    p = _mm_add_ps(_mm_mul_ps(r2, p), _mm_set1_ps(SIN_C5));
+    p = _mm_add_ps(_mm_mul_ps(r2, p), _mm_set1_ps(SIN_C3));
+    p = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(r, r2), p), r);
+    __m128 sign = _mm_castsi128_ps(_mm_slli_epi32(k, 31));
+    return _mm_xor_ps(p, sign);
+}
+#endif
+
+// Evaluates tracks [begin, end) at time t.
+// Result i is written to out[i * stride], so out can point into an interleaved
+// vertex buffer (stride = floats per vertex) or a tightly packed one (stride = 1).
+inline void evaluateSinRemap(const float* a, const float* b, const float* omega, const float* phase,
+                             std::size_t begin, std::size_t end, float t, float* out, std::size_t stride = 1) {
+    std::size_t i = begin;
+
+#if defined(MATHS_AVX2)
+    __m256 t8 = _mm256_set1_ps(t);
+    __m256 half8 = _mm256_set1_ps(0.5f);
+    alignas(32) float tmp[8];
+    for (; i + 8 <= end; i += 8) {
+        __m256 va = _mm256_loadu_ps(a + i);
+        __m256 vb = _mm256_loadu_ps(b + i);
+        __m256 x = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(omega + i), t8), _mm256_loadu_ps(phase + i));
+        __m256 range = _mm256_mul_ps(_mm256_sub_ps(vb, va), half8);
+        __m256 mid = _mm256_mul_ps(_mm256_add_ps(va, vb), half8);
+        __m256 v = _mm256_add_ps(_mm256_mul_ps(range, fastSin8(x)), mid);
+        if (stride == 1) {
+            _mm256_storeu_ps(out + i, v);
+        }
+        else {
+            _mm256_store_ps(tmp, v);
+            for (int j = 0; j < 8; j++) {
+                out[(i + j) * stride] = tmp[j];
+            }
+        }
+    }
+#elif defined(MATHS_SSE)
+    __m128 t4 = _mm_set1_ps(t);
+    __m128 half4 = _mm_set1_ps(0.5f);
+    alignas(16) float tmp[4];
+    for (; i + 4 <= end; i += 4) {
+        __m128 va = _mm_loadu_ps(a + i);
+        __m128 vb = _mm_loadu_ps(b + i);
+        __m128 x = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(omega + i), t4), _mm_loadu_ps(phase + i));
+        __m128 range = _mm_mul_ps(_mm_sub_ps(vb, va), half4);
+        __m128 mid = _mm_mul_ps(_mm_add_ps(va, vb), half4);
+        __m128 v = _mm_add_ps(_mm_mul_ps(range, fastSin4(x)), mid);
+        if (stride == 1) {
+            _mm_storeu_ps(out + i, v);
+        }
+        else {
+            _mm_store_ps(tmp, v);
+            for (int j = 0; j < 4; j++) {
+                out[(i + j) * stride] = tmp[j];
+            }
+        }
+    }
+#endif
+
+    // bounded by a count like the loops above, so the compiler doesn't go
+    // looking for the iteration where i * stride would overflow
+    std::size_t count = end > i ? end - i : 0;
+    for (std::size_t j = 0; j < count; j++, i++) {
+        float s = fastSin(omega[i] * t + phase[i]);
+        out[i * stride] = (b[i] - a[i]) * 0.5f * s + (a[i] + b[i]) * 0.5f;
+    }
+}
+
+// Owns the SoA track data and a set of worker threads that split update()
+// between them. The calling thread takes the first chunk, so threadCount = 1
+// means no extra threads at all.
+class SinRemapAnimator {
+public:
+    std::vector<float> a;
+    std::vector<float> b;
+    std::vector<float> omega;
+    std::vector<float> phase;
+
+    // below this many tracks per thread it's cheaper to stay on one core
+    std::size_t minTracksPerThread = 16384;
+
+    explicit SinRemapAnimator(unsigned int threadCount = 0) {
+        if (threadCount == 0) {
+            threadCount = std::thread::hardware_concurrency();
+        }
+        if (threadCount == 0) {
+            threadCount = 1;
+        }
+        chunkCount = threadCount;
+        for (unsigned int i = 1; i < threadCount; i++) {
+            workers.emplace_back(&SinRemapAnimator::workerLoop, this, i);
+        }
+    }
+
+    ~SinRemapAnimator() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            quit = true;
+            generation++;
+        }
+        wake.notify_all();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    SinRemapAnimator(const SinRemapAnimator&) = delete;
+    SinRemapAnimator& operator=(const SinRemapAnimator&) = delete;
+
+    // returns the index of the new track
+    std::size_t add(float minValue, float maxValue, float angularSpeed, float phaseOffset) {
+        a.push_back(minValue);
+        b.push_back(maxValue);
+        omega.push_back(angularSpeed);
+        phase.push_back(phaseOffset);
+        return a.size() - 1;
+    }
+
+    std::size_t size() const {
+        return a.size();
+    }
+
+    unsigned int threadCount() const {
+        return chunkCount;
+    }
+
+    // Evaluates every track at time t into out[i * stride].
+    // out is typically a pointer returned by glMapBufferRange; it's only
+    // written to, never read, so write-combined mappings are fine.
+    void update(float t, float* out, std::size_t stride = 1) {
+        std::size_t count = size();
+        unsigned int chunks = chunkCount;
+        if (chunks > 1 && count / chunks < minTracksPerThread) {
+            chunks = 1;
+        }
+
+        if (chunks == 1) {
+            evaluateSinRemap(a.data(), b.data(), omega.data(), phase.data(), 0, count, t, out, stride);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job.t = t;
+            job.out = out;
+            job.stride = stride;
+            job.count = count;
+            pending = chunkCount - 1;
+            generation++;
+        }
+        wake.notify_all();
+
+        runChunk(0);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this]() { return pending == 0; });
+    }
+
+private:
+    struct Job {
+        float t = 0.0f;
+        float* out = nullptr;
+        std::size_t stride = 1;
+        std::size_t count = 0;
+    };
+
+    std::vector<std::thread> workers;
+    unsigned int chunkCount;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    std::uint64_t generation = 0;
+    unsigned int pending = 0;
+    bool quit = false;
+    Job job;
+
+    void runChunk(unsigned int chunk) {
+        // chunk boundaries are multiples of 8 so each SIMD loop only has one tail
+        std::size_t per = ((job.count + chunkCount - 1) / chunkCount + 7) & ~(std::size_t)7;
+        std::size_t begin = per * chunk;
+        std::size_t end = begin + per < job.count ? begin + per : job.count;
+        if (begin < end) {
+            evaluateSinRemap(a.data(), b.data(), omega.data(), phase.data(), begin, end, job.t, job.out, job.stride);
+        }
+    }
+
+    void workerLoop(unsigned int chunk) {
+        std::uint64_t seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&]() { return generation != seen; });
+                seen = generation;
+                if (quit) {
+                    return;
+                }
+            }
+
+            runChunk(chunk);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--pending == 0) {
+                done.notify_one();
+            }
+        }
+    }
+};
+
+} // namespace animation
+
+#endif
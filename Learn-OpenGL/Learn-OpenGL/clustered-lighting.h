@@ -0,0 +1,382 @@
+#ifndef CLUSTERED_LIGHTING_H
+#define CLUSTERED_LIGHTING_H
+
+#include "gl-ext.h"
+#include "maths.h"
+#include "shader.h"
+
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Clustered forward shading: the view frustum is cut into CLUSTERS_X x
+// CLUSTERS_Y screen tiles and CLUSTERS_Z depth slices (exponential, so near
+// clusters are as thin as far ones look), every point light is assigned to
+// the clusters its sphere touches, and a fragment only loops over the lights
+// of its own cluster instead of all of them.
+//
+// The assignment runs every frame, in one of two places:
+//   - a compute pass (4.3), one invocation per cluster testing every light,
+//     batched through shared memory. Each cluster owns maxLightsPerCluster
+//     slots of the index buffer, so nothing is counted or compacted
+//   - on the CPU (3.3 contexts), light by light: the depth slices the sphere
+//     spans, then the tile rows, then 8 (AVX2) or 4 (SSE) clusters of a row
+//     per test. The lists are compacted before they're uploaded
+// Either way the shader reads the same three buffer textures: the lights
+// (view space position and radius, color), the (offset, count) of every
+// cluster, and the light indices. shaders/fragment/clustered-lighting.fs
+// does the lookup and the shading.
+//     ClusteredLighting lighting(maxLights);
+//     lighting.setProjection(projection, zNear, zFar, width, height);  // again on resize
+//     ...
+//     lighting.update(lights, lightCount, view);
+//     shader.use();
+//     lighting.bind(shader.ID);
+//     draw the scene
+// A light past its radius contributes nothing, so a cluster it misses loses
+// nothing. A cluster holding more than maxLightsPerCluster lights drops the
+// rest (stats.overflowed says how many were dropped last update, CPU only).
+struct PointLight {
+    float position[3];   // world space
+    float radius;        // the light fades to zero at this distance
+    float color[3];
+    float padding;
+};
+
+class ClusteredLighting {
+public:
+    static const unsigned int CLUSTERS_X = 16;
+    static const unsigned int CLUSTERS_Y = 9;
+    static const unsigned int CLUSTERS_Z = 24;
+    static const unsigned int CLUSTER_COUNT = CLUSTERS_X * CLUSTERS_Y * CLUSTERS_Z;
+
+    struct Stats {
+        unsigned int lights = 0;       // sent by the last update()
+        unsigned int assigned = 0;     // (cluster, light) pairs written, CPU only
+        unsigned int overflowed = 0;   // pairs dropped for a full cluster, CPU only
+        unsigned int maxPerCluster = 0;
+    };
+
+    unsigned int capacity;
+    unsigned int maxLightsPerCluster;
+    bool useCompute;             // assign in a compute pass, needs 4.3
+
+    unsigned int lightBuffer;    // 2 vec4 per light: view space position + radius, color
+    unsigned int gridBuffer;     // uvec2 per cluster: first index, light count
+    unsigned int indexBuffer;    // light indices, cluster by cluster
+
+    // shaderDir is the folder holding compute/. useCompute is turned off
+    // without a 4.3 context (and loadGLExtensions).
+    ClusteredLighting(unsigned int capacity, unsigned int maxLightsPerCluster = 256, bool useCompute = true,
+                      const std::string& shaderDir = "../../shaders/")
+        : capacity(capacity), maxLightsPerCluster(maxLightsPerCluster), useCompute(useCompute && hasGLVersion(4, 3)) {
+        if (this->useCompute) {
+            assignShader.reset(new Shader((shaderDir + "compute/cluster-lights.cs").c_str()));
+            lightCountLocation = glGetUniformLocation(assignShader->ID, "lightCount");
+            maxLightsLocation = glGetUniformLocation(assignShader->ID, "maxLightsPerCluster");
+            clusterCountLocation = glGetUniformLocation(assignShader->ID, "clusterCount");
+        }
+
+        glGenBuffers(1, &lightBuffer);
+        glGenBuffers(1, &gridBuffer);
+        glGenBuffers(1, &indexBuffer);
+        glGenBuffers(1, &boundsBuffer);
+        glBindBuffer(GL_TEXTURE_BUFFER, lightBuffer);
+        glBufferData(GL_TEXTURE_BUFFER, (GLsizeiptr)capacity * 2 * 4 * sizeof(float), NULL, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_TEXTURE_BUFFER, gridBuffer);
+        glBufferData(GL_TEXTURE_BUFFER, CLUSTER_COUNT * 2 * sizeof(GLuint), NULL, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_TEXTURE_BUFFER, indexBuffer);
+        glBufferData(GL_TEXTURE_BUFFER, (GLsizeiptr)CLUSTER_COUNT * maxLightsPerCluster * sizeof(GLuint), NULL, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+        glGenTextures(1, &lightTexture);
+        glGenTextures(1, &gridTexture);
+        glGenTextures(1, &indexTexture);
+        glBindTexture(GL_TEXTURE_BUFFER, lightTexture);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, lightBuffer);
+        glBindTexture(GL_TEXTURE_BUFFER, gridTexture);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RG32UI, gridBuffer);
+        glBindTexture(GL_TEXTURE_BUFFER, indexTexture);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_R32UI, indexBuffer);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+
+        for (int i = 0; i < 6; i++) {
+            bounds[i].resize(CLUSTER_COUNT);
+        }
+        viewLights.resize((std::size_t)capacity * 8);
+    }
+
+    ClusteredLighting(const ClusteredLighting&) = delete;
+    ClusteredLighting& operator=(const ClusteredLighting&) = delete;
+
+    // Builds the view space box of every cluster. projection must be a
+    // perspective projection with these near and far planes.
+    void setProjection(const maths::mat4& projection, float zNear, float zFar, int width, int height) {
+        nearPlane = zNear;
+        farPlane = zFar;
+        tileWidth = (float)((width + CLUSTERS_X - 1) / CLUSTERS_X);
+        tileHeight = (float)((height + CLUSTERS_Y - 1) / CLUSTERS_Y);
+        // slice = log(depth) * zScale + zBias, depth = near * (far / near)^(slice / CLUSTERS_Z)
+        zScale = CLUSTERS_Z / std::log(farPlane / nearPlane);
+        zBias = -std::log(nearPlane) * zScale;
+
+        maths::mat4 inverseProjection = maths::inverse(projection);
+        // the ray through a tile corner, scaled to depth 1
+        auto ray = [&](float px, float py) {
+            maths::vec4 p = inverseProjection * maths::vec4(2.0f * px / width - 1.0f, 2.0f * py / height - 1.0f, -1.0f, 1.0f);
+            return maths::vec3(p.x, p.y, p.z) / -p.z;
+        };
+
+        std::vector<float> boxes((std::size_t)CLUSTER_COUNT * 8);
+        for (unsigned int z = 0; z < CLUSTERS_Z; z++) {
+            float depth0 = nearPlane * std::pow(farPlane / nearPlane, (float)z / CLUSTERS_Z);
+            float depth1 = nearPlane * std::pow(farPlane / nearPlane, (float)(z + 1) / CLUSTERS_Z);
+            for (unsigned int y = 0; y < CLUSTERS_Y; y++) {
+                for (unsigned int x = 0; x < CLUSTERS_X; x++) {
+                    unsigned int c = (z * CLUSTERS_Y + y) * CLUSTERS_X + x;
+                    maths::vec3 lo(1e30f, 1e30f, 1e30f), hi(-1e30f, -1e30f, -1e30f);
+                    for (int corner = 0; corner < 8; corner++) {
+                        maths::vec3 r = ray((x + (corner & 1)) * tileWidth, (y + ((corner >> 1) & 1)) * tileHeight);
+                        maths::vec3 p = r * (corner & 4 ? depth1 : depth0);
+                        lo = maths::vec3(std::fmin(lo.x, p.x), std::fmin(lo.y, p.y), std::fmin(lo.z, p.z));
+                        hi = maths::vec3(std::fmax(hi.x, p.x), std::fmax(hi.y, p.y), std::fmax(hi.z, p.z));
+                    }
+                    float* box = &boxes[(std::size_t)c * 8];
+                    box[0] = bounds[0][c] = lo.x;
+                    box[1] = bounds[1][c] = lo.y;
+                    box[2] = bounds[2][c] = lo.z;
+                    box[3] = 0.0f;
+                    box[4] = bounds[3][c] = hi.x;
+                    box[5] = bounds[4][c] = hi.y;
+                    box[6] = bounds[5][c] = hi.z;
+                    box[7] = 0.0f;
+                }
+            }
+        }
+
+        if (useCompute) {
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, boundsBuffer);
+            glBufferData(GL_SHADER_STORAGE_BUFFER, (GLsizeiptr)(boxes.size() * sizeof(float)), boxes.data(), GL_STATIC_DRAW);
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        }
+    }
+
+    // moves count lights (at most capacity) to view space and assigns them
+    void update(const PointLight* lights, unsigned int count, const maths::mat4& view) {
+        count = count < capacity ? count : capacity;
+        stats = Stats();
+        stats.lights = count;
+        for (unsigned int i = 0; i < count; i++) {
+            const PointLight& light = lights[i];
+            maths::vec4 p = view * maths::vec4(light.position[0], light.position[1], light.position[2], 1.0f);
+            float* out = &viewLights[(std::size_t)i * 8];
+            out[0] = p.x;
+            out[1] = p.y;
+            out[2] = p.z;
+            out[3] = light.radius;
+            out[4] = light.color[0];
+            out[5] = light.color[1];
+            out[6] = light.color[2];
+            out[7] = 0.0f;
+        }
+        lightCount = count;
+        glBindBuffer(GL_TEXTURE_BUFFER, lightBuffer);
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, (GLsizeiptr)count * 8 * sizeof(float), viewLights.data());
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+        if (useCompute) {
+            assignGpu();
+        }
+        else {
+            assignCpu();
+        }
+    }
+
+    // Binds the three buffer textures to units firstUnit.. firstUnit + 2 and
+    // sets the uniforms of clustered-lighting.fs on program, which must be
+    // the one in use.
+    void bind(GLuint program, int firstUnit = 0) {
+        GLuint textures[3] = { lightTexture, gridTexture, indexTexture };
+        const char* names[3] = { "lights", "clusterGrid", "lightIndices" };
+        for (int i = 0; i < 3; i++) {
+            glActiveTexture(GL_TEXTURE0 + firstUnit + i);
+            glBindTexture(GL_TEXTURE_BUFFER, textures[i]);
+            glUniform1i(glGetUniformLocation(program, names[i]), firstUnit + i);
+        }
+        glActiveTexture(GL_TEXTURE0);
+        glUniform3ui(glGetUniformLocation(program, "clusterCount"), CLUSTERS_X, CLUSTERS_Y, CLUSTERS_Z);
+        glUniform2f(glGetUniformLocation(program, "tileSize"), tileWidth, tileHeight);
+        glUniform2f(glGetUniformLocation(program, "sliceScaleBias"), zScale, zBias);
+        glUniform1ui(glGetUniformLocation(program, "lightCount"), lightCount);
+        glUniform1i(glGetUniformLocation(program, "clustered"), 1);
+    }
+
+    const Stats& getStats() const {
+        return stats;
+    }
+
+    // delete all GL objects owned by the lighting
+    void del() {
+        glDeleteTextures(1, &lightTexture);
+        glDeleteTextures(1, &gridTexture);
+        glDeleteTextures(1, &indexTexture);
+        glDeleteBuffers(1, &lightBuffer);
+        glDeleteBuffers(1, &gridBuffer);
+        glDeleteBuffers(1, &indexBuffer);
+        glDeleteBuffers(1, &boundsBuffer);
+        if (assignShader) {
+            glDeleteProgram(assignShader->ID);
+        }
+    }
+
+private:
+    std::unique_ptr<Shader> assignShader;
+    unsigned int boundsBuffer = 0;   // vec4 min, vec4 max per cluster, read by the compute pass
+    unsigned int lightTexture = 0, gridTexture = 0, indexTexture = 0;
+    GLint lightCountLocation = -1;
+    GLint maxLightsLocation = -1;
+    GLint clusterCountLocation = -1;
+
+    float nearPlane = 0.1f, farPlane = 100.0f;
+    float tileWidth = 1.0f, tileHeight = 1.0f;
+    float zScale = 1.0f, zBias = 0.0f;
+    unsigned int lightCount = 0;
+    Stats stats;
+
+    // cluster boxes as SoA: min x, y, z, max x, y, z
+    std::vector<float> bounds[6];
+    std::vector<float> viewLights;
+    // CPU assignment scratch
+    std::vector<unsigned int> counts, grid, indices;
+    std::vector<unsigned int> pairs;   // cluster, light
+
+    void assignGpu() {
+        assignShader->use();
+        glUniform1ui(lightCountLocation, lightCount);
+        glUniform1ui(maxLightsLocation, maxLightsPerCluster);
+        glUniform1ui(clusterCountLocation, CLUSTER_COUNT);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, lightBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, boundsBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, gridBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, indexBuffer);
+        glDispatchCompute((CLUSTER_COUNT + 127) / 128, 1, 1);
+        // read through buffer textures by the fragment shader
+        glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+    }
+
+    // bit j set when the sphere touches cluster first + j, for count <= 8 clusters of a row
+    unsigned int touchRow(unsigned int first, unsigned int count, float px, float py, float pz, float radius2) const {
+        const float *minX = bounds[0].data() + first, *minY = bounds[1].data() + first, *minZ = bounds[2].data() + first;
+        const float *maxX = bounds[3].data() + first, *maxY = bounds[4].data() + first, *maxZ = bounds[5].data() + first;
+        unsigned int mask = 0;
+        unsigned int i = 0;
+
+#if defined(MATHS_AVX2)
+        if (count == 8) {
+            __m256 zero = _mm256_setzero_ps();
+            __m256 x = _mm256_set1_ps(px), y = _mm256_set1_ps(py), z = _mm256_set1_ps(pz);
+            // distance from the center to the box, per axis
+            __m256 dx = _mm256_max_ps(_mm256_max_ps(_mm256_sub_ps(_mm256_loadu_ps(minX), x), _mm256_sub_ps(x, _mm256_loadu_ps(maxX))), zero);
+            __m256 dy = _mm256_max_ps(_mm256_max_ps(_mm256_sub_ps(_mm256_loadu_ps(minY), y), _mm256_sub_ps(y, _mm256_loadu_ps(maxY))), zero);
+            __m256 dz = _mm256_max_ps(_mm256_max_ps(_mm256_sub_ps(_mm256_loadu_ps(minZ), z), _mm256_sub_ps(z, _mm256_loadu_ps(maxZ))), zero);
+            __m256 d2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+            return (unsigned int)_mm256_movemask_ps(_mm256_cmp_ps(d2, _mm256_set1_ps(radius2), _CMP_LE_OQ));
+        }
+#endif
+#if defined(MATHS_SSE)
+        __m128 zero = _mm_setzero_ps();
+        __m128 x = _mm_set1_ps(px), y = _mm_set1_ps(py), z = _mm_set1_ps(pz), r2 = _mm_set1_ps(radius2);
+        for (; i + 4 <= count; i += 4) {
+            __m128 dx = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(minX + i), x), _mm_sub_ps(x, _mm_loadu_ps(maxX + i))), zero);
+            __m128 dy = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(minY + i), y), _mm_sub_ps(y, _mm_loadu_ps(maxY + i))), zero);
+            __m128 dz = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(minZ + i), z), _mm_sub_ps(z, _mm_loadu_ps(maxZ + i))), zero);
+            __m128 d2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+            mask |= (unsigned int)_mm_movemask_ps(_mm_cmple_ps(d2, r2)) << i;
+        }
+#endif
+
+        for (; i < count; i++) {
+            float dx = std::fmax(std::fmax(minX[i] - px, px - maxX[i]), 0.0f);
+            float dy = std::fmax(std::fmax(minY[i] - py, py - maxY[i]), 0.0f);
+            float dz = std::fmax(std::fmax(minZ[i] - pz, pz - maxZ[i]), 0.0f);
+            mask |= (dx * dx + dy * dy + dz * dz <= radius2 ? 1u : 0u) << i;
+        }
+        return mask;
+    }
+
+    void assignCpu() {
+        counts.assign(CLUSTER_COUNT, 0);
+        pairs.clear();
+
+        for (unsigned int light = 0; light < lightCount; light++) {
+            const float* l = &viewLights[(std::size_t)light * 8];
+            float radius = l[3];
+            float depth = -l[2];
+            if (depth + radius < nearPlane || depth - radius > farPlane) {
+                continue;
+            }
+            // the slices the sphere's depth range spans
+            int z0 = (int)std::floor(std::log(std::fmax(depth - radius, nearPlane)) * zScale + zBias);
+            int z1 = (int)std::floor(std::log(std::fmin(depth + radius, farPlane)) * zScale + zBias);
+            z0 = z0 < 0 ? 0 : z0;
+            z1 = z1 > (int)CLUSTERS_Z - 1 ? (int)CLUSTERS_Z - 1 : z1;
+            float radius2 = radius * radius;
+
+            for (int z = z0; z <= z1; z++) {
+                for (unsigned int y = 0; y < CLUSTERS_Y; y++) {
+                    unsigned int row = (z * CLUSTERS_Y + y) * CLUSTERS_X;
+                    for (unsigned int x = 0; x < CLUSTERS_X; x += 8) {
+                        unsigned int count = CLUSTERS_X - x < 8 ? CLUSTERS_X - x : 8;
+                        unsigned int mask = touchRow(row + x, count, l[0], l[1], l[2], radius2);
+                        while (mask) {
+                            unsigned int c = row + x + lowestBit(mask);
+                            mask &= mask - 1;
+                            counts[c]++;
+                            pairs.push_back(c);
+                            pairs.push_back(light);
+                        }
+                    }
+                }
+            }
+        }
+
+        // offsets of the compacted lists, then the lights in their order of
+        // assignment, which is the light order
+        grid.resize(CLUSTER_COUNT * 2);
+        unsigned int offset = 0;
+        for (unsigned int c = 0; c < CLUSTER_COUNT; c++) {
+            unsigned int kept = counts[c] < maxLightsPerCluster ? counts[c] : maxLightsPerCluster;
+            stats.overflowed += counts[c] - kept;
+            stats.maxPerCluster = counts[c] > stats.maxPerCluster ? counts[c] : stats.maxPerCluster;
+            grid[c * 2] = offset;
+            grid[c * 2 + 1] = 0;
+            offset += kept;
+        }
+        stats.assigned = offset;
+        indices.resize(offset > 0 ? offset : 1);
+        for (std::size_t p = 0; p < pairs.size(); p += 2) {
+            unsigned int c = pairs[p];
+            if (grid[c * 2 + 1] < maxLightsPerCluster) {
+                indices[grid[c * 2] + grid[c * 2 + 1]++] = pairs[p + 1];
+            }
+        }
+
+        glBindBuffer(GL_TEXTURE_BUFFER, gridBuffer);
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, (GLsizeiptr)(grid.size() * sizeof(GLuint)), grid.data());
+        glBindBuffer(GL_TEXTURE_BUFFER, indexBuffer);
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, (GLsizeiptr)offset * sizeof(GLuint), indices.data());
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+
+    static unsigned int lowestBit(unsigned int mask) {
+        unsigned int bit = 0;
+        while (!(mask & 1u)) {
+            mask >>= 1;
+            bit++;
+        }
+        return bit;
+    }
+};
+
+#endif
@@ -0,0 +1,344 @@
+#ifndef CULLING_H
+#define CULLING_H
+
+#include "jobs.h"
+#include "maths.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+// CPU visibility culling over bounding volumes stored as SoA arrays.
+//
+// Every object has a box (center and half extent) and a bounding sphere
+// (the same center and a radius). The batch kernels test 8 (AVX2) or 4 (SSE)
+// objects per iteration and append the indices of the visible ones, in
+// order, to a compact list:
+//   cullSpheres  sphere against the 6 frustum planes (maths::frustumPlanes)
+//   cullBoxes    box against the 6 planes, tighter than the sphere test
+//   cullRect     the xy extent against a 2D rectangle, for scenes drawn
+//                straight in NDC (or any other 2D space)
+// A plane test is conservative: an object straddling a corner of the frustum
+// can be reported visible, one that is visible is never culled.
+//
+// CullingSet owns the arrays and splits a cull into chunks run on a
+// JobSystem:
+//     CullingSet set;
+//     set.addBox(min, max);  set.addSphere(center, radius);  ...
+//     maths::vec4 planes[6];
+//     maths::frustumPlanes(projection * view, planes);
+//     std::vector<unsigned int> visible;
+//     set.cullBoxes(planes, visible, &jobs);
+namespace culling {
+
+#if defined(MATHS_AVX2)
+// appends base + j for every set bit j of mask (8 lanes), returns the new count
+inline std::size_t appendLanes8(int mask, unsigned int base, unsigned int* out, std::size_t n) {
+    if (mask == 0xFF) {
+        __m256i lanes = _mm256_add_epi32(_mm256_set1_epi32((int)base), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+        _mm256_storeu_si256((__m256i*)(out + n), lanes);
+        return n + 8;
+    }
+    // branchless: every lane is written, only the visible ones advance n
+    for (int j = 0; j < 8; j++) {
+        out[n] = base + j;
+        n += (mask >> j) & 1;
+    }
+    return n;
+}
+#endif
+
+#if defined(MATHS_SSE)
+inline std::size_t appendLanes4(int mask, unsigned int base, unsigned int* out, std::size_t n) {
+    for (int j = 0; j < 4; j++) {
+        out[n] = base + j;
+        n += (mask >> j) & 1;
+    }
+    return n;
+}
+#endif
+
+// Spheres [begin, end) against the planes, writes the visible indices to
+// out (room for end - begin) and returns how many there are.
+inline std::size_t cullSpheres(const float* x, const float* y, const float* z, const float* radius,
+                               std::size_t begin, std::size_t end, const maths::vec4 planes[6], unsigned int* out) {
+    std::size_t n = 0;
+    std::size_t i = begin;
+
+#if defined(MATHS_AVX2)
+    for (; i + 8 <= end; i += 8) {
+        __m256 cx = _mm256_loadu_ps(x + i);
+        __m256 cy = _mm256_loadu_ps(y + i);
+        __m256 cz = _mm256_loadu_ps(z + i);
+        __m256 r = _mm256_loadu_ps(radius + i);
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int p = 0; p < 6; p++) {
+            const maths::vec4& plane = planes[p];
+            __m256 d = _mm256_add_ps(_mm256_mul_ps(cx, _mm256_set1_ps(plane.x)), _mm256_set1_ps(plane.w));
+            d = _mm256_add_ps(d, _mm256_mul_ps(cy, _mm256_set1_ps(plane.y)));
+            d = _mm256_add_ps(d, _mm256_mul_ps(cz, _mm256_set1_ps(plane.z)));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(d, r), _mm256_setzero_ps(), _CMP_GT_OQ));
+        }
+        n = appendLanes8(_mm256_movemask_ps(inside), (unsigned int)i, out, n);
+    }
+#elif defined(MATHS_SSE)
+    for (; i + 4 <= end; i += 4) {
+        __m128 cx = _mm_loadu_ps(x + i);
+        __m128 cy = _mm_loadu_ps(y + i);
+        __m128 cz = _mm_loadu_ps(z + i);
+        __m128 r = _mm_loadu_ps(radius + i);
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int p = 0; p < 6; p++) {
+            const maths::vec4& plane = planes[p];
+            __m128 d = _mm_add_ps(_mm_mul_ps(cx, _mm_set1_ps(plane.x)), _mm_set1_ps(plane.w));
+            d = _mm_add_ps(d, _mm_mul_ps(cy, _mm_set1_ps(plane.y)));
+            d = _mm_add_ps(d, _mm_mul_ps(cz, _mm_set1_ps(plane.z)));
+            inside = _mm_and_ps(inside, _mm_cmpgt_ps(_mm_add_ps(d, r), _mm_setzero_ps()));
+        }
+        n = appendLanes4(_mm_movemask_ps(inside), (unsigned int)i, out, n);
+    }
+#endif
+
+    for (; i < end; i++) {
+        bool inside = true;
+        for (int p = 0; p < 6; p++) {
+            const maths::vec4& plane = planes[p];
+            inside &= x[i] * plane.x + plane.w + y[i] * plane.y + z[i] * plane.z + radius[i] > 0.0f;
+        }
+        out[n] = (unsigned int)i;
+        n += inside ? 1 : 0;
+    }
+    return n;
+}
+
+// Boxes [begin, end) against the planes. A box is outside a plane when its
+// corner furthest along the normal is, that corner's distance is
+// n . center + |n| . extent + w.
+inline std::size_t cullBoxes(const float* x, const float* y, const float* z,
+                             const float* extentX, const float* extentY, const float* extentZ,
+                             std::size_t begin, std::size_t end, const maths::vec4 planes[6], unsigned int* out) {
+    std::size_t n = 0;
+    std::size_t i = begin;
+
+#if defined(MATHS_AVX2)
+    for (; i + 8 <= end; i += 8) {
+        __m256 cx = _mm256_loadu_ps(x + i);
+        __m256 cy = _mm256_loadu_ps(y + i);
+        __m256 cz = _mm256_loadu_ps(z + i);
+        __m256 ex = _mm256_loadu_ps(extentX + i);
+        __m256 ey = _mm256_loadu_ps(extentY + i);
+        __m256 ez = _mm256_loadu_ps(extentZ + i);
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int p = 0; p < 6; p++) {
+            const maths::vec4& plane = planes[p];
+            __m256 d = _mm256_add_ps(_mm256_mul_ps(cx, _mm256_set1_ps(plane.x)), _mm256_set1_ps(plane.w));
+            d = _mm256_add_ps(d, _mm256_mul_ps(cy, _mm256_set1_ps(plane.y)));
+            d = _mm256_add_ps(d, _mm256_mul_ps(cz, _mm256_set1_ps(plane.z)));
+            d = _mm256_add_ps(d, _mm256_mul_ps(ex, _mm256_set1_ps(std::fabs(plane.x))));
+            d = _mm256_add_ps(d, _mm256_mul_ps(ey, _mm256_set1_ps(std::fabs(plane.y))));
+            d = _mm256_add_ps(d, _mm256_mul_ps(ez, _mm256_set1_ps(std::fabs(plane.z))));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(d, _mm256_setzero_ps(), _CMP_GT_OQ));
+        }
+        n = appendLanes8(_mm256_movemask_ps(inside), (unsigned int)i, out, n);
+    }
+#elif defined(MATHS_SSE)
+    for (; i + 4 <= end; i += 4) {
+        __m128 cx = _mm_loadu_ps(x + i);
+        __m128 cy = _mm_loadu_ps(y + i);
+        __m128 cz = _mm_loadu_ps(z + i);
+        __m128 ex = _mm_loadu_ps(extentX + i);
+        __m128 ey = _mm_loadu_ps(extentY + i);
+        __m128 ez = _mm_loadu_ps(extentZ + i);
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int p = 0; p < 6; p++) {
+            const maths::vec4& plane = planes[p];
+            __m128 d = _mm_add_ps(_mm_mul_ps(cx, _mm_set1_ps(plane.x)), _mm_set1_ps(plane.w));
+            d = _mm_add_ps(d, _mm_mul_ps(cy, _mm_set1_ps(plane.y)));
+            d = _mm_add_ps(d, _mm_mul_ps(cz, _mm_set1_ps(plane.z)));
+            d = _mm_add_ps(d, _mm_mul_ps(ex, _mm_set1_ps(std::fabs(plane.x))));
+            d = _mm_add_ps(d, _mm_mul_ps(ey, _mm_set1_ps(std::fabs(plane.y))));
+            d = _mm_add_ps(d, _mm_mul_ps(ez, _mm_set1_ps(std::fabs(plane.z))));
+            inside = _mm_and_ps(inside, _mm_cmpgt_ps(d, _mm_setzero_ps()));
+        }
+        n = appendLanes4(_mm_movemask_ps(inside), (unsigned int)i, out, n);
+    }
+#endif
+
+    // same order of operations as the SIMD loops, so a tail object gets the same answer
+    for (; i < end; i++) {
+        bool inside = true;
+        for (int p = 0; p < 6; p++) {
+            const maths::vec4& plane = planes[p];
+            float d = x[i] * plane.x + plane.w + y[i] * plane.y + z[i] * plane.z;
+            d = d + extentX[i] * std::fabs(plane.x) + extentY[i] * std::fabs(plane.y) + extentZ[i] * std::fabs(plane.z);
+            inside &= d > 0.0f;
+        }
+        out[n] = (unsigned int)i;
+        n += inside ? 1 : 0;
+    }
+    return n;
+}
+
+// The xy extent of boxes [begin, end) against rect = (minX, minY, maxX, maxY),
+// touching the edge counts as visible.
+inline std::size_t cullRect(const float* x, const float* y, const float* extentX, const float* extentY,
+                            std::size_t begin, std::size_t end, const maths::vec4& rect, unsigned int* out) {
+    std::size_t n = 0;
+    std::size_t i = begin;
+
+#if defined(MATHS_AVX2)
+    __m256 minX = _mm256_set1_ps(rect.x), minY = _mm256_set1_ps(rect.y);
+    __m256 maxX = _mm256_set1_ps(rect.z), maxY = _mm256_set1_ps(rect.w);
+    for (; i + 8 <= end; i += 8) {
+        __m256 cx = _mm256_loadu_ps(x + i);
+        __m256 cy = _mm256_loadu_ps(y + i);
+        __m256 ex = _mm256_loadu_ps(extentX + i);
+        __m256 ey = _mm256_loadu_ps(extentY + i);
+        __m256 inside = _mm256_and_ps(_mm256_cmp_ps(_mm256_add_ps(cx, ex), minX, _CMP_GE_OQ),
+                                      _mm256_cmp_ps(_mm256_sub_ps(cx, ex), maxX, _CMP_LE_OQ));
+        inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(cy, ey), minY, _CMP_GE_OQ));
+        inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_sub_ps(cy, ey), maxY, _CMP_LE_OQ));
+        n = appendLanes8(_mm256_movemask_ps(inside), (unsigned int)i, out, n);
+    }
+#elif defined(MATHS_SSE)
+    __m128 minX = _mm_set1_ps(rect.x), minY = _mm_set1_ps(rect.y);
+    __m128 maxX = _mm_set1_ps(rect.z), maxY = _mm_set1_ps(rect.w);
+    for (; i + 4 <= end; i += 4) {
+        __m128 cx = _mm_loadu_ps(x + i);
+        __m128 cy = _mm_loadu_ps(y + i);
+        __m128 ex = _mm_loadu_ps(extentX + i);
+        __m128 ey = _mm_loadu_ps(extentY + i);
+        __m128 inside = _mm_and_ps(_mm_cmpge_ps(_mm_add_ps(cx, ex), minX), _mm_cmple_ps(_mm_sub_ps(cx, ex), maxX));
+        inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(cy, ey), minY));
+        inside = _mm_and_ps(inside, _mm_cmple_ps(_mm_sub_ps(cy, ey), maxY));
+        n = appendLanes4(_mm_movemask_ps(inside), (unsigned int)i, out, n);
+    }
+#endif
+
+    for (; i < end; i++) {
+        bool inside = x[i] + extentX[i] >= rect.x && x[i] - extentX[i] <= rect.z &&
+                      y[i] + extentY[i] >= rect.y && y[i] - extentY[i] <= rect.w;
+        out[n] = (unsigned int)i;
+        n += inside ? 1 : 0;
+    }
+    return n;
+}
+
+// Owns the SoA bounding volumes. Every object has both a box and a sphere,
+// addBox() derives the sphere from the box and addSphere() the box from the
+// sphere, so every test works on every object.
+class CullingSet {
+public:
+    std::vector<float> x, y, z;                   // centers
+    std::vector<float> extentX, extentY, extentZ; // box half sizes
+    std::vector<float> radius;                    // sphere radii
+
+    // objects per job, a multiple of 8 so each SIMD loop only has one tail
+    std::size_t chunkSize = 16384;
+
+    // returns the index of the new object
+    std::size_t addBox(const maths::vec3& min, const maths::vec3& max) {
+        maths::vec3 center = (min + max) * 0.5f;
+        maths::vec3 extent = (max - min) * 0.5f;
+        return add(center, extent, maths::length(extent));
+    }
+
+    std::size_t addSphere(const maths::vec3& center, float r) {
+        return add(center, maths::vec3(r), r);
+    }
+
+    void setCenter(std::size_t index, const maths::vec3& center) {
+        x[index] = center.x;
+        y[index] = center.y;
+        z[index] = center.z;
+    }
+
+    std::size_t size() const {
+        return x.size();
+    }
+
+    void clear() {
+        x.clear();
+        y.clear();
+        z.clear();
+        extentX.clear();
+        extentY.clear();
+        extentZ.clear();
+        radius.clear();
+    }
+
+    // The cull functions replace visible with the indices of the objects
+    // that pass, in increasing order, and return how many. With a JobSystem
+    // the objects are split in chunkSize chunks over its workers.
+    std::size_t cullSpheres(const maths::vec4 planes[6], std::vector<unsigned int>& visible, JobSystem* jobs = NULL) const {
+        return run(visible, jobs, [&](std::size_t begin, std::size_t end, unsigned int* out) {
+            return culling::cullSpheres(x.data(), y.data(), z.data(), radius.data(), begin, end, planes, out);
+        });
+    }
+
+    std::size_t cullBoxes(const maths::vec4 planes[6], std::vector<unsigned int>& visible, JobSystem* jobs = NULL) const {
+        return run(visible, jobs, [&](std::size_t begin, std::size_t end, unsigned int* out) {
+            return culling::cullBoxes(x.data(), y.data(), z.data(), extentX.data(), extentY.data(), extentZ.data(),
+                begin, end, planes, out);
+        });
+    }
+
+    // rect = (minX, minY, maxX, maxY), (-1, -1, 1, 1) is the NDC viewport
+    std::size_t cullRect(const maths::vec4& rect, std::vector<unsigned int>& visible, JobSystem* jobs = NULL) const {
+        return run(visible, jobs, [&](std::size_t begin, std::size_t end, unsigned int* out) {
+            return culling::cullRect(x.data(), y.data(), extentX.data(), extentY.data(), begin, end, rect, out);
+        });
+    }
+
+private:
+    std::size_t add(const maths::vec3& center, const maths::vec3& extent, float r) {
+        x.push_back(center.x);
+        y.push_back(center.y);
+        z.push_back(center.z);
+        extentX.push_back(extent.x);
+        extentY.push_back(extent.y);
+        extentZ.push_back(extent.z);
+        radius.push_back(r);
+        return x.size() - 1;
+    }
+
+    // Every chunk writes its indices at its own offset of visible, then the
+    // lists are moved down next to each other. A chunk's list never starts
+    // before its offset, so moving them in order never overwrites one that
+    // hasn't moved yet.
+    template <typename F>
+    std::size_t run(std::vector<unsigned int>& visible, JobSystem* jobs, const F& kernel) const {
+        std::size_t count = size();
+        visible.resize(count);
+        std::size_t chunk = (chunkSize + 7) & ~(std::size_t)7;
+        std::size_t chunks = chunk > 0 ? (count + chunk - 1) / chunk : 1;
+
+        if (jobs == NULL || jobs->threadCount() == 1 || chunks <= 1) {
+            std::size_t n = kernel(0, count, visible.data());
+            visible.resize(n);
+            return n;
+        }
+
+        std::vector<std::size_t> found(chunks);
+        jobs->parallelFor(chunks, 1, [&](std::size_t first, std::size_t last) {
+            for (std::size_t c = first; c < last; c++) {
+                std::size_t begin = c * chunk;
+                std::size_t end = begin + chunk < count ? begin + chunk : count;
+                found[c] = kernel(begin, end, visible.data() + begin);
+            }
+        });
+
+        std::size_t n = found[0];
+        for (std::size_t c = 1; c < chunks; c++) {
+            const unsigned int* from = visible.data() + c * chunk;
+            std::copy(from, from + found[c], visible.data() + n);
+            n += found[c];
+        }
+        visible.resize(n);
+        return n;
+    }
+};
+
+} // namespace culling
+
+#endif
@@ -0,0 +1,175 @@
+#ifndef DYNAMIC_RESOLUTION_H
+#define DYNAMIC_RESOLUTION_H
+
+#include "frame-profiler.h"
+#include "shader.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <deque>
+#include <string>
+
+// Renders the scene at whatever fraction of the window it can afford.
+//
+// DynamicResolution picks a scale every frame from the GPU time of a
+// FrameProfiler scope around the scene. Cost is taken to follow the pixel
+// count, so a frame measured at scale s taking t ms would have hit the
+// target at s * sqrt(target / t). The scale moves there all at once when
+// over budget and a quarter of the way when under, since a result is
+// FrameProfiler::FRAMES frames old by the time it's read, and snaps to
+// multiples of scaleStep so small wobbles of the timer don't change it.
+//
+// The offscreen target stays at the window size and only its lower left
+// renderWidth x renderHeight is drawn, so a change of scale allocates
+// nothing; Upscaler then stretches that corner over the window.
+//     DynamicResolution resolution(16.0f);
+//     Upscaler upscaler;
+//     each frame:
+//     profiler.beginFrame();
+//     resolution.update(profiler, "scene", windowWidth, windowHeight);
+//     bind the target, glViewport(0, 0, resolution.renderWidth, resolution.renderHeight);
+//     profiler.beginGpu("scene"); draw; profiler.endGpu();
+//     bind the default framebuffer, glViewport(0, 0, windowWidth, windowHeight);
+//     upscaler.draw(color, windowWidth, windowHeight, resolution.renderWidth, resolution.renderHeight);
+// getHistory() has the scale and measured time of the last frames, for
+// plotting how the controller behaves; writeHistory() prints it as CSV.
+class DynamicResolution {
+public:
+    struct Sample {
+        unsigned long long frame;
+        float scale;
+        double gpuMs;      // measured time of the frame, negative if it never came back
+    };
+
+    float targetMs;
+    float minScale, maxScale;
+    float scaleStep;
+    std::size_t maxHistory = 4096;
+
+    float scale;                 // of the window, per axis
+    int renderWidth = 1;
+    int renderHeight = 1;
+
+    DynamicResolution(float targetMs, float minScale = 0.5f, float maxScale = 1.0f, float scaleStep = 0.05f)
+        : targetMs(targetMs), minScale(minScale), maxScale(maxScale), scaleStep(scaleStep), scale(maxScale) {}
+
+    // After profiler.beginFrame(): reads the newest time of scope, if there
+    // is one, and sets the render size of this frame for a window of
+    // width x height.
+    void update(const FrameProfiler& profiler, const char* scope, int width, int height) {
+        unsigned long long frame = profiler.frameIndex() - 1;
+        const FrameProfiler::Entry* entry = profiler.find(scope);
+        if (entry && entry->samples != seenSamples) {
+            seenSamples = entry->samples;
+            // the results read by this beginFrame() are from FRAMES frames ago
+            Sample* measured = find(frame - FrameProfiler::FRAMES);
+            if (measured) {
+                measured->gpuMs = entry->last;
+                adjust(measured->scale, entry->last);
+            }
+        }
+
+        renderWidth = std::max(1, (int)std::lround(width * scale));
+        renderHeight = std::max(1, (int)std::lround(height * scale));
+        history.push_back(Sample{ frame, scale, -1.0 });
+        while (history.size() > maxHistory) {
+            history.pop_front();
+        }
+    }
+
+    const std::deque<Sample>& getHistory() const {
+        return history;
+    }
+
+    // frame,scale,gpu ms (empty when unknown), one line per sample
+    void writeHistory(FILE* out) const {
+        fprintf(out, "frame,scale,gpu ms\n");
+        for (const Sample& sample : history) {
+            if (sample.gpuMs >= 0.0) {
+                fprintf(out, "%llu,%.3f,%.3f\n", sample.frame, sample.scale, sample.gpuMs);
+            }
+            else {
+                fprintf(out, "%llu,%.3f,\n", sample.frame, sample.scale);
+            }
+        }
+    }
+
+private:
+    std::deque<Sample> history;
+    unsigned long long seenSamples = 0;
+
+    Sample* find(unsigned long long frame) {
+        for (std::size_t i = history.size(); i-- > 0;) {
+            if (history[i].frame == frame) {
+                return &history[i];
+            }
+            if (history[i].frame < frame) {
+                break;
+            }
+        }
+        return NULL;
+    }
+
+    void adjust(float measuredScale, double ms) {
+        if (ms <= 0.0) {
+            return;
+        }
+        float ideal = measuredScale * (float)std::sqrt(targetMs / ms);
+        float next = scale + (ideal < scale ? 1.0f : 0.25f) * (ideal - scale);
+        next = std::round(next / scaleStep) * scaleStep;
+        scale = std::min(maxScale, std::max(minScale, next));
+    }
+};
+
+// Stretches the lower left corner of a texture over the viewport.
+// sharpness 0 is plain bilinear filtering; above it the result is
+// sharpened against its 4 neighbours, clamped to their range so edges
+// don't ring.
+class Upscaler {
+public:
+    float sharpness = 0.0f;   // 0 to 1
+
+    // shaderDir holds vertex/ and fragment/
+    explicit Upscaler(const std::string& shaderDir = "../../shaders/")
+        : shader((shaderDir + "vertex/fullscreen.vs").c_str(), (shaderDir + "fragment/upscale.fs").c_str()) {
+        glGenVertexArrays(1, &vao);
+        shader.use();
+        shader.setInt("source", 0);
+        regionLocation = glGetUniformLocation(shader.ID, "region");
+        texelLocation = glGetUniformLocation(shader.ID, "texel");
+        sharpnessLocation = glGetUniformLocation(shader.ID, "sharpness");
+    }
+
+    Upscaler(const Upscaler&) = delete;
+    Upscaler& operator=(const Upscaler&) = delete;
+
+    // texture is textureWidth x textureHeight, of which
+    // [0, width) x [0, height) was rendered. Changes the program and VAO.
+    void draw(GLuint texture, int textureWidth, int textureHeight, int width, int height) {
+        shader.use();
+        glUniform2f(regionLocation, (float)width / textureWidth, (float)height / textureHeight);
+        glUniform2f(texelLocation, 1.0f / textureWidth, 1.0f / textureHeight);
+        glUniform1f(sharpnessLocation, sharpness);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glBindVertexArray(vao);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glBindVertexArray(0);
+    }
+
+    // delete all GL objects owned by the upscaler
+    void del() {
+        glDeleteVertexArrays(1, &vao);
+        glDeleteProgram(shader.ID);
+    }
+
+private:
+    Shader shader;
+    unsigned int vao = 0;
+    GLint regionLocation = -1;
+    GLint texelLocation = -1;
+    GLint sharpnessLocation = -1;
+};
+
+#endif
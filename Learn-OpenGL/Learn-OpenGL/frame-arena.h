@@ -0,0 +1,234 @@
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// Linear allocator for data that only lives until the end of the frame.
+//
+// allocate() bumps a pointer inside one block of memory and reset() rewinds
+// it, so transient arrays, draw lists and uniform names cost no heap
+// allocation. When a frame needs more than the block, extra blocks are taken
+// from the heap and the next reset() replaces everything with one block big
+// enough for that frame, so after a frame or two the loop allocates nothing.
+//
+//     FrameArena& arena = frameArena();   // one per thread
+//     arena.reset();                      // once per frame, before anything uses it
+//     FrameVector<DrawItem> draws;        // std::vector in the arena
+//     const char* name = arena.format("lights[%d].position", i);
+//     shader.setVec2(name, x, y);
+//
+// Nothing allocated from the arena may be used after the next reset(), and
+// destructors are never run, so only put trivially destructible objects or
+// FrameAllocator containers that die before the reset in it.
+class FrameArena {
+public:
+    explicit FrameArena(std::size_t capacity = 1 << 20) {
+        grow(capacity);
+    }
+
+    ~FrameArena() {
+        release();
+        ::operator delete(block);
+    }
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    void* allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t)) {
+        std::uintptr_t aligned = ((std::uintptr_t)top + alignment - 1) & ~(std::uintptr_t)(alignment - 1);
+        if (aligned + size > (std::uintptr_t)end) {
+            return allocateOverflow(size, alignment);
+        }
+        top = (char*)(aligned + size);
+        allocations++;
+        return (void*)aligned;
+    }
+
+    // gives the memory back if it was the last allocation, which lets a
+    // container that shrinks or is destroyed right away reuse it
+    void deallocate(void* pointer, std::size_t size) {
+        if ((char*)pointer + size == top) {
+            top = (char*)pointer;
+        }
+    }
+
+    // uninitialized storage for count objects
+    template <typename T>
+    T* allocateArray(std::size_t count) {
+        return (T*)allocate(count * sizeof(T), alignof(T));
+    }
+
+    template <typename T, typename... Args>
+    T* make(Args&&... args) {
+        static_assert(std::is_trivially_destructible<T>::value, "the arena never runs destructors");
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    // zero terminated copy, so it can be passed to GL
+    const char* copyString(std::string_view text) {
+        char* copy = (char*)allocate(text.size() + 1, 1);
+        memcpy(copy, text.data(), text.size());
+        copy[text.size()] = '\0';
+        return copy;
+    }
+
+    // printf into the arena
+    const char* format(const char* fmt, ...) {
+        va_list args;
+        va_start(args, fmt);
+        va_list copy;
+        va_copy(copy, args);
+        // try the space left first, most strings fit
+        std::size_t available = (std::size_t)(end - top);
+        int length = vsnprintf(top, available, fmt, args);
+        va_end(args);
+
+        char* text;
+        if (length >= 0 && (std::size_t)length < available) {
+            text = (char*)allocate((std::size_t)length + 1, 1);
+        }
+        else {
+            text = (char*)allocate(length >= 0 ? (std::size_t)length + 1 : 1, 1);
+            if (length >= 0) {
+                vsnprintf(text, (std::size_t)length + 1, fmt, copy);
+            }
+            else {
+                text[0] = '\0';
+            }
+        }
+        va_end(copy);
+        return text;
+    }
+
+    // frees everything allocated since the last reset
+    void reset() {
+        std::size_t frameBytes = used();
+        peak = frameBytes > peak ? frameBytes : peak;
+
+        // the frame didn't fit: one block for all of it from now on
+        if (!overflow.empty()) {
+            release();
+            ::operator delete(block);
+            grow(peak + peak / 4);
+        }
+        top = block;
+        overflowBytes = 0;
+        allocations = 0;
+    }
+
+    // bytes handed out since the last reset
+    std::size_t used() const {
+        return (std::size_t)(top - block) + overflowBytes;
+    }
+
+    std::size_t capacity() const {
+        return (std::size_t)(end - block);
+    }
+
+    // the most used() seen at a reset
+    std::size_t peakUsed() const {
+        return peak;
+    }
+
+    // allocations since the last reset
+    unsigned int allocationCount() const {
+        return allocations;
+    }
+
+    // blocks taken from the heap over the arena's lifetime, stops growing once the frames fit
+    unsigned int heapBlocks() const {
+        return blocks;
+    }
+
+private:
+    char* block = NULL;
+    char* top = NULL;
+    char* end = NULL;
+    std::vector<void*> overflow;
+    std::size_t overflowBytes = 0;
+    std::size_t peak = 0;
+    unsigned int allocations = 0;
+    unsigned int blocks = 0;
+
+    void grow(std::size_t capacity) {
+        block = (char*)::operator new(capacity);
+        top = block;
+        end = block + capacity;
+        blocks++;
+    }
+
+    void* allocateOverflow(std::size_t size, std::size_t alignment) {
+        void* memory = ::operator new(size + alignment);
+        overflow.push_back(memory);
+        overflowBytes += size;
+        blocks++;
+        allocations++;
+        return (void*)(((std::uintptr_t)memory + alignment - 1) & ~(std::uintptr_t)(alignment - 1));
+    }
+
+    void release() {
+        for (void* memory : overflow) {
+            ::operator delete(memory);
+        }
+        overflow.clear();
+    }
+};
+
+// the calling thread's arena
+inline FrameArena& frameArena() {
+    thread_local FrameArena arena;
+    return arena;
+}
+
+// STL allocator on a FrameArena, the calling thread's unless one is given
+template <typename T>
+class FrameAllocator {
+public:
+    typedef T value_type;
+
+    FrameAllocator() : arena(&frameArena()) {}
+    explicit FrameAllocator(FrameArena& arena) : arena(&arena) {}
+
+    template <typename U>
+    FrameAllocator(const FrameAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(std::size_t count) {
+        return arena->allocateArray<T>(count);
+    }
+
+    void deallocate(T* pointer, std::size_t count) {
+        arena->deallocate(pointer, count * sizeof(T));
+    }
+
+    template <typename U>
+    bool operator==(const FrameAllocator<U>& other) const {
+        return arena == other.arena;
+    }
+
+    template <typename U>
+    bool operator!=(const FrameAllocator<U>& other) const {
+        return arena != other.arena;
+    }
+
+private:
+    template <typename U>
+    friend class FrameAllocator;
+
+    FrameArena* arena;
+};
+
+template <typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+using FrameString = std::basic_string<char, std::char_traits<char>, FrameAllocator<char>>;
+
+#endif
@@ -0,0 +1,194 @@
+#ifndef FRAME_PROFILER_H
+#define FRAME_PROFILER_H
+
+#include <glad/glad.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// One place for the numbers of a frame: GPU times of named scopes, and any
+// value another system wants to show (counts, ratios, latencies). Every
+// entry keeps its last value and its average and maximum since resetStats().
+//
+// GPU scopes are GL_TIME_ELAPSED queries. A scope is read FRAMES frames after
+// it was issued, and only if its result is available by then, so the
+// profiler never makes the CPU wait for the GPU; a late result is dropped.
+//     profiler.beginFrame();
+//     profiler.beginGpu("shadows"); ... profiler.endGpu();
+//     profiler.value("occlusion.culled", culled);
+//     ...
+//     profiler.print();
+// GL_TIME_ELAPSED queries can't be nested, so GPU scopes can't either.
+class FrameProfiler {
+public:
+    static const unsigned int FRAMES = 4;
+
+    struct Entry {
+        std::string name;
+        bool gpu = false;           // a GPU scope in ms, otherwise a published value
+        double last = 0.0;
+        double total = 0.0;
+        double max = 0.0;
+        unsigned long long samples = 0;
+
+        double average() const {
+            return samples > 0 ? total / samples : 0.0;
+        }
+    };
+
+    unsigned long long droppedQueries = 0;  // GPU scopes not ready after FRAMES frames
+
+    FrameProfiler() = default;
+
+    FrameProfiler(const FrameProfiler&) = delete;
+    FrameProfiler& operator=(const FrameProfiler&) = delete;
+
+    // starts a frame, reads the GPU scopes of FRAMES frames ago
+    void beginFrame() {
+        current = (unsigned int)(frame % FRAMES);
+        collect(current, false);
+        frame++;
+    }
+
+    unsigned long long frameIndex() const {
+        return frame;
+    }
+
+    void beginGpu(const char* name) {
+        if (active) {
+            printf("ERROR::FRAME_PROFILER::NESTED_GPU_SCOPE %s\n", name);
+            return;
+        }
+        GLuint query = 0;
+        if (freeQueries.empty()) {
+            glGenQueries(1, &query);
+        }
+        else {
+            query = freeQueries.back();
+            freeQueries.pop_back();
+        }
+        glBeginQuery(GL_TIME_ELAPSED, query);
+        pending[current].push_back(Pending{ entryIndex(name, true), query });
+        active = true;
+    }
+
+    void endGpu() {
+        if (active) {
+            glEndQuery(GL_TIME_ELAPSED);
+            active = false;
+        }
+    }
+
+    // publishes this frame's value of name
+    void value(const char* name, double v) {
+        record(entryIndex(name, false), v);
+    }
+
+    // NULL if name was never recorded
+    const Entry* find(const char* name) const {
+        for (const Entry& entry : entries) {
+            if (entry.name == name) {
+                return &entry;
+            }
+        }
+        return NULL;
+    }
+
+    const std::vector<Entry>& getEntries() const {
+        return entries;
+    }
+
+    // reads every GPU scope still in flight, waiting for them, e.g. before print()
+    void flush() {
+        for (unsigned int slot = 0; slot < FRAMES; slot++) {
+            collect(slot, true);
+        }
+    }
+
+    void resetStats() {
+        for (Entry& entry : entries) {
+            entry.last = entry.total = entry.max = 0.0;
+            entry.samples = 0;
+        }
+        droppedQueries = 0;
+    }
+
+    // one line per entry: last, average and max
+    void print(FILE* out = stdout) const {
+        fprintf(out, "%-32s %10s %10s %10s\n", "", "last", "avg", "max");
+        for (const Entry& entry : entries) {
+            fprintf(out, "%-32s %10.3f %10.3f %10.3f%s\n", entry.name.c_str(), entry.last, entry.average(), entry.max,
+                entry.gpu ? "  ms GPU" : "");
+        }
+    }
+
+    // delete all GL objects owned by the profiler
+    void del() {
+        for (unsigned int slot = 0; slot < FRAMES; slot++) {
+            for (const Pending& p : pending[slot]) {
+                freeQueries.push_back(p.query);
+            }
+            pending[slot].clear();
+        }
+        if (!freeQueries.empty()) {
+            glDeleteQueries((GLsizei)freeQueries.size(), freeQueries.data());
+            freeQueries.clear();
+        }
+    }
+
+private:
+    struct Pending {
+        unsigned int entry;
+        GLuint query;
+    };
+
+    std::vector<Entry> entries;
+    std::vector<Pending> pending[FRAMES];
+    std::vector<GLuint> freeQueries;
+    unsigned long long frame = 0;
+    unsigned int current = 0;
+    bool active = false;
+
+    unsigned int entryIndex(const char* name, bool gpu) {
+        for (std::size_t i = 0; i < entries.size(); i++) {
+            if (entries[i].name == name) {
+                return (unsigned int)i;
+            }
+        }
+        Entry entry;
+        entry.name = name;
+        entry.gpu = gpu;
+        entries.push_back(entry);
+        return (unsigned int)(entries.size() - 1);
+    }
+
+    void record(unsigned int index, double v) {
+        Entry& entry = entries[index];
+        entry.last = v;
+        entry.total += v;
+        entry.max = v > entry.max ? v : entry.max;
+        entry.samples++;
+    }
+
+    void collect(unsigned int slot, bool wait) {
+        for (const Pending& p : pending[slot]) {
+            GLint available = GL_TRUE;
+            if (!wait) {
+                glGetQueryObjectiv(p.query, GL_QUERY_RESULT_AVAILABLE, &available);
+            }
+            if (available) {
+                GLuint64 ns = 0;
+                glGetQueryObjectui64v(p.query, GL_QUERY_RESULT, &ns);
+                record(p.entry, ns / 1e6);
+            }
+            else {
+                droppedQueries++;
+            }
+            freeQueries.push_back(p.query);
+        }
+        pending[slot].clear();
+    }
+};
+
+#endif
@@ -0,0 +1,192 @@
+#ifndef FRAMES_IN_FLIGHT_H
+#define FRAMES_IN_FLIGHT_H
+
+#include <glad/glad.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+
+// Explicit limit on how many frames the CPU may run ahead of the GPU.
+//
+// Without it the only throttle is whatever the driver does inside
+// glfwSwapBuffers, which varies between drivers and settings (and disappears
+// with swap interval 0), so latency and the lifetime of per-frame data are
+// unpredictable. FramesInFlight keeps one fence per frame slot:
+//     unsigned int slot = frames.begin();  // waits for the GPU to finish the frame that last used slot
+//     ... write the per-frame resources of slot, draw ...
+//     frames.end();                        // fences the frame
+//     glfwSwapBuffers(window);
+// With count = 1 the CPU waits for every frame to finish before starting the
+// next (lowest latency, no overlap), 2 is double buffering, 3 lets the CPU
+// get two whole frames ahead.
+//
+// Because begin() guarantees the GPU is done with everything the slot was
+// used for, per-frame data can be rewritten without orphaning or implicit
+// syncs, see FrameRingBuffer below.
+class FramesInFlight {
+public:
+    static const unsigned int MAX_FRAMES = 3;
+
+    struct Stats {
+        unsigned long long frames = 0;
+        unsigned long long waitedFrames = 0;  // frames where the fence wasn't signaled yet
+        double waitMs = 0.0;                  // total CPU time spent blocked in begin()
+        double maxWaitMs = 0.0;
+        double lastWaitMs = 0.0;
+    };
+
+    explicit FramesInFlight(unsigned int count = 2) {
+        setCount(count);
+    }
+
+    FramesInFlight(const FramesInFlight&) = delete;
+    FramesInFlight& operator=(const FramesInFlight&) = delete;
+
+    // clamped to [1, MAX_FRAMES], waits for every frame in flight first
+    void setCount(unsigned int count) {
+        finish();
+        frameCount = count < 1 ? 1 : (count > MAX_FRAMES ? MAX_FRAMES : count);
+        current = 0;
+    }
+
+    unsigned int count() const {
+        return frameCount;
+    }
+
+    // slot of the frame being recorded, valid between begin() and end()
+    unsigned int slot() const {
+        return current;
+    }
+
+    // Starts a frame: waits until the GPU has finished the frame that last
+    // used this slot and returns the slot.
+    unsigned int begin() {
+        stats.lastWaitMs = 0.0;
+        GLsync& fence = fences[current];
+        if (fence != 0) {
+            // the flush bit makes sure the fence was submitted, otherwise the wait could never end
+            GLenum status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+            if (status == GL_TIMEOUT_EXPIRED) {
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                while (status == GL_TIMEOUT_EXPIRED) {
+                    status = glClientWaitSync(fence, 0, 1000000000ull);
+                }
+                stats.lastWaitMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                stats.waitedFrames++;
+            }
+            if (status == GL_WAIT_FAILED) {
+                printf("ERROR::FRAMES_IN_FLIGHT::WAIT_FAILED\n");
+            }
+            glDeleteSync(fence);
+            fence = 0;
+        }
+        stats.waitMs += stats.lastWaitMs;
+        stats.maxWaitMs = stats.lastWaitMs > stats.maxWaitMs ? stats.lastWaitMs : stats.maxWaitMs;
+        return current;
+    }
+
+    // ends the frame started by begin(), after its last GL command
+    void end() {
+        fences[current] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        current = (current + 1) % frameCount;
+        stats.frames++;
+    }
+
+    // waits for all frames in flight, e.g. before deleting per-frame resources
+    void finish() {
+        for (GLsync& fence : fences) {
+            if (fence != 0) {
+                glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+                glDeleteSync(fence);
+                fence = 0;
+            }
+        }
+    }
+
+    const Stats& getStats() const {
+        return stats;
+    }
+
+    void resetStats() {
+        stats = Stats();
+    }
+
+    // deletes the fences without waiting
+    void del() {
+        for (GLsync& fence : fences) {
+            if (fence != 0) {
+                glDeleteSync(fence);
+                fence = 0;
+            }
+        }
+    }
+
+private:
+    GLsync fences[MAX_FRAMES] = {};
+    unsigned int frameCount = 2;
+    unsigned int current = 0;
+    Stats stats;
+};
+
+// One buffer split into a region per frame slot. The region of the current
+// slot is mapped unsynchronized: FramesInFlight::begin() already waited for
+// the GPU to stop reading it, so the driver has nothing to check, copy or
+// orphan.
+//     FrameRingBuffer ring(GL_ARRAY_BUFFER, INSTANCE_COUNT * sizeof(float), frames.count());
+//     unsigned int slot = frames.begin();
+//     float* data = (float*)ring.map(slot); ... ring.unmap();
+//     glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, sizeof(float), (void*)ring.offset(slot));
+class FrameRingBuffer {
+public:
+    unsigned int buffer = 0;
+
+    FrameRingBuffer(GLenum target, std::size_t bytesPerFrame, unsigned int frameCount)
+        : target(target), regionSize(alignUp(bytesPerFrame)), regions(frameCount) {
+        glGenBuffers(1, &buffer);
+        glBindBuffer(target, buffer);
+        glBufferData(target, (GLsizeiptr)(regionSize * regions), NULL, GL_DYNAMIC_DRAW);
+        glBindBuffer(target, 0);
+    }
+
+    FrameRingBuffer(const FrameRingBuffer&) = delete;
+    FrameRingBuffer& operator=(const FrameRingBuffer&) = delete;
+
+    // byte offset of the region of slot, for attribute pointers and range binds
+    std::size_t offset(unsigned int slot) const {
+        return (slot % regions) * regionSize;
+    }
+
+    std::size_t bytesPerFrame() const {
+        return regionSize;
+    }
+
+    // binds the buffer to its target and maps the region of slot, NULL on failure
+    void* map(unsigned int slot) {
+        glBindBuffer(target, buffer);
+        return glMapBufferRange(target, (GLintptr)offset(slot), (GLsizeiptr)regionSize,
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    }
+
+    void unmap() {
+        glUnmapBuffer(target);
+        glBindBuffer(target, 0);
+    }
+
+    void del() {
+        glDeleteBuffers(1, &buffer);
+        buffer = 0;
+    }
+
+private:
+    GLenum target;
+    std::size_t regionSize;
+    unsigned int regions;
+
+    // 256 covers the uniform and storage buffer offset alignments of every implementation
+    static std::size_t alignUp(std::size_t size) {
+        return (size + 255) & ~(std::size_t)255;
+    }
+};
+
+#endif
@@ -0,0 +1,1278 @@
+#ifndef GL_CAPTURE_H
+#define GL_CAPTURE_H
+
+#include "gl-ext.h"
+#include "gl-functions.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Capture and replay of GL command streams at the glad function-pointer level.
+//
+// glcapture::start wraps every glad_gl* pointer (and the gl-ext.h ones) with a
+// recorder that serializes each call into a binary trace: plain arguments by
+// value, the data behind pointer arguments (buffer uploads, uniform arrays,
+// shader sources, texture pixels, writes to mapped buffers) inline, and the
+// object names, uniform locations and syncs the driver returned, so replay
+// can map them to its own. code/tools/capture links this into an unmodified
+// sample through glad's load callback.
+//
+// Frames are found from the GL stream alone: a frame starts with a glClear of
+// the default framebuffer, if something was drawn since the last one. The
+// calls before frame startFrame are the setup, the next frameCount frames are
+// captured, then the recorder unwraps itself and the program runs untouched.
+//
+// glcapture::Replayer loads a trace, plays the setup once and the frames as
+// often as asked, timing every call.
+//
+// Limits: one context on one thread; client-side vertex/index arrays are not
+// supported (core profile doesn't allow them either); pointer arguments of
+// entry points without a rule below are recorded as buffer offsets and
+// reported once.
+namespace glcapture {
+    namespace detail {
+        const char MAGIC[8] = { 'G', 'L', 'C', 'A', 'P', 'T', 'R', '2' };
+
+        // record ids with a special meaning
+        const uint16_t DEFINE = 0xFFFF;   // u16 id, u16 length, name
+        const uint16_t FRAME = 0xFFFE;    // a captured frame starts
+        const uint16_t END = 0xFFFD;
+
+        // how a pointer argument was stored
+        enum Tag : uint8_t {
+            TAG_NULL,       // NULL
+            TAG_OFFSET,     // u64, an offset into a bound buffer
+            TAG_BLOB,       // u32 size, bytes
+            TAG_STRING,     // u32 size, bytes including the terminating zero
+            TAG_STRINGS,    // u32 count, then count strings as TAG_STRING
+            TAG_LENGTHS,    // the lengths of the previous TAG_STRINGS argument
+            TAG_NAMES,      // u32 count, u32 names (input, e.g. glDeleteBuffers)
+            TAG_GENERATED,  // u32 count, the names follow after the call
+            TAG_SCRATCH,    // u32 size, an output the replay doesn't need
+        };
+
+        // object kinds whose names are remapped on replay, as used in Rule::names
+        enum Kind {
+            KIND_BUFFER, KIND_VERTEX_ARRAY, KIND_TEXTURE, KIND_FRAMEBUFFER, KIND_RENDERBUFFER,
+            KIND_SAMPLER, KIND_QUERY, KIND_PROGRAM, KIND_SHADER, KIND_COUNT,
+            KIND_LOCATION = KIND_COUNT, KIND_NONE
+        };
+
+        inline Kind kindOf(char c) {
+            switch (c) {
+            case 'B': return KIND_BUFFER;
+            case 'V': return KIND_VERTEX_ARRAY;
+            case 'T': return KIND_TEXTURE;
+            case 'F': return KIND_FRAMEBUFFER;
+            case 'R': return KIND_RENDERBUFFER;
+            case 'S': return KIND_SAMPLER;
+            case 'Q': return KIND_QUERY;
+            case 'P': return KIND_PROGRAM;
+            case 'H': return KIND_SHADER;
+            case 'L': return KIND_LOCATION;
+            default: return KIND_NONE;
+            }
+        }
+
+        // what the data behind an input pointer argument is
+        enum Payload {
+            PAYLOAD_DEFAULT,  // by type: strings, name arrays, otherwise an offset
+            PAYLOAD_OFFSET,   // buffer offset
+            PAYLOAD_ARRAY,    // args[0] elements (fixed count if -1) of args[1] bytes
+            PAYLOAD_PIXELS,   // args = width, height, depth, format, type indices
+            PAYLOAD_PARAMS,   // 16 bytes for GL_TEXTURE_BORDER_COLOR (pname at args[0]), else 4
+            PAYLOAD_CLEAR,    // 16 bytes for GL_COLOR (buffer at args[0]), else 4
+            PAYLOAD_STRINGS,  // args[0] strings, lengths at args[1] (-1 if none)
+            PAYLOAD_TEXTURE,  // level args[1] of the texture bound to args[0] in format args[2], type args[3], compressed if -1
+        };
+
+        // calls the recorder or replayer has to know about
+        enum Special {
+            SPECIAL_NONE, SPECIAL_DRAW, SPECIAL_CLEAR, SPECIAL_BIND_FRAMEBUFFER, SPECIAL_BIND_BUFFER,
+            SPECIAL_PIXEL_STORE, SPECIAL_USE_PROGRAM, SPECIAL_MAP, SPECIAL_UNMAP
+        };
+
+        struct Rule {
+            const char* names = "";   // kind per argument ('.' plain), then '>' and the kind of the return value
+            Payload payload = PAYLOAD_DEFAULT;
+            int args[5] = { -1, -1, -1, -1, -1 };
+            Payload output = PAYLOAD_DEFAULT;   // size of the outputs that aren't names, a glGet* query by default
+            int outputArgs[5] = { -1, -1, -1, -1, -1 };
+            Special special = SPECIAL_NONE;
+            bool skip = false;        // not recorded (takes a callback)
+        };
+
+        struct NameRule {
+            const char* function;
+            const char* names;
+        };
+
+        // arguments that are object names, uniform locations or create results
+        const NameRule NAME_RULES[] = {
+            { "glAttachShader", "PH" }, { "glDetachShader", "PH" }, { "glBindAttribLocation", "P" },
+            { "glBindFragDataLocation", "P" }, { "glBindFragDataLocationIndexed", "P" }, { "glCompileShader", "H" },
+            { "glCreateProgram", ">P" }, { "glCreateShader", ".>H" }, { "glDeleteProgram", "P" }, { "glDeleteShader", "H" },
+            { "glGetAttribLocation", "P" }, { "glGetUniformLocation", "P.>L" }, { "glGetUniformBlockIndex", "P" },
+            { "glGetFragDataLocation", "P" }, { "glGetFragDataIndex", "P" }, { "glGetProgramiv", "P" },
+            { "glGetProgramInfoLog", "P" }, { "glGetShaderiv", "H" }, { "glGetShaderInfoLog", "H" }, { "glGetShaderSource", "H" },
+            { "glGetActiveUniform", "P" }, { "glGetActiveAttrib", "P" }, { "glGetActiveUniformBlockiv", "P" },
+            { "glGetActiveUniformBlockName", "P" }, { "glGetActiveUniformsiv", "P" }, { "glGetActiveUniformName", "P" },
+            { "glGetUniformIndices", "P" }, { "glGetUniformfv", "PL" }, { "glGetUniformiv", "PL" }, { "glGetUniformuiv", "PL" },
+            { "glGetAttachedShaders", "P" }, { "glIsProgram", "P" }, { "glIsShader", "H" }, { "glLinkProgram", "P" },
+            { "glShaderSource", "H" }, { "glUseProgram", "P" }, { "glValidateProgram", "P" },
+            { "glTransformFeedbackVaryings", "P" }, { "glGetTransformFeedbackVarying", "P" }, { "glUniformBlockBinding", "P" },
+            { "glBindBuffer", ".B" }, { "glBindBufferBase", "..B" }, { "glBindBufferRange", "..B" }, { "glGenBuffers", ".B" },
+            { "glDeleteBuffers", ".B" }, { "glIsBuffer", "B" }, { "glTexBuffer", "..B" },
+            { "glBindVertexArray", "V" }, { "glGenVertexArrays", ".V" }, { "glDeleteVertexArrays", ".V" }, { "glIsVertexArray", "V" },
+            { "glBindTexture", ".T" }, { "glGenTextures", ".T" }, { "glDeleteTextures", ".T" }, { "glIsTexture", "T" },
+            { "glBindFramebuffer", ".F" }, { "glGenFramebuffers", ".F" }, { "glDeleteFramebuffers", ".F" }, { "glIsFramebuffer", "F" },
+            { "glFramebufferTexture", "..T" }, { "glFramebufferTexture1D", "...T" }, { "glFramebufferTexture2D", "...T" },
+            { "glFramebufferTexture3D", "...T" }, { "glFramebufferTextureLayer", "..T" }, { "glFramebufferRenderbuffer", "...R" },
+            { "glBindRenderbuffer", ".R" }, { "glGenRenderbuffers", ".R" }, { "glDeleteRenderbuffers", ".R" }, { "glIsRenderbuffer", "R" },
+            { "glBindSampler", ".S" }, { "glGenSamplers", ".S" }, { "glDeleteSamplers", ".S" }, { "glIsSampler", "S" },
+            { "glSamplerParameteri", "S" }, { "glSamplerParameterf", "S" }, { "glSamplerParameteriv", "S" },
+            { "glSamplerParameterfv", "S" }, { "glSamplerParameterIiv", "S" }, { "glSamplerParameterIuiv", "S" },
+            { "glBeginQuery", ".Q" }, { "glGenQueries", ".Q" }, { "glDeleteQueries", ".Q" }, { "glIsQuery", "Q" },
+            { "glQueryCounter", "Q" }, { "glGetQueryObjectiv", "Q" }, { "glGetQueryObjectuiv", "Q" },
+            { "glGetQueryObjecti64v", "Q" }, { "glGetQueryObjectui64v", "Q" }, { "glBeginConditionalRender", "Q" },
+        };
+
+        struct PayloadRule {
+            const char* function;
+            Payload payload;
+            int args[5];              // as in Rule, -1 for none
+        };
+
+        // input pointers that aren't strings, name arrays or uniform / vertex attribute arrays
+        const PayloadRule PAYLOAD_RULES[] = {
+            { "glBufferData", PAYLOAD_ARRAY, { 1, 1, -1, -1, -1 } },
+            { "glBufferSubData", PAYLOAD_ARRAY, { 2, 1, -1, -1, -1 } },
+            { "glDrawBuffers", PAYLOAD_ARRAY, { 0, 4, -1, -1, -1 } },
+            { "glMultiDrawArrays", PAYLOAD_ARRAY, { 3, 4, -1, -1, -1 } },
+            { "glInvalidateFramebuffer", PAYLOAD_ARRAY, { 1, 4, -1, -1, -1 } },
+            { "glInvalidateSubFramebuffer", PAYLOAD_ARRAY, { 1, 4, -1, -1, -1 } },
+            { "glCompressedTexImage1D", PAYLOAD_ARRAY, { 5, 1, -1, -1, -1 } },
+            { "glCompressedTexImage2D", PAYLOAD_ARRAY, { 6, 1, -1, -1, -1 } },
+            { "glCompressedTexImage3D", PAYLOAD_ARRAY, { 7, 1, -1, -1, -1 } },
+            { "glCompressedTexSubImage1D", PAYLOAD_ARRAY, { 5, 1, -1, -1, -1 } },
+            { "glCompressedTexSubImage2D", PAYLOAD_ARRAY, { 7, 1, -1, -1, -1 } },
+            { "glCompressedTexSubImage3D", PAYLOAD_ARRAY, { 9, 1, -1, -1, -1 } },
+            { "glTexImage1D", PAYLOAD_PIXELS, { 3, -1, -1, 5, 6 } },
+            { "glTexImage2D", PAYLOAD_PIXELS, { 3, 4, -1, 6, 7 } },
+            { "glTexImage3D", PAYLOAD_PIXELS, { 3, 4, 5, 7, 8 } },
+            { "glTexSubImage1D", PAYLOAD_PIXELS, { 3, -1, -1, 4, 5 } },
+            { "glTexSubImage2D", PAYLOAD_PIXELS, { 4, 5, -1, 6, 7 } },
+            { "glTexSubImage3D", PAYLOAD_PIXELS, { 5, 6, 7, 8, 9 } },
+            { "glTexParameterfv", PAYLOAD_PARAMS, { 1, -1, -1, -1, -1 } },
+            { "glTexParameteriv", PAYLOAD_PARAMS, { 1, -1, -1, -1, -1 } },
+            { "glTexParameterIiv", PAYLOAD_PARAMS, { 1, -1, -1, -1, -1 } },
+            { "glTexParameterIuiv", PAYLOAD_PARAMS, { 1, -1, -1, -1, -1 } },
+            { "glSamplerParameterfv", PAYLOAD_PARAMS, { 1, -1, -1, -1, -1 } },
+            { "glSamplerParameteriv", PAYLOAD_PARAMS, { 1, -1, -1, -1, -1 } },
+            { "glSamplerParameterIiv", PAYLOAD_PARAMS, { 1, -1, -1, -1, -1 } },
+            { "glSamplerParameterIuiv", PAYLOAD_PARAMS, { 1, -1, -1, -1, -1 } },
+            { "glClearBufferiv", PAYLOAD_CLEAR, { 0, -1, -1, -1, -1 } },
+            { "glClearBufferuiv", PAYLOAD_CLEAR, { 0, -1, -1, -1, -1 } },
+            { "glClearBufferfv", PAYLOAD_CLEAR, { 0, -1, -1, -1, -1 } },
+            { "glShaderSource", PAYLOAD_STRINGS, { 1, 3, -1, -1, -1 } },
+            { "glTransformFeedbackVaryings", PAYLOAD_STRINGS, { 1, -1, -1, -1, -1 } },
+            { "glGetUniformIndices", PAYLOAD_STRINGS, { 1, -1, -1, -1, -1 } },
+            { "glVertexAttribPointer", PAYLOAD_OFFSET, { -1, -1, -1, -1, -1 } },
+            { "glVertexAttribIPointer", PAYLOAD_OFFSET, { -1, -1, -1, -1, -1 } },
+            { "glDrawElements", PAYLOAD_OFFSET, { -1, -1, -1, -1, -1 } },
+            { "glDrawElementsInstanced", PAYLOAD_OFFSET, { -1, -1, -1, -1, -1 } },
+            { "glDrawRangeElements", PAYLOAD_OFFSET, { -1, -1, -1, -1, -1 } },
+            { "glDrawElementsBaseVertex", PAYLOAD_OFFSET, { -1, -1, -1, -1, -1 } },
+            { "glDrawRangeElementsBaseVertex", PAYLOAD_OFFSET, { -1, -1, -1, -1, -1 } },
+            { "glDrawElementsInstancedBaseVertex", PAYLOAD_OFFSET, { -1, -1, -1, -1, -1 } },
+            { "glDrawArraysIndirect", PAYLOAD_OFFSET, { -1, -1, -1, -1, -1 } },
+            { "glDrawElementsIndirect", PAYLOAD_OFFSET, { -1, -1, -1, -1, -1 } },
+        };
+
+        // outputs that can be bigger than a glGet* query, so the replay knows what to allocate
+        const PayloadRule OUTPUT_RULES[] = {
+            { "glReadPixels", PAYLOAD_PIXELS, { 2, 3, -1, 4, 5 } },
+            { "glGetTexImage", PAYLOAD_TEXTURE, { 0, 1, 2, 3, -1 } },
+            { "glGetCompressedTexImage", PAYLOAD_TEXTURE, { 0, 1, -1, -1, -1 } },
+            { "glGetBufferSubData", PAYLOAD_ARRAY, { 2, 1, -1, -1, -1 } },
+            { "glGetShaderInfoLog", PAYLOAD_ARRAY, { 1, 1, -1, -1, -1 } },
+            { "glGetProgramInfoLog", PAYLOAD_ARRAY, { 1, 1, -1, -1, -1 } },
+            { "glGetShaderSource", PAYLOAD_ARRAY, { 1, 1, -1, -1, -1 } },
+            { "glGetActiveUniform", PAYLOAD_ARRAY, { 2, 1, -1, -1, -1 } },
+            { "glGetActiveAttrib", PAYLOAD_ARRAY, { 2, 1, -1, -1, -1 } },
+            { "glGetActiveUniformName", PAYLOAD_ARRAY, { 2, 1, -1, -1, -1 } },
+            { "glGetActiveUniformBlockName", PAYLOAD_ARRAY, { 2, 1, -1, -1, -1 } },
+            { "glGetTransformFeedbackVarying", PAYLOAD_ARRAY, { 2, 1, -1, -1, -1 } },
+            { "glGetActiveUniformsiv", PAYLOAD_ARRAY, { 1, 4, -1, -1, -1 } },
+            { "glGetUniformIndices", PAYLOAD_ARRAY, { 1, 4, -1, -1, -1 } },
+            { "glGetAttachedShaders", PAYLOAD_ARRAY, { 1, 4, -1, -1, -1 } },
+            { "glGetSynciv", PAYLOAD_ARRAY, { 2, 4, -1, -1, -1 } },
+        };
+
+        inline bool startsWith(const char* s, const char* prefix) {
+            return strncmp(s, prefix, strlen(prefix)) == 0;
+        }
+
+        // glUniform{1234}{f,i,ui}v, glUniformMatrix{234}[x{234}]fv and glVertexAttrib*v
+        inline bool arrayRuleFromName(const char* name, Rule& rule) {
+            size_t length = strlen(name);
+            if (name[length - 1] != 'v') {
+                return false;
+            }
+            if (startsWith(name, "glUniformMatrix")) {
+                int columns = name[15] - '0';
+                int rows = name[16] == 'x' ? name[17] - '0' : columns;
+                rule.payload = PAYLOAD_ARRAY;
+                rule.args[0] = 1;
+                rule.args[1] = columns * rows * 4;
+                return true;
+            }
+            if (startsWith(name, "glUniform") && name[9] >= '1' && name[9] <= '4') {
+                rule.payload = PAYLOAD_ARRAY;
+                rule.args[0] = 1;
+                rule.args[1] = (name[9] - '0') * 4;
+                return true;
+            }
+            if (startsWith(name, "glVertexAttrib")) {
+                const char* p = name + 14;
+                if (*p == 'I' || *p == 'L') {
+                    p++;
+                }
+                if (*p == 'P') {
+                    // packed formats, one 32-bit value
+                    rule.payload = PAYLOAD_ARRAY;
+                    rule.args[1] = 4;
+                    return true;
+                }
+                int components = *p - '0';
+                if (components < 1 || components > 4) {
+                    return false;
+                }
+                p++;
+                if (*p == 'N') {
+                    p++;
+                }
+                std::string type(p, name + length - 1);
+                int size = type == "d" ? 8 : (type == "s" || type == "us") ? 2 : (type == "b" || type == "ub") ? 1 : 4;
+                rule.payload = PAYLOAD_ARRAY;
+                rule.args[1] = components * size;
+                return true;
+            }
+            return false;
+        }
+
+        inline Rule makeRule(const char* name) {
+            Rule rule;
+            for (const NameRule& names : NAME_RULES) {
+                if (strcmp(names.function, name) == 0) {
+                    rule.names = names.names;
+                }
+            }
+            if (startsWith(name, "glUniform") && !startsWith(name, "glUniformBlockBinding")) {
+                rule.names = "L";
+            }
+
+            bool found = false;
+            for (const PayloadRule& payload : PAYLOAD_RULES) {
+                if (strcmp(payload.function, name) == 0) {
+                    rule.payload = payload.payload;
+                    memcpy(rule.args, payload.args, sizeof(rule.args));
+                    found = true;
+                }
+            }
+            if (!found) {
+                arrayRuleFromName(name, rule);
+            }
+            for (const PayloadRule& output : OUTPUT_RULES) {
+                if (strcmp(output.function, name) == 0) {
+                    rule.output = output.payload;
+                    memcpy(rule.outputArgs, output.args, sizeof(rule.outputArgs));
+                }
+            }
+
+            if ((startsWith(name, "glDraw") || startsWith(name, "glMultiDraw")) && !startsWith(name, "glDrawBuffer")) {
+                rule.special = SPECIAL_DRAW;
+            }
+            else if (strcmp(name, "glClear") == 0) {
+                rule.special = SPECIAL_CLEAR;
+            }
+            else if (strcmp(name, "glBindFramebuffer") == 0) {
+                rule.special = SPECIAL_BIND_FRAMEBUFFER;
+            }
+            else if (strcmp(name, "glBindBuffer") == 0) {
+                rule.special = SPECIAL_BIND_BUFFER;
+            }
+            else if (strcmp(name, "glPixelStorei") == 0) {
+                rule.special = SPECIAL_PIXEL_STORE;
+            }
+            else if (strcmp(name, "glUseProgram") == 0) {
+                rule.special = SPECIAL_USE_PROGRAM;
+            }
+            else if (strcmp(name, "glMapBuffer") == 0 || strcmp(name, "glMapBufferRange") == 0) {
+                rule.special = SPECIAL_MAP;
+            }
+            else if (strcmp(name, "glUnmapBuffer") == 0) {
+                rule.special = SPECIAL_UNMAP;
+            }
+            return rule;
+        }
+
+        inline Kind argKind(const Rule& rule, size_t index) {
+            for (size_t i = 0; i <= index; i++) {
+                if (rule.names[i] == '\0' || rule.names[i] == '>') {
+                    return KIND_NONE;
+                }
+            }
+            return kindOf(rule.names[index]);
+        }
+
+        inline Kind returnKind(const Rule& rule) {
+            const char* r = strchr(rule.names, '>');
+            return r != NULL ? kindOf(r[1]) : KIND_NONE;
+        }
+
+        inline size_t pixelSize(GLenum format, GLenum type) {
+            size_t components;
+            switch (format) {
+            case GL_RG: case GL_RG_INTEGER: case GL_DEPTH_STENCIL: components = 2; break;
+            case GL_RGB: case GL_BGR: case GL_RGB_INTEGER: case GL_BGR_INTEGER: components = 3; break;
+            case GL_RGBA: case GL_BGRA: case GL_RGBA_INTEGER: case GL_BGRA_INTEGER: components = 4; break;
+            default: components = 1; break;
+            }
+            switch (type) {
+            case GL_UNSIGNED_BYTE: case GL_BYTE: return components;
+            case GL_UNSIGNED_SHORT: case GL_SHORT: case GL_HALF_FLOAT: return components * 2;
+            case GL_UNSIGNED_INT: case GL_INT: case GL_FLOAT: return components * 4;
+            case GL_UNSIGNED_BYTE_3_3_2: case GL_UNSIGNED_BYTE_2_3_3_REV: return 1;
+            case GL_UNSIGNED_SHORT_5_6_5: case GL_UNSIGNED_SHORT_5_6_5_REV: case GL_UNSIGNED_SHORT_4_4_4_4:
+            case GL_UNSIGNED_SHORT_4_4_4_4_REV: case GL_UNSIGNED_SHORT_5_5_5_1: case GL_UNSIGNED_SHORT_1_5_5_5_REV: return 2;
+            case GL_FLOAT_32_UNSIGNED_INT_24_8_REV: return 8;
+            default: return 4;
+            }
+        }
+
+        // -------------------------------------------------------------------
+        // recording
+        // -------------------------------------------------------------------
+        struct Writer {
+            FILE* file = NULL;
+            std::vector<char> buffer;
+            size_t recordStart = 0;
+            size_t written = 0;
+
+            void bytes(const void* data, size_t size) {
+                const char* p = (const char*)data;
+                buffer.insert(buffer.end(), p, p + size);
+            }
+
+            template <typename T>
+            void value(T v) {
+                bytes(&v, sizeof(T));
+            }
+
+            // a record is u16 id, u32 size of what follows, then the payload
+            void beginRecord(uint16_t id) {
+                value(id);
+                recordStart = buffer.size();
+                value((uint32_t)0);
+            }
+
+            void endRecord() {
+                uint32_t size = (uint32_t)(buffer.size() - recordStart - sizeof(uint32_t));
+                memcpy(&buffer[recordStart], &size, sizeof(size));
+                if (buffer.size() > (1 << 20)) {
+                    flush();
+                }
+            }
+
+            void flush() {
+                if (file != NULL && !buffer.empty()) {
+                    fwrite(buffer.data(), 1, buffer.size(), file);
+                    written += buffer.size();
+                }
+                buffer.clear();
+            }
+        };
+
+        struct Mapping {
+            GLenum target;
+            void* pointer;
+            size_t length;
+            bool write;
+        };
+
+        // a glGet* query output, the longest being a list like GL_COMPRESSED_TEXTURE_FORMATS
+        const size_t QUERY_OUTPUT = 4096;
+
+        struct Recorder {
+            bool recording = false;
+            Writer out;
+            std::string path;
+            std::vector<void (*)()> restores;
+            std::vector<const char*> warned;
+            uint16_t nextId = 0;
+
+            int startFrame = 0;
+            int frameCount = 1;
+            int framesStarted = 0;
+            unsigned int drawsSinceFrame = 0;
+
+            GLuint drawFramebuffer = 0;
+            GLuint unpackBuffer = 0;
+            GLint unpackAlignment = 4;
+            GLint packAlignment = 4;
+            size_t outputSize = 0;     // of the outputs of the call being recorded
+            std::unordered_map<const void*, uint64_t> syncs;
+            std::vector<Mapping> mappings;
+
+            uint64_t syncId(GLsync sync) {
+                std::unordered_map<const void*, uint64_t>::iterator it = syncs.find(sync);
+                if (it != syncs.end()) {
+                    return it->second;
+                }
+                uint64_t id = syncs.size() + 1;
+                syncs[sync] = id;
+                return id;
+            }
+
+            void warnOnce(const char* name, const char* what) {
+                for (const char* w : warned) {
+                    if (w == name) {
+                        return;
+                    }
+                }
+                warned.push_back(name);
+                printf("GLCAPTURE: %s %s\n", name, what);
+            }
+        };
+
+        inline Recorder& recorder() {
+            static Recorder r;
+            return r;
+        }
+
+        void stopRecording();
+
+        // a frame starts at a glClear of the default framebuffer once something was drawn
+        inline void onClear() {
+            Recorder& r = recorder();
+            if (r.drawFramebuffer != 0 || (r.framesStarted > 0 && r.drawsSinceFrame == 0)) {
+                return;
+            }
+            int frame = r.framesStarted++;
+            r.drawsSinceFrame = 0;
+            if (frame == r.startFrame + r.frameCount) {
+                stopRecording();
+            }
+            else if (frame >= r.startFrame) {
+                r.out.beginRecord(FRAME);
+                r.out.endRecord();
+            }
+        }
+
+        template <typename T>
+        void writeInput(Recorder& r, const char* name, const Rule& rule, size_t index, T arg, const uint64_t* raw, size_t argCount) {
+            Writer& w = r.out;
+            if constexpr (std::is_same<T, GLsync>::value) {
+                w.value(r.syncId(arg));
+            }
+            else if constexpr (std::is_pointer<T>::value) {
+                typedef typename std::remove_pointer<T>::type Pointee;
+                Kind kind = argKind(rule, index);
+
+                if constexpr (!std::is_const<Pointee>::value) {
+                    // outputs: generated names are written after the call
+                    if (kind != KIND_NONE && kind != KIND_LOCATION) {
+                        w.value((uint8_t)TAG_GENERATED);
+                        w.value((uint32_t)raw[0]);
+                    }
+                    else {
+                        w.value((uint8_t)TAG_SCRATCH);
+                        w.value((uint32_t)r.outputSize);
+                    }
+                }
+                else if (arg == NULL) {
+                    w.value((uint8_t)TAG_NULL);
+                }
+                else if constexpr (std::is_pointer<typename std::remove_cv<Pointee>::type>::value) {
+                    // string arrays, e.g. glShaderSource
+                    if (rule.payload != PAYLOAD_STRINGS) {
+                        r.warnOnce(name, "pointer array argument is not captured");
+                        w.value((uint8_t)TAG_NULL);
+                        return;
+                    }
+                    const GLint* lengths = rule.args[1] >= 0 && rule.args[1] < (int)argCount ? (const GLint*)(uintptr_t)raw[rule.args[1]] : NULL;
+                    uint32_t count = (uint32_t)raw[rule.args[0]];
+                    w.value((uint8_t)TAG_STRINGS);
+                    w.value(count);
+                    for (uint32_t i = 0; i < count; i++) {
+                        const char* s = (const char*)arg[i];
+                        uint32_t length = (uint32_t)(lengths != NULL && lengths[i] >= 0 ? lengths[i] : strlen(s));
+                        w.value(length + 1);
+                        w.bytes(s, length);
+                        w.value((char)0);
+                    }
+                }
+                else if constexpr (std::is_same<typename std::remove_cv<Pointee>::type, GLchar>::value) {
+                    const char* s = (const char*)arg;
+                    uint32_t length = (uint32_t)strlen(s) + 1;
+                    w.value((uint8_t)TAG_STRING);
+                    w.value(length);
+                    w.bytes(s, length);
+                }
+                else if (rule.payload == PAYLOAD_STRINGS) {
+                    w.value((uint8_t)TAG_LENGTHS);
+                }
+                else if (kind != KIND_NONE && kind != KIND_LOCATION) {
+                    // names going away, e.g. glDeleteBuffers
+                    w.value((uint8_t)TAG_NAMES);
+                    w.value((uint32_t)raw[0]);
+                    w.bytes(arg, (size_t)raw[0] * sizeof(GLuint));
+                }
+                else {
+                    size_t size = 0;
+                    bool offset = false;
+                    switch (rule.payload) {
+                    case PAYLOAD_ARRAY:
+                        size = (rule.args[0] >= 0 ? (size_t)raw[rule.args[0]] : 1) * rule.args[1];
+                        break;
+                    case PAYLOAD_PIXELS: {
+                        offset = r.unpackBuffer != 0;
+                        size_t width = (size_t)raw[rule.args[0]];
+                        size_t height = rule.args[1] >= 0 ? (size_t)raw[rule.args[1]] : 1;
+                        size_t depth = rule.args[2] >= 0 ? (size_t)raw[rule.args[2]] : 1;
+                        size_t row = width * pixelSize((GLenum)raw[rule.args[3]], (GLenum)raw[rule.args[4]]);
+                        row = (row + r.unpackAlignment - 1) / r.unpackAlignment * r.unpackAlignment;
+                        size = row * height * depth;
+                        break;
+                    }
+                    case PAYLOAD_PARAMS:
+                        size = raw[rule.args[0]] == GL_TEXTURE_BORDER_COLOR ? 16 : 4;
+                        break;
+                    case PAYLOAD_CLEAR:
+                        size = raw[rule.args[0]] == GL_COLOR ? 16 : 4;
+                        break;
+                    case PAYLOAD_OFFSET:
+                        offset = true;
+                        break;
+                    default:
+                        r.warnOnce(name, "pointer argument recorded as a buffer offset");
+                        offset = true;
+                        break;
+                    }
+
+                    if (offset) {
+                        w.value((uint8_t)TAG_OFFSET);
+                        w.value((uint64_t)(uintptr_t)arg);
+                    }
+                    else {
+                        w.value((uint8_t)TAG_BLOB);
+                        w.value((uint32_t)size);
+                        w.bytes(arg, size);
+                    }
+                }
+            }
+            else {
+                w.value(arg);
+            }
+        }
+
+        template <typename T>
+        void writeOutput(Recorder& r, const Rule& rule, size_t index, T arg, const uint64_t* raw) {
+            if constexpr (std::is_pointer<T>::value && !std::is_same<T, GLsync>::value) {
+                typedef typename std::remove_pointer<T>::type Pointee;
+                if constexpr (!std::is_const<Pointee>::value && std::is_same<typename std::remove_cv<Pointee>::type, GLuint>::value) {
+                    Kind kind = argKind(rule, index);
+                    if (kind != KIND_NONE && kind != KIND_LOCATION) {
+                        r.out.bytes(arg, (size_t)raw[0] * sizeof(GLuint));
+                    }
+                }
+            }
+        }
+
+        template <typename T>
+        uint64_t toRaw(T arg) {
+            if constexpr (std::is_pointer<T>::value) {
+                return (uint64_t)(uintptr_t)arg;
+            }
+            else if constexpr (std::is_integral<T>::value) {
+                return (uint64_t)arg;
+            }
+            else {
+                return 0;
+            }
+        }
+
+        // -------------------------------------------------------------------
+        // replay state
+        // -------------------------------------------------------------------
+        struct Reader {
+            const char* p;
+            const char* end;
+
+            template <typename T>
+            T value() {
+                T v;
+                memcpy(&v, p, sizeof(T));
+                p += sizeof(T);
+                return v;
+            }
+
+            const char* bytes(size_t size) {
+                const char* data = p;
+                p += size;
+                return data;
+            }
+        };
+
+        const size_t SCRATCH_SIZE = 64 << 20;
+
+        struct ReplayState {
+            std::unordered_map<GLuint, GLuint> names[KIND_COUNT];
+            std::unordered_map<uint64_t, GLint> locations;   // (captured program << 32) | captured location
+            std::unordered_map<uint64_t, GLsync> syncs;
+            std::vector<std::pair<GLenum, void*>> mappings;
+            GLuint currentProgram = 0;                        // as captured
+
+            // per call scratch memory for outputs and remapped arrays
+            std::vector<char> scratch;
+            size_t scratchUsed = 0;
+            size_t scratchFailed = 0;    // bytes of the first alloc of the call that didn't fit
+            const GLint* lastLengths = NULL;
+            uint64_t captured[16];
+
+            void* alloc(size_t size) {
+                size = (size + 15) & ~(size_t)15;
+                if (scratchUsed + size > scratch.size()) {
+                    scratchFailed = scratchFailed == 0 ? size : scratchFailed;
+                    return NULL;
+                }
+                void* p = &scratch[scratchUsed];
+                scratchUsed += size;
+                return p;
+            }
+
+            GLuint map(Kind kind, GLuint name) {
+                if (kind == KIND_LOCATION) {
+                    std::unordered_map<uint64_t, GLint>::iterator it = locations.find(((uint64_t)currentProgram << 32) | name);
+                    return it != locations.end() ? (GLuint)it->second : name;
+                }
+                if (kind == KIND_NONE || name == 0) {
+                    return name;
+                }
+                std::unordered_map<GLuint, GLuint>::iterator it = names[kind].find(name);
+                return it != names[kind].end() ? it->second : name;
+            }
+        };
+
+        inline ReplayState& replayState() {
+            static ReplayState s;
+            return s;
+        }
+
+        template <typename T>
+        void readInput(Reader& in, ReplayState& s, const Rule& rule, size_t index, T& arg) {
+            if constexpr (std::is_same<T, GLsync>::value) {
+                uint64_t id = in.value<uint64_t>();
+                s.captured[index] = id;
+                arg = s.syncs[id];
+            }
+            else if constexpr (std::is_pointer<T>::value) {
+                uint8_t tag = in.value<uint8_t>();
+                switch (tag) {
+                case TAG_OFFSET:
+                    arg = (T)(uintptr_t)in.value<uint64_t>();
+                    break;
+                case TAG_BLOB:
+                case TAG_STRING: {
+                    uint32_t size = in.value<uint32_t>();
+                    arg = (T)in.bytes(size);
+                    break;
+                }
+                case TAG_STRINGS: {
+                    uint32_t count = in.value<uint32_t>();
+                    const char** strings = (const char**)s.alloc(count * sizeof(char*));
+                    GLint* lengths = (GLint*)s.alloc(count * sizeof(GLint));
+                    for (uint32_t i = 0; i < count; i++) {
+                        uint32_t size = in.value<uint32_t>();
+                        const char* string = in.bytes(size);
+                        if (strings != NULL && lengths != NULL) {
+                            strings[i] = string;
+                            lengths[i] = (GLint)size - 1;
+                        }
+                    }
+                    s.lastLengths = lengths;
+                    arg = (T)strings;
+                    break;
+                }
+                case TAG_LENGTHS:
+                    arg = (T)s.lastLengths;
+                    break;
+                case TAG_NAMES: {
+                    uint32_t count = in.value<uint32_t>();
+                    GLuint* names = (GLuint*)s.alloc(count * sizeof(GLuint));
+                    Kind kind = argKind(rule, index);
+                    for (uint32_t i = 0; i < count; i++) {
+                        GLuint name = s.map(kind, in.value<GLuint>());
+                        if (names != NULL) {
+                            names[i] = name;
+                        }
+                    }
+                    arg = (T)names;
+                    break;
+                }
+                case TAG_GENERATED: {
+                    uint32_t count = in.value<uint32_t>();
+                    s.captured[index] = count;
+                    arg = (T)s.alloc(count * sizeof(GLuint));
+                    break;
+                }
+                case TAG_SCRATCH:
+                    arg = (T)s.alloc(in.value<uint32_t>());
+                    break;
+                default:
+                    arg = NULL;
+                    break;
+                }
+            }
+            else {
+                arg = in.value<T>();
+                s.captured[index] = toRaw(arg);
+                if constexpr (std::is_integral<T>::value) {
+                    Kind kind = argKind(rule, index);
+                    if (kind != KIND_NONE) {
+                        arg = (T)s.map(kind, (GLuint)arg);
+                    }
+                }
+            }
+        }
+
+        template <typename T>
+        void readOutput(Reader& in, ReplayState& s, const Rule& rule, size_t index, T& arg) {
+            if constexpr (std::is_pointer<T>::value && !std::is_same<T, GLsync>::value) {
+                typedef typename std::remove_pointer<T>::type Pointee;
+                Kind kind = argKind(rule, index);
+                if (kind == KIND_NONE || kind == KIND_LOCATION) {
+                    return;
+                }
+                if constexpr (!std::is_const<Pointee>::value && std::is_same<typename std::remove_cv<Pointee>::type, GLuint>::value) {
+                    // generated: captured name -> our name
+                    uint32_t count = (uint32_t)s.captured[index];
+                    for (uint32_t i = 0; i < count; i++) {
+                        s.names[kind][in.value<GLuint>()] = arg[i];
+                    }
+                }
+                else if constexpr (std::is_same<typename std::remove_cv<Pointee>::type, GLuint>::value) {
+                    // deleted: forget the mapping, the driver may reuse the name
+                    for (size_t i = 0; i < (size_t)s.captured[0]; i++) {
+                        for (std::pair<const GLuint, GLuint>& entry : s.names[kind]) {
+                            if (entry.second == arg[i]) {
+                                s.names[kind].erase(entry.first);
+                                break;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        // -------------------------------------------------------------------
+        // per entry point wrapper: records when capturing, decodes when replaying
+        // -------------------------------------------------------------------
+        template <auto Slot>
+        struct Hook;
+
+        template <typename R, typename... Args, R (APIENTRY** Slot)(Args...)>
+        struct Hook<Slot> {
+            typedef R (APIENTRY* Function)(Args...);
+
+            static inline Function real = NULL;
+            static inline const char* name = NULL;
+            static inline int id = -1;
+            static inline Rule rule;
+
+            static constexpr bool takesCallback = (std::is_function<typename std::remove_pointer<Args>::type>::value || ...);
+
+            static void init(const char* functionName) {
+                name = functionName;
+                rule = makeRule(functionName);
+                rule.skip = takesCallback;
+                id = -1;
+            }
+
+            static void restore() {
+                *Slot = real;
+            }
+
+            // bytes each output of the call, other than generated names, can take
+            static size_t outputSize(const Recorder& r, const uint64_t* raw) {
+                const int* args = rule.outputArgs;
+                size_t size = QUERY_OUTPUT;
+                switch (rule.output) {
+                case PAYLOAD_ARRAY:
+                    size = (size_t)raw[args[0]] * args[1];
+                    break;
+                case PAYLOAD_PIXELS: {
+                    size_t row = (size_t)raw[args[0]] * pixelSize((GLenum)raw[args[3]], (GLenum)raw[args[4]]);
+                    row = (row + r.packAlignment - 1) / r.packAlignment * r.packAlignment;
+                    size = row * (size_t)raw[args[1]];
+                    break;
+                }
+                case PAYLOAD_TEXTURE: {
+                    GLenum target = (GLenum)raw[args[0]];
+                    GLint level = (GLint)raw[args[1]];
+                    GLint width = 0, height = 0, depth = 0;
+                    if (args[2] < 0) {
+                        Hook<&glGetTexLevelParameteriv>::real(target, level, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &width);
+                        size = (size_t)width;
+                        break;
+                    }
+                    Hook<&glGetTexLevelParameteriv>::real(target, level, GL_TEXTURE_WIDTH, &width);
+                    Hook<&glGetTexLevelParameteriv>::real(target, level, GL_TEXTURE_HEIGHT, &height);
+                    Hook<&glGetTexLevelParameteriv>::real(target, level, GL_TEXTURE_DEPTH, &depth);
+                    size_t row = (size_t)width * pixelSize((GLenum)raw[args[2]], (GLenum)raw[args[3]]);
+                    row = (row + r.packAlignment - 1) / r.packAlignment * r.packAlignment;
+                    size = row * height * depth;
+                    break;
+                }
+                default:
+                    break;
+                }
+                // a length or count written next to a sized output
+                return std::max(size, (size_t)16);
+            }
+
+            static R APIENTRY capture(Args... args) {
+                Recorder& r = recorder();
+                uint64_t raw[sizeof...(Args) + 1] = { toRaw(args)... };
+
+                if (rule.special == SPECIAL_CLEAR && r.recording) {
+                    onClear();
+                }
+                if (!r.recording || rule.skip) {
+                    return real(args...);
+                }
+
+                switch (rule.special) {
+                case SPECIAL_DRAW:
+                    r.drawsSinceFrame++;
+                    break;
+                case SPECIAL_BIND_FRAMEBUFFER:
+                    if (raw[0] == GL_FRAMEBUFFER || raw[0] == GL_DRAW_FRAMEBUFFER) {
+                        r.drawFramebuffer = (GLuint)raw[1];
+                    }
+                    break;
+                case SPECIAL_BIND_BUFFER:
+                    if (raw[0] == GL_PIXEL_UNPACK_BUFFER) {
+                        r.unpackBuffer = (GLuint)raw[1];
+                    }
+                    break;
+                case SPECIAL_PIXEL_STORE:
+                    if (raw[0] == GL_UNPACK_ALIGNMENT) {
+                        r.unpackAlignment = (GLint)raw[1];
+                    }
+                    else if (raw[0] == GL_PACK_ALIGNMENT) {
+                        r.packAlignment = (GLint)raw[1];
+                    }
+                    break;
+                default:
+                    break;
+                }
+
+                if (id < 0) {
+                    id = r.nextId++;
+                    uint16_t length = (uint16_t)strlen(name);
+                    r.out.beginRecord(DEFINE);
+                    r.out.value((uint16_t)id);
+                    r.out.value(length);
+                    r.out.bytes(name, length);
+                    r.out.endRecord();
+                }
+
+                r.outputSize = outputSize(r, raw);
+                r.out.beginRecord((uint16_t)id);
+                size_t index = 0;
+                (writeInput(r, name, rule, index++, args, raw, sizeof...(Args)), ...);
+
+                // what the program wrote into the mapping goes along with the unmap
+                if (rule.special == SPECIAL_UNMAP) {
+                    Mapping mapping = { 0, NULL, 0, false };
+                    for (size_t i = 0; i < r.mappings.size(); i++) {
+                        if (r.mappings[i].target == (GLenum)raw[0]) {
+                            mapping = r.mappings[i];
+                            r.mappings.erase(r.mappings.begin() + i);
+                            break;
+                        }
+                    }
+                    uint32_t size = mapping.write ? (uint32_t)mapping.length : 0;
+                    r.out.value(size);
+                    r.out.bytes(mapping.pointer, size);
+                }
+
+                if constexpr (std::is_void<R>::value) {
+                    real(args...);
+                    index = 0;
+                    (writeOutput(r, rule, index++, args, raw), ...);
+                    r.out.endRecord();
+                }
+                else {
+                    R result = real(args...);
+                    index = 0;
+                    (writeOutput(r, rule, index++, args, raw), ...);
+
+                    if constexpr (std::is_same<R, GLsync>::value) {
+                        r.out.value(r.syncId(result));
+                    }
+                    else if constexpr (std::is_pointer<R>::value) {
+                        if (rule.special == SPECIAL_MAP && result != NULL) {
+                            Mapping mapping;
+                            mapping.target = (GLenum)raw[0];
+                            mapping.pointer = (void*)result;
+                            if (sizeof...(Args) == 4) {
+                                // glMapBufferRange(target, offset, length, access)
+                                mapping.length = (size_t)raw[2];
+                                mapping.write = (raw[3] & GL_MAP_WRITE_BIT) != 0;
+                            }
+                            else {
+                                // glMapBuffer(target, access)
+                                GLint size = 0;
+                                Hook<&glGetBufferParameteriv>::real((GLenum)raw[0], GL_BUFFER_SIZE, &size);
+                                mapping.length = (size_t)size;
+                                mapping.write = raw[1] != GL_READ_ONLY;
+                            }
+                            r.mappings.push_back(mapping);
+                        }
+                    }
+                    else if (returnKind(rule) != KIND_NONE) {
+                        r.out.value(result);
+                    }
+                    r.out.endRecord();
+                    return result;
+                }
+            }
+
+            static void replay(Reader& in, ReplayState& s) {
+                std::tuple<Args...> values;
+                s.scratchUsed = 0;
+                s.scratchFailed = 0;
+                std::apply([&](Args&... arg) {
+                    size_t index = 0;
+                    (readInput(in, s, rule, index++, arg), ...);
+                }, values);
+                if (s.scratchFailed != 0) {
+                    printf("ERROR::GLCAPTURE::SCRATCH_FULL %s needs %zu bytes of scratch, skipped\n", name, s.scratchFailed);
+                    return;
+                }
+
+                if (rule.special == SPECIAL_USE_PROGRAM) {
+                    s.currentProgram = (GLuint)s.captured[0];
+                }
+                if (rule.special == SPECIAL_UNMAP) {
+                    uint32_t size = in.value<uint32_t>();
+                    const char* data = in.bytes(size);
+                    for (size_t i = 0; i < s.mappings.size(); i++) {
+                        if (s.mappings[i].first == (GLenum)s.captured[0]) {
+                            if (s.mappings[i].second != NULL) {
+                                memcpy(s.mappings[i].second, data, size);
+                            }
+                            s.mappings.erase(s.mappings.begin() + i);
+                            break;
+                        }
+                    }
+                }
+
+                if constexpr (std::is_void<R>::value) {
+                    std::apply(*Slot, values);
+                    std::apply([&](Args&... arg) {
+                        size_t index = 0;
+                        (readOutput(in, s, rule, index++, arg), ...);
+                    }, values);
+                }
+                else {
+                    R result = std::apply(*Slot, values);
+                    std::apply([&](Args&... arg) {
+                        size_t index = 0;
+                        (readOutput(in, s, rule, index++, arg), ...);
+                    }, values);
+
+                    if constexpr (std::is_same<R, GLsync>::value) {
+                        s.syncs[in.value<uint64_t>()] = result;
+                    }
+                    else if constexpr (std::is_pointer<R>::value) {
+                        if (rule.special == SPECIAL_MAP) {
+                            s.mappings.push_back(std::make_pair((GLenum)s.captured[0], (void*)result));
+                        }
+                    }
+                    else {
+                        Kind kind = returnKind(rule);
+                        if (kind == KIND_LOCATION) {
+                            GLint captured = in.value<R>();
+                            s.locations[((uint64_t)s.captured[0] << 32) | (GLuint)captured] = (GLint)result;
+                        }
+                        else if (kind != KIND_NONE) {
+                            s.names[kind][(GLuint)in.value<R>()] = (GLuint)result;
+                        }
+                    }
+                }
+            }
+        };
+
+        typedef void (*ReplayFunction)(Reader& in, ReplayState& s);
+
+        inline std::unordered_map<std::string, ReplayFunction>& replayFunctions() {
+            static std::unordered_map<std::string, ReplayFunction> functions;
+            if (functions.empty()) {
+#define GLCAPTURE_REPLAY(name) detail::Hook<&name>::init(#name); functions[#name] = &detail::Hook<&name>::replay;
+                GL_FUNCTIONS(GLCAPTURE_REPLAY)
+                GLEXT_FUNCTIONS(GLCAPTURE_REPLAY)
+#undef GLCAPTURE_REPLAY
+            }
+            return functions;
+        }
+
+        template <auto Slot>
+        void hook(const char* name) {
+            typedef Hook<Slot> H;
+            H::init(name);
+            if (*Slot == NULL) {
+                return;
+            }
+            H::real = *Slot;
+            *Slot = &H::capture;
+            recorder().restores.push_back(&H::restore);
+        }
+
+        inline void stopRecording() {
+            Recorder& r = recorder();
+            if (!r.recording) {
+                return;
+            }
+            r.recording = false;
+            r.out.beginRecord(END);
+            r.out.endRecord();
+            r.out.flush();
+            fclose(r.out.file);
+            r.out.file = NULL;
+
+            int frames = r.framesStarted - r.startFrame;
+            frames = frames < 0 ? 0 : (frames > r.frameCount ? r.frameCount : frames);
+            printf("GLCAPTURE: wrote %d frame(s), %.1f KB to %s\n", frames, r.out.written / 1024.0, r.path.c_str());
+
+            for (void (*restore)() : r.restores) {
+                restore();
+            }
+            r.restores.clear();
+        }
+    }
+
+    // Starts capturing into path: the calls before frame startFrame become the
+    // setup, then frameCount frames are recorded. Call right after the entry
+    // points are loaded, before any GL object is created.
+    inline bool start(const char* path, int startFrame = 0, int frameCount = 1) {
+        detail::Recorder& r = detail::recorder();
+        if (r.recording) {
+            return false;
+        }
+
+        r.out.file = fopen(path, "wb");
+        if (r.out.file == NULL) {
+            printf("ERROR::GLCAPTURE::FILE_NOT_OPENED %s\n", path);
+            return false;
+        }
+        r.path = path;
+        r.startFrame = startFrame;
+        r.frameCount = frameCount;
+        r.framesStarted = 0;
+        r.drawsSinceFrame = 0;
+        r.nextId = 0;
+
+        // the replay needs the window size and context version
+        GLint viewport[4] = { 0, 0, 800, 600 };
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        r.out.bytes(detail::MAGIC, sizeof(detail::MAGIC));
+        r.out.value((int32_t)viewport[2]);
+        r.out.value((int32_t)viewport[3]);
+        r.out.value((int32_t)GLVersion.major);
+        r.out.value((int32_t)GLVersion.minor);
+
+#define GLCAPTURE_HOOK(name) detail::hook<&name>(#name);
+        GL_FUNCTIONS(GLCAPTURE_HOOK)
+        GLEXT_FUNCTIONS(GLCAPTURE_HOOK)
+#undef GLCAPTURE_HOOK
+
+        r.recording = true;
+        return true;
+    }
+
+    // ends the capture early, also done automatically after the last frame
+    inline void stop() {
+        detail::stopRecording();
+    }
+
+    inline bool recording() {
+        return detail::recorder().recording;
+    }
+
+    struct CallTiming {
+        const char* name;
+        unsigned long long calls;
+        double ms;
+    };
+
+    // Plays a trace back. The context must be current and loaded (glad and
+    // loadGLExtensions) before playSetup.
+    class Replayer {
+    public:
+        int width = 800;
+        int height = 600;
+        int glMajor = 3;
+        int glMinor = 3;
+
+        bool load(const char* path) {
+            FILE* file = fopen(path, "rb");
+            if (file == NULL) {
+                printf("ERROR::GLCAPTURE::FILE_NOT_READ %s\n", path);
+                return false;
+            }
+            fseek(file, 0, SEEK_END);
+            data.resize((size_t)ftell(file));
+            fseek(file, 0, SEEK_SET);
+            size_t read = fread(data.data(), 1, data.size(), file);
+            fclose(file);
+
+            const size_t headerSize = sizeof(detail::MAGIC) + 4 * sizeof(int32_t);
+            if (read != data.size() || data.size() < headerSize || memcmp(data.data(), detail::MAGIC, sizeof(detail::MAGIC)) != 0) {
+                printf("ERROR::GLCAPTURE::NOT_A_TRACE %s\n", path);
+                return false;
+            }
+
+            detail::Reader in = { data.data() + sizeof(detail::MAGIC), data.data() + data.size() };
+            width = in.value<int32_t>();
+            height = in.value<int32_t>();
+            glMajor = in.value<int32_t>();
+            glMinor = in.value<int32_t>();
+
+            // split into the setup and the frames, and resolve the function ids
+            std::unordered_map<std::string, detail::ReplayFunction>& known = detail::replayFunctions();
+            setupBegin = in.p;
+            setupEnd = NULL;
+            const char* segmentBegin = in.p;
+            while (in.p + sizeof(uint16_t) + sizeof(uint32_t) <= in.end) {
+                const char* recordBegin = in.p;
+                uint16_t id = in.value<uint16_t>();
+                uint32_t size = in.value<uint32_t>();
+                const char* payload = in.bytes(size);
+
+                if (id == detail::DEFINE) {
+                    detail::Reader define = { payload, payload + size };
+                    uint16_t functionId = define.value<uint16_t>();
+                    uint16_t length = define.value<uint16_t>();
+                    std::string name(define.bytes(length), length);
+                    if (functions.size() <= functionId) {
+                        functions.resize(functionId + 1, NULL);
+                        names.resize(functionId + 1);
+                        timings.resize(functionId + 1, { NULL, 0, 0.0 });
+                    }
+                    std::unordered_map<std::string, detail::ReplayFunction>::iterator it = known.find(name);
+                    functions[functionId] = it != known.end() ? it->second : NULL;
+                    names[functionId] = name;
+                    if (it == known.end()) {
+                        printf("GLCAPTURE: %s is not available, its calls are skipped\n", name.c_str());
+                    }
+                }
+                else if (id == detail::FRAME || id == detail::END) {
+                    if (setupEnd == NULL) {
+                        setupEnd = recordBegin;
+                    }
+                    else {
+                        frames.push_back(std::make_pair(segmentBegin, recordBegin));
+                    }
+                    segmentBegin = in.p;
+                    if (id == detail::END) {
+                        break;
+                    }
+                }
+            }
+            if (setupEnd == NULL) {
+                setupEnd = in.p;
+            }
+            return true;
+        }
+
+        size_t frameCount() const {
+            return frames.size();
+        }
+
+        size_t traceSize() const {
+            return data.size();
+        }
+
+        // creates the objects, untimed
+        void playSetup() {
+            detail::replayState().scratch.resize(detail::SCRATCH_SIZE);
+            play(setupBegin, setupEnd, false);
+        }
+
+        // plays one captured frame, timing each call when timeCalls is set
+        void playFrame(size_t frame, bool timeCalls = true) {
+            play(frames[frame].first, frames[frame].second, timeCalls);
+        }
+
+        // per entry point timing of the timed frames, most expensive first
+        std::vector<CallTiming> callTimings() const {
+            std::vector<CallTiming> result;
+            for (size_t i = 0; i < timings.size(); i++) {
+                if (timings[i].calls > 0) {
+                    result.push_back({ names[i].c_str(), timings[i].calls, timings[i].ms });
+                }
+            }
+            std::sort(result.begin(), result.end(), [](const CallTiming& a, const CallTiming& b) {
+                return a.ms > b.ms;
+            });
+            return result;
+        }
+
+    private:
+        std::vector<char> data;
+        std::vector<detail::ReplayFunction> functions;   // by id
+        std::vector<std::string> names;                  // by id
+        std::vector<CallTiming> timings;                 // by id
+        const char* setupBegin = NULL;
+        const char* setupEnd = NULL;
+        std::vector<std::pair<const char*, const char*>> frames;
+
+        void play(const char* begin, const char* end, bool timeCalls) {
+            typedef std::chrono::steady_clock Clock;
+            detail::ReplayState& s = detail::replayState();
+            detail::Reader in = { begin, end };
+            while (in.p < in.end) {
+                uint16_t id = in.value<uint16_t>();
+                uint32_t size = in.value<uint32_t>();
+                const char* next = in.p + size;
+                if (id < functions.size() && functions[id] != NULL) {
+                    if (timeCalls) {
+                        Clock::time_point start = Clock::now();
+                        functions[id](in, s);
+                        timings[id].calls++;
+                        timings[id].ms += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+                    }
+                    else {
+                        functions[id](in, s);
+                    }
+                }
+                in.p = next;
+            }
+        }
+    };
+}
+
+#endif
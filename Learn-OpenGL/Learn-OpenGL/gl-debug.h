@@ -0,0 +1,269 @@
+#ifndef GL_DEBUG_H
+#define GL_DEBUG_H
+
+#include "gl-ext.h"
+#include "gl-trace.h"
+
+// GL error reporting through debug output (GL 4.3 / GL_KHR_debug) instead of
+// polling glGetError, which synchronizes with the driver.
+//
+// enable() installs a glDebugMessageCallback. Messages below the severity
+// threshold are filtered out by the driver, ids passed to ignore() are
+// dropped, and a message that repeats is printed once, then again at 10, 100,
+// 1000... occurrences. printSummary() lists everything that repeated.
+//
+// Scopes name what the program is doing: every message is printed with the
+// scope path it was raised in, e.g. [runner/particles], and the scopes are
+// also pushed as debug groups so tools like RenderDoc show them. They go on
+// the scope stack of gl-trace.h, so its report names them too.
+//     glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLDEBUG_ENABLED);
+//     ... create the window, load glad and loadGLExtensions ...
+//     gldebug::enable();
+//     {
+//         GLDEBUG_SCOPE("shadow pass");
+//         ...
+//     }
+//
+// GLDEBUG_ENABLED is 1 unless NDEBUG is defined, define it to override. When
+// it is 0 everything here compiles to nothing.
+#ifndef GLDEBUG_ENABLED
+#ifdef NDEBUG
+#define GLDEBUG_ENABLED 0
+#else
+#define GLDEBUG_ENABLED 1
+#endif
+#endif
+
+#if GLDEBUG_ENABLED
+
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace gldebug {
+    namespace detail {
+        struct Record {
+            std::string message;
+            std::string scope;
+            GLenum source;
+            GLenum type;
+            GLenum severity;
+            GLuint id;
+            unsigned int count;
+        };
+
+        // by a hash of (source, type, id, severity), the text and scope tell records apart
+        typedef std::unordered_multimap<size_t, Record> RecordMap;
+
+        struct State {
+            std::mutex mutex;
+            RecordMap records;
+            std::vector<GLuint> ignored;
+            unsigned int messages = 0;
+        };
+
+        inline State& state() {
+            static State s;
+            return s;
+        }
+
+        inline const char* sourceName(GLenum source) {
+            switch (source) {
+            case GL_DEBUG_SOURCE_API: return "API";
+            case GL_DEBUG_SOURCE_WINDOW_SYSTEM: return "WINDOW_SYSTEM";
+            case GL_DEBUG_SOURCE_SHADER_COMPILER: return "SHADER_COMPILER";
+            case GL_DEBUG_SOURCE_THIRD_PARTY: return "THIRD_PARTY";
+            case GL_DEBUG_SOURCE_APPLICATION: return "APPLICATION";
+            default: return "OTHER";
+            }
+        }
+
+        inline const char* typeName(GLenum type) {
+            switch (type) {
+            case GL_DEBUG_TYPE_ERROR: return "ERROR";
+            case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: return "DEPRECATED";
+            case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR: return "UNDEFINED";
+            case GL_DEBUG_TYPE_PORTABILITY: return "PORTABILITY";
+            case GL_DEBUG_TYPE_PERFORMANCE: return "PERFORMANCE";
+            case GL_DEBUG_TYPE_MARKER: return "MARKER";
+            default: return "OTHER";
+            }
+        }
+
+        inline const char* severityName(GLenum severity) {
+            switch (severity) {
+            case GL_DEBUG_SEVERITY_HIGH: return "HIGH";
+            case GL_DEBUG_SEVERITY_MEDIUM: return "MEDIUM";
+            case GL_DEBUG_SEVERITY_LOW: return "LOW";
+            default: return "NOTIFICATION";
+            }
+        }
+
+        inline bool isPowerOfTen(unsigned int n) {
+            while (n >= 10 && n % 10 == 0) {
+                n /= 10;
+            }
+            return n == 1;
+        }
+
+        inline void APIENTRY callback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message, const void*) {
+            // our own debug groups come back as notifications
+            if (type == GL_DEBUG_TYPE_PUSH_GROUP || type == GL_DEBUG_TYPE_POP_GROUP) {
+                return;
+            }
+
+            State& s = state();
+            std::lock_guard<std::mutex> lock(s.mutex);
+            for (GLuint ignoredId : s.ignored) {
+                if (ignoredId == id) {
+                    return;
+                }
+            }
+            s.messages++;
+
+            // messages are delivered on the calling thread (synchronous output),
+            // so its scope stack is the one the message was raised in
+            std::string scope = gltrace::scopePath();
+            std::string text = length < 0 ? std::string(message) : std::string(message, length);
+
+            // the same message from the same scope is one record
+            size_t key = (((size_t)source * 31 + type) * 31 + severity) * 31 + id;
+            Record* found = NULL;
+            std::pair<RecordMap::iterator, RecordMap::iterator> range = s.records.equal_range(key);
+            for (RecordMap::iterator it = range.first; it != range.second; ++it) {
+                Record& candidate = it->second;
+                if (candidate.source == source && candidate.type == type && candidate.id == id && candidate.severity == severity &&
+                    candidate.message == text && candidate.scope == scope) {
+                    found = &candidate;
+                    break;
+                }
+            }
+            if (found == NULL) {
+                found = &s.records.emplace(key, Record{ text, scope, source, type, severity, id, 0 })->second;
+            }
+            Record& record = *found;
+            record.count++;
+
+            if (record.count == 1) {
+                printf("GL_DEBUG::%s::%s::%s [%s] %u: %s\n", sourceName(source), typeName(type), severityName(severity),
+                    scope.c_str(), id, text.c_str());
+            }
+            else if (isPowerOfTen(record.count)) {
+                printf("GL_DEBUG::%s::%s::%s [%s] %u: repeated %u times\n", sourceName(source), typeName(type), severityName(severity),
+                    scope.c_str(), id, record.count);
+            }
+        }
+    }
+
+    // Installs the callback, false if the context has no debug output. Messages
+    // below minSeverity are not generated at all. Synchronous output makes the
+    // driver report a message inside the offending call, which the scope
+    // attribution relies on.
+    inline bool enable(GLenum minSeverity = GL_DEBUG_SEVERITY_LOW) {
+        if (glDebugMessageCallback == NULL || glDebugMessageControl == NULL) {
+            return false;
+        }
+
+        GLint flags = 0;
+        glGetIntegerv(GL_CONTEXT_FLAGS, &flags);
+        if (!(flags & GL_CONTEXT_FLAG_DEBUG_BIT)) {
+            printf("GL_DEBUG: not a debug context, the driver may report fewer messages\n");
+        }
+
+        glEnable(GL_DEBUG_OUTPUT);
+        glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+        glDebugMessageCallback(detail::callback, NULL);
+
+        // filter in the driver, from the least severe level up to the threshold
+        const GLenum severities[] = { GL_DEBUG_SEVERITY_NOTIFICATION, GL_DEBUG_SEVERITY_LOW, GL_DEBUG_SEVERITY_MEDIUM, GL_DEBUG_SEVERITY_HIGH };
+        bool enabled = false;
+        for (GLenum severity : severities) {
+            enabled = enabled || severity == minSeverity;
+            glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, severity, 0, NULL, enabled ? GL_TRUE : GL_FALSE);
+        }
+        return true;
+    }
+
+    inline void disable() {
+        if (glDebugMessageCallback != NULL) {
+            glDebugMessageCallback(NULL, NULL);
+            glDisable(GL_DEBUG_OUTPUT);
+        }
+    }
+
+    // drop messages with this id, e.g. a driver's informational buffer messages
+    inline void ignore(GLuint id) {
+        detail::State& s = detail::state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.ignored.push_back(id);
+    }
+
+    // messages received since enable, repeats included
+    inline unsigned int messageCount() {
+        detail::State& s = detail::state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        return s.messages;
+    }
+
+    // lists the messages that were received more than once
+    inline void printSummary() {
+        detail::State& s = detail::state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        for (const std::pair<const size_t, detail::Record>& entry : s.records) {
+            const detail::Record& record = entry.second;
+            if (record.count > 1) {
+                printf("GL_DEBUG::%s::%s [%s] %u: %u times: %s\n", detail::typeName(record.type), detail::severityName(record.severity),
+                    record.scope.c_str(), record.id, record.count, record.message.c_str());
+            }
+        }
+    }
+
+    // a gltrace::Scope that is also a debug group, name must outlive the scope
+    class Scope {
+    public:
+        explicit Scope(const char* name) : scope(name) {
+            if (glPushDebugGroup != NULL) {
+                glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, name);
+            }
+        }
+
+        ~Scope() {
+            if (glPopDebugGroup != NULL) {
+                glPopDebugGroup();
+            }
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        gltrace::Scope scope;
+    };
+}
+
+#define GLDEBUG_CONCAT_(a, b) a##b
+#define GLDEBUG_CONCAT(a, b) GLDEBUG_CONCAT_(a, b)
+#define GLDEBUG_SCOPE(name) gldebug::Scope GLDEBUG_CONCAT(gldebugScope, __LINE__)(name)
+
+#else
+
+namespace gldebug {
+    inline bool enable(GLenum /*minSeverity*/ = GL_DEBUG_SEVERITY_LOW) { return false; }
+    inline void disable() {}
+    inline void ignore(GLuint /*id*/) {}
+    inline unsigned int messageCount() { return 0; }
+    inline void printSummary() {}
+
+    class Scope {
+    public:
+        explicit Scope(const char* /*name*/) {}
+    };
+}
+
+#define GLDEBUG_SCOPE(name)
+
+#endif
+
+#endif
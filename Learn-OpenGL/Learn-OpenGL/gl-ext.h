@@ -0,0 +1,271 @@
+#ifndef GL_EXT_H
+#define GL_EXT_H
+
+// glad.c in this project is generated for GL 3.3 core only. This header adds
+// the few newer entry points and enums that the optional 4.x code paths use,
+// following glad's naming so the calls look like any other GL call.
+//
+// Every block is guarded by the same macro glad uses for that version, so if
+// glad is ever regenerated with a newer version these declarations step aside.
+//
+// Call loadGLExtensions right after gladLoadGLLoader, with the same loader:
+//     gladLoadGLLoader((GLADloadproc)glfwGetProcAddress);
+//     loadGLExtensions((GLADloadproc)glfwGetProcAddress);
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstring>
+
+// ---------------------------------------------------------------------------
+// GL 4.0
+// ---------------------------------------------------------------------------
+#ifndef GL_VERSION_4_0
+#define GLEXT_LOAD_VERSION_4_0
+
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+
+typedef void (APIENTRYP PFNGLDRAWARRAYSINDIRECTPROC)(GLenum mode, const void* indirect);
+typedef void (APIENTRYP PFNGLDRAWELEMENTSINDIRECTPROC)(GLenum mode, GLenum type, const void* indirect);
+
+inline PFNGLDRAWARRAYSINDIRECTPROC glext_glDrawArraysIndirect = NULL;
+inline PFNGLDRAWELEMENTSINDIRECTPROC glext_glDrawElementsIndirect = NULL;
+
+#define glDrawArraysIndirect glext_glDrawArraysIndirect
+#define glDrawElementsIndirect glext_glDrawElementsIndirect
+
+#define GLEXT_FUNCTIONS_4_0(X) \
+    X(glDrawArraysIndirect) \
+    X(glDrawElementsIndirect)
+#endif
+
+// ---------------------------------------------------------------------------
+// GL 4.2
+// ---------------------------------------------------------------------------
+#ifndef GL_VERSION_4_2
+#define GLEXT_LOAD_VERSION_4_2
+
+#define GL_ATOMIC_COUNTER_BUFFER 0x92C0
+#define GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT 0x00000001
+#define GL_ELEMENT_ARRAY_BARRIER_BIT 0x00000002
+#define GL_UNIFORM_BARRIER_BIT 0x00000004
+#define GL_TEXTURE_FETCH_BARRIER_BIT 0x00000008
+#define GL_COMMAND_BARRIER_BIT 0x00000040
+#define GL_BUFFER_UPDATE_BARRIER_BIT 0x00000200
+#define GL_ATOMIC_COUNTER_BARRIER_BIT 0x00001000
+#define GL_ALL_BARRIER_BITS 0xFFFFFFFF
+
+typedef void (APIENTRYP PFNGLMEMORYBARRIERPROC)(GLbitfield barriers);
+
+inline PFNGLMEMORYBARRIERPROC glext_glMemoryBarrier = NULL;
+
+#define glMemoryBarrier glext_glMemoryBarrier
+
+#define GLEXT_FUNCTIONS_4_2(X) \
+    X(glMemoryBarrier)
+#endif
+
+// ---------------------------------------------------------------------------
+// GL 4.3
+// ---------------------------------------------------------------------------
+#ifndef GL_VERSION_4_3
+#define GLEXT_LOAD_VERSION_4_3
+
+#define GL_COMPUTE_SHADER 0x91B9
+#define GL_MAX_COMPUTE_WORK_GROUP_COUNT 0x91BE
+#define GL_DISPATCH_INDIRECT_BUFFER 0x90EE
+#define GL_SHADER_STORAGE_BUFFER 0x90D2
+#define GL_SHADER_STORAGE_BARRIER_BIT 0x00002000
+#define GL_ANY_SAMPLES_PASSED_CONSERVATIVE 0x8D6A
+
+typedef void (APIENTRYP PFNGLDISPATCHCOMPUTEPROC)(GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z);
+typedef void (APIENTRYP PFNGLDISPATCHCOMPUTEINDIRECTPROC)(GLintptr indirect);
+typedef void (APIENTRYP PFNGLMULTIDRAWARRAYSINDIRECTPROC)(GLenum mode, const void* indirect, GLsizei drawcount, GLsizei stride);
+typedef void (APIENTRYP PFNGLMULTIDRAWELEMENTSINDIRECTPROC)(GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride);
+
+inline PFNGLDISPATCHCOMPUTEPROC glext_glDispatchCompute = NULL;
+inline PFNGLDISPATCHCOMPUTEINDIRECTPROC glext_glDispatchComputeIndirect = NULL;
+inline PFNGLMULTIDRAWARRAYSINDIRECTPROC glext_glMultiDrawArraysIndirect = NULL;
+inline PFNGLMULTIDRAWELEMENTSINDIRECTPROC glext_glMultiDrawElementsIndirect = NULL;
+
+#define glDispatchCompute glext_glDispatchCompute
+#define glDispatchComputeIndirect glext_glDispatchComputeIndirect
+#define glMultiDrawArraysIndirect glext_glMultiDrawArraysIndirect
+#define glMultiDrawElementsIndirect glext_glMultiDrawElementsIndirect
+
+#define GLEXT_FUNCTIONS_4_3(X) \
+    X(glDispatchCompute) \
+    X(glDispatchComputeIndirect) \
+    X(glMultiDrawArraysIndirect) \
+    X(glMultiDrawElementsIndirect)
+#endif
+
+// ---------------------------------------------------------------------------
+// GL 4.6 / GL_ARB_indirect_parameters (draw count read from a buffer)
+// ---------------------------------------------------------------------------
+#ifndef GL_VERSION_4_6
+#define GLEXT_LOAD_INDIRECT_PARAMETERS
+
+#define GL_PARAMETER_BUFFER 0x80EE
+
+typedef void (APIENTRYP PFNGLMULTIDRAWELEMENTSINDIRECTCOUNTPROC)(GLenum mode, GLenum type, const void* indirect, GLintptr drawcount, GLsizei maxdrawcount, GLsizei stride);
+
+inline PFNGLMULTIDRAWELEMENTSINDIRECTCOUNTPROC glext_glMultiDrawElementsIndirectCount = NULL;
+
+#define glMultiDrawElementsIndirectCount glext_glMultiDrawElementsIndirectCount
+
+#define GLEXT_FUNCTIONS_INDIRECT_PARAMETERS(X) \
+    X(glMultiDrawElementsIndirectCount)
+#endif
+
+// ---------------------------------------------------------------------------
+// GL 4.3 / GL_KHR_debug (debug output, also exposed by many 3.3 drivers)
+// ---------------------------------------------------------------------------
+#if !defined(GL_VERSION_4_3) && !defined(GL_KHR_debug)
+#define GLEXT_LOAD_KHR_DEBUG
+
+#define GL_CONTEXT_FLAG_DEBUG_BIT 0x00000002
+#define GL_DEBUG_OUTPUT_SYNCHRONOUS 0x8242
+#define GL_DEBUG_SOURCE_API 0x8246
+#define GL_DEBUG_SOURCE_WINDOW_SYSTEM 0x8247
+#define GL_DEBUG_SOURCE_SHADER_COMPILER 0x8248
+#define GL_DEBUG_SOURCE_THIRD_PARTY 0x8249
+#define GL_DEBUG_SOURCE_APPLICATION 0x824A
+#define GL_DEBUG_SOURCE_OTHER 0x824B
+#define GL_DEBUG_TYPE_ERROR 0x824C
+#define GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR 0x824D
+#define GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR 0x824E
+#define GL_DEBUG_TYPE_PORTABILITY 0x824F
+#define GL_DEBUG_TYPE_PERFORMANCE 0x8250
+#define GL_DEBUG_TYPE_OTHER 0x8251
+#define GL_DEBUG_TYPE_MARKER 0x8268
+#define GL_DEBUG_TYPE_PUSH_GROUP 0x8269
+#define GL_DEBUG_TYPE_POP_GROUP 0x826A
+#define GL_DEBUG_SEVERITY_NOTIFICATION 0x826B
+#define GL_DEBUG_SEVERITY_HIGH 0x9146
+#define GL_DEBUG_SEVERITY_MEDIUM 0x9147
+#define GL_DEBUG_SEVERITY_LOW 0x9148
+#define GL_DEBUG_OUTPUT 0x92E0
+
+// same as glad's typedef when its header has one, repeating it is allowed
+typedef void (APIENTRY* GLDEBUGPROC)(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message, const void* userParam);
+typedef void (APIENTRYP PFNGLDEBUGMESSAGECONTROLPROC)(GLenum source, GLenum type, GLenum severity, GLsizei count, const GLuint* ids, GLboolean enabled);
+typedef void (APIENTRYP PFNGLDEBUGMESSAGECALLBACKPROC)(GLDEBUGPROC callback, const void* userParam);
+typedef void (APIENTRYP PFNGLPUSHDEBUGGROUPPROC)(GLenum source, GLuint id, GLsizei length, const GLchar* message);
+typedef void (APIENTRYP PFNGLPOPDEBUGGROUPPROC)(void);
+typedef void (APIENTRYP PFNGLOBJECTLABELPROC)(GLenum identifier, GLuint name, GLsizei length, const GLchar* label);
+
+inline PFNGLDEBUGMESSAGECONTROLPROC glext_glDebugMessageControl = NULL;
+inline PFNGLDEBUGMESSAGECALLBACKPROC glext_glDebugMessageCallback = NULL;
+inline PFNGLPUSHDEBUGGROUPPROC glext_glPushDebugGroup = NULL;
+inline PFNGLPOPDEBUGGROUPPROC glext_glPopDebugGroup = NULL;
+inline PFNGLOBJECTLABELPROC glext_glObjectLabel = NULL;
+
+#define glDebugMessageControl glext_glDebugMessageControl
+#define glDebugMessageCallback glext_glDebugMessageCallback
+#define glPushDebugGroup glext_glPushDebugGroup
+#define glPopDebugGroup glext_glPopDebugGroup
+#define glObjectLabel glext_glObjectLabel
+
+#define GLEXT_FUNCTIONS_KHR_DEBUG(X) \
+    X(glDebugMessageControl) \
+    X(glDebugMessageCallback) \
+    X(glPushDebugGroup) \
+    X(glPopDebugGroup) \
+    X(glObjectLabel)
+#endif
+
+// X-macro list of the entry points above, in the style of gl-functions.h.
+// Versions that glad already provides expand to nothing.
+#ifndef GLEXT_FUNCTIONS_4_0
+#define GLEXT_FUNCTIONS_4_0(X)
+#endif
+#ifndef GLEXT_FUNCTIONS_4_2
+#define GLEXT_FUNCTIONS_4_2(X)
+#endif
+#ifndef GLEXT_FUNCTIONS_4_3
+#define GLEXT_FUNCTIONS_4_3(X)
+#endif
+#ifndef GLEXT_FUNCTIONS_INDIRECT_PARAMETERS
+#define GLEXT_FUNCTIONS_INDIRECT_PARAMETERS(X)
+#endif
+#ifndef GLEXT_FUNCTIONS_KHR_DEBUG
+#define GLEXT_FUNCTIONS_KHR_DEBUG(X)
+#endif
+
+#define GLEXT_FUNCTIONS(X) \
+    GLEXT_FUNCTIONS_4_0(X) \
+    GLEXT_FUNCTIONS_4_2(X) \
+    GLEXT_FUNCTIONS_4_3(X) \
+    GLEXT_FUNCTIONS_INDIRECT_PARAMETERS(X) \
+    GLEXT_FUNCTIONS_KHR_DEBUG(X)
+
+// true when the current context is at least major.minor (valid after gladLoadGLLoader)
+inline bool hasGLVersion(int major, int minor) {
+    return GLVersion.major > major || (GLVersion.major == major && GLVersion.minor >= minor);
+}
+
+// true when the current context lists the extension, e.g. "GL_KHR_debug"
+inline bool hasGLExtension(const char* name) {
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; i++) {
+        const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+        if (extension != NULL && strcmp(extension, name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// debug output is core in 4.3 and available through GL_KHR_debug before that
+inline bool hasGLDebugOutput() {
+    return hasGLVersion(4, 3) || hasGLExtension("GL_KHR_debug");
+}
+
+// glMultiDrawElementsIndirectCount is core in 4.6, the ARB version before that
+inline bool hasGLIndirectCount() {
+    return hasGLVersion(4, 6) || (hasGLVersion(4, 3) && hasGLExtension("GL_ARB_indirect_parameters"));
+}
+
+// Resolves the entry points above. Pointers for versions the context doesn't
+// support are left NULL; check hasGLVersion before taking a 4.x path (and
+// hasGLIndirectCount or hasGLDebugOutput before using those functions).
+inline void loadGLExtensions(GLADloadproc load) {
+#ifdef GLEXT_LOAD_VERSION_4_0
+    if (hasGLVersion(4, 0)) {
+        glext_glDrawArraysIndirect = (PFNGLDRAWARRAYSINDIRECTPROC)load("glDrawArraysIndirect");
+        glext_glDrawElementsIndirect = (PFNGLDRAWELEMENTSINDIRECTPROC)load("glDrawElementsIndirect");
+    }
+#endif
+#ifdef GLEXT_LOAD_VERSION_4_2
+    if (hasGLVersion(4, 2)) {
+        glext_glMemoryBarrier = (PFNGLMEMORYBARRIERPROC)load("glMemoryBarrier");
+    }
+#endif
+#ifdef GLEXT_LOAD_VERSION_4_3
+    if (hasGLVersion(4, 3)) {
+        glext_glDispatchCompute = (PFNGLDISPATCHCOMPUTEPROC)load("glDispatchCompute");
+        glext_glDispatchComputeIndirect = (PFNGLDISPATCHCOMPUTEINDIRECTPROC)load("glDispatchComputeIndirect");
+        glext_glMultiDrawArraysIndirect = (PFNGLMULTIDRAWARRAYSINDIRECTPROC)load("glMultiDrawArraysIndirect");
+        glext_glMultiDrawElementsIndirect = (PFNGLMULTIDRAWELEMENTSINDIRECTPROC)load("glMultiDrawElementsIndirect");
+    }
+#endif
+#ifdef GLEXT_LOAD_INDIRECT_PARAMETERS
+    if (hasGLIndirectCount()) {
+        const char* name = hasGLVersion(4, 6) ? "glMultiDrawElementsIndirectCount" : "glMultiDrawElementsIndirectCountARB";
+        glext_glMultiDrawElementsIndirectCount = (PFNGLMULTIDRAWELEMENTSINDIRECTCOUNTPROC)load(name);
+    }
+#endif
+#ifdef GLEXT_LOAD_KHR_DEBUG
+    if (hasGLDebugOutput()) {
+        glext_glDebugMessageControl = (PFNGLDEBUGMESSAGECONTROLPROC)load("glDebugMessageControl");
+        glext_glDebugMessageCallback = (PFNGLDEBUGMESSAGECALLBACKPROC)load("glDebugMessageCallback");
+        glext_glPushDebugGroup = (PFNGLPUSHDEBUGGROUPPROC)load("glPushDebugGroup");
+        glext_glPopDebugGroup = (PFNGLPOPDEBUGGROUPPROC)load("glPopDebugGroup");
+        glext_glObjectLabel = (PFNGLOBJECTLABELPROC)load("glObjectLabel");
+    }
+#endif
+}
+
+#endif
@@ -0,0 +1,131 @@
+#ifndef GL_LAZY_H
+#define GL_LAZY_H
+
+#include "gl-ext.h"
+#include "gl-functions.h"
+
+#include <cstdio>
+
+// Lazy alternative to gladLoadGLLoader + loadGLExtensions.
+//
+// gladLoadGLLoader resolves all ~370 entry points through the loader before
+// the first frame. loadGLLazy instead points every glad_gl* pointer (and the
+// gl-ext.h ones) at a resolver trampoline; the first call through a pointer
+// looks the real function up, patches the pointer and forwards the call, so
+// later calls go straight to the driver and only the functions a program
+// actually uses are ever resolved.
+//
+//     if (!loadGLLazy((GLADloadproc)glfwGetProcAddress)) { ... }
+//
+// Like glad, pointers of versions the context doesn't support are left NULL.
+// The loader must stay valid while the program runs (glfwGetProcAddress does,
+// for the lifetime of the context). If the pointer was replaced in the
+// meantime, e.g. by gltrace::install, it is left alone and the trampoline
+// keeps forwarding to the resolved function.
+
+extern "C" int gladLoadGLVersion(GLADloadproc load);
+
+namespace gllazy {
+    namespace detail {
+        inline GLADloadproc& loader() {
+            static GLADloadproc load = NULL;
+            return load;
+        }
+
+        inline unsigned int& resolvedCount() {
+            static unsigned int count = 0;
+            return count;
+        }
+
+        template <auto Slot>
+        struct Trampoline;
+
+        template <typename R, typename... Args, R (APIENTRY** Slot)(Args...)>
+        struct Trampoline<Slot> {
+            typedef R (APIENTRY* Function)(Args...);
+
+            static inline const char* name = NULL;
+            static inline Function target = NULL;
+
+            static R APIENTRY resolve(Args... args) {
+                if (target == NULL) {
+                    target = (Function)loader()(name);
+                    resolvedCount()++;
+                    if (target == NULL) {
+                        printf("ERROR::GL_LAZY::UNRESOLVED_ENTRY_POINT %s\n", name);
+                        return R();
+                    }
+                }
+                if (*Slot == &resolve) {
+                    *Slot = target;
+                }
+                return target(args...);
+            }
+
+            static void reset(const char* functionName) {
+                name = functionName;
+                target = NULL;
+                *Slot = &resolve;
+            }
+
+            static void clear() {
+                *Slot = NULL;
+            }
+        };
+    }
+
+    // entry points resolved since the last loadGLLazy
+    inline unsigned int resolvedCount() {
+        return detail::resolvedCount();
+    }
+}
+
+// returns what gladLoadGLLoader would, 0 if there is no usable context
+inline int loadGLLazy(GLADloadproc load) {
+    gllazy::detail::loader() = load;
+    gllazy::detail::resolvedCount() = 0;
+
+#define GLLAZY_RESET(name) gllazy::detail::Trampoline<&name>::reset(#name);
+#define GLLAZY_CLEAR(name) gllazy::detail::Trampoline<&name>::clear();
+    // the version and extension queries below go through the trampolines too
+    GL_FUNCTIONS(GLLAZY_RESET)
+    if (!gladLoadGLVersion(load)) {
+        return 0;
+    }
+
+    // match gladLoadGLLoader, which only loads the versions the context has
+    if (!GLAD_GL_VERSION_3_3) { GL_FUNCTIONS_3_3(GLLAZY_CLEAR) }
+    if (!GLAD_GL_VERSION_3_2) { GL_FUNCTIONS_3_2(GLLAZY_CLEAR) }
+    if (!GLAD_GL_VERSION_3_1) { GL_FUNCTIONS_3_1(GLLAZY_CLEAR) }
+    if (!GLAD_GL_VERSION_3_0) { GL_FUNCTIONS_3_0(GLLAZY_CLEAR) }
+    if (!GLAD_GL_VERSION_2_1) { GL_FUNCTIONS_2_1(GLLAZY_CLEAR) }
+    if (!GLAD_GL_VERSION_2_0) { GL_FUNCTIONS_2_0(GLLAZY_CLEAR) }
+    if (!GLAD_GL_VERSION_1_5) { GL_FUNCTIONS_1_5(GLLAZY_CLEAR) }
+    if (!GLAD_GL_VERSION_1_4) { GL_FUNCTIONS_1_4(GLLAZY_CLEAR) }
+    if (!GLAD_GL_VERSION_1_3) { GL_FUNCTIONS_1_3(GLLAZY_CLEAR) }
+    if (!GLAD_GL_VERSION_1_2) { GL_FUNCTIONS_1_2(GLLAZY_CLEAR) }
+    if (!GLAD_GL_VERSION_1_1) { GL_FUNCTIONS_1_1(GLLAZY_CLEAR) }
+    if (!GLAD_GL_VERSION_1_0) { GL_FUNCTIONS_1_0(GLLAZY_CLEAR) }
+
+    // gl-ext.h entry points, same rule as loadGLExtensions
+    if (hasGLVersion(4, 0)) { GLEXT_FUNCTIONS_4_0(GLLAZY_RESET) } else { GLEXT_FUNCTIONS_4_0(GLLAZY_CLEAR) }
+    if (hasGLVersion(4, 2)) { GLEXT_FUNCTIONS_4_2(GLLAZY_RESET) } else { GLEXT_FUNCTIONS_4_2(GLLAZY_CLEAR) }
+    if (hasGLVersion(4, 3)) { GLEXT_FUNCTIONS_4_3(GLLAZY_RESET) } else { GLEXT_FUNCTIONS_4_3(GLLAZY_CLEAR) }
+#ifdef GLEXT_LOAD_INDIRECT_PARAMETERS
+    // the only one whose name depends on the version: core in 4.6, ARB suffix before
+    if (hasGLIndirectCount()) {
+        gllazy::detail::Trampoline<&glMultiDrawElementsIndirectCount>::reset(
+            hasGLVersion(4, 6) ? "glMultiDrawElementsIndirectCount" : "glMultiDrawElementsIndirectCountARB");
+    }
+    else {
+        GLEXT_FUNCTIONS_INDIRECT_PARAMETERS(GLLAZY_CLEAR)
+    }
+#endif
+    if (hasGLDebugOutput()) { GLEXT_FUNCTIONS_KHR_DEBUG(GLLAZY_RESET) } else { GLEXT_FUNCTIONS_KHR_DEBUG(GLLAZY_CLEAR) }
+#undef GLLAZY_RESET
+#undef GLLAZY_CLEAR
+
+    return 1;
+}
+
+#endif
@@ -0,0 +1,395 @@
+#ifndef GL_TRACE_H
+#define GL_TRACE_H
+
+#include "gl-ext.h"
+#include "gl-functions.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Optional instrumentation layer on top of glad's function pointers.
+//
+// install() swaps every loaded glad_gl* pointer (and the gl-ext.h ones) for a
+// wrapper that counts the call, times it on the CPU and then calls the real
+// entry point. Calls known to synchronize with the driver are flagged:
+// glGetError and the other glGet* queries, glFinish, glClientWaitSync,
+// glReadPixels into client memory, glGetShaderiv / glGetProgramiv right after
+// a compile / link, and buffer reads and maps that have to wait for the GPU.
+//
+//     gladLoadGLLoader((GLADloadproc)glfwGetProcAddress);
+//     loadGLExtensions((GLADloadproc)glfwGetProcAddress);
+//     gltrace::install();
+//     ...
+//     // once per frame
+//     gltrace::printReport(gltrace::endFrame());
+//
+// Synchronizing calls are reported with the path of the Scopes they were
+// made in, e.g. [runner/particles]; gl-debug.h names its scopes on the same
+// stack.
+//
+// Nothing is wrapped until install() is called, so the layer costs nothing
+// when unused. The counters are not thread safe, only trace the thread that
+// owns the context. CPU time is the time spent inside the call, which for most
+// calls is just the driver queuing the command; a large time on a call that
+// should be cheap is usually a stall.
+namespace gltrace {
+
+    struct CallStats {
+        const char* name;
+        unsigned int calls;
+        unsigned int syncCalls;
+        double ms;
+    };
+
+    // calls of one entry point flagged for the same reason in the same scope
+    struct SyncStats {
+        const char* name;
+        const char* reason;
+        std::string scope;
+        unsigned int calls;
+        double ms;
+    };
+
+    struct FrameReport {
+        unsigned int frame = 0;
+        unsigned int calls = 0;
+        unsigned int syncCalls = 0;
+        double ms = 0.0;        // CPU time inside GL calls
+        double frameMs = 0.0;   // wall time since the previous endFrame
+        std::vector<CallStats> entries;   // most expensive first
+        std::vector<SyncStats> syncs;     // most expensive first
+    };
+
+    namespace detail {
+        typedef std::chrono::steady_clock Clock;
+
+        struct Entry {
+            const char* name;
+            const char* syncReason;   // set when every call synchronizes
+            void (*restore)();
+            unsigned int calls;
+            unsigned int syncCalls;
+            long long ns;
+        };
+
+        struct SyncEvent {
+            int entry;
+            const char* reason;
+            std::string scope;
+            unsigned int calls;
+            long long ns;
+        };
+
+        struct State {
+            bool installed = false;
+            std::vector<Entry> entries;
+            std::vector<SyncEvent> syncs;
+            unsigned int frame = 0;
+            Clock::time_point frameStart;
+            FrameReport report;
+
+            // GL state the per-call checks need
+            GLuint packBuffer = 0;
+            std::vector<GLuint> compiling;   // compiled, status not queried yet
+            std::vector<GLuint> linking;     // linked, status not queried yet
+        };
+
+        inline State& state() {
+            static State s;
+            return s;
+        }
+
+        // per thread, a scope names what its own thread is doing
+        inline std::vector<const char*>& scopes() {
+            thread_local std::vector<const char*> stack;
+            return stack;
+        }
+    }
+
+    // the names of the open scopes joined by '/', "-" outside of any
+    inline std::string scopePath() {
+        std::string path;
+        for (const char* name : detail::scopes()) {
+            if (!path.empty()) {
+                path += '/';
+            }
+            path += name;
+        }
+        return path.empty() ? "-" : path;
+    }
+
+    // names the work done while it is alive, name must outlive the scope
+    class Scope {
+    public:
+        explicit Scope(const char* name) {
+            detail::scopes().push_back(name);
+        }
+
+        ~Scope() {
+            detail::scopes().pop_back();
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+    namespace detail {
+        inline void record(int index, const char* reason, long long ns) {
+            State& s = state();
+            Entry& entry = s.entries[index];
+            entry.calls++;
+            entry.ns += ns;
+
+            if (reason == NULL) {
+                reason = entry.syncReason;
+            }
+            if (reason == NULL) {
+                return;
+            }
+
+            entry.syncCalls++;
+            std::string scope = scopePath();
+            for (SyncEvent& event : s.syncs) {
+                if (event.entry == index && event.reason == reason && event.scope == scope) {
+                    event.calls++;
+                    event.ns += ns;
+                    return;
+                }
+            }
+            s.syncs.push_back({ index, reason, scope, 1, ns });
+        }
+
+        // records the call when the wrapper returns, also for void calls
+        struct Timer {
+            int index;
+            const char* reason;
+            Clock::time_point start;
+
+            Timer(int index, const char* reason) : index(index), reason(reason), start(Clock::now()) {}
+            ~Timer() {
+                record(index, reason, std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+            }
+        };
+
+        // removes value from list, true if it was there
+        inline bool take(std::vector<GLuint>& list, GLuint value) {
+            std::vector<GLuint>::iterator it = std::find(list.begin(), list.end(), value);
+            if (it == list.end()) {
+                return false;
+            }
+            list.erase(it);
+            return true;
+        }
+
+        // one wrapper per glad pointer, Slot is the address of the pointer
+        template <auto Slot>
+        struct Hook;
+
+        template <typename R, typename... Args, R (APIENTRY** Slot)(Args...)>
+        struct Hook<Slot> {
+            typedef R (APIENTRY* Function)(Args...);
+
+            static inline Function real = NULL;
+            static inline int index = -1;
+            // optional per-call check, may track state, returns a sync reason or NULL
+            static inline const char* (*inspect)(Args...) = NULL;
+
+            static R APIENTRY call(Args... args) {
+                const char* reason = inspect != NULL ? inspect(args...) : NULL;
+                Timer timer(index, reason);
+                return real(args...);
+            }
+
+            static void restore() {
+                *Slot = real;
+            }
+        };
+
+        // reason for entry points where every call synchronizes
+        inline const char* syncReason(const char* name) {
+            if (strcmp(name, "glGetError") == 0) {
+                return "glGetError";
+            }
+            if (strcmp(name, "glFinish") == 0) {
+                return "glFinish";
+            }
+            if (strcmp(name, "glClientWaitSync") == 0) {
+                return "waits on a fence";
+            }
+            if (strcmp(name, "glGetBufferSubData") == 0 || strcmp(name, "glGetTexImage") == 0) {
+                return "reads back GPU memory";
+            }
+            if (strcmp(name, "glMapBuffer") == 0) {
+                return "maps a buffer the GPU may still use";
+            }
+            // answered from what the driver kept of the linked program
+            if (strcmp(name, "glGetUniformLocation") == 0 || strcmp(name, "glGetAttribLocation") == 0 ||
+                strcmp(name, "glGetFragDataLocation") == 0 || strcmp(name, "glGetUniformBlockIndex") == 0) {
+                return NULL;
+            }
+            // only right after a compile or link, installChecks() tells those apart
+            if (strcmp(name, "glGetShaderiv") == 0 || strcmp(name, "glGetProgramiv") == 0) {
+                return NULL;
+            }
+            if (strncmp(name, "glGet", 5) == 0) {
+                return "glGet* query";
+            }
+            return NULL;
+        }
+
+        template <auto Slot>
+        void hook(const char* name) {
+            typedef Hook<Slot> H;
+            if (*Slot == NULL) {
+                return;
+            }
+
+            State& s = state();
+            H::real = *Slot;
+            H::index = (int)s.entries.size();
+            s.entries.push_back({ name, syncReason(name), &H::restore, 0, 0, 0 });
+            *Slot = &H::call;
+        }
+
+        // checks that depend on the arguments or on earlier calls
+        inline void installChecks() {
+            Hook<&glBindBuffer>::inspect = [](GLenum target, GLuint buffer) -> const char* {
+                if (target == GL_PIXEL_PACK_BUFFER) {
+                    state().packBuffer = buffer;
+                }
+                return NULL;
+            };
+            Hook<&glDeleteBuffers>::inspect = [](GLsizei n, const GLuint* buffers) -> const char* {
+                for (GLsizei i = 0; i < n; i++) {
+                    if (buffers[i] == state().packBuffer) {
+                        state().packBuffer = 0;
+                    }
+                }
+                return NULL;
+            };
+            Hook<&glReadPixels>::inspect = [](GLint, GLint, GLsizei, GLsizei, GLenum, GLenum, void*) -> const char* {
+                return state().packBuffer == 0 ? "glReadPixels into client memory" : NULL;
+            };
+            Hook<&glMapBufferRange>::inspect = [](GLenum, GLintptr, GLsizeiptr, GLbitfield access) -> const char* {
+                if (access & (GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_INVALIDATE_RANGE_BIT)) {
+                    return NULL;
+                }
+                return "maps a buffer the GPU may still use";
+            };
+            Hook<&glCompileShader>::inspect = [](GLuint shader) -> const char* {
+                state().compiling.push_back(shader);
+                return NULL;
+            };
+            Hook<&glGetShaderiv>::inspect = [](GLuint shader, GLenum, GLint*) -> const char* {
+                return take(state().compiling, shader) ? "glGetShaderiv right after glCompileShader" : NULL;
+            };
+            Hook<&glLinkProgram>::inspect = [](GLuint program) -> const char* {
+                state().linking.push_back(program);
+                return NULL;
+            };
+            Hook<&glGetProgramiv>::inspect = [](GLuint program, GLenum, GLint*) -> const char* {
+                return take(state().linking, program) ? "glGetProgramiv right after glLinkProgram" : NULL;
+            };
+        }
+    }
+
+    inline bool installed() {
+        return detail::state().installed;
+    }
+
+    // wraps every loaded entry point, call after gladLoadGLLoader and loadGLExtensions
+    inline void install() {
+        detail::State& s = detail::state();
+        if (s.installed) {
+            return;
+        }
+
+        detail::installChecks();
+#define GLTRACE_HOOK(name) detail::hook<&name>(#name);
+        GL_FUNCTIONS(GLTRACE_HOOK)
+        GLEXT_FUNCTIONS(GLTRACE_HOOK)
+#undef GLTRACE_HOOK
+
+        s.installed = true;
+        s.frameStart = detail::Clock::now();
+    }
+
+    // puts the real entry points back
+    inline void uninstall() {
+        detail::State& s = detail::state();
+        for (const detail::Entry& entry : s.entries) {
+            entry.restore();
+        }
+        s.entries.clear();
+        s.syncs.clear();
+        s.installed = false;
+    }
+
+    // closes the current frame, resets the counters and returns the frame's report
+    inline const FrameReport& endFrame() {
+        detail::State& s = detail::state();
+        detail::Clock::time_point now = detail::Clock::now();
+
+        FrameReport& report = s.report;
+        report.frame = s.frame++;
+        report.calls = 0;
+        report.syncCalls = 0;
+        report.ms = 0.0;
+        report.frameMs = std::chrono::duration<double, std::milli>(now - s.frameStart).count();
+        report.entries.clear();
+        report.syncs.clear();
+
+        for (detail::Entry& entry : s.entries) {
+            if (entry.calls == 0) {
+                continue;
+            }
+            double ms = entry.ns / 1e6;
+            report.entries.push_back({ entry.name, entry.calls, entry.syncCalls, ms });
+            report.calls += entry.calls;
+            report.syncCalls += entry.syncCalls;
+            report.ms += ms;
+            entry.calls = 0;
+            entry.syncCalls = 0;
+            entry.ns = 0;
+        }
+        for (const detail::SyncEvent& event : s.syncs) {
+            report.syncs.push_back({ s.entries[event.entry].name, event.reason, event.scope, event.calls, event.ns / 1e6 });
+        }
+        s.syncs.clear();
+
+        std::sort(report.entries.begin(), report.entries.end(), [](const CallStats& a, const CallStats& b) {
+            return a.ms > b.ms;
+        });
+        std::sort(report.syncs.begin(), report.syncs.end(), [](const SyncStats& a, const SyncStats& b) {
+            return a.ms > b.ms;
+        });
+
+        s.frameStart = now;
+        return report;
+    }
+
+    // prints the maxEntries most expensive entry points and every synchronizing call
+    inline void printReport(const FrameReport& report, int maxEntries = 10, FILE* out = stdout) {
+        fprintf(out, "frame %u: %u GL calls, %.3f ms in GL of %.3f ms, %u synchronizing\n",
+            report.frame, report.calls, report.ms, report.frameMs, report.syncCalls);
+
+        int shown = 0;
+        for (const CallStats& entry : report.entries) {
+            if (shown++ == maxEntries) {
+                fprintf(out, "  ... %d more entry points\n", (int)report.entries.size() - maxEntries);
+                break;
+            }
+            fprintf(out, "  %-32s %7u calls %9.3f ms\n", entry.name, entry.calls, entry.ms);
+        }
+        for (const SyncStats& sync : report.syncs) {
+            fprintf(out, "  sync: %-26s %7u calls %9.3f ms  (%s) [%s]\n", sync.name, sync.calls, sync.ms, sync.reason,
+                sync.scope.c_str());
+        }
+    }
+}
+
+#endif
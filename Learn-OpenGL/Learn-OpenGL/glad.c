@@ -1115,6 +1115,11 @@ static void find_coreGL(void) {
 	}
 }
 
+/* Called at the end of every successful gladLoadGLLoader, NULL by default.
+   Lets a tool linked into an unmodified sample wrap the loaded pointers, see
+   code/tools/capture. */
+void (*gladLoadGLCallback)(GLADloadproc load) = NULL;
+
 int gladLoadGLLoader(GLADloadproc load) {
 	GLVersion.major = 0; GLVersion.minor = 0;
 	glGetString = (PFNGLGETSTRINGPROC)load("glGetString");
@@ -1134,6 +1139,24 @@ int gladLoadGLLoader(GLADloadproc load) {
 	load_GL_VERSION_3_2(load);
 	load_GL_VERSION_3_3(load);
 
+	if (!find_extensionsGL()) return 0;
+	if (GLVersion.major == 0 && GLVersion.minor == 0) return 0;
+
+	if (gladLoadGLCallback != NULL) gladLoadGLCallback(load);
+	return 1;
+}
+
+/* Fills GLVersion and the GLAD_GL_VERSION_x_y flags without resolving any
+   entry point other than glGetString. Used by the lazy loader (gl-lazy.h),
+   which points the glad_gl* pointers at resolver trampolines first, so the
+   few calls made here resolve themselves. */
+int gladLoadGLVersion(GLADloadproc load) {
+	GLVersion.major = 0; GLVersion.minor = 0;
+	glGetString = (PFNGLGETSTRINGPROC)load("glGetString");
+	if(glGetString == NULL) return 0;
+	if(glGetString(GL_VERSION) == NULL) return 0;
+	find_coreGL();
+
 	if (!find_extensionsGL()) return 0;
 	return GLVersion.major != 0 || GLVersion.minor != 0;
 }
@@ -0,0 +1,205 @@
+#ifndef GPU_CULLING_H
+#define GPU_CULLING_H
+
+#include "shader.h"
+#include "gpu-heap.h"
+#include "maths.h"
+
+#include <string>
+#include <vector>
+
+// GPU-driven frustum culling. A compute pass tests every object's bounding
+// sphere against the view and writes the draws of the visible ones as
+// DrawElementsIndirectCommand records, which go straight into one multi-draw.
+// The CPU cost per frame is a handful of calls, whatever the object count.
+//
+//   with glMultiDrawElementsIndirectCount (4.6 or GL_ARB_indirect_parameters)
+//     the visible objects are appended with an atomic counter (one per work
+//     group) and the counter is the draw count, read by the GPU from the
+//     parameter buffer.
+//   otherwise
+//     there is one command per object, culled ones get instanceCount 0, and
+//     glMultiDrawElementsIndirect draws all of them. Still no readback, the
+//     GPU skips the empty draws.
+//
+// Every command has baseInstance = object index. attachObjectIndex() adds an
+// instanced uint attribute to the caller's VAO that reads 0, 1, 2, ... so the
+// vertex shader gets its object index through baseInstance without needing
+// gl_BaseInstanceARB:
+//     GpuCuller culler(objectCount);
+//     culler.setMeshes(meshCommands);        // count, firstIndex, baseVertex of each mesh
+//     culler.setObjects(objects);            // sphere and mesh of each object
+//     glBindVertexArray(vao); culler.attachObjectIndex(1);
+//     ...
+//     culler.cull(projection * view);
+//     glBindVertexArray(vao); culler.draw();
+//
+// Needs a 4.3 context and loadGLExtensions (gl-ext.h).
+struct CullObject {
+    float center[3];
+    float radius;
+    unsigned int mesh;
+    unsigned int padding[3];
+};
+
+class GpuCuller {
+public:
+    unsigned int capacity;
+    bool useDrawCount;           // compacted commands + glMultiDrawElementsIndirectCount
+
+    unsigned int objectBuffer;   // CullObject per object, binding 0 of the cull pass
+    unsigned int commandBuffer;  // DrawElementsIndirectCommand per object
+    unsigned int countBuffer;    // draw count of the compacted commands
+
+    // shaderDir is the folder holding compute/
+    GpuCuller(unsigned int capacity, const std::string& shaderDir = "../../shaders/")
+        : capacity(capacity), useDrawCount(hasGLIndirectCount()),
+          cullShader((shaderDir + "compute/cull.cs").c_str()) {
+        glGenBuffers(1, &objectBuffer);
+        glGenBuffers(1, &meshBuffer);
+        glGenBuffers(1, &commandBuffer);
+        glGenBuffers(1, &countBuffer);
+        glGenBuffers(1, &indexBuffer);
+
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, objectBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, (GLsizeiptr)capacity * sizeof(CullObject), NULL, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, commandBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, (GLsizeiptr)capacity * sizeof(DrawElementsIndirectCommand), NULL, GL_DYNAMIC_COPY);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, countBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint), NULL, GL_DYNAMIC_COPY);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+        std::vector<GLuint> indices(capacity);
+        for (unsigned int i = 0; i < capacity; i++) {
+            indices[i] = i;
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, indexBuffer);
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)capacity * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        planesLocation = glGetUniformLocation(cullShader.ID, "planes");
+        objectCountLocation = glGetUniformLocation(cullShader.ID, "objectCount");
+        compactLocation = glGetUniformLocation(cullShader.ID, "compact");
+    }
+
+    GpuCuller(const GpuCuller&) = delete;
+    GpuCuller& operator=(const GpuCuller&) = delete;
+
+    // the draw of each mesh, instanceCount and baseInstance are ignored
+    void setMeshes(const std::vector<DrawElementsIndirectCommand>& meshes) {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, meshBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, (GLsizeiptr)(meshes.size() * sizeof(DrawElementsIndirectCommand)),
+            meshes.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+
+    // objects [first, first + count), objectCount becomes at least first + count
+    void setObjects(const CullObject* objects, unsigned int count, unsigned int first = 0) {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, objectBuffer);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, (GLintptr)first * sizeof(CullObject), (GLsizeiptr)count * sizeof(CullObject), objects);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        objectCount = first + count > objectCount ? first + count : objectCount;
+    }
+
+    void setObjects(const std::vector<CullObject>& objects) {
+        objectCount = 0;
+        setObjects(objects.data(), (unsigned int)objects.size());
+    }
+
+    unsigned int getObjectCount() const {
+        return objectCount;
+    }
+
+    // adds the per-instance object index to the bound VAO at location
+    void attachObjectIndex(GLuint location) {
+        glBindBuffer(GL_ARRAY_BUFFER, indexBuffer);
+        glVertexAttribIPointer(location, 1, GL_UNSIGNED_INT, sizeof(GLuint), (void*)0);
+        glEnableVertexAttribArray(location);
+        glVertexAttribDivisor(location, 1);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    // writes the draws of the objects inside the frustum of viewProjection
+    void cull(const maths::mat4& viewProjection) {
+        maths::vec4 planes[6];
+        maths::frustumPlanes(viewProjection, planes);
+
+        if (useDrawCount) {
+            GLuint zero = 0;
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, countBuffer);
+            glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(GLuint), &zero);
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        }
+
+        cullShader.use();
+        glUniform4fv(planesLocation, 6, &planes[0].x);
+        glUniform1ui(objectCountLocation, objectCount);
+        glUniform1i(compactLocation, useDrawCount ? 1 : 0);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, objectBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, meshBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, commandBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, countBuffer);
+        glDispatchCompute((objectCount + 255) / 256, 1, 1);
+
+        // the commands and the count are read by the draw as indirect arguments
+        glMemoryBarrier(GL_COMMAND_BARRIER_BIT);
+    }
+
+    // draws what the last cull() kept, with the caller's program and VAO
+    // (which holds the element buffer the mesh commands refer to)
+    void draw(GLenum mode = GL_TRIANGLES) {
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+        if (useDrawCount) {
+            glBindBuffer(GL_PARAMETER_BUFFER, countBuffer);
+            glMultiDrawElementsIndirectCount(mode, GL_UNSIGNED_INT, (void*)0, 0, (GLsizei)objectCount, 0);
+            glBindBuffer(GL_PARAMETER_BUFFER, 0);
+        }
+        else {
+            glMultiDrawElementsIndirect(mode, GL_UNSIGNED_INT, (void*)0, (GLsizei)objectCount, 0);
+        }
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+
+    // Visible objects of the last cull(). Reads back, so it waits for the GPU:
+    // for statistics and tests, not for every frame.
+    unsigned int readVisibleCount() {
+        GLuint visible = 0;
+        // the cull pass wrote these as storage, this reads them from the CPU
+        glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+        if (useDrawCount) {
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, countBuffer);
+            glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(GLuint), &visible);
+        }
+        else {
+            std::vector<DrawElementsIndirectCommand> commands(objectCount);
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, commandBuffer);
+            glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, (GLsizeiptr)(objectCount * sizeof(DrawElementsIndirectCommand)), commands.data());
+            for (const DrawElementsIndirectCommand& command : commands) {
+                visible += command.instanceCount;
+            }
+        }
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        return visible;
+    }
+
+    // delete all GL objects owned by the culler
+    void del() {
+        glDeleteBuffers(1, &objectBuffer);
+        glDeleteBuffers(1, &meshBuffer);
+        glDeleteBuffers(1, &commandBuffer);
+        glDeleteBuffers(1, &countBuffer);
+        glDeleteBuffers(1, &indexBuffer);
+        glDeleteProgram(cullShader.ID);
+    }
+
+private:
+    Shader cullShader;
+    unsigned int meshBuffer = 0;
+    unsigned int indexBuffer = 0;  // 0, 1, 2, ... read per instance
+    unsigned int objectCount = 0;
+    GLint planesLocation = -1;
+    GLint objectCountLocation = -1;
+    GLint compactLocation = -1;
+};
+
+#endif
@@ -0,0 +1,730 @@
+#ifndef GPU_HEAP_H
+#define GPU_HEAP_H
+
+#include "gl-ext.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// GPU memory sub-allocation: a few large buffers instead of one glGenBuffers
+// per mesh.
+//
+//   TlsfAllocator  hands out offsets inside a range of bytes. It is a two-level
+//                  segregated fit allocator (TLSF): free blocks are kept in
+//                  lists by size class, 32 power-of-two classes each split in
+//                  16, and two bitmaps say which lists are non-empty, so
+//                  allocate and free are O(1) bit scans. Freed blocks merge
+//                  with free neighbours right away.
+//   GpuHeap        pages of one GL buffer each with a TlsfAllocator, returns
+//                  allocation ids that resolve to (buffer, offset, size). It
+//                  can compact a page with glCopyBufferSubData; ids stay valid
+//                  and buffer names don't change, only offsets do.
+//   MeshPool       indexed meshes of one vertex layout in a GpuHeap. Each page
+//                  has one VAO, a mesh's vertices and indices share one
+//                  allocation, and draw() uses glDrawElementsBaseVertex so the
+//                  indices stay relative to the mesh. command() gives the
+//                  same draw as a DrawElementsIndirectCommand, for multi-draw.
+//
+// Sizes are rounded up to the alignment, at least TlsfAllocator::GRANULARITY
+// bytes.
+
+class TlsfAllocator {
+public:
+    static constexpr uint32_t NONE = 0xFFFFFFFF;
+    static constexpr uint64_t GRANULARITY = 16;
+
+    TlsfAllocator(uint64_t capacity = 0) {
+        reset(capacity);
+    }
+
+    // forget every allocation, the whole range becomes one free block
+    void reset(uint64_t newCapacity) {
+        capacity = newCapacity / GRANULARITY * GRANULARITY;
+        blocks.clear();
+        unusedBlocks.clear();
+        flBitmap = 0;
+        std::fill(slBitmap, slBitmap + FL_COUNT, 0u);
+        std::fill(&heads[0][0], &heads[0][0] + FL_COUNT * SL_COUNT, NONE);
+        usedBytes = 0;
+        freeBytes = 0;
+        freeBlocks = 0;
+        allocations = 0;
+
+        if (capacity > 0) {
+            insertFree(newBlock(0, capacity, NONE, NONE));
+        }
+    }
+
+    // Returns a block handle, NONE when no free block is big enough. The
+    // offset is a multiple of alignment (any value, not only powers of two).
+    uint32_t allocate(uint64_t size, uint64_t alignment = GRANULARITY) {
+        alignment = effectiveAlignment(alignment);
+        size = roundUp(size > 0 ? size : 1, alignment);
+        uint64_t padded = size + (alignment - GRANULARITY);
+
+        uint32_t index = findFree(padded);
+        if (index == NONE) {
+            return NONE;
+        }
+        removeFree(index);
+
+        // leading padding becomes a free block of its own
+        uint64_t pad = roundUp(blocks[index].offset, alignment) - blocks[index].offset;
+        if (pad > 0) {
+            uint32_t front = newBlock(blocks[index].offset, pad, blocks[index].prevPhysical, index);
+            if (blocks[front].prevPhysical != NONE) {
+                blocks[blocks[front].prevPhysical].nextPhysical = front;
+            }
+            blocks[index].prevPhysical = front;
+            blocks[index].offset += pad;
+            blocks[index].size -= pad;
+            insertFree(front);
+        }
+
+        // and so does what is left at the end
+        if (blocks[index].size - size >= GRANULARITY) {
+            uint32_t back = newBlock(blocks[index].offset + size, blocks[index].size - size, index, blocks[index].nextPhysical);
+            if (blocks[back].nextPhysical != NONE) {
+                blocks[blocks[back].nextPhysical].prevPhysical = back;
+            }
+            blocks[index].nextPhysical = back;
+            blocks[index].size = size;
+            insertFree(back);
+        }
+
+        usedBytes += blocks[index].size;
+        allocations++;
+        return index;
+    }
+
+    void free(uint32_t index) {
+        Block& block = blocks[index];
+        usedBytes -= block.size;
+        allocations--;
+
+        // merge with the free neighbours
+        uint32_t prev = block.prevPhysical;
+        if (prev != NONE && blocks[prev].free) {
+            removeFree(prev);
+            index = merge(prev, index);
+        }
+        uint32_t next = blocks[index].nextPhysical;
+        if (next != NONE && blocks[next].free) {
+            removeFree(next);
+            index = merge(index, next);
+        }
+        insertFree(index);
+    }
+
+    uint64_t offset(uint32_t index) const {
+        return blocks[index].offset;
+    }
+
+    uint64_t size(uint32_t index) const {
+        return blocks[index].size;
+    }
+
+    uint64_t getCapacity() const {
+        return capacity;
+    }
+
+    uint64_t getUsedBytes() const {
+        return usedBytes;
+    }
+
+    uint64_t getFreeBytes() const {
+        return freeBytes;
+    }
+
+    uint32_t getFreeBlocks() const {
+        return freeBlocks;
+    }
+
+    uint32_t getAllocations() const {
+        return allocations;
+    }
+
+    // The capacity of an empty allocator that allocate(size, alignment) can't
+    // fail on. More than size: the request is rounded up to the next size
+    // class boundary so that every block of the class it searches fits.
+    static uint64_t capacityFor(uint64_t size, uint64_t alignment = GRANULARITY) {
+        alignment = effectiveAlignment(alignment);
+        uint64_t padded = roundUp(size > 0 ? size : 1, alignment) + (alignment - GRANULARITY);
+        return classCeiling(padded);
+    }
+
+    // only scans the list of the largest non-empty size class
+    uint64_t largestFreeBlock() const {
+        if (flBitmap == 0) {
+            return 0;
+        }
+        uint32_t fl = 31 - clz(flBitmap);
+        uint32_t sl = 31 - clz(slBitmap[fl]);
+        uint64_t largest = 0;
+        for (uint32_t i = heads[fl][sl]; i != NONE; i = blocks[i].nextFree) {
+            largest = std::max(largest, blocks[i].size);
+        }
+        return largest;
+    }
+
+    // 0 when the free space is one block, towards 1 the more it is scattered
+    float fragmentation() const {
+        return freeBytes > 0 ? 1.0f - (float)largestFreeBlock() / (float)freeBytes : 0.0f;
+    }
+
+private:
+    static constexpr uint32_t SL_LOG2 = 4;
+    static constexpr uint32_t SL_COUNT = 1 << SL_LOG2;
+    static constexpr uint32_t FL_COUNT = 32;
+    // below this size the classes are linear, GRANULARITY bytes apart
+    static constexpr uint64_t SMALL_SIZE = SL_COUNT * GRANULARITY;
+    static constexpr uint32_t SMALL_LOG2 = 8;
+
+    struct Block {
+        uint64_t offset;
+        uint64_t size;
+        uint32_t prevPhysical;
+        uint32_t nextPhysical;
+        uint32_t prevFree;
+        uint32_t nextFree;
+        bool free;
+    };
+
+    uint64_t capacity = 0;
+    std::vector<Block> blocks;
+    std::vector<uint32_t> unusedBlocks;
+    uint32_t flBitmap = 0;
+    uint32_t slBitmap[FL_COUNT];
+    uint32_t heads[FL_COUNT][SL_COUNT];
+    uint64_t usedBytes = 0;
+    uint64_t freeBytes = 0;
+    uint32_t freeBlocks = 0;
+    uint32_t allocations = 0;
+
+    static uint32_t ctz(uint32_t x) {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward(&index, x);
+        return index;
+#else
+        return __builtin_ctz(x);
+#endif
+    }
+
+    static uint32_t clz(uint32_t x) {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanReverse(&index, x);
+        return 31 - index;
+#else
+        return __builtin_clz(x);
+#endif
+    }
+
+    static uint32_t log2(uint64_t x) {
+        uint32_t high = (uint32_t)(x >> 32);
+        return high != 0 ? 63 - clz(high) : 31 - clz((uint32_t)x);
+    }
+
+    static uint64_t roundUp(uint64_t x, uint64_t multiple) {
+        return (x + multiple - 1) / multiple * multiple;
+    }
+
+    static uint64_t lcm(uint64_t a, uint64_t b) {
+        uint64_t x = a, y = b;
+        while (y != 0) {
+            uint64_t t = x % y;
+            x = y;
+            y = t;
+        }
+        return a / x * b;
+    }
+
+    // offsets are always multiples of the granularity, so align to both. The
+    // size is a multiple of the alignment too, so allocations of the same
+    // alignment pack without leaving padding blocks between them.
+    static uint64_t effectiveAlignment(uint64_t alignment) {
+        return lcm(alignment > 0 ? alignment : 1, GRANULARITY);
+    }
+
+    // the smallest class boundary at or above size, any block of that class
+    // fits size
+    static uint64_t classCeiling(uint64_t size) {
+        if (size < SMALL_SIZE) {
+            return size;
+        }
+        size += ((uint64_t)1 << (log2(size) - SL_LOG2)) - 1;
+        return size & ~(((uint64_t)1 << (log2(size) - SL_LOG2)) - 1);
+    }
+
+    // size class holding blocks of this size
+    static void mapping(uint64_t size, uint32_t& fl, uint32_t& sl) {
+        if (size < SMALL_SIZE) {
+            fl = 0;
+            sl = (uint32_t)(size / GRANULARITY);
+        }
+        else {
+            uint32_t f = log2(size);
+            sl = (uint32_t)(size >> (f - SL_LOG2)) ^ SL_COUNT;
+            fl = f - SMALL_LOG2 + 1;
+        }
+    }
+
+    // first non-empty class whose every block fits size, NONE if there is none
+    uint32_t findFree(uint64_t size) const {
+        uint32_t fl, sl;
+        mapping(classCeiling(size), fl, sl);
+        if (fl >= FL_COUNT) {
+            return NONE;
+        }
+
+        uint32_t slMap = slBitmap[fl] & (~0u << sl);
+        if (slMap == 0) {
+            uint32_t flMap = fl + 1 < FL_COUNT ? flBitmap & (~0u << (fl + 1)) : 0;
+            if (flMap == 0) {
+                return NONE;
+            }
+            fl = ctz(flMap);
+            slMap = slBitmap[fl];
+        }
+        return heads[fl][ctz(slMap)];
+    }
+
+    uint32_t newBlock(uint64_t offset, uint64_t size, uint32_t prevPhysical, uint32_t nextPhysical) {
+        Block block = { offset, size, prevPhysical, nextPhysical, NONE, NONE, false };
+        if (!unusedBlocks.empty()) {
+            uint32_t index = unusedBlocks.back();
+            unusedBlocks.pop_back();
+            blocks[index] = block;
+            return index;
+        }
+        blocks.push_back(block);
+        return (uint32_t)blocks.size() - 1;
+    }
+
+    void insertFree(uint32_t index) {
+        Block& block = blocks[index];
+        uint32_t fl, sl;
+        mapping(block.size, fl, sl);
+        block.free = true;
+        block.prevFree = NONE;
+        block.nextFree = heads[fl][sl];
+        if (block.nextFree != NONE) {
+            blocks[block.nextFree].prevFree = index;
+        }
+        heads[fl][sl] = index;
+        flBitmap |= 1u << fl;
+        slBitmap[fl] |= 1u << sl;
+        freeBytes += block.size;
+        freeBlocks++;
+    }
+
+    void removeFree(uint32_t index) {
+        Block& block = blocks[index];
+        uint32_t fl, sl;
+        mapping(block.size, fl, sl);
+        if (block.prevFree != NONE) {
+            blocks[block.prevFree].nextFree = block.nextFree;
+        }
+        else {
+            heads[fl][sl] = block.nextFree;
+            if (heads[fl][sl] == NONE) {
+                slBitmap[fl] &= ~(1u << sl);
+                if (slBitmap[fl] == 0) {
+                    flBitmap &= ~(1u << fl);
+                }
+            }
+        }
+        if (block.nextFree != NONE) {
+            blocks[block.nextFree].prevFree = block.prevFree;
+        }
+        block.free = false;
+        freeBytes -= block.size;
+        freeBlocks--;
+    }
+
+    // a absorbs its physical successor b, returns a
+    uint32_t merge(uint32_t a, uint32_t b) {
+        blocks[a].size += blocks[b].size;
+        blocks[a].nextPhysical = blocks[b].nextPhysical;
+        if (blocks[a].nextPhysical != NONE) {
+            blocks[blocks[a].nextPhysical].prevPhysical = a;
+        }
+        unusedBlocks.push_back(b);
+        return a;
+    }
+};
+
+// where an allocation lives right now, offsets change when a page is compacted
+struct GpuRange {
+    unsigned int buffer;
+    unsigned int page;
+    GLintptr offset;
+    GLsizeiptr size;
+};
+
+struct GpuHeapStats {
+    unsigned int pages = 0;
+    unsigned int allocations = 0;
+    uint64_t capacity = 0;
+    uint64_t usedBytes = 0;
+    uint64_t freeBytes = 0;
+    uint32_t freeBlocks = 0;
+    uint64_t largestFreeBlock = 0;
+    float fragmentation = 0.0f;   // 1 - largestFreeBlock / freeBytes
+};
+
+class GpuHeap {
+public:
+    static constexpr unsigned int INVALID = 0xFFFFFFFF;
+
+    GLsizeiptr pageSize;
+    GLenum usage;
+
+    // pages are created on demand, an allocation larger than pageSize gets a page of its own
+    GpuHeap(GLsizeiptr pageSize = 64 << 20, GLenum usage = GL_STATIC_DRAW)
+        : pageSize(pageSize), usage(usage) {}
+
+    GpuHeap(const GpuHeap&) = delete;
+    GpuHeap& operator=(const GpuHeap&) = delete;
+
+    // INVALID if the page for it couldn't hold it either
+    unsigned int allocate(GLsizeiptr size, GLsizeiptr alignment = TlsfAllocator::GRANULARITY) {
+        unsigned int page = 0;
+        uint32_t block = TlsfAllocator::NONE;
+        for (; page < pages.size(); page++) {
+            block = pages[page].allocator.allocate(size, alignment);
+            if (block != TlsfAllocator::NONE) {
+                break;
+            }
+        }
+        if (block == TlsfAllocator::NONE) {
+            uint64_t needed = TlsfAllocator::capacityFor((uint64_t)size, (uint64_t)alignment);
+            page = addPage(std::max(pageSize, (GLsizeiptr)needed));
+            block = pages[page].allocator.allocate(size, alignment);
+        }
+        if (block == TlsfAllocator::NONE) {
+            printf("ERROR::GPU_HEAP::ALLOCATION_FAILED %lld bytes\n", (long long)size);
+            return INVALID;
+        }
+
+        unsigned int id;
+        if (!unusedIds.empty()) {
+            id = unusedIds.back();
+            unusedIds.pop_back();
+        }
+        else {
+            id = (unsigned int)allocations.size();
+            allocations.push_back(Allocation());
+        }
+        allocations[id] = { page, block, (uint64_t)alignment, true };
+        return id;
+    }
+
+    void free(unsigned int id) {
+        Allocation& allocation = allocations[id];
+        pages[allocation.page].allocator.free(allocation.block);
+        allocation.live = false;
+        unusedIds.push_back(id);
+    }
+
+    GpuRange range(unsigned int id) const {
+        const Allocation& allocation = allocations[id];
+        const Page& page = pages[allocation.page];
+        return { page.buffer, allocation.page, (GLintptr)page.allocator.offset(allocation.block),
+                 (GLsizeiptr)page.allocator.size(allocation.block) };
+    }
+
+    // writes through GL_COPY_WRITE_BUFFER so no VAO or element array binding is touched
+    void upload(unsigned int id, const void* data, GLsizeiptr size, GLintptr offset = 0) {
+        GpuRange r = range(id);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, r.buffer);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, r.offset + offset, size, data);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+
+    unsigned int pageCount() const {
+        return (unsigned int)pages.size();
+    }
+
+    unsigned int pageBuffer(unsigned int page) const {
+        return pages[page].buffer;
+    }
+
+    GpuHeapStats stats() const {
+        GpuHeapStats s;
+        s.pages = (unsigned int)pages.size();
+        for (const Page& page : pages) {
+            const TlsfAllocator& a = page.allocator;
+            s.allocations += a.getAllocations();
+            s.capacity += a.getCapacity();
+            s.usedBytes += a.getUsedBytes();
+            s.freeBytes += a.getFreeBytes();
+            s.freeBlocks += a.getFreeBlocks();
+            s.largestFreeBlock = std::max(s.largestFreeBlock, a.largestFreeBlock());
+        }
+        s.fragmentation = s.freeBytes > 0 ? 1.0f - (float)s.largestFreeBlock / (float)s.freeBytes : 0.0f;
+        return s;
+    }
+
+    // Packs the allocations of every page whose fragmentation is above
+    // threshold towards offset 0, returns the bytes moved. The live ranges are
+    // copied into a staging buffer at their new offsets and back in one copy,
+    // because glCopyBufferSubData can't copy between overlapping ranges of
+    // one buffer. Copies are ordered after earlier draws by GL, but ranges
+    // looked up before compacting are stale afterwards.
+    uint64_t compact(float threshold = 0.0f) {
+        uint64_t moved = 0;
+        for (unsigned int p = 0; p < pages.size(); p++) {
+            Page& page = pages[p];
+            if (page.allocator.getAllocations() == 0 || page.allocator.fragmentation() <= threshold) {
+                continue;
+            }
+
+            std::vector<unsigned int> ids;
+            for (unsigned int id = 0; id < allocations.size(); id++) {
+                if (allocations[id].live && allocations[id].page == p) {
+                    ids.push_back(id);
+                }
+            }
+            std::sort(ids.begin(), ids.end(), [&](unsigned int a, unsigned int b) {
+                return page.allocator.offset(allocations[a].block) < page.allocator.offset(allocations[b].block);
+            });
+
+            std::vector<uint64_t> oldOffsets, sizes;
+            for (unsigned int id : ids) {
+                oldOffsets.push_back(page.allocator.offset(allocations[id].block));
+                sizes.push_back(page.allocator.size(allocations[id].block));
+            }
+
+            // allocating in offset order from an empty page packs them in the same order
+            page.allocator.reset(page.allocator.getCapacity());
+            uint64_t end = 0;
+            for (size_t i = 0; i < ids.size(); i++) {
+                Allocation& allocation = allocations[ids[i]];
+                allocation.block = page.allocator.allocate(sizes[i], allocation.alignment);
+                end = page.allocator.offset(allocation.block) + sizes[i];
+            }
+
+            if (staging == 0 || stagingSize < (GLsizeiptr)end) {
+                glDeleteBuffers(1, &staging);
+                glGenBuffers(1, &staging);
+                glBindBuffer(GL_COPY_WRITE_BUFFER, staging);
+                glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)end, NULL, GL_STREAM_COPY);
+                stagingSize = (GLsizeiptr)end;
+            }
+
+            glBindBuffer(GL_COPY_READ_BUFFER, page.buffer);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, staging);
+            for (size_t i = 0; i < ids.size(); i++) {
+                uint64_t newOffset = page.allocator.offset(allocations[ids[i]].block);
+                glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, (GLintptr)oldOffsets[i], (GLintptr)newOffset, (GLsizeiptr)sizes[i]);
+                if (newOffset != oldOffsets[i]) {
+                    moved += sizes[i];
+                }
+            }
+            glBindBuffer(GL_COPY_READ_BUFFER, staging);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, page.buffer);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, (GLsizeiptr)end);
+        }
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        return moved;
+    }
+
+    // delete all GL objects owned by the heap
+    void del() {
+        for (Page& page : pages) {
+            glDeleteBuffers(1, &page.buffer);
+        }
+        glDeleteBuffers(1, &staging);
+        pages.clear();
+        allocations.clear();
+        unusedIds.clear();
+        staging = 0;
+        stagingSize = 0;
+    }
+
+private:
+    struct Page {
+        unsigned int buffer;
+        TlsfAllocator allocator;
+    };
+
+    struct Allocation {
+        unsigned int page;
+        uint32_t block;
+        uint64_t alignment;
+        bool live;
+    };
+
+    std::vector<Page> pages;
+    std::vector<Allocation> allocations;
+    std::vector<unsigned int> unusedIds;
+    unsigned int staging = 0;
+    GLsizeiptr stagingSize = 0;
+
+    unsigned int addPage(GLsizeiptr size) {
+        Page page;
+        glGenBuffers(1, &page.buffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, page.buffer);
+        glBufferData(GL_COPY_WRITE_BUFFER, size, NULL, usage);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        page.allocator.reset((uint64_t)size);
+        pages.push_back(page);
+        return (unsigned int)pages.size() - 1;
+    }
+};
+
+// the record glDrawElementsIndirect and glMultiDrawElementsIndirect read
+struct DrawElementsIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+
+// one float vertex attribute inside an interleaved vertex
+struct MeshAttribute {
+    unsigned int location;
+    int size; // number of floats
+};
+
+// Indexed meshes of one interleaved vertex layout, packed into a GpuHeap.
+//
+// A mesh is one allocation: its vertices, then its 32-bit indices. The
+// allocation is aligned to the vertex stride, so the mesh's first vertex is
+// vertex offset / stride of the page and glDrawElementsBaseVertex can add it
+// to the indices. Each page is bound as both the vertex and the element
+// buffer of the page's VAO, so drawing meshes of one page only changes the
+// draw call arguments.
+class MeshPool {
+public:
+    unsigned int stride; // bytes per vertex
+    GpuHeap heap;
+
+    MeshPool(const std::vector<MeshAttribute>& attributes, GLsizeiptr pageSize = 32 << 20)
+        : stride(0), heap(pageSize), attributes(attributes) {
+        for (const MeshAttribute& attribute : attributes) {
+            stride += attribute.size * sizeof(float);
+        }
+    }
+
+    MeshPool(const MeshPool&) = delete;
+    MeshPool& operator=(const MeshPool&) = delete;
+
+    // returns the mesh id, which stays valid until remove, GpuHeap::INVALID
+    // if it couldn't be allocated
+    unsigned int add(const float* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount) {
+        GLsizeiptr vertexBytes = (GLsizeiptr)vertexCount * stride;
+        GLsizeiptr indexBytes = (GLsizeiptr)indexCount * sizeof(unsigned int);
+        unsigned int id = heap.allocate(vertexBytes + indexBytes, stride);
+        if (id == GpuHeap::INVALID) {
+            return id;
+        }
+        heap.upload(id, vertices, vertexBytes);
+        heap.upload(id, indices, indexBytes, vertexBytes);
+
+        if (meshes.size() <= id) {
+            meshes.resize(id + 1);
+        }
+        meshes[id] = { vertexCount, indexCount };
+        updateVaos();
+        return id;
+    }
+
+    void remove(unsigned int mesh) {
+        heap.free(mesh);
+    }
+
+    // binds the mesh's page VAO, skipped when it is already bound
+    void bind(unsigned int mesh) {
+        unsigned int vao = vaos[heap.range(mesh).page];
+        if (vao != boundVao) {
+            glBindVertexArray(vao);
+            boundVao = vao;
+        }
+    }
+
+    void draw(unsigned int mesh, GLenum mode = GL_TRIANGLES) {
+        bind(mesh);
+        GpuRange r = heap.range(mesh);
+        const Mesh& m = meshes[mesh];
+        std::size_t indexOffset = (std::size_t)r.offset + (std::size_t)m.vertexCount * stride;
+        glDrawElementsBaseVertex(mode, m.indexCount, GL_UNSIGNED_INT, (void*)indexOffset, (GLint)(r.offset / stride));
+    }
+
+    // page of the mesh, only meshes of one page can share a draw call
+    unsigned int page(unsigned int mesh) const {
+        return heap.range(mesh).page;
+    }
+
+    // the draw() of the mesh as an indirect command, offsets relative to its page
+    DrawElementsIndirectCommand command(unsigned int mesh, unsigned int baseInstance = 0) const {
+        GpuRange r = heap.range(mesh);
+        const Mesh& m = meshes[mesh];
+        std::size_t indexOffset = (std::size_t)r.offset + (std::size_t)m.vertexCount * stride;
+        return { m.indexCount, 1, (GLuint)(indexOffset / sizeof(unsigned int)), (GLint)(r.offset / stride), baseInstance };
+    }
+
+    // call when something else may have changed the VAO binding
+    void unbind() {
+        glBindVertexArray(0);
+        boundVao = 0;
+    }
+
+    uint64_t compact(float threshold = 0.0f) {
+        return heap.compact(threshold);
+    }
+
+    // delete all GL objects owned by the pool
+    void del() {
+        glDeleteVertexArrays((GLsizei)vaos.size(), vaos.data());
+        vaos.clear();
+        heap.del();
+        boundVao = 0;
+    }
+
+private:
+    struct Mesh {
+        unsigned int vertexCount;
+        unsigned int indexCount;
+    };
+
+    std::vector<MeshAttribute> attributes;
+    std::vector<Mesh> meshes;
+    std::vector<unsigned int> vaos; // one per heap page
+    unsigned int boundVao = 0;
+
+    void updateVaos() {
+        while (vaos.size() < heap.pageCount()) {
+            unsigned int vao;
+            glGenVertexArrays(1, &vao);
+            glBindVertexArray(vao);
+            unsigned int buffer = heap.pageBuffer((unsigned int)vaos.size());
+            glBindBuffer(GL_ARRAY_BUFFER, buffer);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer);
+
+            std::size_t offset = 0;
+            for (const MeshAttribute& attribute : attributes) {
+                glVertexAttribPointer(attribute.location, attribute.size, GL_FLOAT, GL_FALSE, stride, (void*)offset);
+                glEnableVertexAttribArray(attribute.location);
+                offset += attribute.size * sizeof(float);
+            }
+
+            glBindVertexArray(0);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            boundVao = 0;
+            vaos.push_back(vao);
+        }
+    }
+};
+
+#endif
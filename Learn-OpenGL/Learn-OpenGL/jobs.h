@@ -0,0 +1,416 @@
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Work-stealing job system for the CPU side of a frame.
+//
+// Every worker owns a Chase-Lev deque: it pushes and pops jobs at the bottom
+// without locks, idle workers steal from the top of someone else's. The
+// thread that creates the JobSystem is worker 0 and takes part whenever it
+// waits, so threadCount = 1 runs everything inline on the caller.
+//
+// A job is a function plus a small inline payload (a lambda up to
+// Job::PAYLOAD bytes, no heap allocation). Jobs are connected with counters:
+//   - children: create(fn, parent) makes parent count as unfinished until
+//     the child is done, wait(parent) returns when the whole tree is.
+//   - dependencies: dependsOn(job, first) keeps job out of the queues until
+//     first (and its children) finished. Declare dependencies before running
+//     first, a job that already finished can't be depended on.
+// parallelFor splits an index range into a tree of batches.
+//
+//     JobSystem jobs;
+//     Job* update = jobs.parallelForJob(count, 1024, [&](size_t begin, size_t end) { ... });
+//     Job* cull = jobs.parallelForJob(count, 1024, [&](size_t begin, size_t end) { ... });
+//     jobs.dependsOn(cull, update);
+//     jobs.run(cull);
+//     jobs.run(update);
+//     jobs.wait(cull);
+//
+// Only the workers (the creating thread included) may create, run and wait
+// on jobs. Job memory comes from a per-worker ring that is reused, so a
+// worker must not have more than JOBS_PER_WORKER jobs in flight.
+
+struct Job;
+typedef void (*JobFunction)(Job* job, void* payload);
+
+struct alignas(64) Job {
+    static const std::size_t PAYLOAD = 64;
+    static const int MAX_DEPENDENTS = 6;
+
+    JobFunction function;
+    Job* parent;
+    std::atomic<int> unfinished;     // itself + unfinished children
+    std::atomic<int> dependencies;   // unfinished prerequisites + 1 until run() is called
+    std::atomic<int> dependentCount;
+    Job* dependents[MAX_DEPENDENTS];
+    alignas(16) unsigned char payload[PAYLOAD];
+};
+
+// Chase-Lev work-stealing deque of Job pointers with a fixed capacity
+// (David Chase and Yossi Lev 2005, with the C11 memory orders from Le et al.
+// 2013). push and pop are for the owning thread only, steal for any thread.
+class JobDeque {
+public:
+    explicit JobDeque(std::size_t capacity = 4096) : jobs(capacity), mask(capacity - 1) {}
+
+    // false when full
+    bool push(Job* job) {
+        std::int64_t b = bottom.load(std::memory_order_relaxed);
+        std::int64_t t = top.load(std::memory_order_acquire);
+        if (b - t > (std::int64_t)mask) {
+            return false;
+        }
+        jobs[b & mask].store(job, std::memory_order_relaxed);
+        // publishes the job and everything written to it to the thieves
+        bottom.store(b + 1, std::memory_order_release);
+        return true;
+    }
+
+    // newest job, NULL when empty
+    Job* pop() {
+        std::int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t t = top.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return NULL;
+        }
+        Job* job = jobs[b & mask].load(std::memory_order_relaxed);
+        if (t == b) {
+            // the last one, race the thieves for it
+            if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                job = NULL;
+            }
+            bottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return job;
+    }
+
+    // oldest job, NULL when empty or another thread got it first
+    Job* steal() {
+        std::int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t b = bottom.load(std::memory_order_acquire);
+        if (t >= b) {
+            return NULL;
+        }
+        Job* job = jobs[t & mask].load(std::memory_order_relaxed);
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return NULL;
+        }
+        return job;
+    }
+
+private:
+    std::vector<std::atomic<Job*>> jobs;
+    std::size_t mask;
+    // on separate cache lines, the owner writes bottom and the thieves top
+    alignas(64) std::atomic<std::int64_t> top{ 0 };
+    alignas(64) std::atomic<std::int64_t> bottom{ 0 };
+};
+
+class JobSystem {
+public:
+    static const std::size_t JOBS_PER_WORKER = 4096;
+
+    explicit JobSystem(unsigned int threadCount = 0) {
+        if (threadCount == 0) {
+            threadCount = std::thread::hardware_concurrency();
+        }
+        if (threadCount == 0) {
+            threadCount = 1;
+        }
+
+        workers.reserve(threadCount);
+        for (unsigned int i = 0; i < threadCount; i++) {
+            workers.emplace_back(new Worker());
+        }
+        currentWorker() = workers[0];
+        currentWorker()->system = this;
+        for (unsigned int i = 1; i < threadCount; i++) {
+            threads.emplace_back(&JobSystem::workerLoop, this, i);
+        }
+    }
+
+    ~JobSystem() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            quit = true;
+        }
+        wake.notify_all();
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        if (currentWorker() == workers[0]) {
+            currentWorker() = NULL;
+        }
+        for (Worker* worker : workers) {
+            delete worker;
+        }
+    }
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    unsigned int threadCount() const {
+        return (unsigned int)workers.size();
+    }
+
+    // 1, 2, 4, ... and maxThreads itself, the thread counts a benchmark sweeps
+    static std::vector<unsigned int> threadCountSweep(unsigned int maxThreads) {
+        std::vector<unsigned int> counts;
+        for (unsigned int threads = 1; threads < maxThreads; threads *= 2) {
+            counts.push_back(threads);
+        }
+        counts.push_back(maxThreads > 0 ? maxThreads : 1);
+        return counts;
+    }
+
+    // index of the calling worker, 0 for the thread that created the system
+    unsigned int workerIndex() const {
+        return currentWorker()->index;
+    }
+
+    // A job running fn(), not started until run(). fn is copied into the
+    // job and must fit in Job::PAYLOAD bytes.
+    template <typename F>
+    Job* create(F fn, Job* parent = NULL) {
+        static_assert(sizeof(F) <= Job::PAYLOAD, "job lambda captures too much, capture a pointer to a struct instead");
+        static_assert(alignof(F) <= 16, "job lambda is over-aligned");
+        Job* job = allocate(parent);
+        job->function = [](Job*, void* payload) {
+            F* f = (F*)payload;
+            (*f)();
+            f->~F();
+        };
+        new (job->payload) F(std::move(fn));
+        return job;
+    }
+
+    // job runs only once prerequisite (and its children) finished
+    void dependsOn(Job* job, Job* prerequisite) {
+        int slot = prerequisite->dependentCount.fetch_add(1, std::memory_order_relaxed);
+        if (slot >= Job::MAX_DEPENDENTS) {
+            // out of slots: wait for the last dependent instead, which runs after prerequisite
+            prerequisite->dependentCount.fetch_sub(1, std::memory_order_relaxed);
+            dependsOn(job, prerequisite->dependents[Job::MAX_DEPENDENTS - 1]);
+            return;
+        }
+        job->dependencies.fetch_add(1, std::memory_order_relaxed);
+        prerequisite->dependents[slot] = job;
+    }
+
+    // queues the job on the calling worker once its dependencies are done
+    void run(Job* job) {
+        if (job->dependencies.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            push(job);
+        }
+    }
+
+    // runs other jobs until job and its children are done
+    void wait(const Job* job) {
+        Worker* self = currentWorker();
+        unsigned int idle = 0;
+        while (job->unfinished.load(std::memory_order_acquire) > 0) {
+            Job* next = findJob(self);
+            if (next != NULL) {
+                execute(next);
+                idle = 0;
+            }
+            else if (++idle > 64) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    // Calls fn(begin, end) over [0, count) in batches of at most batchSize,
+    // spread over the workers, and returns when all are done.
+    template <typename F>
+    void parallelFor(std::size_t count, std::size_t batchSize, const F& fn) {
+        Job* job = parallelForJob(count, batchSize, fn);
+        run(job);
+        wait(job);
+    }
+
+    // parallelFor as a job to run later or to add dependencies to. fn is
+    // referenced, not copied, it must stay alive until the job is done.
+    template <typename F>
+    Job* parallelForJob(std::size_t count, std::size_t batchSize, const F& fn, Job* parent = NULL) {
+        Range range = { 0, count, batchSize > 0 ? batchSize : 1, &fn, this };
+        Job* job = allocate(parent);
+        job->function = &splitRange<F>;
+        new (job->payload) Range(range);
+        return job;
+    }
+
+private:
+    struct Worker {
+        unsigned int index = 0;
+        JobSystem* system = NULL;
+        JobDeque deque{ JOBS_PER_WORKER };
+        std::vector<Job> jobs{ JOBS_PER_WORKER };
+        std::size_t nextJob = 0;
+        std::uint32_t random = 1;
+    };
+
+    struct Range {
+        std::size_t begin;
+        std::size_t end;
+        std::size_t batchSize;
+        const void* fn;
+        JobSystem* system;
+    };
+
+    std::vector<Worker*> workers;
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::atomic<int> queued{ 0 };      // jobs pushed and not taken yet, wakes sleeping workers
+    std::atomic<int> sleeping{ 0 };
+    bool quit = false;
+
+    static Worker*& currentWorker() {
+        thread_local Worker* worker = NULL;
+        return worker;
+    }
+
+    // halves the range until it is one batch, the halves become child jobs
+    template <typename F>
+    static void splitRange(Job* job, void* payload) {
+        Range range = *(Range*)payload;
+        while (range.end - range.begin > range.batchSize) {
+            std::size_t middle = range.begin + (range.end - range.begin) / 2;
+            Range upper = { middle, range.end, range.batchSize, range.fn, range.system };
+            Job* child = range.system->allocate(job);
+            child->function = &splitRange<F>;
+            new (child->payload) Range(upper);
+            range.system->run(child);
+            range.end = middle;
+        }
+        (*(const F*)range.fn)(range.begin, range.end);
+    }
+
+    Job* allocate(Job* parent) {
+        Worker* self = currentWorker();
+        Job* job = &self->jobs[self->nextJob++ & (JOBS_PER_WORKER - 1)];
+        job->function = NULL;
+        job->parent = parent;
+        job->unfinished.store(1, std::memory_order_relaxed);
+        job->dependencies.store(1, std::memory_order_relaxed);
+        job->dependentCount.store(0, std::memory_order_relaxed);
+        if (parent != NULL) {
+            parent->unfinished.fetch_add(1, std::memory_order_relaxed);
+        }
+        return job;
+    }
+
+    void push(Job* job) {
+        Worker* self = currentWorker();
+        while (!self->deque.push(job)) {
+            // full, make room by working
+            Job* next = self->deque.pop();
+            if (next != NULL) {
+                queued.fetch_sub(1, std::memory_order_relaxed);
+                execute(next);
+            }
+        }
+        queued.fetch_add(1, std::memory_order_seq_cst);
+        if (sleeping.load(std::memory_order_seq_cst) > 0) {
+            std::lock_guard<std::mutex> lock(mutex);
+            wake.notify_one();
+        }
+    }
+
+    Job* findJob(Worker* self) {
+        Job* job = self->deque.pop();
+        if (job == NULL && workers.size() > 1) {
+            // xorshift to pick where to steal from
+            self->random ^= self->random << 13;
+            self->random ^= self->random >> 17;
+            self->random ^= self->random << 5;
+            unsigned int start = self->random % workers.size();
+            for (unsigned int i = 0; i < workers.size() && job == NULL; i++) {
+                Worker* victim = workers[(start + i) % workers.size()];
+                if (victim != self) {
+                    job = victim->deque.steal();
+                }
+            }
+        }
+        if (job != NULL) {
+            queued.fetch_sub(1, std::memory_order_relaxed);
+        }
+        return job;
+    }
+
+    void execute(Job* job) {
+        job->function(job, job->payload);
+        finish(job);
+    }
+
+    void finish(Job* job) {
+        // Read everything before the decrement: once unfinished reaches 0 a
+        // waiter can return and its worker reuse the slot. Dependents were
+        // all declared before run(), so they can't change in between.
+        Job* parent = job->parent;
+        int dependentCount = job->dependentCount.load(std::memory_order_acquire);
+        Job* dependents[Job::MAX_DEPENDENTS];
+        for (int i = 0; i < dependentCount; i++) {
+            dependents[i] = job->dependents[i];
+        }
+        if (job->unfinished.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+            return;
+        }
+        for (int i = 0; i < dependentCount; i++) {
+            run(dependents[i]);
+        }
+        if (parent != NULL) {
+            finish(parent);
+        }
+    }
+
+    void workerLoop(unsigned int index) {
+        Worker* self = workers[index];
+        self->index = index;
+        self->system = this;
+        self->random = 0x9E3779B9u * (index + 1);
+        currentWorker() = self;
+
+        unsigned int idle = 0;
+        for (;;) {
+            Job* job = findJob(self);
+            if (job != NULL) {
+                execute(job);
+                idle = 0;
+                continue;
+            }
+            if (++idle < 256) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            // nothing to steal for a while, sleep until a push
+            std::unique_lock<std::mutex> lock(mutex);
+            sleeping.fetch_add(1, std::memory_order_seq_cst);
+            wake.wait(lock, [this]() { return quit || queued.load(std::memory_order_seq_cst) > 0; });
+            sleeping.fetch_sub(1, std::memory_order_seq_cst);
+            if (quit) {
+                return;
+            }
+            idle = 0;
+        }
+    }
+};
+
+#endif
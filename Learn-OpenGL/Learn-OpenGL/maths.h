@@ -0,0 +1,564 @@
+#ifndef MATHS_H
+#define MATHS_H
+
+// Small vector/matrix/quaternion library for CPU-side transforms.
+//
+// Matrices are column-major (same memory layout OpenGL expects), so a mat4
+// can be handed straight to glUniformMatrix4fv with transpose = GL_FALSE.
+//
+// The SIMD path is picked at compile time:
+//   - MATHS_AVX2 when the compiler targets AVX2 (/arch:AVX2, -mavx2)
+//   - MATHS_SSE  on any x86 target with SSE2 (always true on x64)
+//   - otherwise a plain scalar path, written so that compilers can still
+//     auto-vectorize it for NEON on ARM
+// Define MATHS_FORCE_SCALAR before including this header to force the scalar path.
+
+#include <cmath>
+#include <cstddef>
+
+#if !defined(MATHS_FORCE_SCALAR)
+    #if defined(__AVX2__)
+        #define MATHS_AVX2
+        #define MATHS_SSE
+    #elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+        #define MATHS_SSE
+    #endif
+#endif
+
+#if defined(MATHS_AVX2)
+    #include <immintrin.h>
+#elif defined(MATHS_SSE)
+    #include <emmintrin.h>
+#endif
+
+namespace maths {
+
+const float PI = 3.14159265358979323846f;
+
+inline float radians(float degrees) {
+    return degrees * (PI / 180.0f);
+}
+
+inline float degrees(float radians) {
+    return radians * (180.0f / PI);
+}
+
+// ---------------------------------------------------------------------------
+// vectors
+// ---------------------------------------------------------------------------
+
+struct vec2 {
+    float x, y;
+
+    vec2() : x(0.0f), y(0.0f) {}
+    explicit vec2(float s) : x(s), y(s) {}
+    vec2(float x, float y) : x(x), y(y) {}
+
+    float& operator[](int i) { return (&x)[i]; }
+    float operator[](int i) const { return (&x)[i]; }
+};
+
+struct vec3 {
+    float x, y, z;
+
+    vec3() : x(0.0f), y(0.0f), z(0.0f) {}
+    explicit vec3(float s) : x(s), y(s), z(s) {}
+    vec3(float x, float y, float z) : x(x), y(y), z(z) {}
+    vec3(const vec2& v, float z) : x(v.x), y(v.y), z(z) {}
+
+    float& operator[](int i) { return (&x)[i]; }
+    float operator[](int i) const { return (&x)[i]; }
+};
+
+// vec4 is 16-byte aligned so it can be loaded into one SSE register
+struct alignas(16) vec4 {
+    float x, y, z, w;
+
+    vec4() : x(0.0f), y(0.0f), z(0.0f), w(0.0f) {}
+    explicit vec4(float s) : x(s), y(s), z(s), w(s) {}
+    vec4(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+    vec4(const vec3& v, float w) : x(v.x), y(v.y), z(v.z), w(w) {}
+
+    float& operator[](int i) { return (&x)[i]; }
+    float operator[](int i) const { return (&x)[i]; }
+};
+
+#if defined(MATHS_SSE)
+inline __m128 load(const vec4& v) {
+    return _mm_load_ps(&v.x);
+}
+
+inline vec4 store(__m128 r) {
+    vec4 v;
+    _mm_store_ps(&v.x, r);
+    return v;
+}
+
+// a * b + c, fused when the target has FMA
+inline __m128 madd(__m128 a, __m128 b, __m128 c) {
+#if defined(MATHS_AVX2) && defined(__FMA__)
+    return _mm_fmadd_ps(a, b, c);
+#else
+    return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+}
+#endif
+
+// vec2 operators
+inline vec2 operator+(const vec2& a, const vec2& b) { return vec2(a.x + b.x, a.y + b.y); }
+inline vec2 operator-(const vec2& a, const vec2& b) { return vec2(a.x - b.x, a.y - b.y); }
+inline vec2 operator*(const vec2& a, const vec2& b) { return vec2(a.x * b.x, a.y * b.y); }
+inline vec2 operator*(const vec2& a, float s) { return vec2(a.x * s, a.y * s); }
+inline vec2 operator*(float s, const vec2& a) { return a * s; }
+inline vec2 operator/(const vec2& a, float s) { return a * (1.0f / s); }
+inline vec2 operator-(const vec2& a) { return vec2(-a.x, -a.y); }
+
+// vec3 operators
+inline vec3 operator+(const vec3& a, const vec3& b) { return vec3(a.x + b.x, a.y + b.y, a.z + b.z); }
+inline vec3 operator-(const vec3& a, const vec3& b) { return vec3(a.x - b.x, a.y - b.y, a.z - b.z); }
+inline vec3 operator*(const vec3& a, const vec3& b) { return vec3(a.x * b.x, a.y * b.y, a.z * b.z); }
+inline vec3 operator*(const vec3& a, float s) { return vec3(a.x * s, a.y * s, a.z * s); }
+inline vec3 operator*(float s, const vec3& a) { return a * s; }
+inline vec3 operator/(const vec3& a, float s) { return a * (1.0f / s); }
+inline vec3 operator-(const vec3& a) { return vec3(-a.x, -a.y, -a.z); }
+
+// vec4 operators
+#if defined(MATHS_SSE)
+inline vec4 operator+(const vec4& a, const vec4& b) { return store(_mm_add_ps(load(a), load(b))); }
+inline vec4 operator-(const vec4& a, const vec4& b) { return store(_mm_sub_ps(load(a), load(b))); }
+inline vec4 operator*(const vec4& a, const vec4& b) { return store(_mm_mul_ps(load(a), load(b))); }
+inline vec4 operator*(const vec4& a, float s) { return store(_mm_mul_ps(load(a), _mm_set1_ps(s))); }
+#else
+inline vec4 operator+(const vec4& a, const vec4& b) { return vec4(a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w); }
+inline vec4 operator-(const vec4& a, const vec4& b) { return vec4(a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w); }
+inline vec4 operator*(const vec4& a, const vec4& b) { return vec4(a.x * b.x, a.y * b.y, a.z * b.z, a.w * b.w); }
+inline vec4 operator*(const vec4& a, float s) { return vec4(a.x * s, a.y * s, a.z * s, a.w * s); }
+#endif
+inline vec4 operator*(float s, const vec4& a) { return a * s; }
+inline vec4 operator/(const vec4& a, float s) { return a * (1.0f / s); }
+inline vec4 operator-(const vec4& a) { return a * -1.0f; }
+
+inline float dot(const vec2& a, const vec2& b) { return a.x * b.x + a.y * b.y; }
+inline float dot(const vec3& a, const vec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+inline float dot(const vec4& a, const vec4& b) { return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w; }
+
+inline vec3 cross(const vec3& a, const vec3& b) {
+    return vec3(a.y * b.z - a.z * b.y,
+                a.z * b.x - a.x * b.z,
+                a.x * b.y - a.y * b.x);
+}
+
+inline float length(const vec2& v) { return std::sqrt(dot(v, v)); }
+inline float length(const vec3& v) { return std::sqrt(dot(v, v)); }
+inline float length(const vec4& v) { return std::sqrt(dot(v, v)); }
+
+inline vec2 normalize(const vec2& v) { return v / length(v); }
+inline vec3 normalize(const vec3& v) { return v / length(v); }
+inline vec4 normalize(const vec4& v) { return v / length(v); }
+
+// ---------------------------------------------------------------------------
+// matrices (column-major)
+// ---------------------------------------------------------------------------
+
+struct mat3 {
+    vec3 cols[3];
+
+    // mat3(1.0f) is the identity, mat3(0.0f) is all zeros
+    explicit mat3(float diagonal = 1.0f) {
+        cols[0] = vec3(diagonal, 0.0f, 0.0f);
+        cols[1] = vec3(0.0f, diagonal, 0.0f);
+        cols[2] = vec3(0.0f, 0.0f, diagonal);
+    }
+    mat3(const vec3& c0, const vec3& c1, const vec3& c2) {
+        cols[0] = c0;
+        cols[1] = c1;
+        cols[2] = c2;
+    }
+
+    vec3& operator[](int i) { return cols[i]; }
+    const vec3& operator[](int i) const { return cols[i]; }
+
+    const float* ptr() const { return &cols[0].x; }
+};
+
+struct alignas(16) mat4 {
+    vec4 cols[4];
+
+    // mat4(1.0f) is the identity, mat4(0.0f) is all zeros
+    explicit mat4(float diagonal = 1.0f) {
+        cols[0] = vec4(diagonal, 0.0f, 0.0f, 0.0f);
+        cols[1] = vec4(0.0f, diagonal, 0.0f, 0.0f);
+        cols[2] = vec4(0.0f, 0.0f, diagonal, 0.0f);
+        cols[3] = vec4(0.0f, 0.0f, 0.0f, diagonal);
+    }
+    mat4(const vec4& c0, const vec4& c1, const vec4& c2, const vec4& c3) {
+        cols[0] = c0;
+        cols[1] = c1;
+        cols[2] = c2;
+        cols[3] = c3;
+    }
+    // upper-left 3x3 from m, rest identity
+    explicit mat4(const mat3& m) {
+        cols[0] = vec4(m[0], 0.0f);
+        cols[1] = vec4(m[1], 0.0f);
+        cols[2] = vec4(m[2], 0.0f);
+        cols[3] = vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    }
+
+    vec4& operator[](int i) { return cols[i]; }
+    const vec4& operator[](int i) const { return cols[i]; }
+
+    // pointer to the 16 floats, ready for glUniformMatrix4fv
+    const float* ptr() const { return &cols[0].x; }
+};
+
+// mat3
+inline vec3 operator*(const mat3& m, const vec3& v) {
+    return m[0] * v.x + m[1] * v.y + m[2] * v.z;
+}
+
+inline mat3 operator*(const mat3& a, const mat3& b) {
+    return mat3(a * b[0], a * b[1], a * b[2]);
+}
+
+inline mat3 transpose(const mat3& m) {
+    return mat3(vec3(m[0].x, m[1].x, m[2].x),
+                vec3(m[0].y, m[1].y, m[2].y),
+                vec3(m[0].z, m[1].z, m[2].z));
+}
+
+inline float determinant(const mat3& m) {
+    return dot(m[0], cross(m[1], m[2]));
+}
+
+inline mat3 inverse(const mat3& m) {
+    // rows of the inverse are the cross products of the columns
+    vec3 r0 = cross(m[1], m[2]);
+    vec3 r1 = cross(m[2], m[0]);
+    vec3 r2 = cross(m[0], m[1]);
+    float invDet = 1.0f / dot(m[0], r0);
+    return transpose(mat3(r0 * invDet, r1 * invDet, r2 * invDet));
+}
+
+// upper-left 3x3 of a mat4
+inline mat3 toMat3(const mat4& m) {
+    return mat3(vec3(m[0].x, m[0].y, m[0].z),
+                vec3(m[1].x, m[1].y, m[1].z),
+                vec3(m[2].x, m[2].y, m[2].z));
+}
+
+// mat4
+inline vec4 operator*(const mat4& m, const vec4& v) {
+#if defined(MATHS_SSE)
+    __m128 r = _mm_mul_ps(load(m[0]), _mm_set1_ps(v.x));
+    r = madd(load(m[1]), _mm_set1_ps(v.y), r);
+    r = madd(load(m[2]), _mm_set1_ps(v.z), r);
+    r = madd(load(m[3]), _mm_set1_ps(v.w), r);
+    return store(r);
+#else
+    return vec4(m[0].x * v.x + m[1].x * v.y + m[2].x * v.z + m[3].x * v.w,
+                m[0].y * v.x + m[1].y * v.y + m[2].y * v.z + m[3].y * v.w,
+                m[0].z * v.x + m[1].z * v.y + m[2].z * v.z + m[3].z * v.w,
+                m[0].w * v.x + m[1].w * v.y + m[2].w * v.z + m[3].w * v.w);
+#endif
+}
+
+inline mat4 operator*(const mat4& a, const mat4& b) {
+    return mat4(a * b[0], a * b[1], a * b[2], a * b[3]);
+}
+
+inline mat4 transpose(const mat4& m) {
+#if defined(MATHS_SSE)
+    __m128 c0 = load(m[0]), c1 = load(m[1]), c2 = load(m[2]), c3 = load(m[3]);
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+    return mat4(store(c0), store(c1), store(c2), store(c3));
+#else
+    return mat4(vec4(m[0].x, m[1].x, m[2].x, m[3].x),
+                vec4(m[0].y, m[1].y, m[2].y, m[3].y),
+                vec4(m[0].z, m[1].z, m[2].z, m[3].z),
+                vec4(m[0].w, m[1].w, m[2].w, m[3].w));
+#endif
+}
+
+// general 4x4 inverse using 2x2 sub-determinants (cofactor expansion)
+inline mat4 inverse(const mat4& m) {
+    const float* a = m.ptr();
+
+    float s0 = a[0] * a[5] - a[4] * a[1];
+    float s1 = a[0] * a[6] - a[4] * a[2];
+    float s2 = a[0] * a[7] - a[4] * a[3];
+    float s3 = a[1] * a[6] - a[5] * a[2];
+    float s4 = a[1] * a[7] - a[5] * a[3];
+    float s5 = a[2] * a[7] - a[6] * a[3];
+
+    float c5 = a[10] * a[15] - a[14] * a[11];
+    float c4 = a[9] * a[15] - a[13] * a[11];
+    float c3 = a[9] * a[14] - a[13] * a[10];
+    float c2 = a[8] * a[15] - a[12] * a[11];
+    float c1 = a[8] * a[14] - a[12] * a[10];
+    float c0 = a[8] * a[13] - a[12] * a[9];
+
+    float invDet = 1.0f / (s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0);
+
+    mat4 r(0.0f);
+    r[0].x = ( a[5] * c5 - a[6] * c4 + a[7] * c3) * invDet;
+    r[0].y = (-a[1] * c5 + a[2] * c4 - a[3] * c3) * invDet;
+    r[0].z = ( a[13] * s5 - a[14] * s4 + a[15] * s3) * invDet;
+    r[0].w = (-a[9] * s5 + a[10] * s4 - a[11] * s3) * invDet;
+
+    r[1].x = (-a[4] * c5 + a[6] * c2 - a[7] * c1) * invDet;
+    r[1].y = ( a[0] * c5 - a[2] * c2 + a[3] * c1) * invDet;
+    r[1].z = (-a[12] * s5 + a[14] * s2 - a[15] * s1) * invDet;
+    r[1].w = ( a[8] * s5 - a[10] * s2 + a[11] * s1) * invDet;
+
+    r[2].x = ( a[4] * c4 - a[5] * c2 + a[7] * c0) * invDet;
+    r[2].y = (-a[0] * c4 + a[1] * c2 - a[3] * c0) * invDet;
+    r[2].z = ( a[12] * s4 - a[13] * s2 + a[15] * s0) * invDet;
+    r[2].w = (-a[8] * s4 + a[9] * s2 - a[11] * s0) * invDet;
+
+    r[3].x = (-a[4] * c3 + a[5] * c1 - a[6] * c0) * invDet;
+    r[3].y = ( a[0] * c3 - a[1] * c1 + a[2] * c0) * invDet;
+    r[3].z = (-a[12] * s3 + a[13] * s1 - a[14] * s0) * invDet;
+    r[3].w = ( a[8] * s3 - a[9] * s1 + a[10] * s0) * invDet;
+    return r;
+}
+
+// ---------------------------------------------------------------------------
+// transforms (all angles in radians, right-handed, OpenGL clip space)
+// ---------------------------------------------------------------------------
+
+inline mat4 translate(const mat4& m, const vec3& t) {
+    mat4 r = m;
+    r[3] = m[0] * t.x + m[1] * t.y + m[2] * t.z + m[3];
+    return r;
+}
+
+inline mat4 scale(const mat4& m, const vec3& s) {
+    return mat4(m[0] * s.x, m[1] * s.y, m[2] * s.z, m[3]);
+}
+
+inline mat4 rotate(const mat4& m, float angle, const vec3& axis) {
+    float c = std::cos(angle);
+    float s = std::sin(angle);
+    vec3 n = normalize(axis);
+    vec3 t = n * (1.0f - c);
+
+    mat3 r(vec3(c + t.x * n.x, t.x * n.y + s * n.z, t.x * n.z - s * n.y),
+           vec3(t.y * n.x - s * n.z, c + t.y * n.y, t.y * n.z + s * n.x),
+           vec3(t.z * n.x + s * n.y, t.z * n.y - s * n.x, c + t.z * n.z));
+    return m * mat4(r);
+}
+
+inline mat4 ortho(float left, float right, float bottom, float top, float zNear, float zFar) {
+    mat4 r(1.0f);
+    r[0].x = 2.0f / (right - left);
+    r[1].y = 2.0f / (top - bottom);
+    r[2].z = -2.0f / (zFar - zNear);
+    r[3].x = -(right + left) / (right - left);
+    r[3].y = -(top + bottom) / (top - bottom);
+    r[3].z = -(zFar + zNear) / (zFar - zNear);
+    return r;
+}
+
+inline mat4 perspective(float fovy, float aspect, float zNear, float zFar) {
+    float f = 1.0f / std::tan(fovy / 2.0f);
+    mat4 r(0.0f);
+    r[0].x = f / aspect;
+    r[1].y = f;
+    r[2].z = -(zFar + zNear) / (zFar - zNear);
+    r[2].w = -1.0f;
+    r[3].z = -(2.0f * zFar * zNear) / (zFar - zNear);
+    return r;
+}
+
+inline mat4 lookAt(const vec3& eye, const vec3& center, const vec3& up) {
+    vec3 f = normalize(center - eye);
+    vec3 s = normalize(cross(f, up));
+    vec3 u = cross(s, f);
+
+    mat4 r(1.0f);
+    r[0].x = s.x; r[1].x = s.y; r[2].x = s.z;
+    r[0].y = u.x; r[1].y = u.y; r[2].y = u.z;
+    r[0].z = -f.x; r[1].z = -f.y; r[2].z = -f.z;
+    r[3].x = -dot(s, eye);
+    r[3].y = -dot(u, eye);
+    r[3].z = dot(f, eye);
+    return r;
+}
+
+// The six frustum planes of a view-projection matrix (Gribb and Hartmann):
+// left, right, bottom, top, near, far. Normals point inside and are unit
+// length, so dot(plane.xyz, p) + plane.w is the signed distance of p and a
+// sphere is outside when that is below -radius for any plane.
+inline void frustumPlanes(const mat4& m, vec4 planes[6]) {
+    vec4 r0(m[0].x, m[1].x, m[2].x, m[3].x);
+    vec4 r1(m[0].y, m[1].y, m[2].y, m[3].y);
+    vec4 r2(m[0].z, m[1].z, m[2].z, m[3].z);
+    vec4 r3(m[0].w, m[1].w, m[2].w, m[3].w);
+    planes[0] = r3 + r0;
+    planes[1] = r3 - r0;
+    planes[2] = r3 + r1;
+    planes[3] = r3 - r1;
+    planes[4] = r3 + r2;
+    planes[5] = r3 - r2;
+    for (int i = 0; i < 6; i++) {
+        planes[i] = planes[i] / length(vec3(planes[i].x, planes[i].y, planes[i].z));
+    }
+}
+
+// ---------------------------------------------------------------------------
+// quaternions (x, y, z = vector part, w = scalar part)
+// ---------------------------------------------------------------------------
+
+struct alignas(16) quat {
+    float x, y, z, w;
+
+    // default is the identity rotation
+    quat() : x(0.0f), y(0.0f), z(0.0f), w(1.0f) {}
+    quat(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+};
+
+inline quat angleAxis(float angle, const vec3& axis) {
+    vec3 n = normalize(axis);
+    float s = std::sin(angle * 0.5f);
+    return quat(n.x * s, n.y * s, n.z * s, std::cos(angle * 0.5f));
+}
+
+inline quat operator*(const quat& a, const quat& b) {
+    return quat(a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+                a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+                a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+                a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z);
+}
+
+// rotates v by q (q must be normalized)
+inline vec3 operator*(const quat& q, const vec3& v) {
+    vec3 u(q.x, q.y, q.z);
+    vec3 t = cross(u, v) * 2.0f;
+    return v + t * q.w + cross(u, t);
+}
+
+inline float dot(const quat& a, const quat& b) {
+    return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+}
+
+inline quat normalize(const quat& q) {
+    float inv = 1.0f / std::sqrt(dot(q, q));
+    return quat(q.x * inv, q.y * inv, q.z * inv, q.w * inv);
+}
+
+inline quat conjugate(const quat& q) {
+    return quat(-q.x, -q.y, -q.z, q.w);
+}
+
+inline quat inverse(const quat& q) {
+    float inv = 1.0f / dot(q, q);
+    return quat(-q.x * inv, -q.y * inv, -q.z * inv, q.w * inv);
+}
+
+// spherical interpolation along the shortest arc
+inline quat slerp(const quat& a, const quat& b, float t) {
+    quat c = b;
+    float cosTheta = dot(a, b);
+    if (cosTheta < 0.0f) {
+        c = quat(-b.x, -b.y, -b.z, -b.w);
+        cosTheta = -cosTheta;
+    }
+
+    // fall back to nlerp when the angle is tiny to avoid dividing by ~0
+    if (cosTheta > 0.9995f) {
+        return normalize(quat(a.x + (c.x - a.x) * t, a.y + (c.y - a.y) * t,
+                              a.z + (c.z - a.z) * t, a.w + (c.w - a.w) * t));
+    }
+
+    float theta = std::acos(cosTheta);
+    float sinTheta = std::sin(theta);
+    float wa = std::sin((1.0f - t) * theta) / sinTheta;
+    float wb = std::sin(t * theta) / sinTheta;
+    return quat(a.x * wa + c.x * wb, a.y * wa + c.y * wb, a.z * wa + c.z * wb, a.w * wa + c.w * wb);
+}
+
+inline mat3 toMat3(const quat& q) {
+    float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+    float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+    float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+    return mat3(vec3(1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz), 2.0f * (xz - wy)),
+                vec3(2.0f * (xy - wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx)),
+                vec3(2.0f * (xz + wy), 2.0f * (yz - wx), 1.0f - 2.0f * (xx + yy)));
+}
+
+inline mat4 toMat4(const quat& q) {
+    return mat4(toMat3(q));
+}
+
+// ---------------------------------------------------------------------------
+// batch routines over SoA (structure of arrays) data
+// ---------------------------------------------------------------------------
+
+// Reference version of transformPoints, one point at a time.
+inline void transformPointsScalar(const float* xs, const float* ys, const float* zs, std::size_t n,
+                                  const mat4& m, float* outXs, float* outYs, float* outZs) {
+    for (std::size_t i = 0; i < n; i++) {
+        float x = xs[i], y = ys[i], z = zs[i];
+        outXs[i] = m[0].x * x + m[1].x * y + m[2].x * z + m[3].x;
+        outYs[i] = m[0].y * x + m[1].y * y + m[2].y * z + m[3].y;
+        outZs[i] = m[0].z * x + m[1].z * y + m[2].z * z + m[3].z;
+    }
+}
+
+// Transforms n points (w = 1) by the affine part of m.
+// Inputs and outputs are separate x/y/z arrays; the output arrays may alias the inputs.
+// AVX2 handles 8 points per iteration, SSE 4, the remainder goes through the scalar loop.
+inline void transformPoints(const float* xs, const float* ys, const float* zs, std::size_t n,
+                            const mat4& m, float* outXs, float* outYs, float* outZs) {
+    std::size_t i = 0;
+
+#if defined(MATHS_AVX2)
+    __m256 m00 = _mm256_set1_ps(m[0].x), m01 = _mm256_set1_ps(m[0].y), m02 = _mm256_set1_ps(m[0].z);
+    __m256 m10 = _mm256_set1_ps(m[1].x), m11 = _mm256_set1_ps(m[1].y), m12 = _mm256_set1_ps(m[1].z);
+    __m256 m20 = _mm256_set1_ps(m[2].x), m21 = _mm256_set1_ps(m[2].y), m22 = _mm256_set1_ps(m[2].z);
+    __m256 m30 = _mm256_set1_ps(m[3].x), m31 = _mm256_set1_ps(m[3].y), m32 = _mm256_set1_ps(m[3].z);
+
+    for (; i + 8 <= n; i += 8) {
+        __m256 x = _mm256_loadu_ps(xs + i);
+        __m256 y = _mm256_loadu_ps(ys + i);
+        __m256 z = _mm256_loadu_ps(zs + i);
+#if defined(__FMA__)
+        __m256 rx = _mm256_fmadd_ps(m20, z, _mm256_fmadd_ps(m10, y, _mm256_fmadd_ps(m00, x, m30)));
+        __m256 ry = _mm256_fmadd_ps(m21, z, _mm256_fmadd_ps(m11, y, _mm256_fmadd_ps(m01, x, m31)));
+        __m256 rz = _mm256_fmadd_ps(m22, z, _mm256_fmadd_ps(m12, y, _mm256_fmadd_ps(m02, x, m32)));
+#else
+        __m256 rx = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m00, x), _mm256_mul_ps(m10, y)), _mm256_add_ps(_mm256_mul_ps(m20, z), m30));
+        __m256 ry = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m01, x), _mm256_mul_ps(m11, y)), _mm256_add_ps(_mm256_mul_ps(m21, z), m31));
+        __m256 rz = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m02, x), _mm256_mul_ps(m12, y)), _mm256_add_ps(_mm256_mul_ps(m22, z), m32));
+#endif
+        _mm256_storeu_ps(outXs + i, rx);
+        _mm256_storeu_ps(outYs + i, ry);
+        _mm256_storeu_ps(outZs + i, rz);
+    }
+#elif defined(MATHS_SSE)
+    __m128 m00 = _mm_set1_ps(m[0].x), m01 = _mm_set1_ps(m[0].y), m02 = _mm_set1_ps(m[0].z);
+    __m128 m10 = _mm_set1_ps(m[1].x), m11 = _mm_set1_ps(m[1].y), m12 = _mm_set1_ps(m[1].z);
+    __m128 m20 = _mm_set1_ps(m[2].x), m21 = _mm_set1_ps(m[2].y), m22 = _mm_set1_ps(m[2].z);
+    __m128 m30 = _mm_set1_ps(m[3].x), m31 = _mm_set1_ps(m[3].y), m32 = _mm_set1_ps(m[3].z);
+
+    for (; i + 4 <= n; i += 4) {
+        __m128 x = _mm_loadu_ps(xs + i);
+        __m128 y = _mm_loadu_ps(ys + i);
+        __m128 z = _mm_loadu_ps(zs + i);
+        __m128 rx = madd(m20, z, madd(m10, y, madd(m00, x, m30)));
+        __m128 ry = madd(m21, z, madd(m11, y, madd(m01, x, m31)));
+        __m128 rz = madd(m22, z, madd(m12, y, madd(m02, x, m32)));
+        _mm_storeu_ps(outXs + i, rx);
+        _mm_storeu_ps(outYs + i, ry);
+        _mm_storeu_ps(outZs + i, rz);
+    }
+#endif
+
+    transformPointsScalar(xs + i, ys + i, zs + i, n - i, m, outXs + i, outYs + i, outZs + i);
+}
+
+} // namespace maths
+
+#endif
@@ -0,0 +1,293 @@
+#ifndef OCCLUSION_QUERIES_H
+#define OCCLUSION_QUERIES_H
+
+#include "frame-profiler.h"
+#include "gl-ext.h"
+#include "maths.h"
+#include "shader.h"
+
+#include <string>
+#include <vector>
+
+// Occlusion culling with hardware queries, without ever waiting for one.
+//
+// Every object remembers whether its last query that came back saw any
+// samples. A query is only looked at latency frames after it was issued,
+// and only if its result is available, so reading results never stalls.
+// Each frame:
+//   - objects that were visible are drawn as usual, inside a query, so the
+//     draw itself tells whether they still are
+//   - objects that were occluded get their bounding box queried (no color
+//     or depth writes) and are drawn under glBeginConditionalRender on that
+//     query: the GPU skips them if the box is still hidden and draws them
+//     the same frame when it isn't, the CPU never needs the answer
+//
+//     queries.beginFrame(viewProjection, eye);
+//     for (i : objects) if (queries.predictedVisible(i)) { queries.beginQuery(i); draw(i); queries.endQuery(); }
+//     queries.queryBounds(occluded, count, min, max);
+//     for (i : occluded) { queries.beginConditional(i); draw(i); queries.endConditional(); }
+//     queries.publish(profiler);
+// Drawing the visible objects front to back makes their queries more
+// accurate, an object drawn before the one hiding it is counted visible.
+//
+// GL_ANY_SAMPLES_PASSED_CONSERVATIVE (4.3 or GL_ARB_ES3_compatibility) is
+// used when available, it may answer visible for a hidden object but is
+// cheaper; otherwise GL_ANY_SAMPLES_PASSED.
+class OcclusionQueries {
+public:
+    static const unsigned int MAX_LATENCY = 4;
+
+    struct Stats {
+        unsigned long long queries = 0;       // issued, box and draw queries
+        unsigned long long results = 0;       // read back
+        unsigned long long latencyFrames = 0; // sum over results of frames from issue to read
+        unsigned long long dropped = 0;       // reissued before their result was read
+        unsigned long long drawn = 0;         // drawn because they were visible before
+        unsigned long long drawResults = 0;   // results read of the queries around those draws
+        unsigned long long falseVisible = 0;  // of those, the ones that saw no samples
+        unsigned long long conditional = 0;   // drawn under conditional render
+    };
+
+    GLenum target;
+    unsigned int latency;
+
+    // latency is clamped to [1, MAX_LATENCY], shaderDir holds vertex/ and fragment/
+    OcclusionQueries(unsigned int objectCount, unsigned int latency = 2, const std::string& shaderDir = "../../shaders/")
+        : latency(latency < 1 ? 1 : (latency > MAX_LATENCY ? MAX_LATENCY : latency)),
+          boxShader((shaderDir + "vertex/bounds.vs").c_str(), (shaderDir + "fragment/bounds.fs").c_str()) {
+        bool conservative = hasGLVersion(4, 3) || hasGLExtension("GL_ARB_ES3_compatibility");
+        target = conservative ? GL_ANY_SAMPLES_PASSED_CONSERVATIVE : GL_ANY_SAMPLES_PASSED;
+
+        ring = this->latency + 1;
+        objects.resize(objectCount);
+        queries.resize((std::size_t)objectCount * ring);
+        if (!queries.empty()) {
+            glGenQueries((GLsizei)queries.size(), queries.data());
+        }
+
+        // unit cube, corners at 0 and 1
+        float corners[24];
+        for (int i = 0; i < 8; i++) {
+            corners[i * 3 + 0] = (float)(i & 1);
+            corners[i * 3 + 1] = (float)((i >> 1) & 1);
+            corners[i * 3 + 2] = (float)((i >> 2) & 1);
+        }
+        unsigned int indices[] = {
+            0, 1, 3, 0, 3, 2,  4, 6, 7, 4, 7, 5,  0, 4, 5, 0, 5, 1,
+            2, 3, 7, 2, 7, 6,  0, 2, 6, 0, 6, 4,  1, 5, 7, 1, 7, 3,
+        };
+        glGenVertexArrays(1, &boxVAO);
+        glGenBuffers(1, &boxVBO);
+        glGenBuffers(1, &boxEBO);
+        glBindVertexArray(boxVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, boxVBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, boxEBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        glBindVertexArray(0);
+
+        viewProjectionLocation = glGetUniformLocation(boxShader.ID, "viewProjection");
+        boxMinLocation = glGetUniformLocation(boxShader.ID, "boxMin");
+        boxMaxLocation = glGetUniformLocation(boxShader.ID, "boxMax");
+    }
+
+    OcclusionQueries(const OcclusionQueries&) = delete;
+    OcclusionQueries& operator=(const OcclusionQueries&) = delete;
+
+    // Starts a frame: reads the results that are old enough and ready.
+    // eye is the camera position, a box around it can't be queried.
+    void beginFrame(const maths::mat4& viewProjection, const maths::vec3& eye) {
+        this->viewProjection = viewProjection;
+        this->eye = eye;
+        frame++;
+        for (std::size_t i = 0; i < objects.size(); i++) {
+            Object& object = objects[i];
+            object.current = NO_QUERY;
+            if (object.pending == 0) {
+                continue;
+            }
+            // oldest first, so the newest result wins
+            for (unsigned int k = 0; k < ring; k++) {
+                unsigned int slot = (object.next + k) % ring;
+                if (!(object.pending & (1u << slot)) || frame - object.issued[slot] < latency) {
+                    continue;
+                }
+                GLuint query = queries[i * ring + slot];
+                GLint available = GL_FALSE;
+                glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+                if (!available) {
+                    continue;
+                }
+                GLuint passed = 0;
+                glGetQueryObjectuiv(query, GL_QUERY_RESULT, &passed);
+                object.pending &= ~(1u << slot);
+                object.visible = passed != 0;
+                stats.results++;
+                stats.latencyFrames += frame - object.issued[slot];
+                if (object.drawQueries & (1u << slot)) {
+                    stats.drawResults++;
+                    stats.falseVisible += passed ? 0 : 1;
+                }
+            }
+        }
+    }
+
+    // what the last result of object said, true until there is one
+    bool predictedVisible(unsigned int object) const {
+        return objects[object].visible;
+    }
+
+    // around the draw of an object predictedVisible() said yes to
+    void beginQuery(unsigned int object) {
+        glBeginQuery(target, issue(object, true));
+        stats.drawn++;
+    }
+
+    void endQuery() {
+        glEndQuery(target);
+    }
+
+    // Queries the boxes of the given objects, min and max indexed by object.
+    // Uses its own program and VAO (the caller rebinds its own afterwards),
+    // restores color and depth writes and face culling.
+    void queryBounds(const unsigned int* list, std::size_t count, const maths::vec3* min, const maths::vec3* max) {
+        GLboolean cull = glIsEnabled(GL_CULL_FACE);
+        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        glDepthMask(GL_FALSE);
+        glDisable(GL_CULL_FACE);
+        boxShader.use();
+        glUniformMatrix4fv(viewProjectionLocation, 1, GL_FALSE, viewProjection.ptr());
+        glBindVertexArray(boxVAO);
+
+        for (std::size_t i = 0; i < count; i++) {
+            unsigned int object = list[i];
+            // the near plane would clip away the faces of a box around the
+            // camera, such an object is simply drawn
+            const maths::vec3 &lo = min[object], &hi = max[object];
+            float margin = NEAR_MARGIN;
+            if (eye.x > lo.x - margin && eye.x < hi.x + margin && eye.y > lo.y - margin && eye.y < hi.y + margin &&
+                eye.z > lo.z - margin && eye.z < hi.z + margin) {
+                objects[object].current = NO_QUERY;
+                continue;
+            }
+            glUniform3f(boxMinLocation, lo.x, lo.y, lo.z);
+            glUniform3f(boxMaxLocation, hi.x, hi.y, hi.z);
+            glBeginQuery(target, issue(object, false));
+            glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
+            glEndQuery(target);
+        }
+
+        glBindVertexArray(0);
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+        glDepthMask(GL_TRUE);
+        if (cull) {
+            glEnable(GL_CULL_FACE);
+        }
+    }
+
+    // around the draw of an object whose box was queried this frame
+    void beginConditional(unsigned int object) {
+        conditionalActive = objects[object].current != NO_QUERY;
+        if (conditionalActive) {
+            glBeginConditionalRender(queries[(std::size_t)object * ring + objects[object].current], GL_QUERY_WAIT);
+        }
+        stats.conditional++;
+    }
+
+    void endConditional() {
+        if (conditionalActive) {
+            glEndConditionalRender();
+            conditionalActive = false;
+        }
+    }
+
+    const Stats& getStats() const {
+        return stats;
+    }
+
+    void resetStats() {
+        stats = Stats();
+    }
+
+    // Adds this frame's numbers to profiler:
+    //   occlusion.queries, occlusion.drawn, occlusion.conditional (per frame)
+    //   occlusion.latency frames  average frames from issue to result
+    //   occlusion.false visible % drawn objects that turned out hidden
+    // and resets the stats.
+    void publish(FrameProfiler& profiler) {
+        profiler.value("occlusion.queries", (double)stats.queries);
+        profiler.value("occlusion.drawn", (double)stats.drawn);
+        profiler.value("occlusion.conditional", (double)stats.conditional);
+        if (stats.results > 0) {
+            profiler.value("occlusion.latency frames", (double)stats.latencyFrames / stats.results);
+        }
+        if (stats.drawResults > 0) {
+            profiler.value("occlusion.false visible %", 100.0 * stats.falseVisible / stats.drawResults);
+        }
+        if (stats.dropped > 0) {
+            profiler.value("occlusion.dropped", (double)stats.dropped);
+        }
+        resetStats();
+    }
+
+    // delete all GL objects owned by the queries
+    void del() {
+        if (!queries.empty()) {
+            glDeleteQueries((GLsizei)queries.size(), queries.data());
+            queries.clear();
+        }
+        glDeleteVertexArrays(1, &boxVAO);
+        glDeleteBuffers(1, &boxVBO);
+        glDeleteBuffers(1, &boxEBO);
+        glDeleteProgram(boxShader.ID);
+    }
+
+private:
+    static const unsigned int NO_QUERY = ~0u;
+    // how close the eye may get to a box before it's no longer queried
+    static constexpr float NEAR_MARGIN = 1.0f;
+
+    struct Object {
+        bool visible = true;
+        unsigned int next = 0;           // ring slot of the next query
+        unsigned int current = NO_QUERY; // slot of the box query of this frame
+        unsigned int pending = 0;        // bit per slot with a result not read yet
+        unsigned int drawQueries = 0;    // bit per slot that wraps a real draw
+        unsigned long long issued[MAX_LATENCY + 1] = {};
+    };
+
+    std::vector<Object> objects;
+    std::vector<GLuint> queries;         // ring queries per object
+    unsigned int ring;
+    unsigned long long frame = 0;
+    maths::mat4 viewProjection = maths::mat4(1.0f);
+    maths::vec3 eye;
+    bool conditionalActive = false;
+    Stats stats;
+
+    Shader boxShader;
+    unsigned int boxVAO = 0, boxVBO = 0, boxEBO = 0;
+    GLint viewProjectionLocation = -1;
+    GLint boxMinLocation = -1;
+    GLint boxMaxLocation = -1;
+
+    // the next query of object, its old result is dropped if never read
+    GLuint issue(unsigned int index, bool draw) {
+        Object& object = objects[index];
+        unsigned int slot = object.next;
+        object.next = (slot + 1) % ring;
+        if (object.pending & (1u << slot)) {
+            stats.dropped++;
+        }
+        object.pending |= 1u << slot;
+        object.drawQueries = draw ? object.drawQueries | (1u << slot) : object.drawQueries & ~(1u << slot);
+        object.issued[slot] = frame;
+        object.current = draw ? NO_QUERY : slot;
+        stats.queries++;
+        return queries[(std::size_t)index * ring + slot];
+    }
+};
+
+#endif
@@ -0,0 +1,328 @@
+#ifndef OCCLUSION_H
+#define OCCLUSION_H
+
+#include "maths.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+// Software occlusion culling: a few large occluders are rasterized on the CPU
+// into a small depth buffer, a max-depth pyramid is built on top of it and
+// the bounding box of every other object is tested against the pyramid
+// before it is submitted. Whatever is hidden never costs the GPU a vertex or
+// a fragment.
+//
+//     OcclusionCuller occlusion(256, 128);
+//     occlusion.begin(projection * view);
+//     for (...) occlusion.addBox(min, max);           // or addOccluder(mesh)
+//     occlusion.buildPyramid();
+//     for (...) if (occlusion.isVisible(min, max)) draw(...);
+//
+// The rasterizer evaluates the edge functions and the depth plane of a
+// triangle for 8 (AVX2) or 4 (SSE) pixels at once. Triangles are clipped
+// against the near plane, back faces (clockwise in NDC, the GL default) are
+// skipped, so occluders have to be closed meshes.
+//
+// The answer errs towards visible:
+//   - an occluder pixel stores the farthest depth its triangle reaches
+//     inside the pixel, not the depth at the center
+//   - an object's screen rectangle is grown by one pixel, so an object
+//     peeking past the silhouette of an occluder still finds an empty pixel
+//   - an object that crosses the near plane is always visible
+// Depth is the NDC depth mapped to [0, 1] like the default glDepthRange.
+class OcclusionCuller {
+public:
+    struct Stats {
+        unsigned int occluders = 0;
+        unsigned int occluderTriangles = 0;  // submitted by addOccluder()/addBox()
+        unsigned int rasterizedTriangles = 0; // left after clipping and back-face culling
+        unsigned int tested = 0;
+        unsigned int occluded = 0;
+    };
+
+    // the width is rounded up to a multiple of 8, the SIMD row width
+    OcclusionCuller(int width = 256, int height = 128) : width((width + 7) & ~7), height(height) {
+        int w = this->width, h = height;
+        for (;;) {
+            levels.push_back(Level{ w, h, std::vector<float>((std::size_t)w * h, 1.0f) });
+            if (w == 1 && h == 1) {
+                break;
+            }
+            w = (w + 1) / 2;
+            h = (h + 1) / 2;
+        }
+    }
+
+    OcclusionCuller(const OcclusionCuller&) = delete;
+    OcclusionCuller& operator=(const OcclusionCuller&) = delete;
+
+    int getWidth() const {
+        return width;
+    }
+
+    int getHeight() const {
+        return height;
+    }
+
+    // depth of mip level (0 is the rasterized buffer), rows bottom to top
+    const std::vector<float>& depth(int level = 0) const {
+        return levels[level].depth;
+    }
+
+    int levelCount() const {
+        return (int)levels.size();
+    }
+
+    const Stats& getStats() const {
+        return stats;
+    }
+
+    // starts a frame: clears the depth and the stats
+    void begin(const maths::mat4& viewProjection) {
+        this->viewProjection = viewProjection;
+        std::fill(levels[0].depth.begin(), levels[0].depth.end(), 1.0f);
+        stats = Stats();
+    }
+
+    // Rasterizes an indexed triangle mesh, positions are vec3s stride floats
+    // apart, transformed by model.
+    void addOccluder(const float* positions, std::size_t vertexCount, std::size_t stride,
+                     const unsigned int* indices, std::size_t indexCount, const maths::mat4& model) {
+        maths::mat4 mvp = viewProjection * model;
+        clip.resize(vertexCount);
+        for (std::size_t i = 0; i < vertexCount; i++) {
+            const float* p = positions + i * stride;
+            clip[i] = mvp * maths::vec4(p[0], p[1], p[2], 1.0f);
+        }
+        for (std::size_t i = 0; i + 2 < indexCount; i += 3) {
+            addTriangle(clip[indices[i]], clip[indices[i + 1]], clip[indices[i + 2]]);
+        }
+        stats.occluders++;
+    }
+
+    // an axis-aligned box in world space, 12 triangles
+    void addBox(const maths::vec3& min, const maths::vec3& max) {
+        static const unsigned int indices[] = {
+            0, 2, 1, 0, 3, 2,  4, 5, 6, 4, 6, 7,  0, 1, 5, 0, 5, 4,
+            3, 6, 2, 3, 7, 6,  0, 4, 7, 0, 7, 3,  1, 2, 6, 1, 6, 5,
+        };
+        float corners[24];
+        for (int i = 0; i < 8; i++) {
+            corners[i * 3 + 0] = (i & 1) != ((i >> 1) & 1) ? max.x : min.x;
+            corners[i * 3 + 1] = (i & 2) ? max.y : min.y;
+            corners[i * 3 + 2] = (i & 4) ? max.z : min.z;
+        }
+        addOccluder(corners, 8, 3, indices, 36, maths::mat4(1.0f));
+    }
+
+    // max of every 2x2 block into the next level, call after the last occluder
+    void buildPyramid() {
+        for (std::size_t l = 1; l < levels.size(); l++) {
+            const Level& src = levels[l - 1];
+            Level& dst = levels[l];
+            for (int y = 0; y < dst.height; y++) {
+                int y0 = y * 2, y1 = std::min(y * 2 + 1, src.height - 1);
+                for (int x = 0; x < dst.width; x++) {
+                    int x0 = x * 2, x1 = std::min(x * 2 + 1, src.width - 1);
+                    float a = std::max(src.at(x0, y0), src.at(x1, y0));
+                    float b = std::max(src.at(x0, y1), src.at(x1, y1));
+                    dst.depth[(std::size_t)y * dst.width + x] = std::max(a, b);
+                }
+            }
+        }
+    }
+
+    // false when the world space box is certainly behind the occluders
+    bool isVisible(const maths::vec3& min, const maths::vec3& max) {
+        stats.tested++;
+        float minX = 1e30f, minY = 1e30f, maxX = -1e30f, maxY = -1e30f, nearest = 1e30f;
+        for (int i = 0; i < 8; i++) {
+            maths::vec4 c = viewProjection * maths::vec4((i & 1) ? max.x : min.x, (i & 2) ? max.y : min.y, (i & 4) ? max.z : min.z, 1.0f);
+            if (c.w <= NEAR_W || c.z < -c.w) {
+                return true;
+            }
+            float inv = 1.0f / c.w;
+            minX = std::min(minX, c.x * inv);
+            maxX = std::max(maxX, c.x * inv);
+            minY = std::min(minY, c.y * inv);
+            maxY = std::max(maxY, c.y * inv);
+            nearest = std::min(nearest, c.z * inv);
+        }
+        nearest = nearest * 0.5f + 0.5f;
+
+        // pixels touched by the rectangle, one more on every side
+        int x0 = std::max((int)std::floor((minX * 0.5f + 0.5f) * width) - 1, 0);
+        int x1 = std::min((int)std::floor((maxX * 0.5f + 0.5f) * width) + 1, width - 1);
+        int y0 = std::max((int)std::floor((minY * 0.5f + 0.5f) * height) - 1, 0);
+        int y1 = std::min((int)std::floor((maxY * 0.5f + 0.5f) * height) + 1, height - 1);
+        if (x0 > x1 || y0 > y1) {
+            return true;
+        }
+
+        // the level where the rectangle covers at most 2 x 2 texels
+        int l = 0;
+        while ((x1 >> l) - (x0 >> l) > 1 || (y1 >> l) - (y0 >> l) > 1) {
+            l++;
+        }
+        const Level& level = levels[l];
+        for (int y = y0 >> l; y <= y1 >> l; y++) {
+            for (int x = x0 >> l; x <= x1 >> l; x++) {
+                if (level.at(x, y) >= nearest) {
+                    return true;
+                }
+            }
+        }
+        stats.occluded++;
+        return false;
+    }
+
+private:
+    struct Level {
+        int width;
+        int height;
+        std::vector<float> depth;
+
+        float at(int x, int y) const {
+            return depth[(std::size_t)y * width + x];
+        }
+    };
+
+    // w below this counts as on or behind the eye
+    static constexpr float NEAR_W = 1e-6f;
+
+    int width;
+    int height;
+    maths::mat4 viewProjection = maths::mat4(1.0f);
+    std::vector<Level> levels;
+    std::vector<maths::vec4> clip;
+    Stats stats;
+
+    // clips against the near plane (z >= -w), the result is a fan of up to 4 vertices
+    void addTriangle(const maths::vec4& a, const maths::vec4& b, const maths::vec4& c) {
+        stats.occluderTriangles++;
+        const maths::vec4* in[3] = { &a, &b, &c };
+        maths::vec4 out[4];
+        int count = 0;
+        for (int i = 0; i < 3; i++) {
+            const maths::vec4& p = *in[i];
+            const maths::vec4& q = *in[(i + 1) % 3];
+            float dp = p.z + p.w, dq = q.z + q.w;
+            if (dp >= 0.0f) {
+                out[count++] = p;
+            }
+            if ((dp >= 0.0f) != (dq >= 0.0f)) {
+                out[count++] = p + (q - p) * (dp / (dp - dq));
+            }
+        }
+        for (int i = 2; i < count; i++) {
+            rasterize(out[0], out[i - 1], out[i]);
+        }
+    }
+
+    void rasterize(const maths::vec4& c0, const maths::vec4& c1, const maths::vec4& c2) {
+        // to pixels, y up like the GL window
+        float x[3], y[3], z[3];
+        const maths::vec4* c[3] = { &c0, &c1, &c2 };
+        for (int i = 0; i < 3; i++) {
+            if (c[i]->w <= NEAR_W) {
+                return;
+            }
+            float inv = 1.0f / c[i]->w;
+            x[i] = (c[i]->x * inv * 0.5f + 0.5f) * width;
+            y[i] = (c[i]->y * inv * 0.5f + 0.5f) * height;
+            z[i] = c[i]->z * inv * 0.5f + 0.5f;
+        }
+
+        float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+        if (area <= 0.0f) {
+            return;
+        }
+
+        int minX = std::max((int)std::floor(std::min({ x[0], x[1], x[2] })), 0);
+        int maxX = std::min((int)std::ceil(std::max({ x[0], x[1], x[2] })), width - 1);
+        int minY = std::max((int)std::floor(std::min({ y[0], y[1], y[2] })), 0);
+        int maxY = std::min((int)std::ceil(std::max({ y[0], y[1], y[2] })), height - 1);
+        if (minX > maxX || minY > maxY) {
+            return;
+        }
+        stats.rasterizedTriangles++;
+
+        // edge i runs from vertex i + 1 to i + 2, e = A x + B y + C is >= 0
+        // inside and is the barycentric weight of vertex i times area
+        float A[3], B[3], C[3];
+        for (int i = 0; i < 3; i++) {
+            int j = (i + 1) % 3, k = (i + 2) % 3;
+            A[i] = y[j] - y[k];
+            B[i] = x[k] - x[j];
+            C[i] = x[j] * y[k] - x[k] * y[j];
+        }
+        float invArea = 1.0f / area;
+        float zA = (A[0] * z[0] + A[1] * z[1] + A[2] * z[2]) * invArea;
+        float zB = (B[0] * z[0] + B[1] * z[1] + B[2] * z[2]) * invArea;
+        float zC = (C[0] * z[0] + C[1] * z[1] + C[2] * z[2]) * invArea;
+        // the farthest the plane gets inside a pixel, measured from its center
+        zC += 0.5f * (std::fabs(zA) + std::fabs(zB));
+
+        std::vector<float>& buffer = levels[0].depth;
+        int startX = minX & ~7;
+        for (int py = minY; py <= maxY; py++) {
+            float cy = py + 0.5f;
+            float* row = buffer.data() + (std::size_t)py * width;
+            int px = startX;
+
+#if defined(MATHS_AVX2)
+            __m256 offsets = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+            __m256 e0Step = _mm256_set1_ps(A[0]), e1Step = _mm256_set1_ps(A[1]), e2Step = _mm256_set1_ps(A[2]);
+            __m256 zStep = _mm256_set1_ps(zA);
+            __m256 zero = _mm256_setzero_ps();
+            for (; px <= maxX; px += 8) {
+                __m256 cx = _mm256_add_ps(_mm256_set1_ps((float)px), offsets);
+                __m256 e0 = _mm256_add_ps(_mm256_mul_ps(e0Step, cx), _mm256_set1_ps(B[0] * cy + C[0]));
+                __m256 e1 = _mm256_add_ps(_mm256_mul_ps(e1Step, cx), _mm256_set1_ps(B[1] * cy + C[1]));
+                __m256 e2 = _mm256_add_ps(_mm256_mul_ps(e2Step, cx), _mm256_set1_ps(B[2] * cy + C[2]));
+                __m256 inside = _mm256_and_ps(_mm256_cmp_ps(e0, zero, _CMP_GE_OQ), _mm256_cmp_ps(e1, zero, _CMP_GE_OQ));
+                inside = _mm256_and_ps(inside, _mm256_cmp_ps(e2, zero, _CMP_GE_OQ));
+                if (_mm256_movemask_ps(inside) == 0) {
+                    continue;
+                }
+                __m256 d = _mm256_add_ps(_mm256_mul_ps(zStep, cx), _mm256_set1_ps(zB * cy + zC));
+                __m256 old = _mm256_loadu_ps(row + px);
+                _mm256_storeu_ps(row + px, _mm256_blendv_ps(old, _mm256_min_ps(old, d), inside));
+            }
+#elif defined(MATHS_SSE)
+            __m128 offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+            __m128 e0Step = _mm_set1_ps(A[0]), e1Step = _mm_set1_ps(A[1]), e2Step = _mm_set1_ps(A[2]);
+            __m128 zStep = _mm_set1_ps(zA);
+            __m128 zero = _mm_setzero_ps();
+            for (; px <= maxX; px += 4) {
+                __m128 cx = _mm_add_ps(_mm_set1_ps((float)px), offsets);
+                __m128 e0 = _mm_add_ps(_mm_mul_ps(e0Step, cx), _mm_set1_ps(B[0] * cy + C[0]));
+                __m128 e1 = _mm_add_ps(_mm_mul_ps(e1Step, cx), _mm_set1_ps(B[1] * cy + C[1]));
+                __m128 e2 = _mm_add_ps(_mm_mul_ps(e2Step, cx), _mm_set1_ps(B[2] * cy + C[2]));
+                __m128 inside = _mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(e2, zero));
+                if (_mm_movemask_ps(inside) == 0) {
+                    continue;
+                }
+                __m128 d = _mm_add_ps(_mm_mul_ps(zStep, cx), _mm_set1_ps(zB * cy + zC));
+                __m128 old = _mm_loadu_ps(row + px);
+                // SSE2 has no blend: old where outside, min(old, d) where inside
+                __m128 nearer = _mm_min_ps(old, d);
+                _mm_storeu_ps(row + px, _mm_or_ps(_mm_and_ps(inside, nearer), _mm_andnot_ps(inside, old)));
+            }
+#endif
+
+            for (; px <= maxX; px++) {
+                float cx = px + 0.5f;
+                if (A[0] * cx + (B[0] * cy + C[0]) >= 0.0f && A[1] * cx + (B[1] * cy + C[1]) >= 0.0f &&
+                    A[2] * cx + (B[2] * cy + C[2]) >= 0.0f) {
+                    row[px] = std::min(row[px], zA * cx + (zB * cy + zC));
+                }
+            }
+        }
+    }
+};
+
+#endif
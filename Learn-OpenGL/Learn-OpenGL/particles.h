@@ -0,0 +1,207 @@
+#ifndef PARTICLES_H
+#define PARTICLES_H
+
+#include "shader.h"
+
+#include <string>
+
+// GPU particle system built on GL 4.3 compute shaders.
+//
+// Particle state stays in shader storage buffers, one buffer per field (SoA)
+// and two sets of them that ping-pong. Every frame runs three passes:
+//   1. update:  integrate the alive particles of the source set and append
+//               the survivors to the destination set with an atomic counter,
+//               which compacts them. Launched with glDispatchComputeIndirect.
+//   2. emit:    append new particles to the destination set.
+//   3. finish:  one thread clamps the count and writes the indirect dispatch
+//               args for the next update and the indirect draw args.
+// draw() renders an instanced quad per particle with glDrawArraysIndirect,
+// so the alive count never has to come back to the CPU.
+//
+// Needs a 4.3 context and loadGLExtensions (gl-ext.h). Mesa llvmpipe works.
+class ParticleSystem {
+public:
+    unsigned int capacity;
+
+    // emitter and simulation settings, can be changed between frames
+    float emitterX = 0.0f;
+    float emitterY = -0.9f;
+    float lifetime = 2.0f;
+    float gravityY = -0.9f;
+    float particleSize = 0.003f;
+
+    // shaderDir is the folder holding compute/, vertex/ and fragment/
+    ParticleSystem(unsigned int capacity, const std::string& shaderDir = "../../shaders/")
+        : capacity(capacity),
+          updateShader((shaderDir + "compute/particles-update.cs").c_str()),
+          emitShader((shaderDir + "compute/particles-emit.cs").c_str()),
+          finishShader((shaderDir + "compute/particles-finish.cs").c_str()),
+          renderShader((shaderDir + "vertex/particles.vs").c_str(), (shaderDir + "fragment/particles.fs").c_str()) {
+        glGenBuffers(2, posBuffer);
+        glGenBuffers(2, velBuffer);
+        glGenBuffers(2, lifeBuffer);
+        glGenBuffers(1, &counterBuffer);
+        glGenBuffers(1, &indirectBuffer);
+        glGenVertexArrays(2, VAO);
+
+        for (int set = 0; set < 2; set++) {
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, posBuffer[set]);
+            glBufferData(GL_SHADER_STORAGE_BUFFER, (GLsizeiptr)capacity * 2 * sizeof(float), NULL, GL_DYNAMIC_COPY);
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, velBuffer[set]);
+            glBufferData(GL_SHADER_STORAGE_BUFFER, (GLsizeiptr)capacity * 2 * sizeof(float), NULL, GL_DYNAMIC_COPY);
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, lifeBuffer[set]);
+            glBufferData(GL_SHADER_STORAGE_BUFFER, (GLsizeiptr)capacity * sizeof(float), NULL, GL_DYNAMIC_COPY);
+
+            // the position and life buffers double as per-instance vertex attributes
+            glBindVertexArray(VAO[set]);
+            glBindBuffer(GL_ARRAY_BUFFER, posBuffer[set]);
+            glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+            glEnableVertexAttribArray(0);
+            glVertexAttribDivisor(0, 1);
+            glBindBuffer(GL_ARRAY_BUFFER, lifeBuffer[set]);
+            glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, sizeof(float), (void*)0);
+            glEnableVertexAttribArray(1);
+            glVertexAttribDivisor(1, 1);
+        }
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        // alive count of each set
+        unsigned int counts[2] = { 0, 0 };
+        glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, counterBuffer);
+        glBufferData(GL_ATOMIC_COUNTER_BUFFER, sizeof(counts), counts, GL_DYNAMIC_COPY);
+        glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, 0);
+
+        // dispatch args (x, y, z) then draw args (count, instanceCount, first, baseInstance)
+        unsigned int indirect[7] = { 0, 1, 1, 4, 0, 0, 0 };
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(indirect), indirect, GL_DYNAMIC_COPY);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+        updateSrcSet = glGetUniformLocation(updateShader.ID, "srcSet");
+        updateDt = glGetUniformLocation(updateShader.ID, "dt");
+        updateGravity = glGetUniformLocation(updateShader.ID, "gravity");
+        emitCountLocation = glGetUniformLocation(emitShader.ID, "emitCount");
+        emitCapacity = glGetUniformLocation(emitShader.ID, "capacity");
+        emitSeed = glGetUniformLocation(emitShader.ID, "seed");
+        emitPos = glGetUniformLocation(emitShader.ID, "emitterPos");
+        emitLifetime = glGetUniformLocation(emitShader.ID, "lifetime");
+        finishDstSet = glGetUniformLocation(finishShader.ID, "dstSet");
+        finishCapacity = glGetUniformLocation(finishShader.ID, "capacity");
+        renderSize = glGetUniformLocation(renderShader.ID, "size");
+        renderLifetime = glGetUniformLocation(renderShader.ID, "lifetime");
+    }
+
+    ParticleSystem(const ParticleSystem&) = delete;
+    ParticleSystem& operator=(const ParticleSystem&) = delete;
+
+    // advance the simulation by dt and spawn emitCount new particles
+    void update(float dt, unsigned int emitCount) {
+        unsigned int src = current;
+        unsigned int dst = 1 - current;
+
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, posBuffer[src]);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, velBuffer[src]);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, lifeBuffer[src]);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, posBuffer[dst]);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, velBuffer[dst]);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, lifeBuffer[dst]);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, counterBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 7, indirectBuffer);
+        glBindBufferRange(GL_ATOMIC_COUNTER_BUFFER, 0, counterBuffer, dst * sizeof(unsigned int), sizeof(unsigned int));
+
+        // 1. update + compact, sized by the previous finish pass
+        updateShader.use();
+        glUniform1ui(updateSrcSet, src);
+        glUniform1f(updateDt, dt);
+        glUniform2f(updateGravity, 0.0f, gravityY);
+        glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, indirectBuffer);
+        glDispatchComputeIndirect(0);
+        glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, 0);
+        glMemoryBarrier(GL_ATOMIC_COUNTER_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+
+        // 2. emit
+        if (emitCount > 0) {
+            emitShader.use();
+            glUniform1ui(emitCountLocation, emitCount);
+            glUniform1ui(emitCapacity, capacity);
+            glUniform1ui(emitSeed, ++frame);
+            glUniform2f(emitPos, emitterX, emitterY);
+            glUniform1f(emitLifetime, lifetime);
+            glDispatchCompute((emitCount + 255) / 256, 1, 1);
+            glMemoryBarrier(GL_ATOMIC_COUNTER_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+        }
+
+        // 3. finish: write the indirect args from the new count
+        finishShader.use();
+        glUniform1ui(finishDstSet, dst);
+        glUniform1ui(finishCapacity, capacity);
+        glDispatchCompute(1, 1, 1);
+        // finish resets the count with a storage write, and the next update
+        // counts up from it as an atomic counter
+        glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT |
+                        GL_ATOMIC_COUNTER_BARRIER_BIT);
+
+        current = dst;
+    }
+
+    void draw() {
+        renderShader.use();
+        glUniform1f(renderSize, particleSize);
+        glUniform1f(renderLifetime, lifetime);
+
+        glBindVertexArray(VAO[current]);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+        // draw args start after the 3 dispatch uints
+        glDrawArraysIndirect(GL_TRIANGLE_STRIP, (void*)(3 * sizeof(unsigned int)));
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        glBindVertexArray(0);
+    }
+
+    // reads the alive count back to the CPU. This stalls, use it for stats only.
+    unsigned int aliveCount() const {
+        unsigned int counts[2];
+        glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, counterBuffer);
+        glGetBufferSubData(GL_ATOMIC_COUNTER_BUFFER, 0, sizeof(counts), counts);
+        glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, 0);
+        return counts[current];
+    }
+
+    // delete all GL objects owned by the particle system
+    void del() {
+        glDeleteBuffers(2, posBuffer);
+        glDeleteBuffers(2, velBuffer);
+        glDeleteBuffers(2, lifeBuffer);
+        glDeleteBuffers(1, &counterBuffer);
+        glDeleteBuffers(1, &indirectBuffer);
+        glDeleteVertexArrays(2, VAO);
+        glDeleteProgram(updateShader.ID);
+        glDeleteProgram(emitShader.ID);
+        glDeleteProgram(finishShader.ID);
+        glDeleteProgram(renderShader.ID);
+    }
+
+private:
+    Shader updateShader;
+    Shader emitShader;
+    Shader finishShader;
+    Shader renderShader;
+
+    unsigned int posBuffer[2];
+    unsigned int velBuffer[2];
+    unsigned int lifeBuffer[2];
+    unsigned int counterBuffer;
+    unsigned int indirectBuffer;
+    unsigned int VAO[2];
+
+    unsigned int current = 0;
+    unsigned int frame = 0;
+
+    int updateSrcSet, updateDt, updateGravity;
+    int emitCountLocation, emitCapacity, emitSeed, emitPos, emitLifetime;
+    int finishDstSet, finishCapacity;
+    int renderSize, renderLifetime;
+};
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef PER_DRAW_BUFFER_H
+#define PER_DRAW_BUFFER_H
+
+#include "frames-in-flight.h"
+#include "gl-ext.h"
+
+#include <cstdio>
+
+// Per-object shader parameters as one array of T per frame, instead of a
+// glUniform call per object per draw.
+//
+// With a 4.3 context the array is a std430 shader storage buffer that the
+// shader indexes with gl_DrawIDARB (multi-draw) or gl_InstanceID (instancing):
+//     struct DrawData { vec4 offset; vec4 color; };
+//     layout (std430, binding = 0) readonly buffer PerDraw { DrawData draws[]; };
+//     ... draws[gl_InstanceID + gl_DrawIDARB] ...
+// On 3.3 it falls back to a std140 uniform block holding a fixed-size array
+// of batch entries, drawn with instancing one batch at a time:
+//     layout (std140) uniform PerDraw { DrawData draws[256]; };
+//     ... draws[gl_InstanceID] ...
+// A T made only of vec4-sized members (16 bytes each) has the same layout in
+// std140 and std430, so one C++ struct serves both.
+//
+// The array is written once per frame through map(), into the region of the
+// FramesInFlight slot, unsynchronized (see FrameRingBuffer):
+//     PerDrawBuffer<DrawData> perDraw(objectCount, frames.count());
+//     ...
+//     unsigned int slot = frames.begin();
+//     DrawData* draws = perDraw.map(slot); ... perDraw.unmap();
+//     perDraw.bind(slot, 0);
+template <typename T>
+class PerDrawBuffer {
+public:
+    bool storage;             // std430 storage buffer, otherwise a std140 uniform block
+    unsigned int capacity;    // entries per frame
+    unsigned int batch;       // entries the shader sees per bind()
+
+    // uniformBatch is the array size the 3.3 shader declares, it has to fit
+    // GL_MAX_UNIFORM_BLOCK_SIZE (at least 16 KB); preferStorage = false takes
+    // the uniform block path on 4.3 too
+    PerDrawBuffer(unsigned int capacity, unsigned int frameCount, unsigned int uniformBatch = 256, bool preferStorage = true)
+        : storage(preferStorage && hasGLVersion(4, 3)), capacity(capacity), batch(storage ? capacity : uniformBatch),
+          ring(storage ? GL_SHADER_STORAGE_BUFFER : GL_UNIFORM_BUFFER, roundUp(capacity, batch) * sizeof(T), frameCount) {
+        if (!storage) {
+            GLint maxBlockSize = 0;
+            glGetIntegerv(GL_MAX_UNIFORM_BLOCK_SIZE, &maxBlockSize);
+            GLint offsetAlignment = 256;
+            glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &offsetAlignment);
+            if ((GLint)(batch * sizeof(T)) > maxBlockSize || (batch * sizeof(T)) % offsetAlignment != 0) {
+                printf("ERROR::PER_DRAW_BUFFER::BAD_UNIFORM_BATCH %u entries of %zu bytes\n", batch, sizeof(T));
+            }
+        }
+    }
+
+    PerDrawBuffer(const PerDrawBuffer&) = delete;
+    PerDrawBuffer& operator=(const PerDrawBuffer&) = delete;
+
+    // number of bind()/draw rounds for count entries
+    unsigned int batches(unsigned int count) const {
+        return (count + batch - 1) / batch;
+    }
+
+    // the capacity entries of slot, write them and unmap
+    T* map(unsigned int slot) {
+        return (T*)ring.map(slot);
+    }
+
+    void unmap() {
+        ring.unmap();
+    }
+
+    // Binds entries from first (a multiple of batch) to the block binding.
+    // A storage buffer sees everything from first on, a uniform block the
+    // next batch entries.
+    void bind(unsigned int slot, unsigned int binding, unsigned int first = 0) const {
+        std::size_t entries = storage ? ring.bytesPerFrame() / sizeof(T) - first : batch;
+        glBindBufferRange(storage ? GL_SHADER_STORAGE_BUFFER : GL_UNIFORM_BUFFER, binding, ring.buffer,
+            (GLintptr)(ring.offset(slot) + first * sizeof(T)), (GLsizeiptr)(entries * sizeof(T)));
+    }
+
+    void del() {
+        ring.del();
+    }
+
+private:
+    FrameRingBuffer ring;
+
+    static std::size_t roundUp(unsigned int count, unsigned int multiple) {
+        return ((std::size_t)count + multiple - 1) / multiple * multiple;
+    }
+};
+
+#endif
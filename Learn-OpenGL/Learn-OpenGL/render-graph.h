@@ -0,0 +1,470 @@
+#ifndef RENDER_GRAPH_H
+#define RENDER_GRAPH_H
+
+#include <glad/glad.h>
+#include "frame-profiler.h"
+#include "render-target-pool.h"
+
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// A frame described as passes that read and write textures, instead of
+// draw code that binds framebuffers by hand. Passes are added in the order
+// they run, and say what they read (sample) and write (render to):
+//     RenderGraph graph;
+//     graph.setBackbufferSize(width, height);
+//     Resource shadow = graph.createTexture("shadow map", RenderTargetDesc(1024, 1024, GL_DEPTH_COMPONENT24));
+//     unsigned int pass = graph.addPass("shadows", [&] { draw casters });
+//     graph.write(pass, shadow);
+//     pass = graph.addPass("scene", [&] { glBindTexture(GL_TEXTURE_2D, graph.texture(shadow)); draw });
+//     graph.read(pass, shadow);
+//     graph.write(pass, RenderGraph::BACKBUFFER);
+//     graph.compile();
+//     every frame: graph.execute(&profiler);
+// compile() then
+//   - culls every pass whose writes nobody needs. A pass is needed when it
+//     writes the backbuffer, an imported texture, or something a needed
+//     pass reads later, or when it is marked with sideEffect()
+//   - gives each created (transient) texture the lifetime from the first to
+//     the last kept pass using it, and puts textures of the same size and
+//     format whose lifetimes don't overlap on the same GL texture. The
+//     contents of a transient texture are undefined before its first write,
+//     so a write clears unless it says it keeps what's there
+//   - builds one framebuffer per kept pass from its writes, in the order
+//     they were declared (color attachments 0, 1, ..., depth)
+// and execute() runs the kept passes with their framebuffer bound and the
+// viewport set, each inside a GPU scope of the profiler named after it.
+//
+// compile() is for when the graph changes (a resize, a pass turned on), not
+// every frame: it makes framebuffers. The textures come from a
+// RenderTargetPool, the caller's or the graph's own; compile() and clear()
+// hand the previous ones back first, so a recompile at the same sizes gets
+// the same textures and one at new sizes leaves the old ones to the pool.
+class RenderGraph {
+public:
+    typedef unsigned int Resource;
+    typedef std::function<void()> PassFunction;
+
+    // the default framebuffer, a pass writing it can't write anything else
+    static const Resource BACKBUFFER = 0;
+
+    struct Stats {
+        unsigned int passes = 0;
+        unsigned int culledPasses = 0;
+        unsigned int transientTextures = 0;    // created by the graph and used by a kept pass
+        unsigned int physicalTextures = 0;     // GL textures they ended up on
+        std::size_t transientBytes = 0;        // what they would take without aliasing
+        std::size_t physicalBytes = 0;         // what they take
+
+        std::size_t savedBytes() const {
+            return transientBytes - physicalBytes;
+        }
+    };
+
+    // false gives every transient texture its own GL texture, to compare against
+    bool aliasing = true;
+
+    // a graph without a pool has its own, aged once per execute()
+    explicit RenderGraph(RenderTargetPool* pool = NULL) : pool(pool) {
+        if (pool == NULL) {
+            ownPool.reset(new RenderTargetPool());
+            this->pool = ownPool.get();
+        }
+        Node backbuffer;
+        backbuffer.name = "backbuffer";
+        backbuffer.imported = true;
+        resources.push_back(backbuffer);
+    }
+
+    RenderGraph(const RenderGraph&) = delete;
+    RenderGraph& operator=(const RenderGraph&) = delete;
+
+    void setBackbufferSize(int width, int height) {
+        resources[BACKBUFFER].desc.width = width;
+        resources[BACKBUFFER].desc.height = height;
+    }
+
+    // a texture the graph allocates, and may share with others
+    Resource createTexture(const char* name, const RenderTargetDesc& desc) {
+        Node node;
+        node.name = name;
+        node.desc = desc;
+        resources.push_back(node);
+        return (Resource)(resources.size() - 1);
+    }
+
+    // a texture owned by the caller: never shared, and a pass writing it is never culled
+    Resource importTexture(const char* name, GLuint texture, const RenderTargetDesc& desc) {
+        Resource resource = createTexture(name, desc);
+        resources[resource].imported = true;
+        resources[resource].texture = texture;
+        return resource;
+    }
+
+    unsigned int addPass(const char* name, PassFunction execute) {
+        Pass pass;
+        pass.name = name;
+        pass.execute = execute;
+        passes.push_back(pass);
+        return (unsigned int)(passes.size() - 1);
+    }
+
+    // pass samples resource
+    void read(unsigned int pass, Resource resource) {
+        passes[pass].reads.push_back(resource);
+    }
+
+    // pass renders to resource, clearing it first (to 0, depth to 1) unless keep
+    void write(unsigned int pass, Resource resource, bool keep = false) {
+        passes[pass].writes.push_back(Write{ resource, keep });
+        if (keep) {
+            passes[pass].reads.push_back(resource);
+        }
+    }
+
+    // pass runs even if nothing reads what it writes
+    void sideEffect(unsigned int pass) {
+        passes[pass].sideEffect = true;
+    }
+
+    // Culls, aliases, and makes the textures and framebuffers. Prints what is
+    // wrong and returns false for a graph that can't run: a transient read
+    // before anything wrote it, the backbuffer written along with textures,
+    // attachments of different sizes, an incomplete framebuffer.
+    bool compile() {
+        releaseFramebuffers();
+        compiled = false;
+        stats = Stats();
+        stats.passes = (unsigned int)passes.size();
+
+        // a read needs an earlier write
+        std::vector<bool> written(resources.size(), false);
+        for (const Pass& pass : passes) {
+            for (Resource resource : pass.reads) {
+                if (!resources[resource].imported && !written[resource]) {
+                    printf("ERROR::RENDER_GRAPH::READ_BEFORE_WRITE %s reads %s\n", pass.name.c_str(), resources[resource].name.c_str());
+                    return false;
+                }
+            }
+            for (const Write& write : pass.writes) {
+                written[write.resource] = true;
+            }
+        }
+
+        // backwards: a pass is kept if what it writes is needed, and then
+        // what it reads is; a clearing write ends the need for older contents
+        std::vector<bool> needed(resources.size(), false);
+        for (std::size_t p = passes.size(); p-- > 0;) {
+            Pass& pass = passes[p];
+            bool keep = pass.sideEffect;
+            for (const Write& write : pass.writes) {
+                keep = keep || resources[write.resource].imported || needed[write.resource];
+            }
+            pass.culled = !keep;
+            if (!keep) {
+                stats.culledPasses++;
+                continue;
+            }
+            for (const Write& write : pass.writes) {
+                needed[write.resource] = false;
+            }
+            for (Resource resource : pass.reads) {
+                needed[resource] = true;
+            }
+        }
+
+        // lifetimes, in pass indices, of the transient textures kept passes use;
+        // a resource culled this time keeps no texture from the last compile
+        for (Node& node : resources) {
+            node.first = node.last = -1;
+            node.physical = -1;
+            node.texture = node.imported ? node.texture : 0;
+        }
+        for (int p = 0; p < (int)passes.size(); p++) {
+            if (passes[p].culled) {
+                continue;
+            }
+            auto use = [&](Resource resource) {
+                Node& node = resources[resource];
+                node.first = node.first < 0 ? p : node.first;
+                node.last = p;
+            };
+            for (Resource resource : passes[p].reads) {
+                use(resource);
+            }
+            for (const Write& write : passes[p].writes) {
+                use(write.resource);
+            }
+        }
+
+        // by first use, each onto the first texture of its kind that is free
+        // by then, or a new one from the pool
+        releaseTextures();
+        for (int p = 0; p < (int)passes.size(); p++) {
+            for (Resource r = 0; r < resources.size(); r++) {
+                Node& node = resources[r];
+                if (node.imported || node.first != p) {
+                    continue;
+                }
+                int found = -1;
+                for (int i = 0; i < (int)physicals.size() && found < 0; i++) {
+                    const Physical& physical = physicals[i];
+                    found = aliasing && physical.desc == node.desc && physical.last < node.first ? i : -1;
+                }
+                if (found < 0) {
+                    Physical physical;
+                    physical.desc = node.desc;
+                    physical.texture = pool->acquire(node.desc);
+                    physicals.push_back(physical);
+                    found = (int)physicals.size() - 1;
+                    stats.physicalTextures++;
+                    stats.physicalBytes += node.desc.bytes();
+                }
+                physicals[found].last = node.last;
+                node.physical = found;
+                node.texture = physicals[found].texture;
+                stats.transientTextures++;
+                stats.transientBytes += node.desc.bytes();
+            }
+        }
+
+        bool complete = true;
+        for (Pass& pass : passes) {
+            if (!pass.culled) {
+                complete = buildFramebuffer(pass) && complete;
+            }
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        compiled = complete;
+        return complete;
+    }
+
+    // runs the kept passes, timing each one on profiler if given
+    void execute(FrameProfiler* profiler = NULL) {
+        if (!compiled) {
+            return;
+        }
+        if (ownPool) {
+            ownPool->beginFrame();
+        }
+        const float zero[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        const float one = 1.0f;
+        for (Pass& pass : passes) {
+            if (pass.culled) {
+                continue;
+            }
+            if (profiler) {
+                profiler->beginGpu(pass.name.c_str());
+            }
+            glBindFramebuffer(GL_FRAMEBUFFER, pass.framebuffer);
+            if (pass.width > 0) {
+                glViewport(0, 0, pass.width, pass.height);
+            }
+
+            int color = 0;
+            for (const Write& write : pass.writes) {
+                const RenderTargetDesc& desc = resources[write.resource].desc;
+                bool depth = write.resource != BACKBUFFER && desc.isDepth();
+                if (!write.keep && depth) {
+                    glDepthMask(GL_TRUE);
+                    if (desc.hasStencil()) {
+                        glClearBufferfi(GL_DEPTH_STENCIL, 0, 1.0f, 0);
+                    }
+                    else {
+                        glClearBufferfv(GL_DEPTH, 0, &one);
+                    }
+                }
+                else if (!write.keep && write.resource == BACKBUFFER) {
+                    glDepthMask(GL_TRUE);
+                    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+                    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+                }
+                else if (!write.keep) {
+                    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+                    glClearBufferfv(GL_COLOR, color, zero);
+                }
+                color += depth ? 0 : 1;
+            }
+
+            pass.execute();
+            if (profiler) {
+                profiler->endGpu();
+            }
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    // the GL texture behind resource after compile(), 0 if it was culled
+    GLuint texture(Resource resource) const {
+        return resources[resource].texture;
+    }
+
+    bool isCulled(unsigned int pass) const {
+        return passes[pass].culled;
+    }
+
+    const Stats& getStats() const {
+        return stats;
+    }
+
+    // Adds the memory numbers of the last compile() to profiler:
+    //   graph.transient MB  transient textures without aliasing
+    //   graph.allocated MB  what they take
+    //   graph.culled passes
+    void publish(FrameProfiler& profiler) const {
+        profiler.value("graph.transient MB", stats.transientBytes / (1024.0 * 1024.0));
+        profiler.value("graph.allocated MB", stats.physicalBytes / (1024.0 * 1024.0));
+        profiler.value("graph.culled passes", (double)stats.culledPasses);
+    }
+
+    // the passes in order, culled or not, and the texture each resource got
+    void print(FILE* out = stdout) const {
+        for (const Pass& pass : passes) {
+            fprintf(out, "  %-16s %s", pass.name.c_str(), pass.culled ? "culled" : "      ");
+            for (const Write& write : pass.writes) {
+                const Node& node = resources[write.resource];
+                if (node.physical >= 0) {
+                    fprintf(out, "  %s -> texture %d", node.name.c_str(), node.physical);
+                }
+                else if (!pass.culled) {
+                    fprintf(out, "  %s", node.name.c_str());
+                }
+            }
+            fprintf(out, "\n");
+        }
+    }
+
+    // forgets passes and resources, their textures go back to the pool
+    void clear() {
+        releaseFramebuffers();
+        releaseTextures();
+        passes.clear();
+        resources.resize(1);
+        compiled = false;
+    }
+
+    // delete all GL objects owned by the graph
+    void del() {
+        clear();
+        if (ownPool) {
+            ownPool->del();
+        }
+    }
+
+private:
+    struct Node {
+        std::string name;
+        RenderTargetDesc desc;
+        bool imported = false;
+        GLuint texture = 0;
+        int physical = -1;      // index into physicals
+        int first = -1, last = -1;
+    };
+
+    struct Write {
+        Resource resource;
+        bool keep;
+    };
+
+    struct Pass {
+        std::string name;
+        PassFunction execute;
+        std::vector<Resource> reads;
+        std::vector<Write> writes;
+        bool sideEffect = false;
+        bool culled = false;
+        GLuint framebuffer = 0;
+        int width = 0, height = 0;
+    };
+
+    struct Physical {
+        RenderTargetDesc desc;
+        GLuint texture = 0;
+        int last = -1;          // last pass of the resources on it
+    };
+
+    std::vector<Node> resources;
+    std::vector<Pass> passes;
+    std::vector<Physical> physicals;   // acquired from the pool by the last compile()
+    RenderTargetPool* pool;
+    std::unique_ptr<RenderTargetPool> ownPool;
+    Stats stats;
+    bool compiled = false;
+
+    bool buildFramebuffer(Pass& pass) {
+        pass.framebuffer = 0;
+        pass.width = pass.height = 0;
+        if (pass.writes.empty()) {
+            return true;
+        }
+        for (const Write& write : pass.writes) {
+            const RenderTargetDesc& desc = resources[write.resource].desc;
+            if (pass.width == 0) {
+                pass.width = desc.width;
+                pass.height = desc.height;
+            }
+            if (write.resource == BACKBUFFER && pass.writes.size() > 1) {
+                printf("ERROR::RENDER_GRAPH::BACKBUFFER_WITH_TEXTURES %s\n", pass.name.c_str());
+                return false;
+            }
+            if (desc.width != pass.width || desc.height != pass.height) {
+                printf("ERROR::RENDER_GRAPH::ATTACHMENT_SIZE_MISMATCH %s\n", pass.name.c_str());
+                return false;
+            }
+        }
+        if (pass.writes[0].resource == BACKBUFFER) {
+            return true;
+        }
+
+        glGenFramebuffers(1, &pass.framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, pass.framebuffer);
+        std::vector<GLenum> drawBuffers;
+        for (const Write& write : pass.writes) {
+            const Node& node = resources[write.resource];
+            GLenum target = node.desc.samples > 1 ? GL_TEXTURE_2D_MULTISAMPLE : GL_TEXTURE_2D;
+            GLenum attachment = node.desc.hasStencil() ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+            if (!node.desc.isDepth()) {
+                attachment = GL_COLOR_ATTACHMENT0 + (GLenum)drawBuffers.size();
+                drawBuffers.push_back(attachment);
+            }
+            glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, target, node.texture, 0);
+        }
+        if (drawBuffers.empty()) {
+            glDrawBuffer(GL_NONE);
+            glReadBuffer(GL_NONE);
+        }
+        else {
+            glDrawBuffers((GLsizei)drawBuffers.size(), drawBuffers.data());
+        }
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            printf("ERROR::RENDER_GRAPH::FRAMEBUFFER_INCOMPLETE %s\n", pass.name.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    void releaseTextures() {
+        for (Physical& physical : physicals) {
+            pool->release(physical.texture);
+        }
+        physicals.clear();
+        for (Node& node : resources) {
+            node.texture = node.imported ? node.texture : 0;
+            node.physical = -1;
+        }
+    }
+
+    void releaseFramebuffers() {
+        for (Pass& pass : passes) {
+            if (pass.framebuffer != 0) {
+                glDeleteFramebuffers(1, &pass.framebuffer);
+                pass.framebuffer = 0;
+            }
+        }
+    }
+};
+
+#endif
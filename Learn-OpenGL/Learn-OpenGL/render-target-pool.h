@@ -0,0 +1,297 @@
+#ifndef RENDER_TARGET_POOL_H
+#define RENDER_TARGET_POOL_H
+
+#include <glad/glad.h>
+#include "frame-profiler.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+
+// Textures to render to, kept around and handed out again instead of being
+// made and deleted whenever a pass or a size changes.
+//
+// A target is identified by its RenderTargetDesc (size, format, samples).
+// acquire() returns a released texture with the same desc if there is one
+// (the most recently released, it's the likeliest to still be resident),
+// and only makes a new one otherwise. Released textures are kept until
+//   - they have sat unused for maxIdleFrames calls of beginFrame(), or
+//   - the released ones take more than budget bytes, least recently used
+//     first
+// so dragging a window through fifty sizes doesn't leave fifty sets of
+// targets behind, and going back to the size of a moment ago is free.
+//     RenderTargetPool pool;
+//     GLuint hdr = pool.acquire(RenderTargetDesc(width, height, GL_RGBA16F));
+//     ...
+//     pool.release(hdr);
+//     every frame: pool.beginFrame();
+//
+// ResizeDebouncer is the other half of handling a resize: it holds the
+// window size from framebuffer_size_callback apart from the size targets
+// are allocated at, and only moves the latter once the window has stopped
+// changing for settleTime seconds. Until then frames render at the old size
+// and present() scales them to the window with a linear blit.
+struct RenderTargetDesc {
+    int width = 0;
+    int height = 0;
+    GLenum format = GL_RGBA8;   // sized internal format
+    int samples = 0;            // more than 1 makes a multisample texture
+
+    RenderTargetDesc() = default;
+    RenderTargetDesc(int width, int height, GLenum format, int samples = 0)
+        : width(width), height(height), format(format), samples(samples) {}
+
+    bool operator==(const RenderTargetDesc& other) const {
+        return width == other.width && height == other.height && format == other.format &&
+               (samples > 1 ? samples : 1) == (other.samples > 1 ? other.samples : 1);
+    }
+
+    bool isDepth() const {
+        return format == GL_DEPTH_COMPONENT16 || format == GL_DEPTH_COMPONENT24 || format == GL_DEPTH_COMPONENT32F ||
+               hasStencil();
+    }
+
+    bool hasStencil() const {
+        return format == GL_DEPTH24_STENCIL8 || format == GL_DEPTH32F_STENCIL8;
+    }
+
+    // what the texture takes in video memory, as far as the format tells
+    std::size_t bytes() const {
+        std::size_t texel = 4;
+        switch (format) {
+        case GL_R8: texel = 1; break;
+        case GL_RG8: case GL_R16F: case GL_DEPTH_COMPONENT16: texel = 2; break;
+        case GL_RGBA16F: case GL_RG32F: case GL_DEPTH32F_STENCIL8: texel = 8; break;
+        case GL_RGBA32F: texel = 16; break;
+        default: texel = 4; break;   // RGBA8, RG16F, R32F, R11F_G11F_B10F, RGB10_A2, 24 and 32 bit depth
+        }
+        return texel * width * height * (samples > 1 ? samples : 1);
+    }
+};
+
+class RenderTargetPool {
+public:
+    struct Stats {
+        unsigned long long allocations = 0;   // textures made
+        unsigned long long evictions = 0;     // released textures deleted
+        unsigned long long hits = 0;          // acquires served by a released texture
+        std::size_t liveTextures = 0;         // made and not deleted, in use or not
+        std::size_t liveBytes = 0;
+        std::size_t freeBytes = 0;            // of those, released
+        std::size_t peakBytes = 0;            // most liveBytes since resetStats()
+        unsigned long long allocatedBytes = 0;  // sum over all allocations
+    };
+
+    std::size_t budget;           // bytes of released textures kept
+    unsigned int maxIdleFrames;   // frames a released texture is kept unused
+
+    explicit RenderTargetPool(std::size_t budget = 64 * 1024 * 1024, unsigned int maxIdleFrames = 120)
+        : budget(budget), maxIdleFrames(maxIdleFrames) {}
+
+    RenderTargetPool(const RenderTargetPool&) = delete;
+    RenderTargetPool& operator=(const RenderTargetPool&) = delete;
+
+    GLuint acquire(const RenderTargetDesc& desc) {
+        int best = -1;
+        for (int i = 0; i < (int)targets.size(); i++) {
+            const Target& target = targets[i];
+            if (target.free && target.desc == desc && (best < 0 || target.lastUsed > targets[best].lastUsed)) {
+                best = i;
+            }
+        }
+        if (best >= 0) {
+            targets[best].free = false;
+            stats.freeBytes -= desc.bytes();
+            stats.hits++;
+            return targets[best].texture;
+        }
+
+        Target target;
+        target.desc = desc;
+        target.texture = createTexture(desc);
+        targets.push_back(target);
+        stats.allocations++;
+        stats.allocatedBytes += desc.bytes();
+        stats.liveTextures++;
+        stats.liveBytes += desc.bytes();
+        stats.peakBytes = stats.liveBytes > stats.peakBytes ? stats.liveBytes : stats.peakBytes;
+        return target.texture;
+    }
+
+    // texture goes back to the pool, to be handed out again or evicted
+    void release(GLuint texture) {
+        for (Target& target : targets) {
+            if (target.texture == texture && !target.free) {
+                target.free = true;
+                target.lastUsed = frame;
+                stats.freeBytes += target.desc.bytes();
+                trim();
+                return;
+            }
+        }
+        printf("ERROR::RENDER_TARGET_POOL::UNKNOWN_TEXTURE %u\n", texture);
+    }
+
+    // evicts the released textures idle for more than maxIdleFrames
+    void beginFrame() {
+        frame++;
+        for (std::size_t i = 0; i < targets.size();) {
+            if (targets[i].free && frame - targets[i].lastUsed > maxIdleFrames) {
+                evict(i);
+            }
+            else {
+                i++;
+            }
+        }
+    }
+
+    // the desc texture was acquired with, NULL if the pool doesn't know it
+    const RenderTargetDesc* find(GLuint texture) const {
+        for (const Target& target : targets) {
+            if (target.texture == texture) {
+                return &target.desc;
+            }
+        }
+        return NULL;
+    }
+
+    const Stats& getStats() const {
+        return stats;
+    }
+
+    // zeroes the counters, the live and free sizes stay
+    void resetStats() {
+        stats.allocations = stats.evictions = stats.hits = stats.allocatedBytes = 0;
+        stats.peakBytes = stats.liveBytes;
+    }
+
+    // Adds to profiler:
+    //   targets.allocations, targets.evictions (since resetStats())
+    //   targets.live MB, targets.free MB
+    void publish(FrameProfiler& profiler) const {
+        profiler.value("targets.allocations", (double)stats.allocations);
+        profiler.value("targets.evictions", (double)stats.evictions);
+        profiler.value("targets.live MB", stats.liveBytes / (1024.0 * 1024.0));
+        profiler.value("targets.free MB", stats.freeBytes / (1024.0 * 1024.0));
+    }
+
+    static GLuint createTexture(const RenderTargetDesc& desc) {
+        GLuint texture;
+        glGenTextures(1, &texture);
+        if (desc.samples > 1) {
+            glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, texture);
+            glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, desc.samples, desc.format, desc.width, desc.height, GL_TRUE);
+            glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, 0);
+            return texture;
+        }
+        GLenum format = desc.hasStencil() ? GL_DEPTH_STENCIL : (desc.isDepth() ? GL_DEPTH_COMPONENT : GL_RGBA);
+        GLenum type = desc.hasStencil() ? GL_UNSIGNED_INT_24_8 : GL_FLOAT;
+        GLint filter = desc.isDepth() ? GL_NEAREST : GL_LINEAR;
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, desc.format, desc.width, desc.height, 0, format, type, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        return texture;
+    }
+
+    // delete all GL objects owned by the pool, released or not
+    void del() {
+        for (Target& target : targets) {
+            glDeleteTextures(1, &target.texture);
+        }
+        targets.clear();
+        stats.liveTextures = stats.liveBytes = stats.freeBytes = 0;
+    }
+
+private:
+    struct Target {
+        RenderTargetDesc desc;
+        GLuint texture = 0;
+        bool free = false;
+        unsigned long long lastUsed = 0;   // frame it was released
+    };
+
+    std::vector<Target> targets;
+    unsigned long long frame = 0;
+    Stats stats;
+
+    void evict(std::size_t i) {
+        std::size_t bytes = targets[i].desc.bytes();
+        glDeleteTextures(1, &targets[i].texture);
+        targets.erase(targets.begin() + i);
+        stats.evictions++;
+        stats.liveTextures--;
+        stats.liveBytes -= bytes;
+        stats.freeBytes -= bytes;
+    }
+
+    // least recently released first, until the released ones fit the budget
+    void trim() {
+        while (stats.freeBytes > budget) {
+            std::size_t oldest = targets.size();
+            for (std::size_t i = 0; i < targets.size(); i++) {
+                if (targets[i].free && (oldest == targets.size() || targets[i].lastUsed < targets[oldest].lastUsed)) {
+                    oldest = i;
+                }
+            }
+            evict(oldest);
+        }
+    }
+};
+
+class ResizeDebouncer {
+public:
+    int renderWidth, renderHeight;   // what targets are allocated at
+    int windowWidth, windowHeight;   // the latest framebuffer size
+    double settleTime;               // seconds without a resize before reallocating
+
+    ResizeDebouncer(int width, int height, double settleTime = 0.25)
+        : renderWidth(width), renderHeight(height), windowWidth(width), windowHeight(height), settleTime(settleTime) {}
+
+    // from framebuffer_size_callback, now in seconds (glfwGetTime)
+    void resize(int width, int height, double now) {
+        if (width != windowWidth || height != windowHeight) {
+            windowWidth = width;
+            windowHeight = height;
+            lastResize = now;
+        }
+    }
+
+    // Once per frame, before rendering. True when the window has settled at
+    // a size other than the render size, which then becomes the new render
+    // size: the caller reallocates its targets. A minimized window (0 x 0)
+    // never settles.
+    bool update(double now) {
+        bool changed = windowWidth != renderWidth || windowHeight != renderHeight;
+        if (!changed || windowWidth <= 0 || windowHeight <= 0 || now - lastResize < settleTime) {
+            return false;
+        }
+        renderWidth = windowWidth;
+        renderHeight = windowHeight;
+        return true;
+    }
+
+    // still rendering at the old size
+    bool scaling() const {
+        return windowWidth != renderWidth || windowHeight != renderHeight;
+    }
+
+    // copies readFramebuffer (color attachment 0, render size) to the
+    // default framebuffer at the window size, filtered if they differ
+    void present(GLuint readFramebuffer) const {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, readFramebuffer);
+        glReadBuffer(GL_COLOR_ATTACHMENT0);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+        glBlitFramebuffer(0, 0, renderWidth, renderHeight, 0, 0, windowWidth, windowHeight, GL_COLOR_BUFFER_BIT,
+            scaling() ? GL_LINEAR : GL_NEAREST);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+private:
+    double lastResize = -1e30;
+};
+
+#endif
@@ -2,12 +2,14 @@
 #define SHADER_H
 
 #include <glad/glad.h>
+#include "gl-ext.h"
 
 #include <string>
 #include <fstream>
 #include <sstream>
 #include <iostream>
 #include <filesystem>
+#include <vector>
 
 class Shader {
 public:
@@ -16,40 +18,8 @@ public:
     // constructor generates the shader on the fly
     Shader(const char* vertexPath, const char* fragmentPath) {
         // 1. retrieve the vertex/fragment source code from filePath
-        std::string vertexCode;
-        std::string fragmentCode;
-        std::ifstream vShaderFile;
-        std::ifstream fShaderFile;
-
-        // ensure ifstream objects can throw exceptions:
-        vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        
-        try {
-            // Resolve relative paths to absolute paths
-            std::filesystem::path vertexFilePath = std::filesystem::absolute(vertexPath);
-            std::filesystem::path fragmentFilePath = std::filesystem::absolute(fragmentPath);
-            
-            // open files
-            vShaderFile.open(vertexFilePath.string());
-            fShaderFile.open(fragmentFilePath.string());
-            std::stringstream vShaderStream, fShaderStream;
-
-            // read file's buffer contents into streams
-            vShaderStream << vShaderFile.rdbuf();
-            fShaderStream << fShaderFile.rdbuf();
-            
-            // close file handlers
-            vShaderFile.close();
-            fShaderFile.close();
-            
-            // convert stream into string
-            vertexCode = vShaderStream.str();
-            fragmentCode = fShaderStream.str();
-        }
-        catch (std::ifstream::failure& e) {
-            printf("ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: %s\n", e.what());
-        }
+        std::string vertexCode = readFile(vertexPath);
+        std::string fragmentCode = readFile(fragmentPath);
 
         const char* vShaderCode = vertexCode.c_str();
         const char* fShaderCode = fragmentCode.c_str();
@@ -79,28 +49,117 @@ public:
         glDeleteShader(fragment);
     }
     
+    // constructor for a vertex-only program whose outputs are captured with
+    // transform feedback instead of being rasterized. The varyings are written
+    // interleaved, in the order given, into the buffer bound at index 0.
+    Shader(const char* vertexPath, const std::vector<const char*>& feedbackVaryings) {
+        std::string vertexCode = readFile(vertexPath);
+        const char* vShaderCode = vertexCode.c_str();
+
+        unsigned int vertex = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(vertex, 1, &vShaderCode, NULL);
+        glCompileShader(vertex);
+        checkCompileErrors(vertex, "VERTEX");
+
+        // varyings have to be declared before linking
+        ID = glCreateProgram();
+        glAttachShader(ID, vertex);
+        glTransformFeedbackVaryings(ID, (GLsizei)feedbackVaryings.size(), feedbackVaryings.data(), GL_INTERLEAVED_ATTRIBS);
+        glLinkProgram(ID);
+        checkCompileErrors(ID, "PROGRAM");
+
+        glDeleteShader(vertex);
+    }
+    
+    // constructor for a compute program (needs a 4.3 context and loadGLExtensions)
+    explicit Shader(const char* computePath) {
+        std::string computeCode = readFile(computePath);
+        const char* cShaderCode = computeCode.c_str();
+
+        unsigned int compute = glCreateShader(GL_COMPUTE_SHADER);
+        glShaderSource(compute, 1, &cShaderCode, NULL);
+        glCompileShader(compute);
+        checkCompileErrors(compute, "COMPUTE");
+
+        ID = glCreateProgram();
+        glAttachShader(ID, compute);
+        glLinkProgram(ID);
+        checkCompileErrors(ID, "PROGRAM");
+
+        glDeleteShader(compute);
+    }
+    
     // use the shader
     void use() {
         glUseProgram(ID);
     }
 
-    // delete the shader
+    // delete the program
     void del() {
-        glDeleteShader(ID);
+        glDeleteProgram(ID);
     }
     
-    // Set functions
+    // Set functions, names must be zero terminated. The const char* versions
+    // are picked for literals and FrameArena strings, so setting a uniform
+    // doesn't build a std::string every call.
+    void setBool(const char* name, bool value) const {
+        glUniform1i(glGetUniformLocation(ID, name), (int)value);
+    }
+    void setInt(const char* name, int value) const {
+        glUniform1i(glGetUniformLocation(ID, name), value);
+    }
+    void setFloat(const char* name, float value) const {
+        glUniform1f(glGetUniformLocation(ID, name), value);
+    }
+    void setUInt(const char* name, unsigned int value) const {
+        glUniform1ui(glGetUniformLocation(ID, name), value);
+    }
+    void setVec2(const char* name, float x, float y) const {
+        glUniform2f(glGetUniformLocation(ID, name), x, y);
+    }
+
     void setBool(const std::string& name, bool value) const {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+        setBool(name.c_str(), value);
     }
     void setInt(const std::string& name, int value) const {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+        setInt(name.c_str(), value);
     }
     void setFloat(const std::string& name, float value) const {
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+        setFloat(name.c_str(), value);
+    }
+    void setUInt(const std::string& name, unsigned int value) const {
+        setUInt(name.c_str(), value);
+    }
+    void setVec2(const std::string& name, float x, float y) const {
+        setVec2(name.c_str(), x, y);
     }
 
 private:
+    // read a whole shader file into a string
+    static std::string readFile(const char* path) {
+        std::ifstream file;
+
+        // ensure ifstream objects can throw exceptions:
+        file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+
+        try {
+            // Resolve relative paths to absolute paths
+            std::filesystem::path filePath = std::filesystem::absolute(path);
+
+            // read file's buffer contents into a stream
+            file.open(filePath.string());
+            std::stringstream stream;
+            stream << file.rdbuf();
+            file.close();
+
+            return stream.str();
+        }
+        catch (std::ifstream::failure& e) {
+            printf("ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: %s\n", e.what());
+        }
+        return std::string();
+    }
+
     // check shader compilation/program linking errors.
     void checkCompileErrors(unsigned int shader, std::string type) {
         int success;
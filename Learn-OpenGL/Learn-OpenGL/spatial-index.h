@@ -0,0 +1,474 @@
+#ifndef SPATIAL_INDEX_H
+#define SPATIAL_INDEX_H
+
+#include "maths.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+// 2D bounding volume hierarchy over axis-aligned rectangles (quads, sprites,
+// UI elements), for "what is on screen" and "what is under the cursor".
+//
+// Four children per node, stored in flat arrays, no pointers. A node holds the
+// rectangles of its four children as SoA arrays, so one SSE compare tests
+// all four against the query. A child is another node or a leaf, a leaf has
+// a fixed block of LEAF_CAPACITY object slots, filled to LEAF_BUILD by a
+// build so objects can be inserted later without reshaping the tree.
+//
+// Updates keep the tree valid without rebuilding it:
+//   insert  goes down the child that grows least, into a free leaf slot or a
+//           new leaf in a free child slot; if there is neither it waits in a
+//           pending list that queries scan, until the next rebuild()
+//   move    grows the ancestors until they contain the new rectangle
+//   remove  frees the slot
+// Growing only ever loosens the bounds. refit() makes them tight again
+// bottom-up (same tree, O(nodes)), rebuild() builds a new tree (O(n log n)).
+// Which one pays off depends on how far things move, see the spatial-index
+// benchmark.
+//
+//     SpatialIndex index;
+//     unsigned int id = index.insert(SpatialIndex::Rect{ x0, y0, x1, y1 });
+//     index.rebuild();
+//     index.move(id, rect);  ...  index.refit();
+//     index.query(SpatialIndex::Rect{ -1, -1, 1, 1 }, visible);
+//     int hit = index.pick(x, y);
+class SpatialIndex {
+public:
+    static constexpr unsigned int LEAF_CAPACITY = 8;
+    static constexpr unsigned int LEAF_BUILD = 4;
+
+    struct Rect {
+        float minX, minY, maxX, maxY;
+    };
+
+    // returns the id of the new object, ids of removed objects are reused
+    unsigned int insert(const Rect& rect) {
+        unsigned int id;
+        if (!freeIds.empty()) {
+            id = freeIds.back();
+            freeIds.pop_back();
+            bounds[id] = rect;
+            location[id] = PENDING;
+            created[id] = nextCreated++;
+        }
+        else {
+            id = (unsigned int)bounds.size();
+            bounds.push_back(rect);
+            location.push_back(PENDING);
+            created.push_back(nextCreated++);
+        }
+        live++;
+        place(id);
+        return id;
+    }
+
+    void move(unsigned int id, const Rect& rect) {
+        bounds[id] = rect;
+        int at = location[id];
+        if (at >= 0) {
+            grow(leaves[at / LEAF_CAPACITY].parent, leaves[at / LEAF_CAPACITY].slot, rect);
+        }
+    }
+
+    void remove(unsigned int id) {
+        int at = location[id];
+        if (at >= 0) {
+            // the last object of the leaf takes the slot
+            Leaf& leaf = leaves[at / LEAF_CAPACITY];
+            unsigned int last = (unsigned int)(at / LEAF_CAPACITY) * LEAF_CAPACITY + leaf.count - 1;
+            items[at] = items[last];
+            location[items[at]] = at;
+            leaf.count--;
+        }
+        else if (at == PENDING) {
+            pending.erase(std::find(pending.begin(), pending.end(), id));
+        }
+        location[id] = FREE;
+        freeIds.push_back(id);
+        live--;
+    }
+
+    const Rect& getBounds(unsigned int id) const {
+        return bounds[id];
+    }
+
+    // live objects
+    std::size_t size() const {
+        return live;
+    }
+
+    std::size_t nodeCount() const {
+        return nodes.size();
+    }
+
+    std::size_t pendingCount() const {
+        return pending.size();
+    }
+
+    // A new tree over every object, pending ones included: split the
+    // objects at the median center along the longer axis, twice per node.
+    void rebuild() {
+        nodes.clear();
+        leaves.clear();
+        items.clear();
+        pending.clear();
+        order.clear();
+        for (unsigned int id = 0; id < bounds.size(); id++) {
+            if (location[id] != FREE) {
+                order.push_back(id);
+            }
+        }
+        if (order.empty()) {
+            return;
+        }
+        nodes.push_back(emptyNode(-1, 0));
+        buildNode(0, 0, order.size());
+    }
+
+    // Recomputes every bound bottom-up. Children always come after their
+    // parent in nodes, so one backwards pass sees each child first.
+    void refit() {
+        for (std::size_t n = nodes.size(); n-- > 0;) {
+            Node& node = nodes[n];
+            for (int s = 0; s < 4; s++) {
+                int child = node.child[s];
+                Rect r = EMPTY;
+                if (child >= 0) {
+                    r = nodeBounds(nodes[child]);
+                }
+                else if (child != NO_CHILD) {
+                    r = leafBounds(~child);
+                }
+                setSlot(node, s, r);
+            }
+        }
+    }
+
+    // appends the objects whose rectangle overlaps rect (edges touching count)
+    void query(const Rect& rect, std::vector<unsigned int>& out) const {
+        visit(rect, [&](unsigned int id) { out.push_back(id); });
+        for (unsigned int id : pending) {
+            if (overlaps(bounds[id], rect)) {
+                out.push_back(id);
+            }
+        }
+    }
+
+    // appends the objects containing the point
+    void pick(float x, float y, std::vector<unsigned int>& out) const {
+        query(Rect{ x, y, x, y }, out);
+    }
+
+    // the most recently inserted object containing the point (usually the
+    // one drawn on top), -1 if there is none. Ids are reused, so that isn't
+    // necessarily the highest id.
+    int pick(float x, float y) const {
+        int best = -1;
+        Rect point = { x, y, x, y };
+        auto consider = [&](unsigned int id) {
+            if (best < 0 || created[id] > created[best]) {
+                best = (int)id;
+            }
+        };
+        visit(point, consider);
+        for (unsigned int id : pending) {
+            if (overlaps(bounds[id], point)) {
+                consider(id);
+            }
+        }
+        return best;
+    }
+
+private:
+    // location of an object: index into items, or one of these
+    static constexpr int PENDING = -1;
+    static constexpr int FREE = -2;
+    // child of a node: >= 0 a node, NO_CHILD, otherwise ~leaf
+    static constexpr int NO_CHILD = std::numeric_limits<int>::min();
+
+    // an empty rectangle fails every overlap test
+    static constexpr Rect EMPTY = { std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+                                    -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max() };
+
+    struct alignas(16) Node {
+        float minX[4], minY[4], maxX[4], maxY[4];
+        int child[4];
+        int parent;  // -1 for the root
+        int slot;    // index of this node in the parent's child slots
+    };
+
+    struct Leaf {
+        unsigned int count;
+        int parent;
+        int slot;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<Leaf> leaves;
+    std::vector<unsigned int> items;      // LEAF_CAPACITY object ids per leaf
+    std::vector<Rect> bounds;             // by object id
+    std::vector<int> location;            // by object id
+    std::vector<unsigned long long> created;  // by object id, insert order
+    unsigned long long nextCreated = 0;
+    std::vector<unsigned int> pending;    // inserted, not in the tree yet
+    std::vector<unsigned int> freeIds;
+    std::vector<unsigned int> order;      // rebuild scratch
+    std::size_t live = 0;
+
+    static bool overlaps(const Rect& a, const Rect& b) {
+        return a.minX <= b.maxX && a.maxX >= b.minX && a.minY <= b.maxY && a.maxY >= b.minY;
+    }
+
+    static Rect merge(const Rect& a, const Rect& b) {
+        return Rect{ std::min(a.minX, b.minX), std::min(a.minY, b.minY), std::max(a.maxX, b.maxX), std::max(a.maxY, b.maxY) };
+    }
+
+    static float area(const Rect& r) {
+        return r.maxX < r.minX ? 0.0f : (r.maxX - r.minX) * (r.maxY - r.minY);
+    }
+
+    static Node emptyNode(int parent, int slot) {
+        Node node;
+        for (int s = 0; s < 4; s++) {
+            setSlot(node, s, EMPTY);
+            node.child[s] = NO_CHILD;
+        }
+        node.parent = parent;
+        node.slot = slot;
+        return node;
+    }
+
+    static void setSlot(Node& node, int s, const Rect& r) {
+        node.minX[s] = r.minX;
+        node.minY[s] = r.minY;
+        node.maxX[s] = r.maxX;
+        node.maxY[s] = r.maxY;
+    }
+
+    static Rect slotBounds(const Node& node, int s) {
+        return Rect{ node.minX[s], node.minY[s], node.maxX[s], node.maxY[s] };
+    }
+
+    static Rect nodeBounds(const Node& node) {
+        Rect r = EMPTY;
+        for (int s = 0; s < 4; s++) {
+            r = merge(r, slotBounds(node, s));
+        }
+        return r;
+    }
+
+    Rect leafBounds(int leaf) const {
+        Rect r = EMPTY;
+        const unsigned int* ids = items.data() + (std::size_t)leaf * LEAF_CAPACITY;
+        for (unsigned int k = 0; k < leaves[leaf].count; k++) {
+            r = merge(r, bounds[ids[k]]);
+        }
+        return r;
+    }
+
+    // bit s set when child slot s of node overlaps rect
+    static int overlapMask(const Node& node, const Rect& rect) {
+#if defined(MATHS_SSE)
+        __m128 inside = _mm_and_ps(_mm_cmple_ps(_mm_load_ps(node.minX), _mm_set1_ps(rect.maxX)),
+                                   _mm_cmpge_ps(_mm_load_ps(node.maxX), _mm_set1_ps(rect.minX)));
+        inside = _mm_and_ps(inside, _mm_cmple_ps(_mm_load_ps(node.minY), _mm_set1_ps(rect.maxY)));
+        inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_load_ps(node.maxY), _mm_set1_ps(rect.minY)));
+        return _mm_movemask_ps(inside);
+#else
+        int mask = 0;
+        for (int s = 0; s < 4; s++) {
+            mask |= overlaps(slotBounds(node, s), rect) ? 1 << s : 0;
+        }
+        return mask;
+#endif
+    }
+
+    // calls fn(id) for every object in the tree overlapping rect
+    template <typename F>
+    void visit(const Rect& rect, const F& fn) const {
+        if (nodes.empty()) {
+            return;
+        }
+        int stack[64];
+        int top = 0;
+        stack[top++] = 0;
+        while (top > 0) {
+            const Node& node = nodes[stack[--top]];
+            int mask = overlapMask(node, rect);
+            while (mask != 0) {
+                int s = 0;
+                while (!(mask & (1 << s))) {
+                    s++;
+                }
+                mask &= mask - 1;
+                int child = node.child[s];
+                if (child >= 0) {
+                    stack[top++] = child;
+                }
+                else {
+                    int leaf = ~child;
+                    const unsigned int* ids = items.data() + (std::size_t)leaf * LEAF_CAPACITY;
+                    for (unsigned int k = 0; k < leaves[leaf].count; k++) {
+                        if (overlaps(bounds[ids[k]], rect)) {
+                            fn(ids[k]);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // grows slot of node and its ancestors until they contain rect
+    void grow(int node, int slot, const Rect& rect) {
+        while (node >= 0) {
+            Rect current = slotBounds(nodes[node], slot);
+            Rect merged = merge(current, rect);
+            if (merged.minX == current.minX && merged.minY == current.minY && merged.maxX == current.maxX &&
+                merged.maxY == current.maxY) {
+                return;
+            }
+            setSlot(nodes[node], slot, merged);
+            slot = nodes[node].slot;
+            node = nodes[node].parent;
+        }
+    }
+
+    // puts a new object into the tree, or in pending if there is no room
+    void place(unsigned int id) {
+        if (nodes.empty()) {
+            pending.push_back(id);
+            location[id] = PENDING;
+            return;
+        }
+        const Rect& rect = bounds[id];
+        int n = 0;
+        for (;;) {
+            Node& node = nodes[n];
+            // a free slot takes a new leaf
+            for (int s = 0; s < 4; s++) {
+                if (node.child[s] == NO_CHILD) {
+                    int leaf = newLeaf(n, s);
+                    addToLeaf(leaf, id);
+                    setSlot(nodes[n], s, EMPTY);
+                    grow(n, s, rect);
+                    return;
+                }
+            }
+            // otherwise down the child that grows least
+            int best = 0;
+            float bestGrowth = std::numeric_limits<float>::max();
+            for (int s = 0; s < 4; s++) {
+                Rect r = slotBounds(node, s);
+                float growth = area(merge(r, rect)) - area(r);
+                if (growth < bestGrowth) {
+                    bestGrowth = growth;
+                    best = s;
+                }
+            }
+            int child = node.child[best];
+            if (child >= 0) {
+                n = child;
+                continue;
+            }
+            int leaf = ~child;
+            if (leaves[leaf].count < LEAF_CAPACITY) {
+                addToLeaf(leaf, id);
+                grow(n, best, rect);
+            }
+            else {
+                pending.push_back(id);
+                location[id] = PENDING;
+            }
+            return;
+        }
+    }
+
+    int newLeaf(int parent, int slot) {
+        int leaf = (int)leaves.size();
+        leaves.push_back(Leaf{ 0, parent, slot });
+        items.resize(items.size() + LEAF_CAPACITY);
+        nodes[parent].child[slot] = ~leaf;
+        return leaf;
+    }
+
+    void addToLeaf(int leaf, unsigned int id) {
+        int at = leaf * (int)LEAF_CAPACITY + (int)leaves[leaf].count++;
+        items[at] = id;
+        location[id] = at;
+    }
+
+    float center(unsigned int id, int axis) const {
+        const Rect& r = bounds[id];
+        return axis == 0 ? r.minX + r.maxX : r.minY + r.maxY;
+    }
+
+    // the extent of the centers of order[begin, end), 0 = x is the longer
+    int splitAxis(std::size_t begin, std::size_t end) const {
+        float minX = std::numeric_limits<float>::max(), maxX = -minX, minY = minX, maxY = -minX;
+        for (std::size_t i = begin; i < end; i++) {
+            float x = center(order[i], 0), y = center(order[i], 1);
+            minX = std::min(minX, x);
+            maxX = std::max(maxX, x);
+            minY = std::min(minY, y);
+            maxY = std::max(maxY, y);
+        }
+        return maxX - minX >= maxY - minY ? 0 : 1;
+    }
+
+    std::size_t split(std::size_t begin, std::size_t end) {
+        std::size_t middle = begin + (end - begin) / 2;
+        int axis = splitAxis(begin, end);
+        std::nth_element(order.begin() + begin, order.begin() + middle, order.begin() + end,
+            [&](unsigned int a, unsigned int b) { return center(a, axis) < center(b, axis); });
+        return middle;
+    }
+
+    // fills node n with the objects order[begin, end), returns its bounds
+    Rect buildNode(int n, std::size_t begin, std::size_t end) {
+        std::size_t ranges[5];
+        std::size_t count = end - begin;
+        int children;
+        if (count <= 4 * LEAF_BUILD) {
+            // up to four leaves of LEAF_BUILD
+            children = (int)((count + LEAF_BUILD - 1) / LEAF_BUILD);
+            for (int c = 0; c <= children; c++) {
+                ranges[c] = begin + std::min<std::size_t>(count, c * LEAF_BUILD);
+            }
+        }
+        else {
+            std::size_t middle = split(begin, end);
+            ranges[0] = begin;
+            ranges[2] = middle;
+            ranges[4] = end;
+            ranges[1] = split(begin, middle);
+            ranges[3] = split(middle, end);
+            children = 4;
+        }
+
+        Rect total = EMPTY;
+        for (int c = 0; c < children; c++) {
+            std::size_t first = ranges[c], last = ranges[c + 1];
+            Rect r = EMPTY;
+            if (last - first <= LEAF_BUILD) {
+                int leaf = newLeaf(n, c);
+                for (std::size_t i = first; i < last; i++) {
+                    addToLeaf(leaf, order[i]);
+                }
+                r = leafBounds(leaf);
+            }
+            else {
+                int child = (int)nodes.size();
+                nodes.push_back(emptyNode(n, c));
+                nodes[n].child[c] = child;
+                r = buildNode(child, first, last);
+            }
+            setSlot(nodes[n], c, r);
+            total = merge(total, r);
+        }
+        return total;
+    }
+};
+
+#endif
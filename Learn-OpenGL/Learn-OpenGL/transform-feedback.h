@@ -0,0 +1,116 @@
+#ifndef TRANSFORM_FEEDBACK_H
+#define TRANSFORM_FEEDBACK_H
+
+#include "shader.h"
+
+#include <vector>
+
+// one float vertex attribute inside an interleaved vertex
+struct FeedbackAttribute {
+    unsigned int location;
+    int size; // number of floats
+};
+
+// Animates vertex data on the GPU with transform feedback.
+//
+// The vertex state lives in two buffers with identical interleaved layouts.
+// Each update() runs the update shader over buffer[src] as GL_POINTS with
+// rasterization discarded, captures its outputs into buffer[dst] and swaps,
+// so the CPU cost per frame doesn't depend on the number of vertices.
+//
+// The update shader must write its varyings in the same order and with the
+// same sizes as the input attributes, so the output can be read back in as
+// next frame's input. It can use two uniforms: "dt" and "time". State
+// stepped by dt picks up a little float error every frame, relative to its
+// magnitude, so keep it bounded (wrap phases and angles).
+class FeedbackAnimator {
+public:
+    unsigned int vertexCount;
+    unsigned int stride; // bytes per vertex
+
+    FeedbackAnimator(const char* updateShaderPath, const std::vector<const char*>& varyings,
+                     const std::vector<FeedbackAttribute>& attributes, const float* vertices, unsigned int vertexCount)
+        : vertexCount(vertexCount), stride(0), updateShader(updateShaderPath, varyings) {
+        for (const FeedbackAttribute& attribute : attributes) {
+            stride += attribute.size * sizeof(float);
+        }
+
+        dtLocation = glGetUniformLocation(updateShader.ID, "dt");
+        timeLocation = glGetUniformLocation(updateShader.ID, "time");
+
+        glGenVertexArrays(2, VAO);
+        glGenBuffers(2, VBO);
+
+        // both buffers get the initial state, GL_DYNAMIC_COPY = written and read by GL only
+        for (int i = 0; i < 2; i++) {
+            glBindVertexArray(VAO[i]);
+            glBindBuffer(GL_ARRAY_BUFFER, VBO[i]);
+            glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)vertexCount * stride, vertices, GL_DYNAMIC_COPY);
+
+            std::size_t offset = 0;
+            for (const FeedbackAttribute& attribute : attributes) {
+                glVertexAttribPointer(attribute.location, attribute.size, GL_FLOAT, GL_FALSE, stride, (void*)offset);
+                glEnableVertexAttribArray(attribute.location);
+                offset += attribute.size * sizeof(float);
+            }
+        }
+
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+    }
+
+    FeedbackAnimator(const FeedbackAnimator&) = delete;
+    FeedbackAnimator& operator=(const FeedbackAnimator&) = delete;
+
+    // run one simulation step on the GPU
+    void update(float dt, float time) {
+        unsigned int src = current;
+        unsigned int dst = 1 - current;
+
+        updateShader.use();
+        glUniform1f(dtLocation, dt);
+        glUniform1f(timeLocation, time);
+
+        glEnable(GL_RASTERIZER_DISCARD);
+        glBindVertexArray(VAO[src]);
+        glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, VBO[dst]);
+
+        glBeginTransformFeedback(GL_POINTS);
+        glDrawArrays(GL_POINTS, 0, vertexCount);
+        glEndTransformFeedback();
+
+        glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+        glBindVertexArray(0);
+        glDisable(GL_RASTERIZER_DISCARD);
+
+        current = dst;
+    }
+
+    // VAO sourcing the latest state, bind it to draw the animated vertices
+    unsigned int vao() const {
+        return VAO[current];
+    }
+
+    // buffer holding the latest state
+    unsigned int buffer() const {
+        return VBO[current];
+    }
+
+    // delete all GL objects owned by the animator
+    void del() {
+        glDeleteVertexArrays(2, VAO);
+        glDeleteBuffers(2, VBO);
+        glDeleteProgram(updateShader.ID);
+    }
+
+private:
+    Shader updateShader;
+    int dtLocation;
+    int timeLocation;
+
+    unsigned int VAO[2];
+    unsigned int VBO[2];
+    unsigned int current = 0;
+};
+
+#endif
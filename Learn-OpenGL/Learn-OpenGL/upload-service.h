@@ -0,0 +1,321 @@
+#ifndef UPLOAD_SERVICE_H
+#define UPLOAD_SERVICE_H
+
+#include <glad/glad.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Buffer and texture uploads on a second thread, so loading doesn't stall
+// the frame.
+//
+// The service thread owns a GL context shared with the render context (GL
+// objects and sync objects are shared between them). For every request it
+// creates the object, fills it, inserts a glFenceSync and flushes. The render
+// thread calls poll() once per frame: uploads whose fence has signaled are
+// handed over by calling their onReady callback with the object name, on the
+// render thread. Until then the object doesn't exist as far as the render
+// thread is concerned, so it can never draw from a half-written buffer. An
+// upload that failed (a buffer that couldn't be mapped for its fill
+// function) is handed over as object 0 and counted in Stats::failed.
+//
+// The context is made current on the service thread through a callback,
+// which keeps this header free of any window library. With GLFW:
+//     glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+//     GLFWwindow* uploadWindow = glfwCreateWindow(1, 1, "", NULL, window);
+//     glfwMakeContextCurrent(window);
+//     UploadService uploads([=](bool current) { glfwMakeContextCurrent(current ? uploadWindow : NULL); });
+//
+// Data is either moved in (the vector is taken over, no copy) or produced by
+// a fill function that runs on the service thread, so reading and decoding
+// files can move off the render thread too. Large buffers are written in
+// chunks of chunkSize bytes with a glFlush in between, so one big upload
+// doesn't hold up the GPU queue in one piece.
+class UploadService {
+public:
+    typedef std::function<void(unsigned int object)> ReadyCallback;
+    typedef std::function<void(void* destination, std::size_t size)> FillFunction;
+
+    std::size_t chunkSize = 4 << 20;
+
+    struct Stats {
+        unsigned int requested = 0;
+        unsigned int completed = 0;
+        unsigned int failed = 0;     // handed over as object 0, not in completed
+        unsigned long long bytes = 0;
+        double latencyMs = 0.0;      // request to hand-over, summed over the completed uploads
+        double maxLatencyMs = 0.0;
+    };
+
+    // bindContext(true) makes the upload context current on the calling
+    // (service) thread, bindContext(false) releases it before the thread ends
+    explicit UploadService(std::function<void(bool current)> bindContext)
+        : bindContext(std::move(bindContext)) {
+        worker = std::thread(&UploadService::workerLoop, this);
+    }
+
+    // waits for the outstanding uploads and deletes the objects that were
+    // never handed over, call with the render context current
+    ~UploadService() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            quit = true;
+        }
+        wake.notify_one();
+        worker.join();
+
+        // the service thread finished every request before it ended, poll()
+        // just hasn't picked all of them up yet
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            while (!finished.empty()) {
+                uploaded.push_back(std::move(finished.front()));
+                finished.pop_front();
+            }
+        }
+        for (Upload& upload : uploaded) {
+            glClientWaitSync(upload.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+            glDeleteSync(upload.fence);
+            deleteObject(upload);
+        }
+    }
+
+    UploadService(const UploadService&) = delete;
+    UploadService& operator=(const UploadService&) = delete;
+
+    // a buffer holding data
+    void uploadBuffer(std::vector<unsigned char> data, GLenum usage, ReadyCallback onReady) {
+        Upload upload = makeUpload(BUFFER, std::move(onReady));
+        upload.size = data.size();
+        upload.data = std::move(data);
+        upload.usage = usage;
+        submit(std::move(upload));
+    }
+
+    // a buffer of size bytes that fill writes straight into the mapped buffer
+    void uploadBuffer(std::size_t size, FillFunction fill, GLenum usage, ReadyCallback onReady) {
+        Upload upload = makeUpload(BUFFER, std::move(onReady));
+        upload.size = size;
+        upload.fill = std::move(fill);
+        upload.usage = usage;
+        submit(std::move(upload));
+    }
+
+    // a 2D texture with linear filtering, mipmapped when mipmaps is set
+    void uploadTexture2D(std::vector<unsigned char> pixels, int width, int height, GLenum internalFormat, GLenum format,
+                         GLenum type, bool mipmaps, ReadyCallback onReady) {
+        Upload upload = makeUpload(TEXTURE_2D, std::move(onReady));
+        upload.size = pixels.size();
+        upload.data = std::move(pixels);
+        upload.width = width;
+        upload.height = height;
+        upload.internalFormat = internalFormat;
+        upload.format = format;
+        upload.type = type;
+        upload.mipmaps = mipmaps;
+        submit(std::move(upload));
+    }
+
+    // Hands over the uploads the GPU has finished, returns how many. Never
+    // blocks, the fences are checked with a zero timeout.
+    unsigned int poll() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            while (!finished.empty()) {
+                uploaded.push_back(std::move(finished.front()));
+                finished.pop_front();
+            }
+        }
+
+        unsigned int ready = 0;
+        Clock::time_point now = Clock::now();
+        for (std::size_t i = 0; i < uploaded.size();) {
+            GLenum status = glClientWaitSync(uploaded[i].fence, 0, 0);
+            if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+                i++;
+                continue;
+            }
+            Upload upload = std::move(uploaded[i]);
+            uploaded.erase(uploaded.begin() + i);
+            glDeleteSync(upload.fence);
+
+            if (upload.failed) {
+                deleteObject(upload);
+                stats.failed++;
+                ready++;
+                if (upload.onReady) {
+                    upload.onReady(0);
+                }
+                continue;
+            }
+
+            double latency = std::chrono::duration<double, std::milli>(now - upload.requested).count();
+            stats.completed++;
+            stats.bytes += upload.size;
+            stats.latencyMs += latency;
+            stats.maxLatencyMs = latency > stats.maxLatencyMs ? latency : stats.maxLatencyMs;
+            ready++;
+            if (upload.onReady) {
+                upload.onReady(upload.object);
+            }
+        }
+        return ready;
+    }
+
+    // uploads requested and not handed over yet
+    unsigned int pending() const {
+        return stats.requested - stats.completed - stats.failed;
+    }
+
+    const Stats& getStats() const {
+        return stats;
+    }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    enum Kind { BUFFER, TEXTURE_2D };
+
+    struct Upload {
+        Kind kind;
+        ReadyCallback onReady;
+        Clock::time_point requested;
+        std::vector<unsigned char> data;
+        FillFunction fill;
+        std::size_t size = 0;
+        GLenum usage = GL_STATIC_DRAW;
+        int width = 0;
+        int height = 0;
+        GLenum internalFormat = GL_RGBA8;
+        GLenum format = GL_RGBA;
+        GLenum type = GL_UNSIGNED_BYTE;
+        bool mipmaps = false;
+
+        unsigned int object = 0;
+        GLsync fence = 0;
+        bool failed = false;
+    };
+
+    std::function<void(bool)> bindContext;
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<Upload> requests;   // service thread input
+    std::deque<Upload> finished;   // fenced, waiting for poll()
+    std::vector<Upload> uploaded;  // render thread side, fence not signaled yet
+    bool quit = false;
+    Stats stats;
+
+    Upload makeUpload(Kind kind, ReadyCallback onReady) {
+        Upload upload;
+        upload.kind = kind;
+        upload.onReady = std::move(onReady);
+        upload.requested = Clock::now();
+        return upload;
+    }
+
+    void submit(Upload&& upload) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stats.requested++;
+            requests.push_back(std::move(upload));
+        }
+        wake.notify_one();
+    }
+
+    static void deleteObject(Upload& upload) {
+        if (upload.kind == BUFFER) {
+            glDeleteBuffers(1, &upload.object);
+        }
+        else {
+            glDeleteTextures(1, &upload.object);
+        }
+    }
+
+    void writeBuffer(Upload& upload) {
+        glGenBuffers(1, &upload.object);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, upload.object);
+        if (upload.fill) {
+            glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)upload.size, NULL, upload.usage);
+            void* destination = glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, (GLsizeiptr)upload.size,
+                GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+            if (destination != NULL) {
+                upload.fill(destination, upload.size);
+                glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+            }
+            else {
+                printf("ERROR::UPLOAD_SERVICE::MAP_FAILED\n");
+                upload.failed = true;
+            }
+        }
+        else if (upload.size <= chunkSize) {
+            glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)upload.size, upload.data.data(), upload.usage);
+        }
+        else {
+            glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)upload.size, NULL, upload.usage);
+            for (std::size_t offset = 0; offset < upload.size; offset += chunkSize) {
+                std::size_t size = upload.size - offset < chunkSize ? upload.size - offset : chunkSize;
+                glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)offset, (GLsizeiptr)size, upload.data.data() + offset);
+                glFlush();
+            }
+        }
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+
+    void writeTexture(Upload& upload) {
+        glGenTextures(1, &upload.object);
+        glBindTexture(GL_TEXTURE_2D, upload.object);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, upload.internalFormat, upload.width, upload.height, 0, upload.format, upload.type,
+            upload.data.data());
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, upload.mipmaps ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        if (upload.mipmaps) {
+            glGenerateMipmap(GL_TEXTURE_2D);
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    void workerLoop() {
+        bindContext(true);
+        for (;;) {
+            Upload upload;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this]() { return quit || !requests.empty(); });
+                if (requests.empty()) {
+                    break;
+                }
+                upload = std::move(requests.front());
+                requests.pop_front();
+            }
+
+            if (upload.kind == BUFFER) {
+                writeBuffer(upload);
+            }
+            else {
+                writeTexture(upload);
+            }
+
+            // the flush makes sure the fence reaches the GPU, the render
+            // thread only ever polls it
+            upload.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            glFlush();
+            upload.data = std::vector<unsigned char>();
+            upload.fill = nullptr;
+
+            std::lock_guard<std::mutex> lock(mutex);
+            finished.push_back(std::move(upload));
+        }
+        bindContext(false);
+    }
+};
+
+#endif
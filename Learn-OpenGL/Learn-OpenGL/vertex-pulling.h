@@ -0,0 +1,126 @@
+#ifndef VERTEX_PULLING_H
+#define VERTEX_PULLING_H
+
+#include "gpu-heap.h"
+
+#include <cstddef>
+#include <vector>
+
+// Programmable vertex pulling for MeshPool meshes: no vertex attributes, no
+// VAO per mesh or page.
+//
+// The vertex shader reads its own vertex out of the page buffer, bound as a
+// shader storage buffer, at gl_VertexID (which already includes the base
+// vertex of the draw). The only VAO is an empty one, the page is just its
+// element buffer. The meshes of one page go out as one
+// glMultiDrawElementsIndirect and the shader tells the draws apart with
+// drawBase + gl_DrawIDARB, draw i of the list passed to draw() is draw i:
+//     #version 430 core
+//     #extension GL_ARB_shader_draw_parameters : enable
+//     layout (std430, binding = 0) readonly buffer Vertices { float vertices[]; };
+//     uniform uint drawBase;
+//     void main() {
+//         uint v = uint(gl_VertexID) * 5u;   // floats per vertex
+//         vec2 pos = vec2(vertices[v], vertices[v + 1u]);
+//     #ifdef GL_ARB_shader_draw_parameters
+//         uint draw = drawBase + uint(gl_DrawIDARB);
+//     #else
+//         uint draw = drawBase;
+//     #endif
+//         ...
+// Without GL_ARB_shader_draw_parameters (core in 4.6) multiDraw is false and
+// the draws are issued one by one with drawBase set for each, which still
+// never touches a VAO. The same command also carries baseInstance = i.
+//
+// Needs a 4.3 context and loadGLExtensions (gl-ext.h).
+class VertexPuller {
+public:
+    unsigned int vertexBinding;  // storage buffer binding of the vertices
+    bool multiDraw;              // one multi-draw per page, needs gl_DrawIDARB
+    unsigned int drawCalls = 0;  // GL draw calls made by the last draw()
+
+    explicit VertexPuller(unsigned int vertexBinding = 0) : vertexBinding(vertexBinding) {
+        multiDraw = hasGLVersion(4, 6) || hasGLExtension("GL_ARB_shader_draw_parameters");
+        glGenVertexArrays(1, &vao);
+        glGenBuffers(1, &indirectBuffer);
+    }
+
+    VertexPuller(const VertexPuller&) = delete;
+    VertexPuller& operator=(const VertexPuller&) = delete;
+
+    // Draws meshes[0, count) of pool with the current program, drawBaseLocation
+    // is the location of its uint drawBase uniform. Leaves VAO 0 bound, call
+    // pool.unbind() before drawing through the pool's own VAOs again.
+    void draw(const MeshPool& pool, const unsigned int* meshes, std::size_t count, GLint drawBaseLocation,
+              GLenum mode = GL_TRIANGLES) {
+        drawCalls = 0;
+        if (count == 0) {
+            return;
+        }
+
+        commands.resize(count);
+        for (std::size_t i = 0; i < count; i++) {
+            commands[i] = pool.command(meshes[i], (unsigned int)i);
+        }
+        if (multiDraw) {
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+            glBufferData(GL_DRAW_INDIRECT_BUFFER, (GLsizeiptr)(count * sizeof(DrawElementsIndirectCommand)),
+                commands.data(), GL_STREAM_DRAW);
+        }
+
+        glBindVertexArray(vao);
+        std::size_t begin = 0;
+        while (begin < count) {
+            // a run of meshes in the same page
+            unsigned int page = pool.page(meshes[begin]);
+            std::size_t end = begin + 1;
+            while (end < count && pool.page(meshes[end]) == page) {
+                end++;
+            }
+
+            unsigned int buffer = pool.heap.pageBuffer(page);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer);
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, vertexBinding, buffer);
+
+            if (multiDraw) {
+                glUniform1ui(drawBaseLocation, (GLuint)begin);
+                glMultiDrawElementsIndirect(mode, GL_UNSIGNED_INT, (void*)(begin * sizeof(DrawElementsIndirectCommand)),
+                    (GLsizei)(end - begin), 0);
+                drawCalls++;
+            }
+            else {
+                for (std::size_t i = begin; i < end; i++) {
+                    const DrawElementsIndirectCommand& c = commands[i];
+                    glUniform1ui(drawBaseLocation, (GLuint)i);
+                    glDrawElementsBaseVertex(mode, (GLsizei)c.count, GL_UNSIGNED_INT,
+                        (void*)((std::size_t)c.firstIndex * sizeof(unsigned int)), c.baseVertex);
+                    drawCalls++;
+                }
+            }
+            begin = end;
+        }
+        glBindVertexArray(0);
+        if (multiDraw) {
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        }
+    }
+
+    void draw(const MeshPool& pool, const std::vector<unsigned int>& meshes, GLint drawBaseLocation,
+              GLenum mode = GL_TRIANGLES) {
+        draw(pool, meshes.data(), meshes.size(), drawBaseLocation, mode);
+    }
+
+    void del() {
+        glDeleteVertexArrays(1, &vao);
+        glDeleteBuffers(1, &indirectBuffer);
+        vao = 0;
+        indirectBuffer = 0;
+    }
+
+private:
+    unsigned int vao = 0;             // empty, only ever holds the element buffer
+    unsigned int indirectBuffer = 0;
+    std::vector<DrawElementsIndirectCommand> commands;
+};
+
+#endif
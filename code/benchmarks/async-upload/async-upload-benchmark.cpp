@@ -0,0 +1,309 @@
+#include "upload-service.h"
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <cmath>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+
+const unsigned int TEXTURE_SIZE = 1024;
+const int LOAD_FRAME = 30;
+const double FRAME_BUDGET_MS = 1000.0 / 60.0;
+
+const char* vertexShaderSource =
+	"#version 330 core\n"
+	"layout (location = 0) in vec2 pos;\n"
+	"out vec2 texCoord;\n"
+	"void main() {\n"
+	"gl_Position = vec4(pos, 0.0, 1.0);\n"
+	"texCoord = pos * 4.0;\n"
+	"}\0";
+const char* fragmentShaderSource =
+	"#version 330 core\n"
+	"in vec2 texCoord;\n"
+	"out vec4 FragColor;\n"
+	"uniform sampler2D image;\n"
+	"void main() {\n"
+	"FragColor = texture(image, texCoord);\n"
+	"}\0";
+
+// A "scene" of meshCount vertex buffers and textureCount textures. Each mesh
+// is meshBytes of vertices, the first three are a small triangle in its own
+// grid cell (the only ones drawn), the rest is filler standing in for the
+// geometry of a real model.
+struct SceneObject {
+	unsigned int VAO = 0;
+	unsigned int buffer = 0;
+	unsigned int texture = 0;
+};
+
+void fillMesh(unsigned int index, unsigned int meshCount, float* vertices, std::size_t floats) {
+	unsigned int columns = (unsigned int)std::ceil(std::sqrt((double)meshCount));
+	float cell = 2.0f / columns;
+	float cx = -1.0f + cell * (index % columns + 0.5f);
+	float cy = -1.0f + cell * (index / columns + 0.5f);
+	float triangle[] = {
+		cx - 0.4f * cell, cy - 0.4f * cell,
+		cx + 0.4f * cell, cy - 0.4f * cell,
+		cx,               cy + 0.4f * cell,
+	};
+	std::copy(triangle, triangle + 6, vertices);
+	for (std::size_t i = 6; i < floats; i++) {
+		vertices[i] = std::sin((float)(i + index));
+	}
+}
+
+std::vector<unsigned char> makeTexture(unsigned int index) {
+	std::vector<unsigned char> pixels(TEXTURE_SIZE * TEXTURE_SIZE * 4);
+	for (unsigned int y = 0; y < TEXTURE_SIZE; y++) {
+		for (unsigned int x = 0; x < TEXTURE_SIZE; x++) {
+			unsigned char* p = &pixels[(y * TEXTURE_SIZE + x) * 4];
+			bool checker = ((x >> 6) + (y >> 6) + index) & 1;
+			p[0] = checker ? 255 : (unsigned char)(index * 37);
+			p[1] = checker ? (unsigned char)(index * 91) : 64;
+			p[2] = (unsigned char)(x ^ y);
+			p[3] = 255;
+		}
+	}
+	return pixels;
+}
+
+// the VAO has to be made on the render thread, vertex arrays aren't shared between contexts
+unsigned int makeVertexArray(unsigned int buffer) {
+	unsigned int VAO;
+	glGenVertexArrays(1, &VAO);
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
+	glBindVertexArray(0);
+	return VAO;
+}
+
+unsigned int compileProgram() {
+	unsigned int vertexShader = glCreateShader(GL_VERTEX_SHADER);
+	glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
+	glCompileShader(vertexShader);
+	unsigned int fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+	glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
+	glCompileShader(fragmentShader);
+	unsigned int program = glCreateProgram();
+	glAttachShader(program, vertexShader);
+	glAttachShader(program, fragmentShader);
+	glLinkProgram(program);
+	int success;
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+	if (!success) {
+		char infoLog[512];
+		glGetProgramInfoLog(program, 512, NULL, infoLog);
+		printf("ERROR::SHADER::PROGRAM::LINKING_FAILED\n%s\n", infoLog);
+	}
+	glDeleteShader(vertexShader);
+	glDeleteShader(fragmentShader);
+	return program;
+}
+
+// sum of the framebuffer, to check both paths end up drawing the same thing
+unsigned long long framebufferChecksum() {
+	std::vector<unsigned char> pixels(SCR_WIDTH * SCR_HEIGHT * 4);
+	glReadPixels(0, 0, SCR_WIDTH, SCR_HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+	unsigned long long sum = 0;
+	for (std::size_t i = 0; i < pixels.size(); i++) {
+		sum += pixels[i] * (i % 251 + 1);
+	}
+	return sum;
+}
+
+// Frames are paced to 60 Hz, as vsync would, and a frame that takes longer
+// than two intervals counts as a hitch. The run keeps going until everything
+// is drawn and then maxFrames more, at most.
+// usage: async-upload-benchmark [meshes] [MB per mesh] [textures] [max frames]
+int main(int argc, char** argv) {
+	unsigned int meshCount = argc > 1 ? (unsigned int)atoi(argv[1]) : 64;
+	std::size_t meshBytes = (std::size_t)(argc > 2 ? atof(argv[2]) : 4.0) * 1048576;
+	unsigned int textureCount = argc > 3 ? (unsigned int)atoi(argv[3]) : 16;
+	int maxFrames = argc > 4 ? atoi(argv[4]) : 600;
+	if (textureCount == 0) {
+		textureCount = 1;
+	}
+
+	glfwInit();
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+	GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Learn OpenGL", NULL, NULL);
+	if (window == NULL) {
+		printf("Failed to create GLFW window\n");
+		glfwTerminate();
+		return -1;
+	}
+
+	// an invisible window whose context shares objects with the main one, for the upload thread
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	GLFWwindow* uploadWindow = glfwCreateWindow(1, 1, "", NULL, window);
+	if (uploadWindow == NULL) {
+		printf("Failed to create the shared GLFW window\n");
+		glfwTerminate();
+		return -1;
+	}
+
+	glfwMakeContextCurrent(window);
+	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+		glfwTerminate();
+		printf("Failed to initialize GLAD\n");
+		return -1;
+	}
+
+	printf("%s / %s\n", (const char*)glGetString(GL_RENDERER), (const char*)glGetString(GL_VERSION));
+	printf("loading %u meshes of %.1f MB and %u textures of %ux%u at frame %d\n", meshCount, meshBytes / 1048576.0,
+		textureCount, TEXTURE_SIZE, TEXTURE_SIZE, LOAD_FRAME);
+	glfwSwapInterval(0);
+
+	unsigned int program = compileProgram();
+	glUseProgram(program);
+	glUniform1i(glGetUniformLocation(program, "image"), 0);
+	glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+
+	unsigned long long checksums[2] = { 0, 0 };
+	for (int pass = 0; pass < 2 && !glfwWindowShouldClose(window); pass++) {
+		bool async = pass == 1;
+		UploadService* uploads = NULL;
+		if (async) {
+			uploads = new UploadService([=](bool current) { glfwMakeContextCurrent(current ? uploadWindow : NULL); });
+		}
+
+		// texture files are taken as already decoded, the meshes are generated during the load
+		std::vector<std::vector<unsigned char>> images;
+		for (unsigned int i = 0; i < textureCount; i++) {
+			images.push_back(makeTexture(i));
+		}
+
+		std::vector<SceneObject> objects(meshCount);
+		std::vector<unsigned int> textures;
+		unsigned int meshesReady = 0;
+		int loadedFrame = -1;
+		std::vector<double> frameTimes;
+
+		double last = glfwGetTime();
+		for (int frame = 0; frame < maxFrames && (loadedFrame < 0 || frame < loadedFrame + LOAD_FRAME); frame++) {
+			if (frame == LOAD_FRAME) {
+				for (unsigned int i = 0; i < meshCount; i++) {
+					auto fill = [=](void* destination, std::size_t size) {
+						fillMesh(i, meshCount, (float*)destination, size / sizeof(float));
+					};
+					if (async) {
+						uploads->uploadBuffer(meshBytes, fill, GL_STATIC_DRAW, [&, i](unsigned int buffer) {
+							// 0 if the upload failed, the mesh is never drawn then
+							if (buffer != 0) {
+								objects[i].buffer = buffer;
+								objects[i].VAO = makeVertexArray(buffer);
+							}
+							meshesReady++;
+						});
+					}
+					else {
+						glGenBuffers(1, &objects[i].buffer);
+						glBindBuffer(GL_ARRAY_BUFFER, objects[i].buffer);
+						glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)meshBytes, NULL, GL_STATIC_DRAW);
+						fill(glMapBufferRange(GL_ARRAY_BUFFER, 0, (GLsizeiptr)meshBytes, GL_MAP_WRITE_BIT), meshBytes);
+						glUnmapBuffer(GL_ARRAY_BUFFER);
+						objects[i].VAO = makeVertexArray(objects[i].buffer);
+						meshesReady++;
+					}
+				}
+				for (unsigned int i = 0; i < textureCount; i++) {
+					if (async) {
+						uploads->uploadTexture2D(std::move(images[i]), TEXTURE_SIZE, TEXTURE_SIZE, GL_RGBA8, GL_RGBA,
+							GL_UNSIGNED_BYTE, true, [&](unsigned int texture) { textures.push_back(texture); });
+					}
+					else {
+						unsigned int texture;
+						glGenTextures(1, &texture);
+						glBindTexture(GL_TEXTURE_2D, texture);
+						glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, TEXTURE_SIZE, TEXTURE_SIZE, 0, GL_RGBA, GL_UNSIGNED_BYTE, images[i].data());
+						glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+						glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+						glGenerateMipmap(GL_TEXTURE_2D);
+						textures.push_back(texture);
+					}
+				}
+			}
+			if (async) {
+				uploads->poll();
+			}
+			if (loadedFrame < 0 && meshesReady == meshCount && textures.size() == textureCount && frame >= LOAD_FRAME) {
+				loadedFrame = frame;
+			}
+
+			// whatever has arrived so far, meshes without their texture yet aren't drawn
+			glClear(GL_COLOR_BUFFER_BIT);
+			for (unsigned int i = 0; i < meshCount; i++) {
+				if (objects[i].VAO != 0 && !textures.empty()) {
+					glBindTexture(GL_TEXTURE_2D, textures[i % textures.size()]);
+					glBindVertexArray(objects[i].VAO);
+					glDrawArrays(GL_TRIANGLES, 0, 3);
+				}
+			}
+
+			glfwSwapBuffers(window);
+			glfwPollEvents();
+
+			double now = glfwGetTime();
+			frameTimes.push_back((now - last) * 1000.0);
+			double wait = FRAME_BUDGET_MS - (now - last) * 1000.0;
+			if (wait > 0.0) {
+				std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(wait));
+			}
+			last = glfwGetTime();
+		}
+		glFinish();
+		checksums[pass] = framebufferChecksum();
+
+		std::vector<double> sorted(frameTimes.begin() + 1, frameTimes.end());
+		std::sort(sorted.begin(), sorted.end());
+		double median = sorted[sorted.size() / 2];
+		double worst = sorted.back();
+		unsigned int hitches = 0;
+		for (double ms : sorted) {
+			hitches += ms > 2.0 * FRAME_BUDGET_MS ? 1 : 0;
+		}
+		printf("%-6s frame work median %7.3f ms, worst %8.3f ms, %3u hitches, everything drawn %d frames after the request\n",
+			async ? "async:" : "sync:", median, worst, hitches, loadedFrame < 0 ? -1 : loadedFrame - LOAD_FRAME);
+		if (async) {
+			const UploadService::Stats& stats = uploads->getStats();
+			printf("       %u uploads, %u failed, %.1f MB, latency %.2f ms average, %.2f ms worst\n", stats.completed,
+				stats.failed, stats.bytes / 1048576.0, stats.latencyMs / (stats.completed ? stats.completed : 1),
+				stats.maxLatencyMs);
+			delete uploads;
+		}
+
+		for (SceneObject& object : objects) {
+			glDeleteVertexArrays(1, &object.VAO);
+			glDeleteBuffers(1, &object.buffer);
+		}
+		glDeleteTextures((GLsizei)textures.size(), textures.data());
+	}
+	printf("%s\n", checksums[0] == checksums[1] ? "same image" : "IMAGES DIFFER");
+
+	glDeleteProgram(program);
+	glfwDestroyWindow(uploadWindow);
+	glfwTerminate();
+	return 0;
+}
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
+	glViewport(0, 0, width, height);
+}
@@ -0,0 +1,237 @@
+#include "clustered-lighting.h"
+#include <GLFW/glfw3.h>
+#include <chrono>
+#include <cstdlib>
+#include <random>
+
+using namespace maths;
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+
+const float AREA = 120.0f;   // side of the ground the lights move over
+
+// a box of 6 faces, 4 vertices each: position, normal, color
+void addBox(std::vector<float>& vertices, std::vector<unsigned int>& indices, const vec3& lo, const vec3& hi, const vec3& color) {
+	const float normals[6][3] = { { 1,0,0 }, { -1,0,0 }, { 0,1,0 }, { 0,-1,0 }, { 0,0,1 }, { 0,0,-1 } };
+	for (int face = 0; face < 6; face++) {
+		vec3 n(normals[face][0], normals[face][1], normals[face][2]);
+		// two axes spanning the face, u x v = n so the winding is counter-clockwise
+		vec3 u = std::fabs(n.y) > 0.5f ? vec3(0.0f, 0.0f, n.y) : vec3(-n.z, 0.0f, n.x);
+		vec3 v = cross(n, u);
+		vec3 center = (lo + hi) * 0.5f, half = (hi - lo) * 0.5f;
+		unsigned int base = (unsigned int)(vertices.size() / 9);
+		for (int corner = 0; corner < 4; corner++) {
+			float su = (corner == 1 || corner == 2) ? 1.0f : -1.0f, sv = corner >= 2 ? 1.0f : -1.0f;
+			vec3 p = center + (n + u * su + v * sv) * half;
+			vertices.insert(vertices.end(), { p.x, p.y, p.z, n.x, n.y, n.z, color.x, color.y, color.z });
+		}
+		indices.insert(indices.end(), { base, base + 1, base + 2, base, base + 2, base + 3 });
+	}
+}
+
+// lights wander in small circles around where they start
+void moveLights(const std::vector<PointLight>& base, std::vector<PointLight>& lights, float time) {
+	for (std::size_t i = 0; i < base.size(); i++) {
+		float phase = (float)i * 0.61f + time * (0.5f + (i % 7) * 0.1f);
+		lights[i] = base[i];
+		lights[i].position[0] += 2.0f * std::cos(phase);
+		lights[i].position[2] += 2.0f * std::sin(phase);
+	}
+}
+
+// usage: clustered-lighting-benchmark [max lights] [frames] [most lights shaded without clusters]
+int main(int argc, char** argv) {
+	unsigned int maxLights = argc > 1 ? (unsigned int)atoi(argv[1]) : 10000;
+	int frames = argc > 2 ? atoi(argv[2]) : 10;
+	unsigned int naiveLimit = argc > 3 ? (unsigned int)atoi(argv[3]) : 1000;
+
+	// 4.3 for the compute assignment, a 3.3 context only gets the CPU one
+	glfwInit();
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+	GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Learn OpenGL", NULL, NULL);
+	if (window == NULL) {
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+		window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Learn OpenGL", NULL, NULL);
+	}
+	if (window == NULL) {
+		printf("Failed to create GLFW window\n");
+		glfwTerminate();
+		return -1;
+	}
+
+	glfwMakeContextCurrent(window);
+	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+		glfwTerminate();
+		printf("Failed to initialize GLAD\n");
+		return -1;
+	}
+	loadGLExtensions((GLADloadproc)glfwGetProcAddress);
+
+	printf("%s / %s, up to %u lights, %d frames\n", (const char*)glGetString(GL_RENDERER), (const char*)glGetString(GL_VERSION),
+		maxLights, frames);
+	glfwSwapInterval(0);
+
+	Shader shader("clustered-lighting.vs", "../../../shaders/fragment/clustered-lighting.fs");
+	GLint viewLocation = glGetUniformLocation(shader.ID, "view");
+	GLint projectionLocation = glGetUniformLocation(shader.ID, "projection");
+	GLint clusteredLocation = glGetUniformLocation(shader.ID, "clustered");
+
+	// the ground and a grid of blocks of different heights
+	std::mt19937 rng(11);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	std::vector<float> vertices;
+	std::vector<unsigned int> indices;
+	addBox(vertices, indices, vec3(-AREA * 0.5f, -1.0f, -AREA * 0.5f), vec3(AREA * 0.5f, 0.0f, AREA * 0.5f), vec3(0.6f, 0.6f, 0.6f));
+	for (int z = 0; z < 12; z++) {
+		for (int x = 0; x < 12; x++) {
+			vec3 lo(-AREA * 0.5f + 4.0f + x * 10.0f, 0.0f, -AREA * 0.5f + 4.0f + z * 10.0f);
+			float height = 1.0f + 6.0f * unit(rng);
+			addBox(vertices, indices, lo, lo + vec3(4.0f, height, 4.0f), vec3(0.5f + 0.4f * unit(rng), 0.5f + 0.4f * unit(rng), 0.7f));
+		}
+	}
+	unsigned int vao, vbo, ebo;
+	glGenVertexArrays(1, &vao);
+	glGenBuffers(1, &vbo);
+	glGenBuffers(1, &ebo);
+	glBindVertexArray(vao);
+	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 9 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 9 * sizeof(float), (void*)(3 * sizeof(float)));
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 9 * sizeof(float), (void*)(6 * sizeof(float)));
+	glEnableVertexAttribArray(2);
+	glBindVertexArray(0);
+
+	// small lights all over the ground, denser as the count grows
+	std::vector<PointLight> baseLights(maxLights), lights(maxLights);
+	for (PointLight& light : baseLights) {
+		light.position[0] = (unit(rng) - 0.5f) * AREA;
+		light.position[1] = 0.5f + 4.0f * unit(rng);
+		light.position[2] = (unit(rng) - 0.5f) * AREA;
+		light.radius = 1.5f + 2.5f * unit(rng);
+		light.color[0] = unit(rng);
+		light.color[1] = unit(rng);
+		light.color[2] = unit(rng);
+		light.padding = 0.0f;
+	}
+
+	const float zNear = 0.5f, zFar = 200.0f;
+	mat4 projection = perspective(radians(60.0f), (float)SCR_WIDTH / SCR_HEIGHT, zNear, zFar);
+	ClusteredLighting cpuLighting(maxLights, 512, false, "../../../shaders/");
+	ClusteredLighting gpuLighting(maxLights, 512, true, "../../../shaders/");
+	cpuLighting.setProjection(projection, zNear, zFar, SCR_WIDTH, SCR_HEIGHT);
+	gpuLighting.setProjection(projection, zNear, zFar, SCR_WIDTH, SCR_HEIGHT);
+	printf("%u x %u x %u clusters, compute assignment %s\n\n", ClusteredLighting::CLUSTERS_X, ClusteredLighting::CLUSTERS_Y,
+		ClusteredLighting::CLUSTERS_Z, gpuLighting.useCompute ? "available" : "not available");
+
+	glEnable(GL_DEPTH_TEST);
+	glEnable(GL_CULL_FACE);
+	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+
+	std::vector<unsigned char> reference(SCR_WIDTH * SCR_HEIGHT * 4), pixels(reference.size());
+	const char* names[] = { "all lights", "clustered, CPU assign", "clustered, GPU assign" };
+	for (unsigned int count = 10; count <= maxLights && !glfwWindowShouldClose(window); count *= 10) {
+		bool haveReference = false;
+		for (int path = 0; path < 3; path++) {
+			if ((path == 0 && count > naiveLimit) || (path == 2 && !gpuLighting.useCompute)) {
+				continue;
+			}
+			ClusteredLighting& lighting = path == 2 ? gpuLighting : cpuLighting;
+			auto viewAt = [](float time) {
+				float angle = 0.4f + time * 0.02f;
+				return lookAt(vec3(std::cos(angle) * 50.0f, 25.0f, std::sin(angle) * 50.0f), vec3(0.0f, 0.0f, 0.0f), vec3(0.0f, 1.0f, 0.0f));
+			};
+
+			auto drawFrame = [&](float time) {
+				mat4 view = viewAt(time);
+				moveLights(baseLights, lights, time);
+				lighting.update(lights.data(), count, view);
+
+				glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+				shader.use();
+				glUniformMatrix4fv(viewLocation, 1, GL_FALSE, view.ptr());
+				glUniformMatrix4fv(projectionLocation, 1, GL_FALSE, projection.ptr());
+				lighting.bind(shader.ID);
+				glUniform1i(clusteredLocation, path == 0 ? 0 : 1);
+				glBindVertexArray(vao);
+				glDrawElements(GL_TRIANGLES, (GLsizei)indices.size(), GL_UNSIGNED_INT, 0);
+				glBindVertexArray(0);
+			};
+
+			auto start = std::chrono::high_resolution_clock::now();
+			for (int frame = 0; frame < frames; frame++) {
+				drawFrame((float)frame);
+				glfwSwapBuffers(window);
+				glfwPollEvents();
+			}
+			glFinish();
+			double total = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+			// the last frame again, read back before the swap, against the first path that ran
+			drawFrame((float)(frames - 1));
+			glReadPixels(0, 0, SCR_WIDTH, SCR_HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, (haveReference ? pixels : reference).data());
+			std::size_t differing = 0;
+			int maxDifference = 0;
+			for (std::size_t p = 0; haveReference && p < pixels.size(); p++) {
+				int difference = std::abs((int)pixels[p] - (int)reference[p]);
+				maxDifference = difference > maxDifference ? difference : maxDifference;
+				differing += difference > 1 ? 1 : 0;
+			}
+
+			// the assignment alone, upload and compute pass included, with
+			// nothing in flight for the upload to wait on
+			double assignTime = 0.0;
+			for (int i = 0; i < 3; i++) {
+				glFinish();
+				start = std::chrono::high_resolution_clock::now();
+				lighting.update(lights.data(), count, viewAt((float)(frames - 1)));
+				glFinish();
+				assignTime += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+			}
+
+			printf("%5u lights  %-22s %9.2f ms/frame  assign %8.3f ms", count, names[path], total / frames, assignTime / 3);
+			if (path == 1) {
+				const ClusteredLighting::Stats& stats = cpuLighting.getStats();
+				printf("  %.1f lights/cluster (max %u, %u dropped)", (double)stats.assigned / ClusteredLighting::CLUSTER_COUNT,
+					stats.maxPerCluster, stats.overflowed);
+			}
+			if (haveReference) {
+				printf("  %zu channels differ, max %d", differing, maxDifference);
+			}
+			printf("\n");
+			haveReference = true;
+		}
+		printf("\n");
+	}
+
+	cpuLighting.del();
+	gpuLighting.del();
+	glDeleteVertexArrays(1, &vao);
+	glDeleteBuffers(1, &vbo);
+	glDeleteBuffers(1, &ebo);
+	glDeleteProgram(shader.ID);
+
+	glfwTerminate();
+	return 0;
+}
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
+	glViewport(0, 0, width, height);
+}
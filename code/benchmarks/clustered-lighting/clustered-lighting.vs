@@ -0,0 +1,20 @@
+#version 330 core
+layout (location = 0) in vec3 pos;
+layout (location = 1) in vec3 normal;
+layout (location = 2) in vec3 color;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+// what clustered-lighting.fs shades with
+out vec3 viewPosition;
+out vec3 viewNormal;
+out vec3 albedo;
+
+void main() {
+    vec4 p = view * vec4(pos, 1.0);
+    viewPosition = p.xyz;
+    viewNormal = mat3(view) * normal;
+    albedo = color;
+    gl_Position = projection * p;
+}
@@ -0,0 +1,162 @@
+#include "culling.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace maths;
+using namespace culling;
+
+// the usual array of structs, culled one object at a time with an early out
+struct Object {
+	vec3 center;
+	vec3 extent;
+	float radius;
+};
+
+std::size_t cullSpheresAoS(const std::vector<Object>& objects, const vec4 planes[6], std::vector<unsigned int>& visible) {
+	visible.clear();
+	for (std::size_t i = 0; i < objects.size(); i++) {
+		const Object& o = objects[i];
+		bool inside = true;
+		for (int p = 0; p < 6 && inside; p++) {
+			const vec4& n = planes[p];
+			inside = o.center.x * n.x + n.w + o.center.y * n.y + o.center.z * n.z + o.radius > 0.0f;
+		}
+		if (inside) {
+			visible.push_back((unsigned int)i);
+		}
+	}
+	return visible.size();
+}
+
+std::size_t cullBoxesAoS(const std::vector<Object>& objects, const vec4 planes[6], std::vector<unsigned int>& visible) {
+	visible.clear();
+	for (std::size_t i = 0; i < objects.size(); i++) {
+		const Object& o = objects[i];
+		bool inside = true;
+		for (int p = 0; p < 6 && inside; p++) {
+			const vec4& n = planes[p];
+			float d = o.center.x * n.x + n.w + o.center.y * n.y + o.center.z * n.z;
+			d = d + o.extent.x * std::fabs(n.x) + o.extent.y * std::fabs(n.y) + o.extent.z * std::fabs(n.z);
+			inside = d > 0.0f;
+		}
+		if (inside) {
+			visible.push_back((unsigned int)i);
+		}
+	}
+	return visible.size();
+}
+
+std::size_t cullRectAoS(const std::vector<Object>& objects, const vec4& rect, std::vector<unsigned int>& visible) {
+	visible.clear();
+	for (std::size_t i = 0; i < objects.size(); i++) {
+		const Object& o = objects[i];
+		if (o.center.x + o.extent.x >= rect.x && o.center.x - o.extent.x <= rect.z &&
+			o.center.y + o.extent.y >= rect.y && o.center.y - o.extent.y <= rect.w) {
+			visible.push_back((unsigned int)i);
+		}
+	}
+	return visible.size();
+}
+
+// average ms of iterations calls of f, after one warm-up call
+template <typename F>
+double timeMs(int iterations, F f) {
+	f();
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < iterations; i++) {
+		f();
+	}
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+void report(const char* name, double ms, std::size_t objects, std::size_t visible, bool same) {
+	printf("%-28s %8.3f ms  %9.0f objects/ms  %7zu visible  %s\n", name, ms, objects / ms, visible,
+		same ? "same list" : "LIST DIFFERS");
+}
+
+// usage: culling-benchmark [object count] [max threads] [iterations]
+int main(int argc, char** argv) {
+	std::size_t objectCount = argc > 1 ? (std::size_t)atoi(argv[1]) : 1000000;
+	unsigned int maxThreads = argc > 2 ? (unsigned int)atoi(argv[2]) : std::thread::hardware_concurrency();
+	int iterations = argc > 3 ? atoi(argv[3]) : 20;
+	if (maxThreads == 0) {
+		maxThreads = 1;
+	}
+
+#if defined(MATHS_AVX2)
+	printf("culling.h path: AVX2, ");
+#elif defined(MATHS_SSE)
+	printf("culling.h path: SSE, ");
+#else
+	printf("culling.h path: scalar, ");
+#endif
+	printf("%zu objects, %d iterations, %u hardware threads\n", objectCount, iterations, std::thread::hardware_concurrency());
+
+	// boxes and spheres scattered over a 2000 x 2000 field, seen from the middle
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<float> field(-1000.0f, 1000.0f);
+	std::uniform_real_distribution<float> height(0.0f, 40.0f);
+	std::uniform_real_distribution<float> size(0.5f, 4.0f);
+	std::vector<Object> objects(objectCount);
+	CullingSet set;
+	for (std::size_t i = 0; i < objectCount; i++) {
+		vec3 center(field(rng), height(rng), field(rng));
+		if (i % 2 == 0) {
+			vec3 extent(size(rng), size(rng), size(rng));
+			set.addBox(center - extent, center + extent);
+			objects[i] = { center, extent, length(extent) };
+		}
+		else {
+			float r = size(rng);
+			set.addSphere(center, r);
+			objects[i] = { center, vec3(r), r };
+		}
+	}
+	mat4 viewProjection = perspective(radians(60.0f), 800.0f / 600.0f, 0.5f, 400.0f) *
+		lookAt(vec3(0.0f, 30.0f, 0.0f), vec3(100.0f, 10.0f, 30.0f), vec3(0.0f, 1.0f, 0.0f));
+	vec4 planes[6];
+	frustumPlanes(viewProjection, planes);
+
+	std::vector<unsigned int> reference, visible;
+
+	printf("\n-- frustum, spheres --\n");
+	double ms = timeMs(iterations, [&]() { cullSpheresAoS(objects, planes, reference); });
+	report("scalar AoS", ms, objectCount, reference.size(), true);
+	ms = timeMs(iterations, [&]() { set.cullSpheres(planes, visible); });
+	report("SoA SIMD", ms, objectCount, visible.size(), visible == reference);
+
+	printf("\n-- frustum, boxes --\n");
+	ms = timeMs(iterations, [&]() { cullBoxesAoS(objects, planes, reference); });
+	report("scalar AoS", ms, objectCount, reference.size(), true);
+	ms = timeMs(iterations, [&]() { set.cullBoxes(planes, visible); });
+	report("SoA SIMD", ms, objectCount, visible.size(), visible == reference);
+
+	for (unsigned int threads : JobSystem::threadCountSweep(maxThreads)) {
+		JobSystem jobs(threads);
+		ms = timeMs(iterations, [&]() { set.cullBoxes(planes, visible, &jobs); });
+		char name[64];
+		snprintf(name, sizeof(name), "SoA SIMD, %u thread%s", threads, threads == 1 ? "" : "s");
+		report(name, ms, objectCount, visible.size(), visible == reference);
+	}
+
+	// quads around NDC, as the instancing samples draw them, against the viewport
+	printf("\n-- viewport rect, NDC quads --\n");
+	std::uniform_real_distribution<float> ndc(-3.0f, 3.0f);
+	std::uniform_real_distribution<float> quad(0.005f, 0.05f);
+	CullingSet quads;
+	for (std::size_t i = 0; i < objectCount; i++) {
+		vec3 center(ndc(rng), ndc(rng), 0.0f);
+		vec3 extent(quad(rng), quad(rng), 0.0f);
+		quads.addBox(center - extent, center + extent);
+		objects[i] = { center, extent, length(extent) };
+	}
+	vec4 viewport(-1.0f, -1.0f, 1.0f, 1.0f);
+	ms = timeMs(iterations, [&]() { cullRectAoS(objects, viewport, reference); });
+	report("scalar AoS", ms, objectCount, reference.size(), true);
+	ms = timeMs(iterations, [&]() { quads.cullRect(viewport, visible); });
+	report("SoA SIMD", ms, objectCount, visible.size(), visible == reference);
+	return 0;
+}
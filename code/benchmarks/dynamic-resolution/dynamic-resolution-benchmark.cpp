@@ -0,0 +1,170 @@
+#include "dynamic-resolution.h"
+#include "render-target-pool.h"
+#include <GLFW/glfw3.h>
+#include <chrono>
+#include <cstdlib>
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+
+// the scene gets twice as heavy in the middle third of the run
+int iterationsAt(int frame, int frames, int base) {
+	return frame >= frames / 3 && frame < frames * 2 / 3 ? base * 2 : base;
+}
+
+// usage: dynamic-resolution-benchmark [frames] [target ms, 0: 60% of full resolution] [iterations] [history csv]
+int main(int argc, char** argv) {
+	int frames = argc > 1 ? atoi(argv[1]) : 180;
+	float targetMs = argc > 2 ? (float)atof(argv[2]) : 0.0f;
+	int iterations = argc > 3 ? atoi(argv[3]) : 64;
+	const char* historyPath = argc > 4 ? argv[4] : NULL;
+
+	glfwInit();
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+	GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Learn OpenGL", NULL, NULL);
+	if (window == NULL) {
+		printf("Failed to create GLFW window\n");
+		glfwTerminate();
+		return -1;
+	}
+
+	glfwMakeContextCurrent(window);
+	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+		glfwTerminate();
+		printf("Failed to initialize GLAD\n");
+		return -1;
+	}
+
+	printf("%s / %s, %d frames, %d iterations (twice that in the middle third)\n\n", (const char*)glGetString(GL_RENDERER),
+		(const char*)glGetString(GL_VERSION), frames, iterations);
+	glfwSwapInterval(0);
+
+	Shader sceneShader("../../../shaders/vertex/fullscreen.vs", "scene.fs");
+	Upscaler upscaler("../../../shaders/");
+	unsigned int emptyVAO;
+	glGenVertexArrays(1, &emptyVAO);
+
+	// the target is window sized, the scene draws into its lower left corner
+	RenderTargetPool pool;
+	GLuint color = pool.acquire(RenderTargetDesc(SCR_WIDTH, SCR_HEIGHT, GL_RGBA8));
+	unsigned int framebuffer;
+	glGenFramebuffers(1, &framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, color, 0);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	const char* names[] = { "full resolution", "dynamic, bilinear", "dynamic, sharpened" };
+	for (int run = 0; run < 3 && !glfwWindowShouldClose(window); run++) {
+		FrameProfiler profiler;
+		DynamicResolution resolution(targetMs > 0.0f ? targetMs : 1000.0f);
+		if (run == 0) {
+			// scale pinned at 1
+			resolution.minScale = 1.0f;
+		}
+		upscaler.sharpness = run == 2 ? 0.5f : 0.0f;
+
+		auto drawFrame = [&](int frame) {
+			profiler.beginFrame();
+			resolution.update(profiler, "scene", SCR_WIDTH, SCR_HEIGHT);
+
+			glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+			glViewport(0, 0, resolution.renderWidth, resolution.renderHeight);
+			profiler.beginGpu("scene");
+			sceneShader.use();
+			glUniform2f(glGetUniformLocation(sceneShader.ID, "resolution"), (float)resolution.renderWidth, (float)resolution.renderHeight);
+			sceneShader.setFloat("time", frame / 60.0f);
+			sceneShader.setInt("iterations", iterationsAt(frame, frames, iterations));
+			glBindVertexArray(emptyVAO);
+			glDrawArrays(GL_TRIANGLES, 0, 3);
+			profiler.endGpu();
+
+			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+			glViewport(0, 0, SCR_WIDTH, SCR_HEIGHT);
+			profiler.beginGpu("upscale");
+			upscaler.draw(color, SCR_WIDTH, SCR_HEIGHT, resolution.renderWidth, resolution.renderHeight);
+			profiler.endGpu();
+		};
+
+		// one frame to warm up, the very first timer query can come back garbage
+		drawFrame(0);
+		glFinish();
+		profiler.flush();
+		profiler.resetStats();
+
+		auto start = std::chrono::high_resolution_clock::now();
+		for (int frame = 0; frame < frames; frame++) {
+			drawFrame(frame);
+			glfwSwapBuffers(window);
+			glfwPollEvents();
+		}
+		glFinish();
+		double total = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		profiler.flush();
+
+		if (run == 0 && targetMs <= 0.0f) {
+			targetMs = 0.6f * (float)profiler.find("scene")->average();
+			printf("target %.2f ms of scene GPU time\n", targetMs);
+		}
+
+		// over the timed frames, the warm-up one is first in the history
+		unsigned int measured = 0, over = 0;
+		double scaleSum = 0.0, minScale = 1.0;
+		for (const DynamicResolution::Sample& sample : resolution.getHistory()) {
+			if (sample.frame == 0) {
+				continue;
+			}
+			scaleSum += sample.scale;
+			minScale = sample.scale < minScale ? sample.scale : minScale;
+			if (sample.gpuMs >= 0.0) {
+				measured++;
+				over += sample.gpuMs > targetMs * 1.1 ? 1 : 0;
+			}
+		}
+		printf("%-20s %7.2f ms/frame  scene %6.2f ms GPU (max %6.2f)  upscale %5.2f ms GPU  scale avg %.2f min %.2f  %3u of %3u frames over target + 10%%\n",
+			names[run], total / frames, profiler.find("scene")->average(), profiler.find("scene")->max,
+			profiler.find("upscale")->average(), scaleSum / frames, minScale, over, measured);
+
+		if (run == 1) {
+			// the controller at work: every 10th frame
+			printf("%-20s", "  frame/scale/ms");
+			for (const DynamicResolution::Sample& sample : resolution.getHistory()) {
+				if (sample.frame > 0 && sample.frame % 10 == 0) {
+					printf(" %llu/%.2f/%.1f", sample.frame, sample.scale, sample.gpuMs);
+				}
+			}
+			printf("\n");
+			if (historyPath) {
+				FILE* out = fopen(historyPath, "w");
+				if (out) {
+					resolution.writeHistory(out);
+					fclose(out);
+				}
+			}
+		}
+		profiler.del();
+	}
+
+	glDeleteFramebuffers(1, &framebuffer);
+	pool.del();
+	upscaler.del();
+	glDeleteVertexArrays(1, &emptyVAO);
+	glDeleteProgram(sceneShader.ID);
+
+	glfwTerminate();
+	return 0;
+}
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
+	glViewport(0, 0, width, height);
+}
@@ -0,0 +1,18 @@
+#version 330 core
+// fill-bound on purpose: a few iterations of a Julia set per pixel
+out vec4 FragColor;
+
+uniform vec2 resolution;   // of the render area
+uniform float time;
+uniform int iterations;
+
+void main() {
+    vec2 z = (gl_FragCoord.xy / resolution * 2.0 - 1.0) * vec2(1.6, 1.2);
+    vec2 c = vec2(-0.8 + 0.1 * sin(time * 0.5), 0.156);
+    int i = 0;
+    for (; i < iterations && dot(z, z) < 4.0; i++) {
+        z = vec2(z.x * z.x - z.y * z.y, 2.0 * z.x * z.y) + c;
+    }
+    float t = float(i) / float(iterations);
+    FragColor = vec4(0.5 + 0.5 * cos(6.2831 * (t + vec3(0.0, 0.33, 0.67))), 1.0);
+}
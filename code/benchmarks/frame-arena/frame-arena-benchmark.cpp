@@ -0,0 +1,192 @@
+#define ALLOC_COUNTER_IMPLEMENTATION
+#include "alloc-counter.h"
+#include "frame-arena.h"
+#include "shader.h"
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <cstdlib>
+#include <random>
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+
+const unsigned int LIGHT_COUNT = 8;
+const unsigned int DRAWN_OBJECTS = 256;
+
+struct Object {
+	float x, y;
+	unsigned int material;
+};
+
+struct DrawItem {
+	unsigned int key;     // sort by material, then depth
+	unsigned int object;
+};
+
+// What a frame builds and throws away: the visible objects as a sorted draw
+// list, a label per drawn object (what a debug overlay would print) and the
+// names of the light uniforms.
+template <typename DrawList, typename MakeLabel, typename LightName>
+void renderFrame(const Shader& shader, const std::vector<Object>& objects, float time, DrawList& draws,
+	MakeLabel makeLabel, LightName lightName, std::size_t& labelBytes) {
+	for (unsigned int i = 0; i < objects.size(); i++) {
+		const Object& object = objects[i];
+		if (std::abs(object.x + 0.2f * std::sin(time)) < 1.0f) {
+			unsigned int depth = (unsigned int)((object.y + 1.0f) * 1000.0f);
+			draws.push_back({ (object.material << 16) | depth, i });
+		}
+	}
+	std::sort(draws.begin(), draws.end(), [](const DrawItem& a, const DrawItem& b) {
+		return a.key < b.key;
+	});
+
+	for (unsigned int i = 0; i < LIGHT_COUNT; i++) {
+		shader.setVec2(lightName(i), std::sin(time + i), std::cos(time + i));
+	}
+	shader.setInt("lightCount", (int)LIGHT_COUNT);
+	shader.setFloat("scale", 0.02f);
+
+	for (std::size_t i = 0; i < draws.size() && i < DRAWN_OBJECTS; i++) {
+		const Object& object = objects[draws[i].object];
+		labelBytes += strlen(makeLabel(draws[i].object, object));
+		shader.setVec2("offset", object.x, object.y);
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+	}
+}
+
+// usage: frame-arena-benchmark [object count] [measured frames]
+int main(int argc, char** argv) {
+	unsigned int objectCount = argc > 1 ? (unsigned int)atoi(argv[1]) : 20000;
+	int measuredFrames = argc > 2 ? atoi(argv[2]) : 300;
+
+	glfwInit();
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+	GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Learn OpenGL", NULL, NULL);
+	if (window == NULL) {
+		printf("Failed to create GLFW window\n");
+		glfwTerminate();
+		return -1;
+	}
+
+	glfwMakeContextCurrent(window);
+	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+		glfwTerminate();
+		printf("Failed to initialize GLAD\n");
+		return -1;
+	}
+
+	printf("%s / %s, %u objects\n", (const char*)glGetString(GL_RENDERER), (const char*)glGetString(GL_VERSION), objectCount);
+	glfwSwapInterval(0);
+
+	Shader shader("frame-arena.vs", "frame-arena.fs");
+
+	float vertices[] = {
+		-0.5f, -0.5f,
+		 0.5f, -0.5f,
+		 0.0f,  0.5f,
+	};
+	unsigned int VAO, VBO;
+	glGenVertexArrays(1, &VAO);
+	glGenBuffers(1, &VBO);
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
+
+	std::mt19937 rng(3);
+	std::uniform_real_distribution<float> position(-1.2f, 1.2f);
+	std::vector<Object> objects(objectCount);
+	for (Object& object : objects) {
+		object = { position(rng), position(rng), (unsigned int)(rng() % 32) };
+	}
+
+	shader.use();
+	glBindVertexArray(VAO);
+	glClearColor(1.0, 1.0, 1.0, 1.0);
+
+	// the same frame with heap containers and strings, then with the frame arena
+	const int warmupFrames = 10;
+	for (int pass = 0; pass < 2 && !glfwWindowShouldClose(window); pass++) {
+		double cpuTime = 0.0;
+		std::size_t labelBytes = 0;
+		unsigned long long allocations = 0, bytes = 0, steadyFrames = 0;
+
+		for (int frame = 0; frame < warmupFrames + measuredFrames; frame++) {
+			glClear(GL_COLOR_BUFFER_BIT);
+			float time = (float)frame / 60.0f;
+
+			double start = glfwGetTime();
+			alloccounter::Snapshot before = alloccounter::snapshot();
+			if (pass == 0) {
+				std::vector<DrawItem> draws;
+				std::string label;
+				std::string name;
+				renderFrame(shader, objects, time, draws,
+					[&](unsigned int index, const Object& object) {
+						label = "object " + std::to_string(index) + " material " + std::to_string(object.material);
+						return label.c_str();
+					},
+					[&](unsigned int light) {
+						name = "lights[" + std::to_string(light) + "]";
+						return name;
+					}, labelBytes);
+			}
+			else {
+				FrameArena& arena = frameArena();
+				arena.reset();
+				FrameVector<DrawItem> draws;
+				renderFrame(shader, objects, time, draws,
+					[&](unsigned int index, const Object& object) {
+						return arena.format("object %u material %u", index, object.material);
+					},
+					[&](unsigned int light) {
+						return arena.format("lights[%u]", light);
+					}, labelBytes);
+			}
+			alloccounter::Snapshot frameAllocations = alloccounter::since(before);
+			double end = glfwGetTime();
+
+			if (frame >= warmupFrames) {
+				cpuTime += end - start;
+				allocations += frameAllocations.allocations;
+				bytes += frameAllocations.bytes;
+				steadyFrames++;
+			}
+
+			glfwSwapBuffers(window);
+			glfwPollEvents();
+		}
+		glFinish();
+
+		printf("%-12s %8.3f ms/frame CPU, %8.1f heap allocations/frame, %9.1f KB/frame (%zu label bytes)\n",
+			pass == 0 ? "heap:" : "frame arena:", cpuTime * 1000.0 / steadyFrames, (double)allocations / steadyFrames,
+			bytes / 1024.0 / steadyFrames, labelBytes);
+	}
+
+	FrameArena& arena = frameArena();
+	printf("arena: %.1f KB peak per frame, %.1f KB capacity, %u heap blocks taken in total\n",
+		arena.peakUsed() / 1024.0, arena.capacity() / 1024.0, arena.heapBlocks());
+
+	glDeleteVertexArrays(1, &VAO);
+	glDeleteBuffers(1, &VBO);
+	shader.del();
+
+	glfwTerminate();
+	return 0;
+}
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
+	glViewport(0, 0, width, height);
+}
@@ -0,0 +1,13 @@
+#version 330 core
+out vec4 FragColor;
+
+uniform vec2 lights[8];
+uniform int lightCount;
+
+void main() {
+    float light = 0.0;
+    for (int i = 0; i < lightCount; i++) {
+        light += lights[i].x * 0.1;
+    }
+    FragColor = vec4(light, 0.5, 0.2, 1.0);
+}
@@ -0,0 +1,9 @@
+#version 330 core
+layout (location = 0) in vec2 pos;
+
+uniform vec2 offset;
+uniform float scale;
+
+void main() {
+    gl_Position = vec4(pos * scale + offset, 0.0, 1.0);
+}
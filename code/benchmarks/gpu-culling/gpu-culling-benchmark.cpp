@@ -0,0 +1,238 @@
+#include "gpu-culling.h"
+#include <GLFW/glfw3.h>
+#include <cstdlib>
+#include <random>
+
+using namespace maths;
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+
+// a cube, an octahedron and a tetrahedron, unit size around the origin
+void addMeshes(MeshPool& pool, std::vector<unsigned int>& meshes) {
+	float cube[] = { -1,-1,-1, 1,-1,-1, 1,1,-1, -1,1,-1, -1,-1,1, 1,-1,1, 1,1,1, -1,1,1 };
+	unsigned int cubeIndices[] = {
+		0,2,1, 0,3,2, 4,5,6, 4,6,7, 0,1,5, 0,5,4, 3,6,2, 3,7,6, 0,4,7, 0,7,3, 1,2,6, 1,6,5,
+	};
+	float octahedron[] = { 1,0,0, -1,0,0, 0,1,0, 0,-1,0, 0,0,1, 0,0,-1 };
+	unsigned int octahedronIndices[] = { 0,2,4, 4,2,1, 1,2,5, 5,2,0, 4,3,0, 1,3,4, 5,3,1, 0,3,5 };
+	float tetrahedron[] = { 1,1,1, -1,-1,1, -1,1,-1, 1,-1,-1 };
+	unsigned int tetrahedronIndices[] = { 0,1,2, 0,3,1, 0,2,3, 1,3,2 };
+	meshes.push_back(pool.add(cube, 8, cubeIndices, 36));
+	meshes.push_back(pool.add(octahedron, 6, octahedronIndices, 24));
+	meshes.push_back(pool.add(tetrahedron, 4, tetrahedronIndices, 12));
+}
+
+bool sphereVisible(const CullObject& object, const vec4 planes[6]) {
+	for (int p = 0; p < 6; p++) {
+		const vec4& n = planes[p];
+		if (n.x * object.center[0] + n.y * object.center[1] + n.z * object.center[2] + n.w <= -object.radius) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// camera circling the middle of the field, looking outwards
+mat4 cameraAt(float time) {
+	float angle = time * 0.5f;
+	vec3 eye(0.0f, 30.0f, 0.0f);
+	vec3 target(std::cos(angle) * 100.0f, 10.0f, std::sin(angle) * 100.0f);
+	return perspective(radians(60.0f), (float)SCR_WIDTH / SCR_HEIGHT, 0.5f, 400.0f) * lookAt(eye, target, vec3(0.0f, 1.0f, 0.0f));
+}
+
+// sum of the framebuffer, to check every path draws the same thing
+unsigned long long framebufferChecksum() {
+	std::vector<unsigned char> pixels(SCR_WIDTH * SCR_HEIGHT * 4);
+	glReadPixels(0, 0, SCR_WIDTH, SCR_HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+	unsigned long long sum = 0;
+	for (std::size_t i = 0; i < pixels.size(); i++) {
+		sum += pixels[i] * (i % 251 + 1);
+	}
+	return sum;
+}
+
+// usage: gpu-culling-benchmark [object count] [frames]
+int main(int argc, char** argv) {
+	unsigned int objectCount = argc > 1 ? (unsigned int)atoi(argv[1]) : 500000;
+	int frames = argc > 2 ? atoi(argv[2]) : 60;
+
+	glfwInit();
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+	GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Learn OpenGL", NULL, NULL);
+	if (window == NULL) {
+		printf("Failed to create GLFW window (GPU culling needs GL 4.3)\n");
+		glfwTerminate();
+		return -1;
+	}
+
+	glfwMakeContextCurrent(window);
+	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+		glfwTerminate();
+		printf("Failed to initialize GLAD\n");
+		return -1;
+	}
+	loadGLExtensions((GLADloadproc)glfwGetProcAddress);
+
+	printf("%s / %s, %u objects, %d frames\n", (const char*)glGetString(GL_RENDERER), (const char*)glGetString(GL_VERSION),
+		objectCount, frames);
+	glfwSwapInterval(0);
+
+	Shader shader("gpu-culling.vs", "gpu-culling.fs");
+	GLint viewProjectionLocation = glGetUniformLocation(shader.ID, "viewProjection");
+
+	MeshPool pool({ { 0, 3 } });
+	std::vector<unsigned int> meshes;
+	addMeshes(pool, meshes);
+	std::vector<DrawElementsIndirectCommand> meshCommands;
+	for (unsigned int mesh : meshes) {
+		meshCommands.push_back(pool.command(mesh));
+	}
+
+	// objects scattered over a 2000 x 2000 field
+	std::mt19937 rng(21);
+	std::uniform_real_distribution<float> field(-1000.0f, 1000.0f);
+	std::uniform_real_distribution<float> height(0.0f, 40.0f);
+	std::vector<CullObject> objects(objectCount);
+	for (CullObject& object : objects) {
+		object = { { field(rng), height(rng), field(rng) }, 0.5f + (rng() % 100) / 50.0f, (unsigned int)(rng() % meshes.size()), { 0, 0, 0 } };
+	}
+
+	GpuCuller culler(objectCount, "../../../shaders/");
+	culler.setMeshes(meshCommands);
+	culler.setObjects(objects);
+	bool hasDrawCount = culler.useDrawCount;
+
+	// MeshPool's VAO only has the position, the object index comes from the
+	// generic attribute value; the culled VAO gets it per instance
+	unsigned int cullVAO;
+	glGenVertexArrays(1, &cullVAO);
+	glBindVertexArray(cullVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, pool.heap.pageBuffer(0));
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, pool.heap.pageBuffer(0));
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
+	culler.attachObjectIndex(1);
+	glBindVertexArray(0);
+
+	unsigned int cpuCommandBuffer;
+	glGenBuffers(1, &cpuCommandBuffer);
+	std::vector<DrawElementsIndirectCommand> cpuCommands;
+	cpuCommands.reserve(objectCount);
+
+	glEnable(GL_DEPTH_TEST);
+	glEnable(GL_CULL_FACE);
+	glClearColor(0.6f, 0.7f, 0.8f, 1.0f);
+
+	const char* names[] = { "CPU cull, draw per object", "CPU cull, multi-draw", "GPU cull, fixed count", "GPU cull, indirect count" };
+	unsigned long long reference = 0;
+	for (int path = 0; path < 4 && !glfwWindowShouldClose(window); path++) {
+		if (path == 3 && !hasDrawCount) {
+			printf("%-26s no glMultiDrawElementsIndirectCount\n", names[path]);
+			continue;
+		}
+		culler.useDrawCount = path == 3;
+
+		// one frame, returns the visible count when the CPU knows it
+		auto drawFrame = [&](float time) -> unsigned int {
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			mat4 viewProjection = cameraAt(time);
+			unsigned int visible = 0;
+			if (path < 2) {
+				vec4 planes[6];
+				frustumPlanes(viewProjection, planes);
+				shader.use();
+				glUniformMatrix4fv(viewProjectionLocation, 1, GL_FALSE, viewProjection.ptr());
+				glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, culler.objectBuffer);
+				cpuCommands.clear();
+				for (unsigned int i = 0; i < objectCount; i++) {
+					if (!sphereVisible(objects[i], planes)) {
+						continue;
+					}
+					visible++;
+					if (path == 0) {
+						glVertexAttribI4ui(1, i, 0, 0, 0);
+						pool.draw(meshes[objects[i].mesh]);
+					}
+					else {
+						DrawElementsIndirectCommand command = meshCommands[objects[i].mesh];
+						command.baseInstance = i;
+						cpuCommands.push_back(command);
+					}
+				}
+				if (path == 0) {
+					pool.unbind();
+				}
+				else {
+					glBindVertexArray(cullVAO);
+					glBindBuffer(GL_DRAW_INDIRECT_BUFFER, cpuCommandBuffer);
+					glBufferData(GL_DRAW_INDIRECT_BUFFER, cpuCommands.size() * sizeof(DrawElementsIndirectCommand),
+						cpuCommands.data(), GL_STREAM_DRAW);
+					glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)0, (GLsizei)cpuCommands.size(), 0);
+					glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+					glBindVertexArray(0);
+				}
+			}
+			else {
+				culler.cull(viewProjection);
+				shader.use();
+				glUniformMatrix4fv(viewProjectionLocation, 1, GL_FALSE, viewProjection.ptr());
+				glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, culler.objectBuffer);
+				glBindVertexArray(cullVAO);
+				culler.draw();
+				glBindVertexArray(0);
+			}
+			return visible;
+		};
+
+		double cpuTime = 0.0;
+		unsigned int visible = 0;
+		double start = glfwGetTime();
+		for (int frame = 0; frame < frames; frame++) {
+			double frameStart = glfwGetTime();
+			visible = drawFrame((float)frame / 60.0f);
+			cpuTime += glfwGetTime() - frameStart;
+
+			glfwSwapBuffers(window);
+			glfwPollEvents();
+		}
+		glFinish();
+		double total = glfwGetTime() - start;
+
+		// the last frame again, read back before the swap
+		visible = drawFrame((float)(frames - 1) / 60.0f);
+		if (path >= 2) {
+			visible = culler.readVisibleCount();
+		}
+		unsigned long long checksum = framebufferChecksum();
+		if (path == 0) {
+			reference = checksum;
+		}
+		printf("%-26s %7u visible, %8.3f ms/frame CPU, %8.3f ms/frame total  %s\n", names[path], visible,
+			cpuTime * 1000.0 / frames, total * 1000.0 / frames, checksum == reference ? "same image" : "IMAGE DIFFERS");
+	}
+
+	glDeleteVertexArrays(1, &cullVAO);
+	glDeleteBuffers(1, &cpuCommandBuffer);
+	culler.del();
+	pool.del();
+	shader.del();
+
+	glfwTerminate();
+	return 0;
+}
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
+	glViewport(0, 0, width, height);
+}
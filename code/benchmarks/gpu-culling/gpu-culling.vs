@@ -0,0 +1,22 @@
+#version 430 core
+layout (location = 0) in vec3 pos;
+// per instance: baseInstance of the draw, the object index
+layout (location = 1) in uint objectIndex;
+
+struct CullObject {
+    vec4 sphere;
+    uvec4 mesh;
+};
+layout (std430, binding = 0) readonly buffer Objects { CullObject objects[]; };
+
+uniform mat4 viewProjection;
+
+out vec3 color;
+
+void main() {
+    vec4 sphere = objects[objectIndex].sphere;
+    gl_Position = viewProjection * vec4(sphere.xyz + pos * sphere.w, 1.0);
+
+    uint h = objectIndex * 2654435761u;
+    color = vec3(float(h & 255u), float((h >> 8) & 255u), float((h >> 16) & 255u)) / 255.0 * 0.8 + 0.2 * (pos.y + 1.0);
+}
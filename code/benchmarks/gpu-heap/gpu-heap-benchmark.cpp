@@ -0,0 +1,296 @@
+#include "gpu-heap.h"
+#include <GLFW/glfw3.h>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+
+const char* vertexShaderSource =
+	"#version 330 core\n"
+	"layout (location = 0) in vec2 pos;\n"
+	"layout (location = 1) in vec3 color;\n"
+	"out vec3 vertexColor;\n"
+	"void main() {\n"
+	"gl_Position = vec4(pos, 0.0, 1.0);\n"
+	"vertexColor = color;\n"
+	"}\0";
+const char* fragmentShaderSource =
+	"#version 330 core\n"
+	"in vec3 vertexColor;\n"
+	"out vec4 FragColor;\n"
+	"void main() {\n"
+	"FragColor = vec4(vertexColor, 1.0);\n"
+	"}\0";
+
+// a polygon with 3 to 16 sides in its own grid cell, drawn as a triangle fan
+struct MeshData {
+	std::vector<float> vertices; // x, y, r, g, b
+	std::vector<unsigned int> indices;
+};
+
+MeshData makeMesh(unsigned int index, unsigned int meshCount, std::mt19937& rng) {
+	unsigned int columns = (unsigned int)std::ceil(std::sqrt((double)meshCount));
+	float cell = 2.0f / columns;
+	float cx = -1.0f + cell * (index % columns + 0.5f);
+	float cy = -1.0f + cell * (index / columns + 0.5f);
+	unsigned int sides = 3 + rng() % 14;
+
+	MeshData mesh;
+	float r = (rng() % 256) / 255.0f, g = (rng() % 256) / 255.0f, b = (rng() % 256) / 255.0f;
+	for (unsigned int i = 0; i < sides; i++) {
+		float angle = 6.2831853f * i / sides;
+		mesh.vertices.insert(mesh.vertices.end(), { cx + 0.45f * cell * std::cos(angle), cy + 0.45f * cell * std::sin(angle), r, g, b });
+	}
+	for (unsigned int i = 1; i + 1 < sides; i++) {
+		mesh.indices.insert(mesh.indices.end(), { 0, i, i + 1 });
+	}
+	return mesh;
+}
+
+// sum of the framebuffer, to check both paths draw the same thing
+unsigned long long framebufferChecksum() {
+	std::vector<unsigned char> pixels(SCR_WIDTH * SCR_HEIGHT * 4);
+	glReadPixels(0, 0, SCR_WIDTH, SCR_HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+	unsigned long long sum = 0;
+	for (std::size_t i = 0; i < pixels.size(); i++) {
+		sum += pixels[i] * (i % 251 + 1);
+	}
+	return sum;
+}
+
+void printStats(const char* label, const GpuHeapStats& s) {
+	printf("%-22s %u pages, %6u allocations, %7.2f MB used, %7.2f MB free in %6u blocks, largest %7.2f MB, fragmentation %.3f\n",
+		label, s.pages, s.allocations, s.usedBytes / 1048576.0, s.freeBytes / 1048576.0, s.freeBlocks,
+		s.largestFreeBlock / 1048576.0, s.fragmentation);
+}
+
+// allocator only, no GL: random allocations and frees in a 1 GB range
+void benchmarkTlsf(unsigned int operations) {
+	typedef std::chrono::steady_clock Clock;
+	std::mt19937 rng(7);
+	TlsfAllocator allocator(1ull << 30);
+	std::vector<uint32_t> live;
+	live.reserve(operations);
+
+	double allocateNs = 0.0, freeNs = 0.0;
+	unsigned int allocates = 0, frees = 0, failed = 0;
+	for (unsigned int i = 0; i < operations; i++) {
+		// grow to about 20k live blocks, then keep churning
+		if (live.empty() || (rng() % 100 < 55 && live.size() < 20000) || rng() % 100 < 50) {
+			uint64_t size = 64 + rng() % (64 << 10);
+			Clock::time_point start = Clock::now();
+			uint32_t block = allocator.allocate(size, (rng() & 1) ? 16 : 20);
+			allocateNs += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+			allocates++;
+			if (block == TlsfAllocator::NONE) {
+				failed++;
+			}
+			else {
+				live.push_back(block);
+			}
+		}
+		else {
+			std::size_t index = rng() % live.size();
+			uint32_t block = live[index];
+			live[index] = live.back();
+			live.pop_back();
+			Clock::time_point start = Clock::now();
+			allocator.free(block);
+			freeNs += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+			frees++;
+		}
+	}
+
+	printf("TLSF: %u allocates %.1f ns avg (%u failed), %u frees %.1f ns avg\n", allocates, allocateNs / allocates, failed,
+		frees, freeNs / (frees > 0 ? frees : 1));
+	printf("TLSF: %u live, %.1f MB used, %u free blocks, fragmentation %.3f\n", allocator.getAllocations(),
+		allocator.getUsedBytes() / 1048576.0, allocator.getFreeBlocks(), allocator.fragmentation());
+}
+
+// usage: gpu-heap-benchmark [mesh count] [measured frames]
+int main(int argc, char** argv) {
+	unsigned int meshCount = argc > 1 ? (unsigned int)atoi(argv[1]) : 20000;
+	int measuredFrames = argc > 2 ? atoi(argv[2]) : 20;
+
+	benchmarkTlsf(1000000);
+
+	glfwInit();
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+	GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Learn OpenGL", NULL, NULL);
+	if (window == NULL) {
+		printf("Failed to create GLFW window\n");
+		glfwTerminate();
+		return -1;
+	}
+
+	glfwMakeContextCurrent(window);
+	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+		glfwTerminate();
+		printf("Failed to initialize GLAD\n");
+		return -1;
+	}
+
+	printf("\n%s / %s, %u meshes\n", (const char*)glGetString(GL_RENDERER), (const char*)glGetString(GL_VERSION), meshCount);
+	glfwSwapInterval(0);
+
+	unsigned int vertexShader = glCreateShader(GL_VERTEX_SHADER);
+	glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
+	glCompileShader(vertexShader);
+	unsigned int fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+	glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
+	glCompileShader(fragmentShader);
+	unsigned int shaderProgram = glCreateProgram();
+	glAttachShader(shaderProgram, vertexShader);
+	glAttachShader(shaderProgram, fragmentShader);
+	glLinkProgram(shaderProgram);
+	glDeleteShader(vertexShader);
+	glDeleteShader(fragmentShader);
+	glUseProgram(shaderProgram);
+
+	std::mt19937 rng(1);
+	std::vector<MeshData> meshes;
+	for (unsigned int i = 0; i < meshCount; i++) {
+		meshes.push_back(makeMesh(i, meshCount, rng));
+	}
+
+	// 1. one VAO, VBO and EBO per mesh, like the samples do
+	double start = glfwGetTime();
+	std::vector<unsigned int> VAO(meshCount), VBO(meshCount), EBO(meshCount);
+	glGenVertexArrays(meshCount, VAO.data());
+	glGenBuffers(meshCount, VBO.data());
+	glGenBuffers(meshCount, EBO.data());
+	for (unsigned int i = 0; i < meshCount; i++) {
+		glBindVertexArray(VAO[i]);
+		glBindBuffer(GL_ARRAY_BUFFER, VBO[i]);
+		glBufferData(GL_ARRAY_BUFFER, meshes[i].vertices.size() * sizeof(float), meshes[i].vertices.data(), GL_STATIC_DRAW);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO[i]);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, meshes[i].indices.size() * sizeof(unsigned int), meshes[i].indices.data(), GL_STATIC_DRAW);
+		glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(2 * sizeof(float)));
+		glEnableVertexAttribArray(1);
+	}
+	glBindVertexArray(0);
+	glFinish();
+	double separateCreate = glfwGetTime() - start;
+
+	start = glfwGetTime();
+	for (int frame = 0; frame < measuredFrames; frame++) {
+		glClear(GL_COLOR_BUFFER_BIT);
+		for (unsigned int i = 0; i < meshCount; i++) {
+			glBindVertexArray(VAO[i]);
+			glDrawElements(GL_TRIANGLES, (GLsizei)meshes[i].indices.size(), GL_UNSIGNED_INT, 0);
+		}
+		glFinish();
+	}
+	double separateDraw = glfwGetTime() - start;
+	unsigned long long separateChecksum = framebufferChecksum();
+	glfwSwapBuffers(window);
+
+	// 2. the same meshes in a MeshPool
+	start = glfwGetTime();
+	MeshPool pool({ { 0, 2 }, { 1, 3 } }, 4 << 20);
+	std::vector<unsigned int> ids(meshCount);
+	for (unsigned int i = 0; i < meshCount; i++) {
+		ids[i] = pool.add(meshes[i].vertices.data(), (unsigned int)meshes[i].vertices.size() / 5,
+			meshes[i].indices.data(), (unsigned int)meshes[i].indices.size());
+	}
+	glFinish();
+	double pooledCreate = glfwGetTime() - start;
+
+	auto drawPool = [&]() {
+		glClear(GL_COLOR_BUFFER_BIT);
+		for (unsigned int i = 0; i < meshCount; i++) {
+			pool.draw(ids[i]);
+		}
+		glFinish();
+	};
+
+	start = glfwGetTime();
+	for (int frame = 0; frame < measuredFrames; frame++) {
+		drawPool();
+	}
+	double pooledDraw = glfwGetTime() - start;
+	unsigned long long pooledChecksum = framebufferChecksum();
+	glfwSwapBuffers(window);
+
+	printf("separate buffers: create %8.3f ms, draw %8.3f ms/frame\n", separateCreate * 1000.0, separateDraw * 1000.0 / measuredFrames);
+	printf("mesh pool:        create %8.3f ms, draw %8.3f ms/frame (%s)\n", pooledCreate * 1000.0, pooledDraw * 1000.0 / measuredFrames,
+		pooledChecksum == separateChecksum ? "same image" : "IMAGE DIFFERS");
+	printStats("after create:", pool.heap.stats());
+
+	// 3. churn: replace half the meshes with new ones of other sizes, then compact
+	std::vector<unsigned int> order(meshCount);
+	for (unsigned int i = 0; i < meshCount; i++) {
+		order[i] = i;
+	}
+	std::shuffle(order.begin(), order.end(), rng);
+	for (unsigned int i = 0; i < meshCount / 2; i++) {
+		pool.remove(ids[order[i]]);
+	}
+	for (unsigned int i = 0; i < meshCount / 2; i++) {
+		unsigned int mesh = order[i];
+		meshes[mesh] = makeMesh(mesh, meshCount, rng);
+		ids[mesh] = pool.add(meshes[mesh].vertices.data(), (unsigned int)meshes[mesh].vertices.size() / 5,
+			meshes[mesh].indices.data(), (unsigned int)meshes[mesh].indices.size());
+		// drop a few more so holes stay behind
+		if (i % 4 == 0) {
+			unsigned int victim = order[meshCount / 2 + i / 4];
+			pool.remove(ids[victim]);
+			meshes[victim].indices.clear();
+			ids[victim] = GpuHeap::INVALID;
+		}
+	}
+
+	auto drawLive = [&]() {
+		glClear(GL_COLOR_BUFFER_BIT);
+		for (unsigned int i = 0; i < meshCount; i++) {
+			if (ids[i] != GpuHeap::INVALID) {
+				pool.draw(ids[i]);
+			}
+		}
+		glFinish();
+	};
+
+	drawLive();
+	unsigned long long churnChecksum = framebufferChecksum();
+	printStats("after churn:", pool.heap.stats());
+
+	start = glfwGetTime();
+	uint64_t moved = pool.compact();
+	glFinish();
+	double compactTime = glfwGetTime() - start;
+
+	drawLive();
+	unsigned long long compactChecksum = framebufferChecksum();
+	printStats("after compaction:", pool.heap.stats());
+	printf("compaction: %.2f MB moved in %.3f ms (%s)\n", moved / 1048576.0, compactTime * 1000.0,
+		compactChecksum == churnChecksum ? "same image" : "IMAGE DIFFERS");
+
+	pool.del();
+	glDeleteVertexArrays(meshCount, VAO.data());
+	glDeleteBuffers(meshCount, VBO.data());
+	glDeleteBuffers(meshCount, EBO.data());
+	glDeleteProgram(shaderProgram);
+
+	glfwTerminate();
+	return 0;
+}
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
+	glViewport(0, 0, width, height);
+}
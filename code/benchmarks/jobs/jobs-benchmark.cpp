@@ -0,0 +1,226 @@
+#include "jobs.h"
+#include "maths.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace maths;
+
+// A synthetic frame over objectCount objects, every stage split into batches:
+//   update  move and spin each object, rebuild its model matrix
+//   cull    test the bounding sphere against the view frustum
+//   sort    sort the visible objects by depth (sorted chunks, then merge rounds)
+//   record  write the MVP of each visible object, as a command buffer would
+// The stages are one job graph chained with dependsOn, the frame waits on
+// the last one.
+struct Scene {
+	std::size_t count = 0;
+	std::vector<vec3> position;
+	std::vector<vec3> velocity;
+	std::vector<float> angle;
+	std::vector<float> spin;
+	std::vector<float> radius;
+	std::vector<mat4> model;
+	std::vector<unsigned long long> keys[2];   // depth << 32 | index, ~0 when culled
+	std::vector<mat4> commands;
+	mat4 viewProjection;
+	vec4 planes[6];
+	unsigned int sorted = 0;                   // which keys array holds the result
+};
+
+const std::size_t BATCH = 1024;
+
+void updateObjects(Scene& scene, std::size_t begin, std::size_t end, float dt) {
+	for (std::size_t i = begin; i < end; i++) {
+		vec3 p = scene.position[i] + scene.velocity[i] * dt;
+		// bounce inside the [-50, 50] box
+		if (std::fabs(p.x) > 50.0f) scene.velocity[i].x = -scene.velocity[i].x;
+		if (std::fabs(p.y) > 50.0f) scene.velocity[i].y = -scene.velocity[i].y;
+		if (std::fabs(p.z) > 50.0f) scene.velocity[i].z = -scene.velocity[i].z;
+		scene.position[i] = p;
+		scene.angle[i] += scene.spin[i] * dt;
+		scene.model[i] = rotate(translate(mat4(1.0f), p), scene.angle[i], vec3(0.0f, 1.0f, 0.0f));
+	}
+}
+
+void cullObjects(Scene& scene, std::size_t begin, std::size_t end) {
+	std::vector<unsigned long long>& keys = scene.keys[0];
+	for (std::size_t i = begin; i < end; i++) {
+		const vec3& p = scene.position[i];
+		bool visible = true;
+		for (int plane = 0; plane < 6 && visible; plane++) {
+			const vec4& n = scene.planes[plane];
+			visible = n.x * p.x + n.y * p.y + n.z * p.z + n.w > -scene.radius[i];
+		}
+		if (visible) {
+			vec4 clip = scene.viewProjection * vec4(p.x, p.y, p.z, 1.0f);
+			unsigned int depth = (unsigned int)(std::max(clip.w, 0.0f) * 1000.0f);
+			keys[i] = ((unsigned long long)depth << 32) | i;
+		}
+		else {
+			keys[i] = ~0ull;
+		}
+	}
+}
+
+void recordCommands(Scene& scene, std::size_t begin, std::size_t end) {
+	const std::vector<unsigned long long>& keys = scene.keys[scene.sorted];
+	for (std::size_t i = begin; i < end; i++) {
+		if (keys[i] == ~0ull) {
+			break;
+		}
+		scene.commands[i] = scene.viewProjection * scene.model[keys[i] & 0xFFFFFFFFull];
+	}
+}
+
+// one merge round: pairs of sorted runs of width elements from keys[src] into keys[1 - src]
+struct MergeRound {
+	Scene* scene;
+	std::size_t width;
+	unsigned int src;
+
+	void operator()(std::size_t begin, std::size_t end) const {
+		const std::vector<unsigned long long>& in = scene->keys[src];
+		std::vector<unsigned long long>& out = scene->keys[1 - src];
+		for (std::size_t pair = begin; pair < end; pair++) {
+			std::size_t left = pair * 2 * width;
+			std::size_t middle = std::min(left + width, scene->count);
+			std::size_t right = std::min(left + 2 * width, scene->count);
+			std::merge(in.begin() + left, in.begin() + middle, in.begin() + middle, in.begin() + right, out.begin() + left);
+		}
+	}
+};
+
+void runFrame(JobSystem& jobs, Scene& scene, float dt) {
+	std::size_t count = scene.count;
+	std::size_t chunk = BATCH * 8;
+	std::size_t chunks = (count + chunk - 1) / chunk;
+
+	auto update = [&](std::size_t begin, std::size_t end) { updateObjects(scene, begin, end, dt); };
+	auto cull = [&](std::size_t begin, std::size_t end) { cullObjects(scene, begin, end); };
+	auto sortChunks = [&](std::size_t begin, std::size_t end) {
+		for (std::size_t c = begin; c < end; c++) {
+			std::sort(scene.keys[0].begin() + c * chunk, scene.keys[0].begin() + std::min((c + 1) * chunk, count));
+		}
+	};
+	auto record = [&](std::size_t begin, std::size_t end) { recordCommands(scene, begin, end); };
+
+	// merge rounds until one run is left, each reading what the last wrote
+	std::vector<MergeRound> rounds;
+	unsigned int src = 0;
+	for (std::size_t width = chunk; width < count; width *= 2) {
+		rounds.push_back({ &scene, width, src });
+		src = 1 - src;
+	}
+	scene.sorted = src;
+
+	std::vector<Job*> graph;
+	graph.push_back(jobs.parallelForJob(count, BATCH, update));
+	graph.push_back(jobs.parallelForJob(count, BATCH, cull));
+	graph.push_back(jobs.parallelForJob(chunks, 1, sortChunks));
+	for (const MergeRound& round : rounds) {
+		std::size_t pairs = (count + 2 * round.width - 1) / (2 * round.width);
+		graph.push_back(jobs.parallelForJob(pairs, 1, round));
+	}
+	graph.push_back(jobs.parallelForJob(count, BATCH, record));
+
+	for (std::size_t i = 1; i < graph.size(); i++) {
+		jobs.dependsOn(graph[i], graph[i - 1]);
+	}
+	for (Job* job : graph) {
+		jobs.run(job);
+	}
+	jobs.wait(graph.back());
+}
+
+// the same frame as plain loops, to see what the job system costs
+void runFrameSerial(Scene& scene, float dt) {
+	updateObjects(scene, 0, scene.count, dt);
+	cullObjects(scene, 0, scene.count);
+	std::sort(scene.keys[0].begin(), scene.keys[0].end());
+	scene.sorted = 0;
+	recordCommands(scene, 0, scene.count);
+}
+
+void initScene(Scene& scene, std::size_t count) {
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> position(-50.0f, 50.0f);
+	std::uniform_real_distribution<float> speed(-5.0f, 5.0f);
+	scene.count = count;
+	scene.position.resize(count);
+	scene.velocity.resize(count);
+	scene.angle.assign(count, 0.0f);
+	scene.spin.resize(count);
+	scene.radius.resize(count);
+	scene.model.resize(count);
+	scene.keys[0].resize(count);
+	scene.keys[1].resize(count);
+	scene.commands.assign(count, mat4(0.0f));
+	for (std::size_t i = 0; i < count; i++) {
+		scene.position[i] = vec3(position(rng), position(rng), position(rng));
+		scene.velocity[i] = vec3(speed(rng), speed(rng), speed(rng));
+		scene.spin[i] = speed(rng);
+		scene.radius[i] = 0.5f + (rng() % 100) / 100.0f;
+	}
+	scene.viewProjection = perspective(radians(60.0f), 800.0f / 600.0f, 0.1f, 200.0f) *
+		lookAt(vec3(0.0f, 20.0f, 90.0f), vec3(0.0f), vec3(0.0f, 1.0f, 0.0f));
+	frustumPlanes(scene.viewProjection, scene.planes);
+}
+
+// sum over the recorded commands, identical for every thread count
+double checksum(const Scene& scene) {
+	const std::vector<unsigned long long>& keys = scene.keys[scene.sorted];
+	double sum = 0.0;
+	for (std::size_t i = 0; i < scene.count && keys[i] != ~0ull; i++) {
+		sum += scene.commands[i][3][0] * (double)(i % 7 + 1) + (double)(keys[i] & 0xFFFFFFFFull);
+	}
+	return sum;
+}
+
+// usage: jobs-benchmark [object count] [max threads] [frames]
+int main(int argc, char** argv) {
+	std::size_t objectCount = argc > 1 ? (std::size_t)atoi(argv[1]) : 100000;
+	unsigned int maxThreads = argc > 2 ? (unsigned int)atoi(argv[2]) : std::thread::hardware_concurrency();
+	int frames = argc > 3 ? atoi(argv[3]) : 100;
+	if (maxThreads == 0) {
+		maxThreads = 1;
+	}
+	const float dt = 1.0f / 60.0f;
+
+	printf("%zu objects, %d frames, %u hardware threads\n", objectCount, frames, std::thread::hardware_concurrency());
+
+	Scene scene;
+	initScene(scene, objectCount);
+	auto start = std::chrono::steady_clock::now();
+	for (int frame = 0; frame < frames; frame++) {
+		runFrameSerial(scene, dt);
+	}
+	double serialMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / frames;
+	double reference = checksum(scene);
+	printf("%-12s %9.3f ms/frame\n", "plain loops", serialMs);
+
+	double oneThreadMs = 0.0;
+	for (unsigned int threads : JobSystem::threadCountSweep(maxThreads)) {
+		JobSystem jobs(threads);
+		initScene(scene, objectCount);
+
+		runFrame(jobs, scene, dt);   // warm up the threads
+		initScene(scene, objectCount);
+
+		start = std::chrono::steady_clock::now();
+		for (int frame = 0; frame < frames; frame++) {
+			runFrame(jobs, scene, dt);
+		}
+		double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / frames;
+		if (threads == 1) {
+			oneThreadMs = ms;
+		}
+
+		printf("%2u thread%s   %9.3f ms/frame  %5.2fx  %s\n", threads, threads == 1 ? " " : "s", ms, oneThreadMs / ms,
+			checksum(scene) == reference ? "same result" : "RESULT DIFFERS");
+	}
+	return 0;
+}
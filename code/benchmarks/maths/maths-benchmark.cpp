@@ -0,0 +1,170 @@
+#include "maths.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+
+// glm is optional, the comparison is skipped when it isn't on the include path
+#if defined(__has_include)
+#if __has_include(<glm/glm.hpp>)
+#define HAVE_GLM
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#endif
+#endif
+
+using namespace maths;
+
+const std::size_t POINT_COUNT = 1 << 20;
+const int ITERATIONS = 50;
+const int MATRIX_ITERATIONS = 5000000;
+
+// keeps the optimizer from throwing away results we never read
+volatile float sink;
+
+template <typename F>
+double timeMs(F f) {
+	auto start = std::chrono::high_resolution_clock::now();
+	f();
+	auto end = std::chrono::high_resolution_clock::now();
+	return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+void report(const char* name, double ms, double items) {
+	printf("%-36s %9.3f ms  %8.1f Mitems/s\n", name, ms, items / (ms * 1000.0));
+}
+
+float maxError(const std::vector<float>& a, const std::vector<float>& b) {
+	float err = 0.0f;
+	for (std::size_t i = 0; i < a.size(); i++) {
+		err = fmaxf(err, fabsf(a[i] - b[i]));
+	}
+	return err;
+}
+
+int main() {
+#if defined(MATHS_AVX2)
+	printf("maths.h path: AVX2\n");
+#elif defined(MATHS_SSE)
+	printf("maths.h path: SSE\n");
+#else
+	printf("maths.h path: scalar\n");
+#endif
+
+	// Setup point data, SoA for the batch routines and AoS for the per-point ones
+	std::vector<float> xs(POINT_COUNT), ys(POINT_COUNT), zs(POINT_COUNT);
+	std::vector<vec4> points(POINT_COUNT);
+	srand(1234);
+	for (std::size_t i = 0; i < POINT_COUNT; i++) {
+		xs[i] = (float)rand() / RAND_MAX * 2.0f - 1.0f;
+		ys[i] = (float)rand() / RAND_MAX * 2.0f - 1.0f;
+		zs[i] = (float)rand() / RAND_MAX * 2.0f - 1.0f;
+		points[i] = vec4(xs[i], ys[i], zs[i], 1.0f);
+	}
+
+	mat4 model = translate(mat4(1.0f), vec3(0.3f, -0.2f, 0.1f));
+	model = rotate(model, radians(30.0f), vec3(0.0f, 0.0f, 1.0f));
+	model = scale(model, vec3(0.5f, 0.5f, 0.5f));
+
+	std::vector<float> refX(POINT_COUNT), refY(POINT_COUNT), refZ(POINT_COUNT);
+	std::vector<float> outX(POINT_COUNT), outY(POINT_COUNT), outZ(POINT_COUNT);
+	std::vector<vec4> outPoints(POINT_COUNT);
+	double items = (double)POINT_COUNT * ITERATIONS;
+
+	printf("\n-- transform %zu points x %d --\n", POINT_COUNT, ITERATIONS);
+
+	double ms = timeMs([&]() {
+		for (int it = 0; it < ITERATIONS; it++) {
+			transformPointsScalar(xs.data(), ys.data(), zs.data(), POINT_COUNT, model, refX.data(), refY.data(), refZ.data());
+		}
+	});
+	report("scalar SoA", ms, items);
+
+	ms = timeMs([&]() {
+		for (int it = 0; it < ITERATIONS; it++) {
+			transformPoints(xs.data(), ys.data(), zs.data(), POINT_COUNT, model, outX.data(), outY.data(), outZ.data());
+		}
+	});
+	report("SIMD SoA (transformPoints)", ms, items);
+	printf("  max error vs scalar: %g\n", fmaxf(maxError(refX, outX), fmaxf(maxError(refY, outY), maxError(refZ, outZ))));
+
+	ms = timeMs([&]() {
+		for (int it = 0; it < ITERATIONS; it++) {
+			for (std::size_t i = 0; i < POINT_COUNT; i++) {
+				outPoints[i] = model * points[i];
+			}
+		}
+	});
+	report("SIMD AoS (mat4 * vec4)", ms, items);
+
+#ifdef HAVE_GLM
+	std::vector<glm::vec4> glmPoints(POINT_COUNT), glmOut(POINT_COUNT);
+	for (std::size_t i = 0; i < POINT_COUNT; i++) {
+		glmPoints[i] = glm::vec4(xs[i], ys[i], zs[i], 1.0f);
+	}
+	glm::mat4 glmModel = glm::translate(glm::mat4(1.0f), glm::vec3(0.3f, -0.2f, 0.1f));
+	glmModel = glm::rotate(glmModel, glm::radians(30.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+	glmModel = glm::scale(glmModel, glm::vec3(0.5f, 0.5f, 0.5f));
+
+	ms = timeMs([&]() {
+		for (int it = 0; it < ITERATIONS; it++) {
+			for (std::size_t i = 0; i < POINT_COUNT; i++) {
+				glmOut[i] = glmModel * glmPoints[i];
+			}
+		}
+	});
+	report("glm AoS (mat4 * vec4)", ms, items);
+
+	float glmErr = 0.0f;
+	for (std::size_t i = 0; i < POINT_COUNT; i++) {
+		glmErr = fmaxf(glmErr, fabsf(glmOut[i].x - refX[i]));
+	}
+	printf("  max error vs scalar: %g\n", glmErr);
+#else
+	printf("%-36s skipped (glm not found)\n", "glm AoS (mat4 * vec4)");
+#endif
+
+	printf("\n-- mat4 * mat4 x %d --\n", MATRIX_ITERATIONS);
+
+	mat4 step = rotate(mat4(1.0f), 0.001f, vec3(0.0f, 1.0f, 0.0f));
+	mat4 acc(1.0f);
+	ms = timeMs([&]() {
+		for (int it = 0; it < MATRIX_ITERATIONS; it++) {
+			acc = acc * step;
+		}
+	});
+	sink = acc[0].x;
+	report("maths.h mat4 multiply", ms, MATRIX_ITERATIONS);
+
+#ifdef HAVE_GLM
+	glm::mat4 glmStep = glm::rotate(glm::mat4(1.0f), 0.001f, glm::vec3(0.0f, 1.0f, 0.0f));
+	glm::mat4 glmAcc(1.0f);
+	ms = timeMs([&]() {
+		for (int it = 0; it < MATRIX_ITERATIONS; it++) {
+			glmAcc = glmAcc * glmStep;
+		}
+	});
+	sink = glmAcc[0][0];
+	report("glm mat4 multiply", ms, MATRIX_ITERATIONS);
+#endif
+
+	// quick sanity checks on the rest of the library
+	mat4 inv = inverse(model);
+	mat4 shouldBeIdentity = model * inv;
+	float identityErr = 0.0f;
+	for (int c = 0; c < 4; c++) {
+		for (int r = 0; r < 4; r++) {
+			identityErr = fmaxf(identityErr, fabsf(shouldBeIdentity[c][r] - (c == r ? 1.0f : 0.0f)));
+		}
+	}
+
+	quat q = angleAxis(radians(30.0f), vec3(0.0f, 0.0f, 1.0f));
+	vec3 byQuat = q * vec3(1.0f, 0.0f, 0.0f);
+	vec4 byMat = rotate(mat4(1.0f), radians(30.0f), vec3(0.0f, 0.0f, 1.0f)) * vec4(1.0f, 0.0f, 0.0f, 0.0f);
+
+	printf("\nmodel * inverse(model) max error from identity: %g\n", identityErr);
+	printf("quaternion vs matrix rotation error: %g\n", length(byQuat - vec3(byMat.x, byMat.y, byMat.z)));
+
+	return 0;
+}
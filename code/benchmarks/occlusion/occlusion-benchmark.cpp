@@ -0,0 +1,358 @@
+#include "culling.h"
+#include "occlusion.h"
+#include "occlusion-queries.h"
+#include "shader.h"
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <cstdlib>
+#include <random>
+
+using namespace maths;
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+
+// one VAO per mesh, drawn with glDrawElements
+struct Mesh {
+	unsigned int vao = 0, vbo = 0, ebo = 0;
+	unsigned int indexCount = 0;
+
+	void create(const std::vector<float>& vertices, const std::vector<unsigned int>& indices) {
+		glGenVertexArrays(1, &vao);
+		glGenBuffers(1, &vbo);
+		glGenBuffers(1, &ebo);
+		glBindVertexArray(vao);
+		glBindBuffer(GL_ARRAY_BUFFER, vbo);
+		glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+		glEnableVertexAttribArray(0);
+		glBindVertexArray(0);
+		indexCount = (unsigned int)indices.size();
+	}
+
+	void del() {
+		glDeleteVertexArrays(1, &vao);
+		glDeleteBuffers(1, &vbo);
+		glDeleteBuffers(1, &ebo);
+	}
+};
+
+// unit cube and a unit sphere of stacks x slices quads
+void makeCube(std::vector<float>& vertices, std::vector<unsigned int>& indices) {
+	vertices = { -1,-1,-1, 1,-1,-1, 1,1,-1, -1,1,-1, -1,-1,1, 1,-1,1, 1,1,1, -1,1,1 };
+	indices = { 0,2,1, 0,3,2, 4,5,6, 4,6,7, 0,1,5, 0,5,4, 3,6,2, 3,7,6, 0,4,7, 0,7,3, 1,2,6, 1,6,5 };
+}
+
+void makeSphere(int stacks, int slices, std::vector<float>& vertices, std::vector<unsigned int>& indices) {
+	for (int i = 0; i <= stacks; i++) {
+		float phi = PI * i / stacks;
+		for (int j = 0; j <= slices; j++) {
+			float theta = 2.0f * PI * j / slices;
+			vertices.push_back(std::sin(phi) * std::cos(theta));
+			vertices.push_back(-std::cos(phi));
+			vertices.push_back(-std::sin(phi) * std::sin(theta));
+		}
+	}
+	for (int i = 0; i < stacks; i++) {
+		for (int j = 0; j < slices; j++) {
+			unsigned int a = i * (slices + 1) + j, b = a + slices + 1;
+			indices.insert(indices.end(), { a, a + 1, b + 1, a, b + 1, b });
+		}
+	}
+}
+
+// Blocks of buildings on a grid of streets, with props (street furniture,
+// trees, cars: all spheres here) scattered over the streets and the roofs.
+struct City {
+	std::vector<vec3> min, max;
+	std::vector<vec3> color;
+	std::vector<bool> building;
+	culling::CullingSet bounds;
+
+	void add(const vec3& lo, const vec3& hi, const vec3& c, bool isBuilding) {
+		min.push_back(lo);
+		max.push_back(hi);
+		color.push_back(c);
+		building.push_back(isBuilding);
+		bounds.addBox(lo, hi);
+	}
+};
+
+const int BLOCKS = 24;
+const float PITCH = 20.0f;   // block + street
+const float STREET = 8.0f;
+
+void buildCity(City& city, int propsPerBlock) {
+	std::mt19937 rng(3);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	float half = BLOCKS * PITCH * 0.5f;
+	for (int bz = 0; bz < BLOCKS; bz++) {
+		for (int bx = 0; bx < BLOCKS; bx++) {
+			float x0 = bx * PITCH - half + STREET * 0.5f, z0 = bz * PITCH - half + STREET * 0.5f;
+			float size = PITCH - STREET;
+			float height = 10.0f + 50.0f * unit(rng) * unit(rng);
+			float grey = 0.4f + 0.3f * unit(rng);
+			city.add(vec3(x0, 0.0f, z0), vec3(x0 + size, height, z0 + size), vec3(grey, grey, grey * 1.1f), true);
+
+			for (int p = 0; p < propsPerBlock; p++) {
+				float r = 0.4f + 1.1f * unit(rng);
+				float px = bx * PITCH - half + unit(rng) * PITCH;
+				float pz = bz * PITCH - half + unit(rng) * PITCH;
+				// inside the footprint: on the roof
+				bool roof = px > x0 && px < x0 + size && pz > z0 && pz < z0 + size;
+				float py = (roof ? height : 0.0f) + r;
+				city.add(vec3(px - r, py - r, pz - r), vec3(px + r, py + r, pz + r),
+					vec3(0.3f + 0.7f * unit(rng), 0.3f + 0.7f * unit(rng), 0.2f), false);
+			}
+		}
+	}
+}
+
+// down the middle of a street, drifting sideways so the view keeps changing
+void cameraAt(float time, vec3& eye, vec3& target) {
+	float half = BLOCKS * PITCH * 0.5f;
+	eye = vec3(-half + PITCH * 3.0f + time * 2.0f, 2.0f, 0.0f);
+	target = eye + vec3(std::cos(0.3f + time * 0.05f), 0.05f, std::sin(0.3f + time * 0.05f));
+}
+
+// usage: occlusion-benchmark [props per block] [occluders] [frames]
+int main(int argc, char** argv) {
+	int propsPerBlock = argc > 1 ? atoi(argv[1]) : 24;
+	unsigned int maxOccluders = argc > 2 ? (unsigned int)atoi(argv[2]) : 32;
+	int frames = argc > 3 ? atoi(argv[3]) : 30;
+
+	glfwInit();
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+	GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Learn OpenGL", NULL, NULL);
+	if (window == NULL) {
+		printf("Failed to create GLFW window\n");
+		glfwTerminate();
+		return -1;
+	}
+
+	glfwMakeContextCurrent(window);
+	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+		glfwTerminate();
+		printf("Failed to initialize GLAD\n");
+		return -1;
+	}
+
+	City city;
+	buildCity(city, propsPerBlock);
+	printf("%s / %s\n%zu objects (%d buildings), %u occluders, %d frames\n", (const char*)glGetString(GL_RENDERER),
+		(const char*)glGetString(GL_VERSION), city.min.size(), BLOCKS * BLOCKS, maxOccluders, frames);
+	glfwSwapInterval(0);
+
+	Shader shader("occlusion.vs", "occlusion.fs");
+	GLint mvpLocation = glGetUniformLocation(shader.ID, "mvp");
+	GLint colorLocation = glGetUniformLocation(shader.ID, "color");
+
+	std::vector<float> vertices;
+	std::vector<unsigned int> indices;
+	Mesh cube, sphere;
+	makeCube(vertices, indices);
+	cube.create(vertices, indices);
+	vertices.clear();
+	indices.clear();
+	makeSphere(16, 24, vertices, indices);
+	sphere.create(vertices, indices);
+
+	// ground, drawn every frame
+	float half = BLOCKS * PITCH * 0.5f;
+	mat4 groundModel = scale(translate(mat4(1.0f), vec3(0.0f, -0.5f, 0.0f)), vec3(half, 0.5f, half));
+
+	OcclusionCuller occlusion(256, 192);
+	OcclusionQueries queries((unsigned int)city.min.size(), 2, "../../../shaders/");
+	FrameProfiler profiler;
+	std::vector<unsigned int> visible;
+	std::vector<unsigned int> drawList;
+	std::vector<unsigned int> hidden;
+	std::vector<std::pair<float, unsigned int>> byDistance;
+
+	glEnable(GL_DEPTH_TEST);
+	glEnable(GL_CULL_FACE);
+	glClearColor(0.55f, 0.7f, 0.9f, 1.0f);
+
+	std::vector<unsigned char> reference(SCR_WIDTH * SCR_HEIGHT * 4), pixels(reference.size());
+	const char* names[] = { "frustum", "frustum + occlusion", "frustum + HW queries" };
+	for (int path = 0; path < 3 && !glfwWindowShouldClose(window); path++) {
+		double cullTime = 0.0;
+		unsigned long long draws = 0, triangles = 0, occluded = 0, occludedTriangles = 0, conditional = 0;
+
+		auto drawFrame = [&](float time) {
+			vec3 eye, target;
+			cameraAt(time, eye, target);
+			mat4 viewProjection = perspective(radians(60.0f), (float)SCR_WIDTH / SCR_HEIGHT, 0.5f, 600.0f) *
+				lookAt(eye, target, vec3(0.0f, 1.0f, 0.0f));
+
+			double start = glfwGetTime();
+			vec4 planes[6];
+			frustumPlanes(viewProjection, planes);
+			city.bounds.cullBoxes(planes, visible);
+
+			drawList.clear();
+			if (path == 0) {
+				drawList = visible;
+			}
+			else if (path == 2) {
+				// front to back, so an object's query runs after whatever hides it
+				byDistance.clear();
+				for (unsigned int i : visible) {
+					vec3 center = (city.min[i] + city.max[i]) * 0.5f;
+					byDistance.push_back({ length(center - eye), i });
+				}
+				std::sort(byDistance.begin(), byDistance.end());
+				for (const std::pair<float, unsigned int>& object : byDistance) {
+					drawList.push_back(object.second);
+				}
+				profiler.beginFrame();
+				queries.beginFrame(viewProjection, eye);
+			}
+			else {
+				// the nearest buildings in view are the occluders, and are drawn as they are
+				byDistance.clear();
+				for (unsigned int i : visible) {
+					if (city.building[i]) {
+						vec3 center = (city.min[i] + city.max[i]) * 0.5f;
+						byDistance.push_back({ length(center - eye), i });
+					}
+				}
+				std::size_t occluders = std::min<std::size_t>(maxOccluders, byDistance.size());
+				std::partial_sort(byDistance.begin(), byDistance.begin() + occluders, byDistance.end());
+
+				occlusion.begin(viewProjection);
+				std::vector<bool> isOccluder(city.min.size(), false);
+				for (std::size_t o = 0; o < occluders; o++) {
+					unsigned int i = byDistance[o].second;
+					occlusion.addBox(city.min[i], city.max[i]);
+					isOccluder[i] = true;
+				}
+				occlusion.buildPyramid();
+
+				for (unsigned int i : visible) {
+					if (isOccluder[i] || occlusion.isVisible(city.min[i], city.max[i])) {
+						drawList.push_back(i);
+					}
+					else {
+						occluded++;
+						occludedTriangles += (city.building[i] ? cube : sphere).indexCount / 3;
+					}
+				}
+			}
+			cullTime += glfwGetTime() - start;
+
+			auto drawObject = [&](unsigned int i) {
+				const Mesh& mesh = city.building[i] ? cube : sphere;
+				vec3 center = (city.min[i] + city.max[i]) * 0.5f;
+				vec3 extent = (city.max[i] - city.min[i]) * 0.5f;
+				mat4 model = scale(translate(mat4(1.0f), center), extent);
+				glBindVertexArray(mesh.vao);
+				glUniformMatrix4fv(mvpLocation, 1, GL_FALSE, (viewProjection * model).ptr());
+				glUniform3f(colorLocation, city.color[i].x, city.color[i].y, city.color[i].z);
+				glDrawElements(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_INT, 0);
+				triangles += mesh.indexCount / 3;
+			};
+
+			if (path == 2) {
+				profiler.beginGpu("frame");
+			}
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			shader.use();
+			glBindVertexArray(cube.vao);
+			glUniformMatrix4fv(mvpLocation, 1, GL_FALSE, (viewProjection * groundModel).ptr());
+			glUniform3f(colorLocation, 0.25f, 0.3f, 0.25f);
+			glDrawElements(GL_TRIANGLES, cube.indexCount, GL_UNSIGNED_INT, 0);
+			if (path < 2) {
+				for (unsigned int i : drawList) {
+					drawObject(i);
+					draws++;
+				}
+			}
+			else {
+				// what was visible is drawn and queried, what was hidden gets its box
+				// queried and is drawn only if the GPU finds the box visible
+				hidden.clear();
+				for (unsigned int i : drawList) {
+					if (queries.predictedVisible(i)) {
+						queries.beginQuery(i);
+						drawObject(i);
+						queries.endQuery();
+						draws++;
+					}
+					else {
+						hidden.push_back(i);
+					}
+				}
+				queries.queryBounds(hidden.data(), hidden.size(), city.min.data(), city.max.data());
+				shader.use();
+				for (unsigned int i : hidden) {
+					queries.beginConditional(i);
+					drawObject(i);
+					queries.endConditional();
+					conditional++;
+				}
+				profiler.endGpu();
+				queries.publish(profiler);
+			}
+			glBindVertexArray(0);
+		};
+
+		double start = glfwGetTime();
+		for (int frame = 0; frame < frames; frame++) {
+			drawFrame((float)frame);
+			glfwSwapBuffers(window);
+			glfwPollEvents();
+		}
+		glFinish();
+		double total = glfwGetTime() - start;
+		const OcclusionCuller::Stats& stats = occlusion.getStats();
+
+		// the last frame again, read back before the swap
+		drawFrame((float)(frames - 1));
+		glReadPixels(0, 0, SCR_WIDTH, SCR_HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, (path == 0 ? reference : pixels).data());
+		std::size_t differing = 0;
+		for (std::size_t p = 0; path > 0 && p < pixels.size(); p += 4) {
+			differing += std::equal(pixels.begin() + p, pixels.begin() + p + 4, reference.begin() + p) ? 0 : 1;
+		}
+
+		printf("%-22s %7.1f draws %9.0f triangles/frame, %6.3f ms cull, %8.3f ms/frame  %zu pixels differ\n", names[path],
+			(double)draws / (frames + 1), (double)triangles / (frames + 1), cullTime * 1000.0 / (frames + 1),
+			total * 1000.0 / frames, differing);
+		if (path == 1) {
+			printf("%-22s %7.1f draws %9.0f triangles/frame culled by occlusion, %u occluder triangles rasterized\n", "",
+				(double)occluded / (frames + 1), (double)occludedTriangles / (frames + 1), stats.rasterizedTriangles);
+		}
+		if (path == 2) {
+			// triangles above include the conditional draws the GPU may have skipped
+			printf("%-22s %7.1f conditional draws/frame\n\n", "", (double)conditional / (frames + 1));
+			profiler.flush();
+			profiler.print();
+		}
+	}
+
+	queries.del();
+	profiler.del();
+	cube.del();
+	sphere.del();
+	shader.del();
+
+	glfwTerminate();
+	return 0;
+}
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
+	glViewport(0, 0, width, height);
+}
@@ -0,0 +1,13 @@
+#version 330 core
+layout (location = 0) in vec3 pos;
+
+uniform mat4 mvp;
+uniform vec3 color;
+
+out vec4 vertexColor;
+
+void main() {
+    gl_Position = mvp * vec4(pos, 1.0);
+    // darker towards the bottom of the mesh, so faces of one color stay apart
+    vertexColor = vec4(color * (0.55 + 0.45 * (pos.y * 0.5 + 0.5)), 1.0);
+}
@@ -0,0 +1,114 @@
+#include "particles.h"
+#include <GLFW/glfw3.h>
+#include <cstdlib>
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void processInput(GLFWwindow* window);
+
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+
+const float DT = 1.0f / 60.0f;
+
+// usage: particles-benchmark [particle count] [measured frames]
+int main(int argc, char** argv) {
+	unsigned int particleCount = argc > 1 ? (unsigned int)atoi(argv[1]) : 1000000;
+	int measuredFrames = argc > 2 ? atoi(argv[2]) : 120;
+
+	glfwInit();
+
+	// compute shaders need 4.3 (not available on macOS)
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+	GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Learn OpenGL", NULL, NULL);
+	if (window == NULL) {
+		printf("Failed to create GLFW window\n");
+		glfwTerminate();
+		return -1;
+	}
+
+	glfwMakeContextCurrent(window);
+	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+		glfwTerminate();
+		printf("Failed to initialize GLAD\n");
+		return -1;
+	}
+	loadGLExtensions((GLADloadproc)glfwGetProcAddress);
+
+	if (!hasGLVersion(4, 3)) {
+		printf("OpenGL 4.3 is required, got %d.%d\n", GLVersion.major, GLVersion.minor);
+		glfwTerminate();
+		return -1;
+	}
+
+	printf("%s / %s\n", (const char*)glGetString(GL_RENDERER), (const char*)glGetString(GL_VERSION));
+	glfwSwapInterval(0);
+
+	ParticleSystem particles(particleCount, "../../../shaders/");
+
+	// particles live 0.5 to 1.0 times the lifetime, so this keeps about particleCount alive
+	float averageLife = particles.lifetime * 0.75f;
+	unsigned int emitPerFrame = (unsigned int)(particleCount * DT / averageLife);
+	int warmupFrames = (int)(particles.lifetime / DT);
+
+	glClearColor(1.0, 1.0, 1.0, 1.0);
+
+	// warm up until the alive count is steady
+	for (int frame = 0; frame < warmupFrames; frame++) {
+		particles.update(DT, emitPerFrame);
+	}
+	glFinish();
+
+	// simulation only, then simulation + instanced rendering
+	double simulationTime = 0.0;
+	double totalTime = 0.0;
+	for (int pass = 0; pass < 2 && !glfwWindowShouldClose(window); pass++) {
+		double start = glfwGetTime();
+		for (int frame = 0; frame < measuredFrames; frame++) {
+			processInput(window);
+
+			glClear(GL_COLOR_BUFFER_BIT);
+
+			particles.update(DT, emitPerFrame);
+			if (pass == 1) {
+				particles.draw();
+			}
+
+			glfwPollEvents();
+			glfwSwapBuffers(window);
+		}
+		glFinish();
+		(pass == 0 ? simulationTime : totalTime) = glfwGetTime() - start;
+	}
+
+	// only read back once, after timing
+	unsigned int alive = particles.aliveCount();
+	printf("alive particles:   %u (capacity %u, %u emitted per frame)\n", alive, particleCount, emitPerFrame);
+	if (simulationTime > 0.0) {
+		printf("update only:       %8.3f ms/frame  %8.1f M particles/s\n",
+			simulationTime * 1000.0 / measuredFrames, (double)alive * measuredFrames / simulationTime / 1e6);
+	}
+	if (totalTime > 0.0) {
+		printf("update + draw:     %8.3f ms/frame  %8.1f M particles/s\n",
+			totalTime * 1000.0 / measuredFrames, (double)alive * measuredFrames / totalTime / 1e6);
+	}
+
+	particles.del();
+
+	glfwTerminate();
+	return 0;
+}
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
+	glViewport(0, 0, width, height);
+}
+
+void processInput(GLFWwindow* window) {
+	if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_RIGHT) == GLFW_PRESS) {
+		glfwSetWindowShouldClose(window, true);
+	}
+}
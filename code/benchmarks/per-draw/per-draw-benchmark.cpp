@@ -0,0 +1,256 @@
+#include "shader.h"
+#include "per-draw-buffer.h"
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+
+const unsigned int UNIFORM_BATCH = 256;   // array size in per-draw-ubo.vs
+
+// matches DrawData in the shaders, std140 and std430 alike
+struct DrawData {
+	float offset[4];
+	float color[4];
+};
+
+// the record glDrawArraysIndirect and glMultiDrawArraysIndirect read
+struct DrawArraysIndirectCommand {
+	GLuint count;
+	GLuint instanceCount;
+	GLuint first;
+	GLuint baseInstance;
+};
+
+// Every object is a small triangle that slides along x (setFloat("xOffset")
+// in 6-shaders/exercises/2) and blinks red at its own rate (ourColor in
+// blinking-red-triangle).
+struct Object {
+	float x, y;
+	float speed;
+	float green, blue;
+};
+
+DrawData evaluate(const Object& object, float time) {
+	float slide = 0.05f * std::sin(object.speed * time);
+	float red = std::round(std::sin(5.0f * object.speed * time) / 2.0f + 0.5f);
+	return { { object.x + slide, object.y, 0.0f, 0.0f }, { red, object.green, object.blue, 1.0f } };
+}
+
+// sum of the framebuffer, to check every path draws the same thing
+unsigned long long framebufferChecksum() {
+	std::vector<unsigned char> pixels(SCR_WIDTH * SCR_HEIGHT * 4);
+	glReadPixels(0, 0, SCR_WIDTH, SCR_HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+	unsigned long long sum = 0;
+	for (std::size_t i = 0; i < pixels.size(); i++) {
+		sum += pixels[i] * (i % 251 + 1);
+	}
+	return sum;
+}
+
+// usage: per-draw-benchmark [object count] [frames]
+int main(int argc, char** argv) {
+	unsigned int objectCount = argc > 1 ? (unsigned int)atoi(argv[1]) : 10000;
+	int frames = argc > 2 ? atoi(argv[2]) : 100;
+
+	glfwInit();
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+	GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Learn OpenGL", NULL, NULL);
+	if (window == NULL) {
+		// the uniform paths still run on 3.3
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+		window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Learn OpenGL", NULL, NULL);
+	}
+	if (window == NULL) {
+		printf("Failed to create GLFW window\n");
+		glfwTerminate();
+		return -1;
+	}
+
+	glfwMakeContextCurrent(window);
+	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+		glfwTerminate();
+		printf("Failed to initialize GLAD\n");
+		return -1;
+	}
+	loadGLExtensions((GLADloadproc)glfwGetProcAddress);
+
+	bool storage = hasGLVersion(4, 3);
+	bool multiDraw = storage && (hasGLVersion(4, 6) || hasGLExtension("GL_ARB_shader_draw_parameters"));
+	printf("%s / %s, %u objects, %d frames\n", (const char*)glGetString(GL_RENDERER), (const char*)glGetString(GL_VERSION),
+		objectCount, frames);
+	glfwSwapInterval(0);
+
+	Shader uniformShader("per-draw-uniform.vs", "per-draw.fs");
+	Shader blockShader("per-draw-ubo.vs", "per-draw.fs");
+	glUniformBlockBinding(blockShader.ID, glGetUniformBlockIndex(blockShader.ID, "PerDraw"), 0);
+	GLint offsetLocation = glGetUniformLocation(uniformShader.ID, "offset");
+	GLint colorLocation = glGetUniformLocation(uniformShader.ID, "ourColor");
+	Shader* storageShader = storage ? new Shader("per-draw.vs", "per-draw.fs") : NULL;
+
+	float vertices[] = {
+		-0.004f, -0.004f, // left
+		 0.004f, -0.004f, // right
+		 0.0f,    0.004f, // top
+	};
+	unsigned int VAO, VBO, indirectBuffer = 0;
+	glGenVertexArrays(1, &VAO);
+	glGenBuffers(1, &VBO);
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	// the same triangle once per object, the draws only differ in their draw id
+	if (multiDraw) {
+		std::vector<DrawArraysIndirectCommand> commands(objectCount, { 3, 1, 0, 0 });
+		glGenBuffers(1, &indirectBuffer);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, commands.size() * sizeof(DrawArraysIndirectCommand), commands.data(), GL_STATIC_DRAW);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	}
+
+	std::mt19937 rng(5);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	std::vector<Object> objects(objectCount);
+	for (Object& object : objects) {
+		object = { unit(rng) * 1.9f - 0.95f, unit(rng) * 1.9f - 0.95f, 0.5f + 3.0f * unit(rng), unit(rng), unit(rng) };
+	}
+
+	FramesInFlight framesInFlight(2);
+	glClearColor(1.0, 1.0, 1.0, 1.0);
+
+	const char* names[] = { "uniforms per draw", "uniform block batches", "storage buffer, instanced", "storage buffer, multi-draw" };
+	unsigned long long reference = 0;
+	for (int path = 0; path < 4 && !glfwWindowShouldClose(window); path++) {
+		if ((path >= 2 && !storage) || (path == 3 && !multiDraw)) {
+			printf("%-28s not supported by this context\n", names[path]);
+			continue;
+		}
+
+		PerDrawBuffer<DrawData>* perDraw = NULL;
+		if (path > 0) {
+			perDraw = new PerDrawBuffer<DrawData>(objectCount, framesInFlight.count(), UNIFORM_BATCH, path >= 2);
+		}
+
+		// one frame of every object, returns the number of GL calls that set or draw something
+		auto drawFrame = [&](float time) -> unsigned int {
+			unsigned int slot = framesInFlight.begin();
+			unsigned int calls = 0;
+			glBindVertexArray(VAO);
+			if (path == 0) {
+				uniformShader.use();
+				for (const Object& object : objects) {
+					DrawData d = evaluate(object, time);
+					glUniform2f(offsetLocation, d.offset[0], d.offset[1]);
+					glUniform4f(colorLocation, d.color[0], d.color[1], d.color[2], d.color[3]);
+					glDrawArrays(GL_TRIANGLES, 0, 3);
+				}
+				calls = objectCount * 3;
+			}
+			else {
+				// every object's parameters in one mapped write
+				DrawData* draws = perDraw->map(slot);
+				if (draws != NULL) {
+					for (unsigned int i = 0; i < objectCount; i++) {
+						draws[i] = evaluate(objects[i], time);
+					}
+					perDraw->unmap();
+				}
+
+				if (path == 1) {
+					blockShader.use();
+					for (unsigned int batch = 0; batch < perDraw->batches(objectCount); batch++) {
+						unsigned int first = batch * perDraw->batch;
+						unsigned int count = std::min(perDraw->batch, objectCount - first);
+						perDraw->bind(slot, 0, first);
+						glDrawArraysInstanced(GL_TRIANGLES, 0, 3, count);
+						calls += 2;
+					}
+				}
+				else {
+					storageShader->use();
+					perDraw->bind(slot, 0);
+					if (path == 2) {
+						glDrawArraysInstanced(GL_TRIANGLES, 0, 3, objectCount);
+					}
+					else {
+						glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+						glMultiDrawArraysIndirect(GL_TRIANGLES, (void*)0, objectCount, 0);
+						glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+					}
+					calls = 2;
+				}
+			}
+			glBindVertexArray(0);
+			framesInFlight.end();
+			return calls;
+		};
+
+		double submitTime = 0.0;
+		unsigned int calls = 0;
+		double start = glfwGetTime();
+		for (int frame = 0; frame < frames; frame++) {
+			glClear(GL_COLOR_BUFFER_BIT);
+			double submitStart = glfwGetTime();
+			calls = drawFrame((float)frame / 60.0f);
+			submitTime += glfwGetTime() - submitStart;
+
+			glfwSwapBuffers(window);
+			glfwPollEvents();
+		}
+		glFinish();
+		double total = glfwGetTime() - start;
+
+		// the last frame again, read back before the swap
+		glClear(GL_COLOR_BUFFER_BIT);
+		drawFrame((float)(frames - 1) / 60.0f);
+		unsigned long long checksum = framebufferChecksum();
+		if (path == 0) {
+			reference = checksum;
+		}
+		printf("%-28s %6u GL calls, %8.3f ms/frame submit, %8.3f ms/frame total  %s\n", names[path], calls,
+			submitTime * 1000.0 / frames, total * 1000.0 / frames, checksum == reference ? "same image" : "IMAGE DIFFERS");
+
+		framesInFlight.finish();
+		if (perDraw != NULL) {
+			perDraw->del();
+			delete perDraw;
+		}
+	}
+
+	framesInFlight.del();
+	glDeleteVertexArrays(1, &VAO);
+	glDeleteBuffers(1, &VBO);
+	glDeleteBuffers(1, &indirectBuffer);
+	uniformShader.del();
+	blockShader.del();
+	if (storageShader != NULL) {
+		storageShader->del();
+		delete storageShader;
+	}
+
+	glfwTerminate();
+	return 0;
+}
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
+	glViewport(0, 0, width, height);
+}
@@ -0,0 +1,18 @@
+#version 330 core
+layout (location = 0) in vec2 pos;
+
+struct DrawData {
+    vec4 offset;   // xy
+    vec4 color;
+};
+// the batch size given to PerDrawBuffer
+layout (std140) uniform PerDraw {
+    DrawData draws[256];
+};
+
+out vec4 vertexColor;
+
+void main() {
+    gl_Position = vec4(pos + draws[gl_InstanceID].offset.xy, 0.0, 1.0);
+    vertexColor = draws[gl_InstanceID].color;
+}
@@ -0,0 +1,12 @@
+#version 330 core
+layout (location = 0) in vec2 pos;
+
+uniform vec2 offset;
+uniform vec4 ourColor;
+
+out vec4 vertexColor;
+
+void main() {
+    gl_Position = vec4(pos + offset, 0.0, 1.0);
+    vertexColor = ourColor;
+}
@@ -0,0 +1,24 @@
+#version 430 core
+#extension GL_ARB_shader_draw_parameters : enable
+layout (location = 0) in vec2 pos;
+
+struct DrawData {
+    vec4 offset;   // xy
+    vec4 color;
+};
+layout (std430, binding = 0) readonly buffer PerDraw {
+    DrawData draws[];
+};
+
+out vec4 vertexColor;
+
+void main() {
+    // one of the two is always 0: instanced draws have one draw, the multi-draw one instance each
+#ifdef GL_ARB_shader_draw_parameters
+    int draw = gl_InstanceID + gl_DrawIDARB;
+#else
+    int draw = gl_InstanceID;
+#endif
+    gl_Position = vec4(pos + draws[draw].offset.xy, 0.0, 1.0);
+    vertexColor = draws[draw].color;
+}
@@ -0,0 +1,17 @@
+#version 330 core
+in vec2 uv;
+out vec4 FragColor;
+
+uniform sampler2D source;
+uniform vec2 direction;   // one texel along the blur
+
+const float weights[5] = float[](0.227027, 0.1945946, 0.1216216, 0.054054, 0.016216);
+
+void main() {
+    vec3 sum = texture(source, uv).rgb * weights[0];
+    for (int i = 1; i < 5; i++) {
+        sum += texture(source, uv + direction * i).rgb * weights[i];
+        sum += texture(source, uv - direction * i).rgb * weights[i];
+    }
+    FragColor = vec4(sum, 1.0);
+}
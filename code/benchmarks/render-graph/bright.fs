@@ -0,0 +1,10 @@
+#version 330 core
+in vec2 uv;
+out vec4 FragColor;
+
+uniform sampler2D source;
+
+void main() {
+    vec3 color = texture(source, uv).rgb;
+    FragColor = vec4(max(color - 1.0, 0.0), 1.0);
+}
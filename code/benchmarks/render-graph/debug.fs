@@ -0,0 +1,10 @@
+#version 330 core
+// a debug view of the shadow map, nothing reads it unless it's shown
+in vec2 uv;
+out vec4 FragColor;
+
+uniform sampler2D source;
+
+void main() {
+    FragColor = vec4(vec3(texture(source, uv).r), 1.0);
+}
@@ -0,0 +1,280 @@
+#include "render-graph.h"
+#include "maths.h"
+#include "shader.h"
+#include <GLFW/glfw3.h>
+#include <chrono>
+#include <cstdlib>
+#include <random>
+
+using namespace maths;
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+
+// a box of 6 faces, 4 vertices each: position, normal, color
+void addBox(std::vector<float>& vertices, std::vector<unsigned int>& indices, const vec3& lo, const vec3& hi, const vec3& color) {
+	const float normals[6][3] = { { 1,0,0 }, { -1,0,0 }, { 0,1,0 }, { 0,-1,0 }, { 0,0,1 }, { 0,0,-1 } };
+	for (int face = 0; face < 6; face++) {
+		vec3 n(normals[face][0], normals[face][1], normals[face][2]);
+		// two axes spanning the face, u x v = n so the winding is counter-clockwise
+		vec3 u = std::fabs(n.y) > 0.5f ? vec3(0.0f, 0.0f, n.y) : vec3(-n.z, 0.0f, n.x);
+		vec3 v = cross(n, u);
+		vec3 center = (lo + hi) * 0.5f, half = (hi - lo) * 0.5f;
+		unsigned int base = (unsigned int)(vertices.size() / 9);
+		for (int corner = 0; corner < 4; corner++) {
+			float su = (corner == 1 || corner == 2) ? 1.0f : -1.0f, sv = corner >= 2 ? 1.0f : -1.0f;
+			vec3 p = center + (n + u * su + v * sv) * half;
+			vertices.insert(vertices.end(), { p.x, p.y, p.z, n.x, n.y, n.z, color.x, color.y, color.z });
+		}
+		indices.insert(indices.end(), { base, base + 1, base + 2, base, base + 2, base + 3 });
+	}
+}
+
+// usage: render-graph-benchmark [frames]
+int main(int argc, char** argv) {
+	int frames = argc > 1 ? atoi(argv[1]) : 30;
+
+	glfwInit();
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+	GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Learn OpenGL", NULL, NULL);
+	if (window == NULL) {
+		printf("Failed to create GLFW window\n");
+		glfwTerminate();
+		return -1;
+	}
+
+	glfwMakeContextCurrent(window);
+	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+		glfwTerminate();
+		printf("Failed to initialize GLAD\n");
+		return -1;
+	}
+
+	printf("%s / %s, %d frames\n\n", (const char*)glGetString(GL_RENDERER), (const char*)glGetString(GL_VERSION), frames);
+	glfwSwapInterval(0);
+
+	Shader sceneShader("scene.vs", "scene.fs");
+	Shader shadowShader("shadow.vs", "shadow.fs");
+	Shader brightShader("../../../shaders/vertex/fullscreen.vs", "bright.fs");
+	Shader blurShader("../../../shaders/vertex/fullscreen.vs", "blur.fs");
+	Shader tonemapShader("../../../shaders/vertex/fullscreen.vs", "tonemap.fs");
+	Shader debugShader("../../../shaders/vertex/fullscreen.vs", "debug.fs");
+	tonemapShader.use();
+	tonemapShader.setInt("scene", 0);
+	tonemapShader.setInt("bloom", 1);
+
+	// the ground, a grid of blocks, and a few bright ones for the bloom
+	std::mt19937 rng(5);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	std::vector<float> vertices;
+	std::vector<unsigned int> indices;
+	addBox(vertices, indices, vec3(-40.0f, -1.0f, -40.0f), vec3(40.0f, 0.0f, 40.0f), vec3(0.5f, 0.5f, 0.5f));
+	for (int z = 0; z < 8; z++) {
+		for (int x = 0; x < 8; x++) {
+			vec3 lo(-36.0f + x * 9.0f, 0.0f, -36.0f + z * 9.0f);
+			float height = 1.0f + 8.0f * unit(rng);
+			float glow = unit(rng) < 0.15f ? 3.0f : 1.0f;
+			addBox(vertices, indices, lo, lo + vec3(4.0f, height, 4.0f),
+				vec3(0.3f + 0.5f * unit(rng), 0.3f + 0.5f * unit(rng), 0.6f) * glow);
+		}
+	}
+	unsigned int vao, vbo, ebo, emptyVAO;
+	glGenVertexArrays(1, &vao);
+	glGenVertexArrays(1, &emptyVAO);
+	glGenBuffers(1, &vbo);
+	glGenBuffers(1, &ebo);
+	glBindVertexArray(vao);
+	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 9 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 9 * sizeof(float), (void*)(3 * sizeof(float)));
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 9 * sizeof(float), (void*)(6 * sizeof(float)));
+	glEnableVertexAttribArray(2);
+	glBindVertexArray(0);
+
+	vec3 lightDirection = normalize(vec3(0.4f, 1.0f, 0.3f));
+	mat4 lightViewProjection = ortho(-50.0f, 50.0f, -50.0f, 50.0f, 1.0f, 120.0f) *
+		lookAt(lightDirection * 60.0f, vec3(0.0f, 0.0f, 0.0f), vec3(0.0f, 1.0f, 0.0f));
+	mat4 viewProjection;
+	int debugRuns = 0;
+
+	auto drawScene = [&](Shader& shader) {
+		shader.use();
+		glUniformMatrix4fv(glGetUniformLocation(shader.ID, "viewProjection"), 1, GL_FALSE, viewProjection.ptr());
+		glUniformMatrix4fv(glGetUniformLocation(shader.ID, "lightViewProjection"), 1, GL_FALSE, lightViewProjection.ptr());
+		glBindVertexArray(vao);
+		glDrawElements(GL_TRIANGLES, (GLsizei)indices.size(), GL_UNSIGNED_INT, 0);
+	};
+	auto fullscreen = [&](Shader& shader, GLuint source) {
+		shader.use();
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, source);
+		glBindVertexArray(emptyVAO);
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+	};
+
+	// shadows -> scene -> bright -> 2 x (blur h, blur v) -> tonemap, and a
+	// debug view of the shadow map that nothing shows
+	auto buildGraph = [&](RenderGraph& graph) {
+		typedef RenderGraph::Resource Resource;
+		const int w = SCR_WIDTH, h = SCR_HEIGHT;
+		graph.setBackbufferSize(w, h);
+		Resource shadowMap = graph.createTexture("shadow map", RenderTargetDesc(1024, 1024, GL_DEPTH_COMPONENT24));
+		Resource hdr = graph.createTexture("hdr", RenderTargetDesc(w, h, GL_RGBA16F));
+		Resource depth = graph.createTexture("depth", RenderTargetDesc(w, h, GL_DEPTH_COMPONENT24));
+		Resource debugView = graph.createTexture("debug view", RenderTargetDesc(w, h, GL_RGBA8));
+		Resource bloom[5];
+		const char* bloomNames[5] = { "bright", "blur h1", "blur v1", "blur h2", "blur v2" };
+		for (int i = 0; i < 5; i++) {
+			bloom[i] = graph.createTexture(bloomNames[i], RenderTargetDesc(w / 2, h / 2, GL_RGBA16F));
+		}
+
+		unsigned int pass = graph.addPass("shadows", [&] {
+			glEnable(GL_DEPTH_TEST);
+			drawScene(shadowShader);
+		});
+		graph.write(pass, shadowMap);
+
+		pass = graph.addPass("scene", [&, shadowMap] {
+			glEnable(GL_DEPTH_TEST);
+			glActiveTexture(GL_TEXTURE0);
+			glBindTexture(GL_TEXTURE_2D, graph.texture(shadowMap));
+			sceneShader.use();
+			sceneShader.setInt("shadowMap", 0);
+			glUniform3f(glGetUniformLocation(sceneShader.ID, "lightDirection"), lightDirection.x, lightDirection.y, lightDirection.z);
+			drawScene(sceneShader);
+		});
+		graph.read(pass, shadowMap);
+		graph.write(pass, hdr);
+		graph.write(pass, depth);
+
+		pass = graph.addPass("debug shadows", [&, shadowMap] {
+			debugRuns++;
+			glDisable(GL_DEPTH_TEST);
+			fullscreen(debugShader, graph.texture(shadowMap));
+		});
+		graph.read(pass, shadowMap);
+		graph.write(pass, debugView);
+
+		pass = graph.addPass("bright", [&, hdr] {
+			glDisable(GL_DEPTH_TEST);
+			fullscreen(brightShader, graph.texture(hdr));
+		});
+		graph.read(pass, hdr);
+		graph.write(pass, bloom[0]);
+
+		for (int i = 1; i < 5; i++) {
+			bool horizontal = i % 2 == 1;
+			Resource source = bloom[i - 1];
+			pass = graph.addPass(bloomNames[i], [&, source, horizontal] {
+				blurShader.use();
+				glUniform2f(glGetUniformLocation(blurShader.ID, "direction"), horizontal ? 2.0f / w : 0.0f, horizontal ? 0.0f : 2.0f / h);
+				fullscreen(blurShader, graph.texture(source));
+			});
+			graph.read(pass, source);
+			graph.write(pass, bloom[i]);
+		}
+
+		pass = graph.addPass("tonemap", [&, hdr, bloom] {
+			glActiveTexture(GL_TEXTURE1);
+			glBindTexture(GL_TEXTURE_2D, graph.texture(bloom[4]));
+			fullscreen(tonemapShader, graph.texture(hdr));
+		});
+		graph.read(pass, hdr);
+		graph.read(pass, bloom[4]);
+		graph.write(pass, RenderGraph::BACKBUFFER);
+	};
+
+	std::vector<unsigned char> reference(SCR_WIDTH * SCR_HEIGHT * 4), pixels(reference.size());
+	for (int run = 0; run < 2 && !glfwWindowShouldClose(window); run++) {
+		RenderGraph graph;
+		graph.aliasing = run == 0;
+		buildGraph(graph);
+		if (!graph.compile()) {
+			return -1;
+		}
+		const RenderGraph::Stats& stats = graph.getStats();
+		printf("aliasing %s: %u passes, %u culled, %u transient textures on %u GL textures, %.2f MB instead of %.2f MB (%.2f MB saved)\n",
+			graph.aliasing ? "on" : "off", stats.passes, stats.culledPasses, stats.transientTextures, stats.physicalTextures,
+			stats.physicalBytes / (1024.0 * 1024.0), stats.transientBytes / (1024.0 * 1024.0), stats.savedBytes() / (1024.0 * 1024.0));
+		graph.print();
+
+		FrameProfiler profiler;
+		debugRuns = 0;
+		auto drawFrame = [&](float time) {
+			float angle = 0.3f + time * 0.03f;
+			viewProjection = perspective(radians(60.0f), (float)SCR_WIDTH / SCR_HEIGHT, 0.5f, 200.0f) *
+				lookAt(vec3(std::cos(angle) * 45.0f, 20.0f, std::sin(angle) * 45.0f), vec3(0.0f, 0.0f, 0.0f), vec3(0.0f, 1.0f, 0.0f));
+			profiler.beginFrame();
+			graph.execute(&profiler);
+			graph.publish(profiler);
+		};
+
+		// one frame to warm up, the very first timer query can come back garbage
+		drawFrame(0.0f);
+		glFinish();
+		profiler.flush();
+		profiler.resetStats();
+
+		auto start = std::chrono::high_resolution_clock::now();
+		for (int frame = 0; frame < frames; frame++) {
+			drawFrame((float)frame);
+			glfwSwapBuffers(window);
+			glfwPollEvents();
+		}
+		glFinish();
+		double total = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+		// the last frame again, read back before the swap
+		drawFrame((float)(frames - 1));
+		glReadPixels(0, 0, SCR_WIDTH, SCR_HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, (run == 0 ? reference : pixels).data());
+		std::size_t differing = 0;
+		for (std::size_t p = 0; run > 0 && p < pixels.size(); p += 4) {
+			differing += std::equal(pixels.begin() + p, pixels.begin() + p + 4, reference.begin() + p) ? 0 : 1;
+		}
+		printf("%.2f ms/frame, culled pass ran %d times", total / frames, debugRuns);
+		if (run > 0) {
+			printf(", %zu pixels differ from aliasing on", differing);
+		}
+		printf("\n");
+		profiler.flush();
+		profiler.print();
+		printf("\n");
+
+		profiler.del();
+		graph.del();
+	}
+
+	glDeleteVertexArrays(1, &vao);
+	glDeleteVertexArrays(1, &emptyVAO);
+	glDeleteBuffers(1, &vbo);
+	glDeleteBuffers(1, &ebo);
+	glDeleteProgram(sceneShader.ID);
+	glDeleteProgram(shadowShader.ID);
+	glDeleteProgram(brightShader.ID);
+	glDeleteProgram(blurShader.ID);
+	glDeleteProgram(tonemapShader.ID);
+	glDeleteProgram(debugShader.ID);
+
+	glfwTerminate();
+	return 0;
+}
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
+	glViewport(0, 0, width, height);
+}
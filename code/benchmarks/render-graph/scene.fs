@@ -0,0 +1,17 @@
+#version 330 core
+in vec3 worldNormal;
+in vec3 albedo;
+in vec4 lightSpace;
+
+out vec4 FragColor;
+
+uniform sampler2D shadowMap;
+uniform vec3 lightDirection;   // towards the light
+
+void main() {
+    vec3 p = lightSpace.xyz / lightSpace.w * 0.5 + 0.5;
+    float lit = p.z - 0.002 > texture(shadowMap, p.xy).r ? 0.0 : 1.0;
+    float diffuse = max(dot(normalize(worldNormal), lightDirection), 0.0) * lit;
+    // HDR: colors brighter than white are what the bloom picks up
+    FragColor = vec4(albedo * (0.15 + 2.5 * diffuse), 1.0);
+}
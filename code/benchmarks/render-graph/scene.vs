@@ -0,0 +1,18 @@
+#version 330 core
+layout (location = 0) in vec3 pos;
+layout (location = 1) in vec3 normal;
+layout (location = 2) in vec3 color;
+
+uniform mat4 viewProjection;
+uniform mat4 lightViewProjection;
+
+out vec3 worldNormal;
+out vec3 albedo;
+out vec4 lightSpace;
+
+void main() {
+    worldNormal = normal;
+    albedo = color;
+    lightSpace = lightViewProjection * vec4(pos, 1.0);
+    gl_Position = viewProjection * vec4(pos, 1.0);
+}
@@ -0,0 +1,8 @@
+#version 330 core
+layout (location = 0) in vec3 pos;
+
+uniform mat4 lightViewProjection;
+
+void main() {
+    gl_Position = lightViewProjection * vec4(pos, 1.0);
+}
@@ -0,0 +1,12 @@
+#version 330 core
+in vec2 uv;
+out vec4 FragColor;
+
+uniform sampler2D scene;
+uniform sampler2D bloom;
+
+void main() {
+    vec3 color = texture(scene, uv).rgb + texture(bloom, uv).rgb;
+    color = color / (color + 1.0);
+    FragColor = vec4(pow(color, vec3(1.0 / 2.2)), 1.0);
+}
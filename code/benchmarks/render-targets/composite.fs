@@ -0,0 +1,11 @@
+#version 330 core
+in vec2 uv;
+out vec4 FragColor;
+
+uniform sampler2D scene;
+uniform sampler2D glow;
+
+void main() {
+    vec3 color = texture(scene, uv).rgb + 0.5 * texture(glow, uv).rgb;
+    FragColor = vec4(color / (color + 1.0), 1.0);
+}
@@ -0,0 +1,10 @@
+#version 330 core
+// half size, the bilinear fetch averages 2 x 2 source texels
+in vec2 uv;
+out vec4 FragColor;
+
+uniform sampler2D source;
+
+void main() {
+    FragColor = vec4(texture(source, uv).rgb, 1.0);
+}
@@ -0,0 +1,197 @@
+#include "render-graph.h"
+#include "render-target-pool.h"
+#include "shader.h"
+#include <GLFW/glfw3.h>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+
+const double FRAME_TIME = 1.0 / 60.0;   // simulated, the resize storm doesn't depend on how fast frames are
+
+// the window size while it is dragged around, a new size nearly every frame
+void dragSize(int frame, int& width, int& height) {
+	width = 600 + (int)(200.0 * std::sin(frame * 0.13));
+	height = 450 + (int)(150.0 * std::cos(frame * 0.11));
+}
+
+// usage: render-targets-benchmark [resize frames] [settle frames]
+int main(int argc, char** argv) {
+	int stormFrames = argc > 1 ? atoi(argv[1]) : 120;
+	int settleFrames = argc > 2 ? atoi(argv[2]) : 30;
+
+	glfwInit();
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+	GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Learn OpenGL", NULL, NULL);
+	if (window == NULL) {
+		printf("Failed to create GLFW window\n");
+		glfwTerminate();
+		return -1;
+	}
+
+	glfwMakeContextCurrent(window);
+	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+		glfwTerminate();
+		printf("Failed to initialize GLAD\n");
+		return -1;
+	}
+
+	printf("%s / %s\n%d frames of resizing then %d still, at %.0f simulated fps\n\n", (const char*)glGetString(GL_RENDERER),
+		(const char*)glGetString(GL_VERSION), stormFrames, settleFrames, 1.0 / FRAME_TIME);
+	glfwSwapInterval(0);
+
+	Shader sceneShader("../../../shaders/vertex/fullscreen.vs", "scene.fs");
+	Shader downsampleShader("../../../shaders/vertex/fullscreen.vs", "downsample.fs");
+	Shader compositeShader("../../../shaders/vertex/fullscreen.vs", "composite.fs");
+	compositeShader.use();
+	compositeShader.setInt("scene", 0);
+	compositeShader.setInt("glow", 1);
+	unsigned int emptyVAO;
+	glGenVertexArrays(1, &emptyVAO);
+	float time = 0.0f;
+
+	auto fullscreen = [&](Shader& shader, GLuint source) {
+		shader.use();
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, source);
+		glBindVertexArray(emptyVAO);
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+	};
+
+	// scene -> half size copy -> composite into output, all at width x height
+	auto buildGraph = [&](RenderGraph& graph, int width, int height, GLuint output) {
+		typedef RenderGraph::Resource Resource;
+		Resource scene = graph.createTexture("scene", RenderTargetDesc(width, height, GL_RGBA16F));
+		Resource half = graph.createTexture("half", RenderTargetDesc(width / 2, height / 2, GL_RGBA16F));
+		Resource target = graph.importTexture("output", output, RenderTargetDesc(width, height, GL_RGBA8));
+
+		unsigned int pass = graph.addPass("scene", [&] {
+			sceneShader.use();
+			sceneShader.setFloat("time", time);
+			glBindVertexArray(emptyVAO);
+			glDrawArrays(GL_TRIANGLES, 0, 3);
+		});
+		graph.write(pass, scene);
+
+		pass = graph.addPass("downsample", [&, scene] {
+			fullscreen(downsampleShader, graph.texture(scene));
+		});
+		graph.read(pass, scene);
+		graph.write(pass, half);
+
+		pass = graph.addPass("composite", [&, scene, half] {
+			glActiveTexture(GL_TEXTURE1);
+			glBindTexture(GL_TEXTURE_2D, graph.texture(half));
+			fullscreen(compositeShader, graph.texture(scene));
+		});
+		graph.read(pass, scene);
+		graph.read(pass, half);
+		graph.write(pass, target);
+	};
+
+	std::vector<unsigned char> reference, pixels;
+	const char* names[] = { "reallocate on resize", "pool", "pool + debounce" };
+	for (int mode = 0; mode < 3 && !glfwWindowShouldClose(window); mode++) {
+		// no pool to speak of: whatever is released is deleted
+		RenderTargetPool pool(mode == 0 ? 0 : 64 * 1024 * 1024, mode == 0 ? 0 : 120);
+		ResizeDebouncer debouncer(SCR_WIDTH, SCR_HEIGHT, mode == 2 ? 0.25 : 0.0);
+		RenderGraph graph(&pool);
+		unsigned int outputFramebuffer;
+		glGenFramebuffers(1, &outputFramebuffer);
+		GLuint output = 0;
+		unsigned int reallocations = 0, scaledFrames = 0;
+		std::size_t peakBytes = 0;
+
+		auto allocate = [&] {
+			if (output != 0) {
+				pool.release(output);
+			}
+			output = pool.acquire(RenderTargetDesc(debouncer.renderWidth, debouncer.renderHeight, GL_RGBA8));
+			glBindFramebuffer(GL_FRAMEBUFFER, outputFramebuffer);
+			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, output, 0);
+			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+			graph.clear();
+			buildGraph(graph, debouncer.renderWidth, debouncer.renderHeight, output);
+			graph.compile();
+		};
+		allocate();
+		pool.resetStats();
+
+		auto start = std::chrono::high_resolution_clock::now();
+		int frames = stormFrames + settleFrames;
+		for (int frame = 0; frame < frames; frame++) {
+			double now = frame * FRAME_TIME;
+			time = (float)now;
+			// what framebuffer_size_callback would pass on while the window is dragged
+			int width, height;
+			dragSize(frame < stormFrames ? frame : stormFrames - 1, width, height);
+			debouncer.resize(width, height, now);
+
+			pool.beginFrame();
+			if (debouncer.update(now)) {
+				allocate();
+				reallocations++;
+			}
+			scaledFrames += debouncer.scaling() ? 1 : 0;
+			graph.execute();
+
+			glClear(GL_COLOR_BUFFER_BIT);
+			debouncer.present(outputFramebuffer);
+			peakBytes = pool.getStats().liveBytes > peakBytes ? pool.getStats().liveBytes : peakBytes;
+			if (frame == frames - 1) {
+				// what the window shows at the size it settled at
+				pixels.resize((std::size_t)width * height * 4);
+				glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+			}
+			glfwSwapBuffers(window);
+			glfwPollEvents();
+		}
+		glFinish();
+		double total = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+		const RenderTargetPool::Stats& stats = pool.getStats();
+		printf("%-22s %3u reallocations %4llu textures made (%7.1f MB), %4llu evicted, %3llu reused, peak %5.1f MB live, %3u frames scaled, %6.2f ms/frame",
+			names[mode], reallocations, stats.allocations, stats.allocatedBytes / (1024.0 * 1024.0), stats.evictions, stats.hits,
+			peakBytes / (1024.0 * 1024.0), scaledFrames, total / frames);
+		if (mode == 0) {
+			reference = pixels;
+		}
+		else {
+			std::size_t differing = 0;
+			for (std::size_t p = 0; p < pixels.size(); p += 4) {
+				differing += std::equal(pixels.begin() + p, pixels.begin() + p + 4, reference.begin() + p) ? 0 : 1;
+			}
+			printf("  last frame: %zu pixels differ", differing);
+		}
+		printf("\n");
+
+		graph.del();
+		pool.del();
+		glDeleteFramebuffers(1, &outputFramebuffer);
+	}
+
+	glDeleteVertexArrays(1, &emptyVAO);
+	glDeleteProgram(sceneShader.ID);
+	glDeleteProgram(downsampleShader.ID);
+	glDeleteProgram(compositeShader.ID);
+
+	glfwTerminate();
+	return 0;
+}
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
+	glViewport(0, 0, width, height);
+}
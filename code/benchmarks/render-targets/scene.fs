@@ -0,0 +1,14 @@
+#version 330 core
+// something with edges and gradients that looks the same at any size
+in vec2 uv;
+out vec4 FragColor;
+
+uniform float time;
+
+void main() {
+    vec2 p = uv * 2.0 - 1.0;
+    float rings = 0.5 + 0.5 * sin(length(p) * 30.0 - time * 2.0);
+    float grid = step(0.9, fract(uv.x * 12.0)) + step(0.9, fract(uv.y * 9.0));
+    vec3 color = mix(vec3(0.1, 0.2, 0.5), vec3(1.0, 0.6, 0.2), rings) + grid * 0.8;
+    FragColor = vec4(color * 1.5, 1.0);
+}
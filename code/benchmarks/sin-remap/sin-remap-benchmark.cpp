@@ -0,0 +1,104 @@
+#include "animation.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace animation;
+
+const std::size_t TRACK_COUNT = 500000;
+const int FRAMES = 200;
+
+template <typename F>
+double timeMs(F f) {
+	auto start = std::chrono::high_resolution_clock::now();
+	f();
+	auto end = std::chrono::high_resolution_clock::now();
+	return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+void report(const char* name, double ms) {
+	double perFrame = ms / FRAMES;
+	printf("%-34s %8.3f ms/frame  %8.1f Mtracks/s\n", name, perFrame, TRACK_COUNT / (perFrame * 1000.0));
+}
+
+int main() {
+	SinRemapAnimator animator;
+
+	// random ranges, speeds and phases like a scene full of blinking/sliding objects
+	srand(42);
+	for (std::size_t i = 0; i < TRACK_COUNT; i++) {
+		float a = (float)rand() / RAND_MAX - 1.0f;
+		float b = a + (float)rand() / RAND_MAX;
+		float omega = 0.5f + 10.0f * (float)rand() / RAND_MAX;
+		float phase = 6.2831853f * (float)rand() / RAND_MAX;
+		animator.add(a, b, omega, phase);
+	}
+
+	std::vector<float> reference(TRACK_COUNT), out(TRACK_COUNT);
+	float dt = 1.0f / 60.0f;
+
+	printf("%zu tracks, %d frames, %u threads\n\n", TRACK_COUNT, FRAMES, animator.threadCount());
+
+	// the formula from cheatsheet/maths.md, evaluated with libm like blinking-red-triangle.cpp does
+	double ms = timeMs([&]() {
+		for (int frame = 0; frame < FRAMES; frame++) {
+			float t = frame * dt;
+			for (std::size_t i = 0; i < TRACK_COUNT; i++) {
+				float s = sinf(animator.omega[i] * t + animator.phase[i]);
+				reference[i] = (animator.b[i] - animator.a[i]) / 2.0f * s + (animator.a[i] + animator.b[i]) / 2.0f;
+			}
+		}
+	});
+	report("libm sinf, 1 thread", ms);
+
+	ms = timeMs([&]() {
+		for (int frame = 0; frame < FRAMES; frame++) {
+			evaluateSinRemap(animator.a.data(), animator.b.data(), animator.omega.data(), animator.phase.data(),
+				0, TRACK_COUNT, frame * dt, out.data());
+		}
+	});
+	report("SIMD fastSin, 1 thread", ms);
+
+	ms = timeMs([&]() {
+		for (int frame = 0; frame < FRAMES; frame++) {
+			animator.update(frame * dt, out.data());
+		}
+	});
+	report("SIMD fastSin, all threads", ms);
+
+	// interleaved output, as when writing one attribute of a mapped vertex buffer
+	std::vector<float> interleaved(TRACK_COUNT * 4);
+	ms = timeMs([&]() {
+		for (int frame = 0; frame < FRAMES; frame++) {
+			animator.update(frame * dt, interleaved.data() + 1, 4);
+		}
+	});
+	report("SIMD fastSin, all threads, stride 4", ms);
+
+	// error against double precision sin over a long time range
+	double maxSinErr = 0.0;
+	for (int i = -2000000; i <= 2000000; i++) {
+		float x = i * 0.001f;
+		double err = fabs((double)fastSin(x) - sin((double)x));
+		if (err > maxSinErr) {
+			maxSinErr = err;
+		}
+	}
+
+	float t = (FRAMES - 1) * dt;
+	double maxErr = 0.0;
+	for (std::size_t i = 0; i < TRACK_COUNT; i++) {
+		double x = (double)animator.omega[i] * t + animator.phase[i];
+		double exact = (animator.b[i] - animator.a[i]) / 2.0 * sin(x) + (animator.a[i] + animator.b[i]) / 2.0;
+		double err = fabs(out[i] - exact);
+		if (err > maxErr) {
+			maxErr = err;
+		}
+	}
+
+	printf("\nfastSin max abs error on [-2000, 2000]: %.3g\n", maxSinErr);
+	printf("remapped value max abs error:           %.3g\n", maxErr);
+	return 0;
+}
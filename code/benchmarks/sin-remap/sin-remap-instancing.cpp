@@ -0,0 +1,155 @@
+#include "shader.h"
+#include "animation.h"
+#include "frames-in-flight.h"
+#include <GLFW/glfw3.h>
+#include <cstdlib>
+#include <vector>
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void processInput(GLFWwindow* window);
+
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+
+// one tiny triangle per track
+const unsigned int INSTANCE_COUNT = 200000;
+
+// usage: sin-remap-instancing [frames in flight, 1 to 3]
+int main(int argc, char** argv) {
+	glfwInit();
+
+	// Initialize GLFW window (https://www.glfw.org/docs/latest/window.html#window_hints)
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+	GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Learn OpenGL", NULL, NULL);
+	if (window == NULL) {
+		printf("Failed to create GLFW window\n");
+		glfwTerminate();
+		return -1;
+	}
+
+	glfwMakeContextCurrent(window);
+	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+		glfwTerminate();
+		printf("Failed to initialize GLAD\n");
+		return -1;
+	}
+
+	Shader myShader("sin-remap.vs", "sin-remap.fs");
+
+	float vertices[] = {
+		-0.004f, -0.004f, // left
+		 0.004f, -0.004f, // right
+		 0.0f,    0.004f, // top
+	};
+
+	// every instance slides between its own [a, b] at its own speed
+	animation::SinRemapAnimator animator;
+	std::vector<float> bases(INSTANCE_COUNT * 2);
+	srand(7);
+	for (unsigned int i = 0; i < INSTANCE_COUNT; i++) {
+		bases[i * 2] = 0.0f;
+		bases[i * 2 + 1] = (float)rand() / RAND_MAX * 1.9f - 0.95f;
+		float a = (float)rand() / RAND_MAX * -0.95f;
+		float b = (float)rand() / RAND_MAX * 0.95f;
+		animator.add(a, b, 0.5f + 4.0f * (float)rand() / RAND_MAX, 6.2831853f * (float)rand() / RAND_MAX);
+	}
+
+	unsigned int VAO, VBO[2];
+	glGenVertexArrays(1, &VAO);
+	glGenBuffers(2, VBO);
+
+	glBindVertexArray(VAO);
+
+	// triangle shape
+	glBindBuffer(GL_ARRAY_BUFFER, VBO[0]);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
+
+	// per-instance base position, set once
+	glBindBuffer(GL_ARRAY_BUFFER, VBO[1]);
+	glBufferData(GL_ARRAY_BUFFER, bases.size() * sizeof(float), bases.data(), GL_STATIC_DRAW);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(1);
+	glVertexAttribDivisor(1, 1);
+
+	// per-instance xOffset, rewritten by the animator every frame into the
+	// region of the current frame slot
+	FramesInFlight framesInFlight(argc > 1 ? (unsigned int)atoi(argv[1]) : 2);
+	FrameRingBuffer offsetRing(GL_ARRAY_BUFFER, INSTANCE_COUNT * sizeof(float), framesInFlight.count());
+	glEnableVertexAttribArray(2);
+	glVertexAttribDivisor(2, 1);
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+
+	glClearColor(1.0, 1.0, 1.0, 1.0);
+
+	double updateTime = 0.0;
+	unsigned int frames = 0;
+
+	while (!glfwWindowShouldClose(window)) {
+		processInput(window);
+
+		glClear(GL_COLOR_BUFFER_BIT);
+
+		// once the GPU is done with this slot's offsets, write the new ones
+		// straight into the mapping, no orphaning needed
+		unsigned int slot = framesInFlight.begin();
+		double start = glfwGetTime();
+		float* offsets = (float*)offsetRing.map(slot);
+		if (offsets != NULL) {
+			animator.update((float)start, offsets);
+			offsetRing.unmap();
+		}
+		updateTime += glfwGetTime() - start;
+		frames++;
+
+		myShader.use();
+		glBindVertexArray(VAO);
+		glBindBuffer(GL_ARRAY_BUFFER, offsetRing.buffer);
+		glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, sizeof(float), (void*)offsetRing.offset(slot));
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glDrawArraysInstanced(GL_TRIANGLES, 0, 3, INSTANCE_COUNT);
+		framesInFlight.end();
+
+		glfwPollEvents();
+		glfwSwapBuffers(window);
+	}
+
+	if (frames > 0) {
+		const FramesInFlight::Stats& stats = framesInFlight.getStats();
+		printf("%u instances, %u threads: %.3f ms per animation update\n",
+			INSTANCE_COUNT, animator.threadCount(), updateTime * 1000.0 / frames);
+		printf("%u frames in flight: CPU waited on the GPU in %llu of %llu frames, %.3f ms per frame, %.3f ms worst\n",
+			framesInFlight.count(), stats.waitedFrames, stats.frames, stats.waitMs / stats.frames, stats.maxWaitMs);
+	}
+
+	framesInFlight.finish();
+	offsetRing.del();
+	glDeleteVertexArrays(1, &VAO);
+	glDeleteBuffers(2, VBO);
+	myShader.del();
+
+	glfwTerminate();
+	return 0;
+}
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
+	glViewport(0, 0, width, height);
+}
+
+void processInput(GLFWwindow* window) {
+	if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_RIGHT) == GLFW_PRESS) {
+		glfwSetWindowShouldClose(window, true);
+	}
+}
@@ -0,0 +1,8 @@
+#version 330 core
+layout (location = 0) in vec2 pos;
+layout (location = 1) in vec2 instanceBase;
+layout (location = 2) in float xOffset;
+
+void main() {
+    gl_Position = vec4(pos + instanceBase + vec2(xOffset, 0.0), 0.0, 1.0);
+}
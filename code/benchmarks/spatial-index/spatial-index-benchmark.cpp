@@ -0,0 +1,164 @@
+#include "spatial-index.h"
+#include "culling.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace maths;
+
+typedef SpatialIndex::Rect Rect;
+
+// quads scattered over [-FIELD, FIELD]^2, the viewport is NDC [-1, 1]^2
+const float FIELD = 8.0f;
+const int PICKS = 1000;
+
+struct Scene {
+	std::vector<vec2> center;
+	std::vector<vec2> extent;
+	std::vector<vec2> velocity;
+	std::vector<unsigned int> movers;
+	culling::CullingSet soa;
+
+	Rect rect(unsigned int i) const {
+		return Rect{ center[i].x - extent[i].x, center[i].y - extent[i].y, center[i].x + extent[i].x, center[i].y + extent[i].y };
+	}
+};
+
+void initScene(Scene& scene, std::size_t count, float movingFraction) {
+	std::mt19937 rng(11);
+	std::uniform_real_distribution<float> field(-FIELD, FIELD);
+	std::uniform_real_distribution<float> size(0.005f, 0.03f);
+	std::uniform_real_distribution<float> speed(-0.5f, 0.5f);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	for (std::size_t i = 0; i < count; i++) {
+		scene.center.push_back(vec2(field(rng), field(rng)));
+		scene.extent.push_back(vec2(size(rng), size(rng)));
+		scene.velocity.push_back(vec2(speed(rng), speed(rng)));
+		if (unit(rng) < movingFraction) {
+			scene.movers.push_back((unsigned int)i);
+		}
+		vec3 c(scene.center[i], 0.0f), e(scene.extent[i], 0.0f);
+		scene.soa.addBox(c - e, c + e);
+	}
+}
+
+// moves the movers, bouncing off the edges of the field
+void step(Scene& scene, float dt) {
+	for (unsigned int i : scene.movers) {
+		vec2& c = scene.center[i];
+		vec2& v = scene.velocity[i];
+		c = vec2(c.x + v.x * dt, c.y + v.y * dt);
+		if (std::fabs(c.x) > FIELD) v.x = -v.x;
+		if (std::fabs(c.y) > FIELD) v.y = -v.y;
+		scene.soa.setCenter(i, vec3(c, 0.0f));
+	}
+}
+
+double msSince(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// usage: spatial-index-benchmark [quad count] [frames] [moving fraction]
+int main(int argc, char** argv) {
+	std::size_t count = argc > 1 ? (std::size_t)atoi(argv[1]) : 200000;
+	int frames = argc > 2 ? atoi(argv[2]) : 60;
+	float movingFraction = argc > 3 ? (float)atof(argv[3]) : 0.1f;
+	const float dt = 1.0f / 60.0f;
+
+#if defined(MATHS_SSE)
+	printf("spatial-index.h node test: SSE, ");
+#else
+	printf("spatial-index.h node test: scalar, ");
+#endif
+	printf("%zu quads, %.0f%% moving, %d frames\n", count, movingFraction * 100.0f, frames);
+
+	std::mt19937 rng(5);
+	std::uniform_real_distribution<float> ndc(-1.0f, 1.0f);
+	std::vector<vec2> picks(PICKS);
+	for (vec2& p : picks) {
+		p = vec2(ndc(rng), ndc(rng));
+	}
+	const Rect viewport = { -1.0f, -1.0f, 1.0f, 1.0f };
+
+	const char* names[] = { "linear SoA scan", "grow only", "refit", "rebuild" };
+	for (int mode = 0; mode < 4; mode++) {
+		Scene scene;
+		initScene(scene, count, movingFraction);
+		SpatialIndex index;
+		auto start = std::chrono::steady_clock::now();
+		for (std::size_t i = 0; i < count; i++) {
+			index.insert(scene.rect((unsigned int)i));
+		}
+		index.rebuild();
+		double buildMs = msSince(start);
+
+		double updateMs = 0.0, queryMs = 0.0, pickMs = 0.0;
+		std::vector<unsigned int> visible, expected;
+		std::size_t visibleTotal = 0, hits = 0;
+		bool same = true;
+		for (int frame = 0; frame < frames; frame++) {
+			step(scene, dt);
+
+			start = std::chrono::steady_clock::now();
+			if (mode > 0) {
+				for (unsigned int i : scene.movers) {
+					index.move(i, scene.rect(i));
+				}
+				if (mode == 2) {
+					index.refit();
+				}
+				else if (mode == 3) {
+					index.rebuild();
+				}
+			}
+			updateMs += msSince(start);
+
+			start = std::chrono::steady_clock::now();
+			visible.clear();
+			if (mode == 0) {
+				scene.soa.cullRect(vec4(viewport.minX, viewport.minY, viewport.maxX, viewport.maxY), visible);
+			}
+			else {
+				index.query(viewport, visible);
+			}
+			queryMs += msSince(start);
+			visibleTotal += visible.size();
+
+			start = std::chrono::steady_clock::now();
+			for (const vec2& p : picks) {
+				int hit = -1;
+				if (mode == 0) {
+					// the scan has no picking of its own, a 0-size rect does it
+					std::vector<unsigned int> under;
+					scene.soa.cullRect(vec4(p.x, p.y, p.x, p.y), under);
+					hit = under.empty() ? -1 : (int)under.back();
+				}
+				else {
+					hit = index.pick(p.x, p.y);
+				}
+				hits += hit >= 0 ? 1 : 0;
+			}
+			pickMs += msSince(start);
+
+			// against a plain loop, every 10th frame
+			if (frame % 10 == 0) {
+				expected.clear();
+				for (unsigned int i = 0; i < count; i++) {
+					Rect r = scene.rect(i);
+					if (r.minX <= viewport.maxX && r.maxX >= viewport.minX && r.minY <= viewport.maxY && r.maxY >= viewport.minY) {
+						expected.push_back(i);
+					}
+				}
+				std::sort(visible.begin(), visible.end());
+				same = same && visible == expected;
+			}
+		}
+
+		printf("%-16s build %7.2f ms  update %7.3f ms  query %6.3f ms  %d picks %7.3f ms  %6zu visible %6.1f hits  %s\n",
+			names[mode], mode == 0 ? 0.0 : buildMs, updateMs / frames, queryMs / frames, PICKS, pickMs / frames,
+			visibleTotal / frames, (double)hits / frames, same ? "same result" : "RESULT DIFFERS");
+	}
+	return 0;
+}
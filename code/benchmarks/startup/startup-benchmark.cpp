@@ -0,0 +1,171 @@
+#include "gl-lazy.h"
+#include <GLFW/glfw3.h>
+#include <cstdlib>
+#include <cstring>
+
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+
+const char* vertexShaderSource =
+	"#version 330 core\n"
+	"layout (location = 0) in vec3 pos;\n"
+	"void main() {\n"
+	"gl_Position = vec4(pos, 1.0);\n"
+	"}\0";
+const char* fragmentShaderSource =
+	"#version 330 core\n"
+	"out vec4 FragColor;\n"
+	"void main() {\n"
+	"FragColor = vec4(1.0, 0.0, 0.0, 1.0);\n"
+	"}\0";
+
+struct StartupTimes {
+	double context = 0.0;     // glfwCreateWindow + glfwMakeContextCurrent
+	double load = 0.0;        // resolving the GL entry points
+	double firstFrame = 0.0;  // hello-triangle setup and first frame, until glFinish
+	double total = 0.0;
+};
+
+// hello-triangle's setup and first frame, the lazy mode resolves its entry points here
+void drawFirstFrame(GLFWwindow* window) {
+	unsigned int vertexShader = glCreateShader(GL_VERTEX_SHADER);
+	glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
+	glCompileShader(vertexShader);
+	unsigned int fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+	glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
+	glCompileShader(fragmentShader);
+	unsigned int shaderProgram = glCreateProgram();
+	glAttachShader(shaderProgram, vertexShader);
+	glAttachShader(shaderProgram, fragmentShader);
+	glLinkProgram(shaderProgram);
+	glDeleteShader(vertexShader);
+	glDeleteShader(fragmentShader);
+
+	float vertices[] = {
+		-0.5f, -0.5f, 0.0f, // left
+		 0.5f, -0.5f, 0.0f, // right
+		 0.0f,  0.5f, 0.0f, // top
+	};
+
+	unsigned int VAO, VBO;
+	glGenVertexArrays(1, &VAO);
+	glGenBuffers(1, &VBO);
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
+
+	glClearColor(1.0, 1.0, 1.0, 1.0);
+	glClear(GL_COLOR_BUFFER_BIT);
+	glUseProgram(shaderProgram);
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+	glfwSwapBuffers(window);
+	glFinish();
+
+	glDeleteVertexArrays(1, &VAO);
+	glDeleteBuffers(1, &VBO);
+	glDeleteProgram(shaderProgram);
+}
+
+// context creation to first frame, false if the window or GL couldn't be set up
+bool measureStartup(bool lazy, StartupTimes& times) {
+	double start = glfwGetTime();
+
+	GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Learn OpenGL", NULL, NULL);
+	if (window == NULL) {
+		printf("Failed to create GLFW window\n");
+		return false;
+	}
+	glfwMakeContextCurrent(window);
+	double contextDone = glfwGetTime();
+
+	int loaded;
+	if (lazy) {
+		loaded = loadGLLazy((GLADloadproc)glfwGetProcAddress);
+	}
+	else {
+		loaded = gladLoadGLLoader((GLADloadproc)glfwGetProcAddress);
+		if (loaded) {
+			loadGLExtensions((GLADloadproc)glfwGetProcAddress);
+		}
+	}
+	if (!loaded) {
+		printf("Failed to initialize GLAD\n");
+		glfwDestroyWindow(window);
+		return false;
+	}
+	double loadDone = glfwGetTime();
+
+	drawFirstFrame(window);
+	double frameDone = glfwGetTime();
+
+	times.context = (contextDone - start) * 1000.0;
+	times.load = (loadDone - contextDone) * 1000.0;
+	times.firstFrame = (frameDone - loadDone) * 1000.0;
+	times.total = (frameDone - start) * 1000.0;
+
+	glfwDestroyWindow(window);
+	return true;
+}
+
+// usage: startup-benchmark [iterations]
+int main(int argc, char** argv) {
+	int iterations = argc > 1 ? atoi(argv[1]) : 20;
+
+	glfwInit();
+
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+	// one throwaway run so the driver is loaded and warm for both modes
+	StartupTimes warmup;
+	if (!measureStartup(false, warmup)) {
+		glfwTerminate();
+		return -1;
+	}
+
+	// alternate the modes so drift affects both the same way
+	StartupTimes sum[2], best[2];
+	unsigned int lazyResolved = 0;
+	for (int i = 0; i < iterations * 2; i++) {
+		bool lazy = i % 2 == 1;
+		StartupTimes times;
+		if (!measureStartup(lazy, times)) {
+			glfwTerminate();
+			return -1;
+		}
+		if (lazy) {
+			lazyResolved = gllazy::resolvedCount();
+		}
+
+		StartupTimes& s = sum[lazy];
+		StartupTimes& b = best[lazy];
+		s.context += times.context;
+		s.load += times.load;
+		s.firstFrame += times.firstFrame;
+		s.total += times.total;
+		if (i < 2 || times.total < b.total) {
+			b = times;
+		}
+	}
+
+	printf("%d iterations per mode, times in ms (average / best run)\n", iterations);
+	printf("%-6s %17s %17s %17s %17s\n", "mode", "context", "load", "first frame", "total");
+	for (int lazy = 0; lazy < 2; lazy++) {
+		const StartupTimes& s = sum[lazy];
+		const StartupTimes& b = best[lazy];
+		printf("%-6s %8.3f / %6.3f %8.3f / %6.3f %8.3f / %6.3f %8.3f / %6.3f\n", lazy ? "lazy" : "eager",
+			s.context / iterations, b.context, s.load / iterations, b.load,
+			s.firstFrame / iterations, b.firstFrame, s.total / iterations, b.total);
+	}
+	printf("lazy mode resolved %u entry points for hello-triangle\n", lazyResolved);
+
+	glfwTerminate();
+	return 0;
+}
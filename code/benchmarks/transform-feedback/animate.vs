@@ -0,0 +1,25 @@
+#version 330 core
+layout (location = 0) in vec3 pos;
+layout (location = 1) in vec3 col;
+layout (location = 2) in vec3 anim; // x = phase, y = angular speed, z = x of the rest position
+
+out vec3 outPos;
+out vec3 outCol;
+out vec3 outAnim;
+
+uniform float dt;
+
+const float TWO_PI = 6.28318530718;
+const float AMPLITUDE = 0.15;
+
+void main() {
+    // the phase is the state carried to the next frame. Wrapping it keeps it
+    // small, so the float error of stepping it by dt stays small too
+    float phase = anim.x + anim.y * dt;
+    phase -= TWO_PI * floor(phase / TWO_PI);
+
+    // x = rest x + AMPLITUDE * sin(phase), the same xOffset as in 2.vs
+    outPos = vec3(anim.z + AMPLITUDE * sin(phase), pos.yz);
+    outCol = col;
+    outAnim = vec3(phase, anim.yz);
+}
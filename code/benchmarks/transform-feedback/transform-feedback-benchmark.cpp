@@ -0,0 +1,191 @@
+#include "transform-feedback.h"
+#include <GLFW/glfw3.h>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+
+const int FRAMES = 100;
+const float DT = 1.0f / 60.0f;
+
+// must match animate.vs
+const int FLOATS_PER_VERTEX = 9; // pos.xyz, col.rgb, phase, speed, rest x
+const float TWO_PI = 6.28318530718f;
+const float AMPLITUDE = 0.15f;
+
+// small triangles scattered over the screen, all vertices of a triangle share a phase
+std::vector<float> makeVertices(unsigned int triangleCount) {
+	std::vector<float> vertices(triangleCount * 3 * FLOATS_PER_VERTEX);
+	float corners[3][2] = { { -0.01f, -0.01f }, { 0.01f, -0.01f }, { 0.0f, 0.01f } };
+
+	srand(99);
+	for (unsigned int t = 0; t < triangleCount; t++) {
+		float x = (float)rand() / RAND_MAX * 1.6f - 0.8f;
+		float y = (float)rand() / RAND_MAX * 1.9f - 0.95f;
+		float phase = (float)rand() / RAND_MAX * TWO_PI;
+		float speed = 0.5f + (float)rand() / RAND_MAX * 4.0f;
+		for (int c = 0; c < 3; c++) {
+			float* v = &vertices[(t * 3 + c) * FLOATS_PER_VERTEX];
+			v[0] = x + corners[c][0];
+			v[1] = y + corners[c][1];
+			v[2] = 0.0f;
+			v[3] = c == 0 ? 1.0f : 0.0f;
+			v[4] = c == 1 ? 1.0f : 0.0f;
+			v[5] = c == 2 ? 1.0f : 0.0f;
+			v[6] = phase;
+			v[7] = speed;
+			v[8] = v[0];
+			v[0] += AMPLITUDE * sinf(phase);
+		}
+	}
+	return vertices;
+}
+
+// the same as animate.vs, on the CPU
+void cpuUpdate(std::vector<float>& vertices, float dt) {
+	for (std::size_t i = 0; i < vertices.size(); i += FLOATS_PER_VERTEX) {
+		float* v = &vertices[i];
+		float phase = v[6] + v[7] * dt;
+		phase -= TWO_PI * floorf(phase / TWO_PI);
+		v[6] = phase;
+		v[0] = v[8] + AMPLITUDE * sinf(phase);
+	}
+}
+
+void setupAttributes() {
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, FLOATS_PER_VERTEX * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, FLOATS_PER_VERTEX * sizeof(float), (void*)(3 * sizeof(float)));
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, FLOATS_PER_VERTEX * sizeof(float), (void*)(6 * sizeof(float)));
+	glEnableVertexAttribArray(2);
+}
+
+int main() {
+	glfwInit();
+
+	// Initialize GLFW window (https://www.glfw.org/docs/latest/window.html#window_hints)
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+	GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Learn OpenGL", NULL, NULL);
+	if (window == NULL) {
+		printf("Failed to create GLFW window\n");
+		glfwTerminate();
+		return -1;
+	}
+
+	glfwMakeContextCurrent(window);
+	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+		glfwTerminate();
+		printf("Failed to initialize GLAD\n");
+		return -1;
+	}
+
+	// no vsync, we want to measure the work and not the display
+	glfwSwapInterval(0);
+
+	Shader renderShader("render.vs", "render.fs");
+	glClearColor(1.0, 1.0, 1.0, 1.0);
+
+	printf("%10s  %-20s %12s %12s\n", "vertices", "mode", "cpu ms/frame", "ms/frame");
+
+	unsigned int triangleCounts[] = { 10000, 50000, 200000 };
+	for (unsigned int triangleCount : triangleCounts) {
+		std::vector<float> vertices = makeVertices(triangleCount);
+		unsigned int vertexCount = triangleCount * 3;
+
+		// CPU update + glBufferSubData of the whole buffer every frame
+		{
+			unsigned int VAO, VBO;
+			glGenVertexArrays(1, &VAO);
+			glGenBuffers(1, &VBO);
+			glBindVertexArray(VAO);
+			glBindBuffer(GL_ARRAY_BUFFER, VBO);
+			glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_DYNAMIC_DRAW);
+			setupAttributes();
+			glBindVertexArray(0);
+
+			double cpuTime = 0.0;
+			double start = glfwGetTime();
+			for (int frame = 0; frame < FRAMES; frame++) {
+				glClear(GL_COLOR_BUFFER_BIT);
+
+				double updateStart = glfwGetTime();
+				cpuUpdate(vertices, DT);
+				glBufferSubData(GL_ARRAY_BUFFER, 0, vertices.size() * sizeof(float), vertices.data());
+				cpuTime += glfwGetTime() - updateStart;
+
+				renderShader.use();
+				glBindVertexArray(VAO);
+				glDrawArrays(GL_TRIANGLES, 0, vertexCount);
+				glFinish();
+			}
+			double total = glfwGetTime() - start;
+			printf("%10u  %-20s %12.3f %12.3f\n", vertexCount, "cpu + BufferSubData", cpuTime * 1000.0 / FRAMES, total * 1000.0 / FRAMES);
+
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+			glBindVertexArray(0);
+			glDeleteVertexArrays(1, &VAO);
+			glDeleteBuffers(1, &VBO);
+		}
+
+		// GPU update with transform feedback ping-pong
+		{
+			vertices = makeVertices(triangleCount);
+			FeedbackAnimator animator("animate.vs", { "outPos", "outCol", "outAnim" },
+				{ { 0, 3 }, { 1, 3 }, { 2, 3 } }, vertices.data(), vertexCount);
+
+			double cpuTime = 0.0;
+			double start = glfwGetTime();
+			for (int frame = 0; frame < FRAMES; frame++) {
+				glClear(GL_COLOR_BUFFER_BIT);
+
+				double updateStart = glfwGetTime();
+				animator.update(DT, (frame + 1) * DT);
+				cpuTime += glfwGetTime() - updateStart;
+
+				renderShader.use();
+				glBindVertexArray(animator.vao());
+				glDrawArrays(GL_TRIANGLES, 0, vertexCount);
+				glFinish();
+			}
+			double total = glfwGetTime() - start;
+			printf("%10u  %-20s %12.3f %12.3f\n", vertexCount, "transform feedback", cpuTime * 1000.0 / FRAMES, total * 1000.0 / FRAMES);
+
+			// both paths took FRAMES steps, compare the first vertex as a sanity check
+			for (int frame = 0; frame < FRAMES; frame++) {
+				cpuUpdate(vertices, DT);
+			}
+			float gpuVertex[FLOATS_PER_VERTEX];
+			glBindBuffer(GL_ARRAY_BUFFER, animator.buffer());
+			glGetBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(gpuVertex), gpuVertex);
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+			printf("%10s  first vertex x: cpu %.5f, gpu %.5f\n", "", vertices[0], gpuVertex[0]);
+
+			animator.del();
+		}
+
+		glfwSwapBuffers(window);
+	}
+
+	renderShader.del();
+
+	glfwTerminate();
+	return 0;
+}
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
+	glViewport(0, 0, width, height);
+}
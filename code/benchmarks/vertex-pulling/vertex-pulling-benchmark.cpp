@@ -0,0 +1,212 @@
+#include "shader.h"
+#include "vertex-pulling.h"
+#include <GLFW/glfw3.h>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+
+// a polygon with 3 to 16 sides around the origin, moved into its grid cell by
+// the per-draw offset
+struct MeshData {
+	std::vector<float> vertices; // x, y, r, g, b
+	std::vector<unsigned int> indices;
+	float offsetX, offsetY;
+};
+
+MeshData makeMesh(unsigned int index, unsigned int meshCount, std::mt19937& rng) {
+	unsigned int columns = (unsigned int)std::ceil(std::sqrt((double)meshCount));
+	float cell = 2.0f / columns;
+	unsigned int sides = 3 + rng() % 14;
+
+	MeshData mesh;
+	mesh.offsetX = -1.0f + cell * (index % columns + 0.5f);
+	mesh.offsetY = -1.0f + cell * (index / columns + 0.5f);
+	float r = (rng() % 256) / 255.0f, g = (rng() % 256) / 255.0f, b = (rng() % 256) / 255.0f;
+	for (unsigned int i = 0; i < sides; i++) {
+		float angle = 6.2831853f * i / sides;
+		mesh.vertices.insert(mesh.vertices.end(), { 0.45f * cell * std::cos(angle), 0.45f * cell * std::sin(angle), r, g, b });
+	}
+	for (unsigned int i = 1; i + 1 < sides; i++) {
+		mesh.indices.insert(mesh.indices.end(), { 0, i, i + 1 });
+	}
+	return mesh;
+}
+
+// sum of the framebuffer, to check every path draws the same thing
+unsigned long long framebufferChecksum() {
+	std::vector<unsigned char> pixels(SCR_WIDTH * SCR_HEIGHT * 4);
+	glReadPixels(0, 0, SCR_WIDTH, SCR_HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+	unsigned long long sum = 0;
+	for (std::size_t i = 0; i < pixels.size(); i++) {
+		sum += pixels[i] * (i % 251 + 1);
+	}
+	return sum;
+}
+
+// usage: vertex-pulling-benchmark [mesh count] [frames]
+int main(int argc, char** argv) {
+	unsigned int meshCount = argc > 1 ? (unsigned int)atoi(argv[1]) : 20000;
+	int frames = argc > 2 ? atoi(argv[2]) : 100;
+
+	glfwInit();
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+	GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Learn OpenGL", NULL, NULL);
+	if (window == NULL) {
+		printf("Failed to create GLFW window (vertex pulling needs GL 4.3)\n");
+		glfwTerminate();
+		return -1;
+	}
+
+	glfwMakeContextCurrent(window);
+	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+		glfwTerminate();
+		printf("Failed to initialize GLAD\n");
+		return -1;
+	}
+	loadGLExtensions((GLADloadproc)glfwGetProcAddress);
+
+	printf("%s / %s, %u meshes, %d frames\n", (const char*)glGetString(GL_RENDERER), (const char*)glGetString(GL_VERSION),
+		meshCount, frames);
+	glfwSwapInterval(0);
+
+	Shader vaoShader("vertex-pulling-vao.vs", "vertex-pulling.fs");
+	Shader pullingShader("vertex-pulling.vs", "vertex-pulling.fs");
+	GLint offsetLocation = glGetUniformLocation(vaoShader.ID, "offset");
+	GLint drawBaseLocation = glGetUniformLocation(pullingShader.ID, "drawBase");
+
+	std::mt19937 rng(11);
+	std::vector<MeshData> meshData;
+	for (unsigned int i = 0; i < meshCount; i++) {
+		meshData.push_back(makeMesh(i, meshCount, rng));
+	}
+
+	// the classic setup: a VAO, VBO and EBO per mesh
+	std::vector<unsigned int> vaos(meshCount), buffers(meshCount * 2);
+	glGenVertexArrays(meshCount, vaos.data());
+	glGenBuffers(meshCount * 2, buffers.data());
+	for (unsigned int i = 0; i < meshCount; i++) {
+		glBindVertexArray(vaos[i]);
+		glBindBuffer(GL_ARRAY_BUFFER, buffers[i * 2]);
+		glBufferData(GL_ARRAY_BUFFER, meshData[i].vertices.size() * sizeof(float), meshData[i].vertices.data(), GL_STATIC_DRAW);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers[i * 2 + 1]);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, meshData[i].indices.size() * sizeof(unsigned int), meshData[i].indices.data(), GL_STATIC_DRAW);
+		glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(2 * sizeof(float)));
+		glEnableVertexAttribArray(1);
+	}
+	glBindVertexArray(0);
+
+	// the same meshes in a MeshPool, drawn through its page VAOs or pulled
+	MeshPool pool({ { 0, 2 }, { 1, 3 } });
+	std::vector<unsigned int> poolMeshes;
+	std::vector<float> offsets;
+	for (const MeshData& mesh : meshData) {
+		poolMeshes.push_back(pool.add(mesh.vertices.data(), (unsigned int)mesh.vertices.size() / 5,
+			mesh.indices.data(), (unsigned int)mesh.indices.size()));
+		offsets.insert(offsets.end(), { mesh.offsetX, mesh.offsetY });
+	}
+	unsigned int offsetBuffer;
+	glGenBuffers(1, &offsetBuffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, offsetBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, offsets.size() * sizeof(float), offsets.data(), GL_STATIC_DRAW);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, offsetBuffer);
+	VertexPuller puller;
+	bool canMultiDraw = puller.multiDraw;
+	if (!canMultiDraw) {
+		printf("no GL_ARB_shader_draw_parameters, pulling draws one by one\n");
+	}
+
+	// every mesh once, returns the number of GL draw calls
+	auto drawScene = [&](int path) -> unsigned int {
+		if (path == 0) {
+			vaoShader.use();
+			for (unsigned int i = 0; i < meshCount; i++) {
+				glBindVertexArray(vaos[i]);
+				glUniform2f(offsetLocation, meshData[i].offsetX, meshData[i].offsetY);
+				glDrawElements(GL_TRIANGLES, (GLsizei)meshData[i].indices.size(), GL_UNSIGNED_INT, 0);
+			}
+			glBindVertexArray(0);
+			return meshCount;
+		}
+		if (path == 1) {
+			vaoShader.use();
+			for (unsigned int i = 0; i < meshCount; i++) {
+				glUniform2f(offsetLocation, meshData[i].offsetX, meshData[i].offsetY);
+				pool.draw(poolMeshes[i]);
+			}
+			pool.unbind();
+			return meshCount;
+		}
+		pullingShader.use();
+		puller.draw(pool, poolMeshes, drawBaseLocation);
+		return puller.drawCalls;
+	};
+
+	glClearColor(1.0, 1.0, 1.0, 1.0);
+
+	const char* names[] = { "VAO per mesh", "MeshPool page VAOs", "pulling, draw per mesh", "pulling, multi-draw" };
+	unsigned long long reference = 0;
+	for (int path = 0; path < 4 && !glfwWindowShouldClose(window); path++) {
+		if (path == 3 && !canMultiDraw) {
+			continue;
+		}
+		puller.multiDraw = path == 3;
+
+		double submitTime = 0.0;
+		unsigned int drawCalls = 0;
+		double start = glfwGetTime();
+		for (int frame = 0; frame < frames; frame++) {
+			glClear(GL_COLOR_BUFFER_BIT);
+
+			double submitStart = glfwGetTime();
+			drawCalls = drawScene(path);
+			submitTime += glfwGetTime() - submitStart;
+
+			glfwSwapBuffers(window);
+			glfwPollEvents();
+		}
+		glFinish();
+		double total = glfwGetTime() - start;
+
+		// draw once more and read back before the swap
+		glClear(GL_COLOR_BUFFER_BIT);
+		drawScene(path);
+		unsigned long long checksum = framebufferChecksum();
+		if (path == 0) {
+			reference = checksum;
+		}
+
+		printf("%-24s %6u draw calls, %8.3f ms/frame submit, %8.3f ms/frame total  %s\n", names[path], drawCalls,
+			submitTime * 1000.0 / frames, total * 1000.0 / frames, checksum == reference ? "same image" : "IMAGE DIFFERS");
+	}
+
+	glDeleteVertexArrays(meshCount, vaos.data());
+	glDeleteBuffers(meshCount * 2, buffers.data());
+	glDeleteBuffers(1, &offsetBuffer);
+	puller.del();
+	pool.del();
+	vaoShader.del();
+	pullingShader.del();
+
+	glfwTerminate();
+	return 0;
+}
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
+	glViewport(0, 0, width, height);
+}
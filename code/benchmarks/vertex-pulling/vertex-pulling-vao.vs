@@ -0,0 +1,12 @@
+#version 330 core
+layout (location = 0) in vec2 pos;
+layout (location = 1) in vec3 color;
+
+uniform vec2 offset;
+
+out vec3 vertexColor;
+
+void main() {
+    gl_Position = vec4(pos + offset, 0.0, 1.0);
+    vertexColor = color;
+}
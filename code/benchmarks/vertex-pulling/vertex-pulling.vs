@@ -0,0 +1,26 @@
+#version 430 core
+#extension GL_ARB_shader_draw_parameters : enable
+
+// x, y, r, g, b per vertex, the MeshPool layout
+layout (std430, binding = 0) readonly buffer Vertices {
+    float vertices[];
+};
+layout (std430, binding = 1) readonly buffer Offsets {
+    vec2 offsets[];
+};
+
+uniform uint drawBase;
+
+out vec3 vertexColor;
+
+void main() {
+#ifdef GL_ARB_shader_draw_parameters
+    uint draw = drawBase + uint(gl_DrawIDARB);
+#else
+    uint draw = drawBase;
+#endif
+    uint v = uint(gl_VertexID) * 5u;
+    vec2 pos = vec2(vertices[v], vertices[v + 1u]);
+    gl_Position = vec4(pos + offsets[draw], 0.0, 1.0);
+    vertexColor = vec3(vertices[v + 2u], vertices[v + 3u], vertices[v + 4u]);
+}
@@ -0,0 +1,325 @@
+// Runs every registered sample back-to-back in one process, sharing one
+// window, one context and one loaded GL function table: all the chapter
+// samples, from their own sources (tutorial.h), and the particles benchmark.
+//
+// Build: runner.cpp, samples/*.cpp and Learn-OpenGL/glad.c, with
+// Learn-OpenGL/Learn-OpenGL on the include path. Run it from code/runner,
+// shader paths are relative to it.
+//
+// usage: runner [--frames N] [--in-flight N] [--finish] [--trace] [--list] [sample names...]
+//   --frames N     frames per sample (default 300)
+//   --in-flight N  frames the CPU may be ahead of the GPU, 1 to 3 (default 2);
+//                  the wait column is the CPU time blocked on that limit
+//   --finish       glFinish after every frame so frame times include GPU work
+//   --trace        wrap the GL entry points (gl-trace.h) and print the GL calls
+//                  of each sample's last frame
+//   --list         print the registered samples and exit
+#include "sample.h"
+#include "frames-in-flight.h"
+#include "gl-debug.h"
+#include "gl-trace.h"
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+
+void printUsage() {
+	printf("usage: runner [--frames N] [--in-flight N] [--finish] [--trace] [--list] [sample names...]\n");
+}
+
+// text as a whole number in [min, max], false if it's anything else
+bool parseInt(const char* text, int min, int max, int& value) {
+	char* end;
+	errno = 0;
+	long parsed = strtol(text, &end, 10);
+	if (end == text || *end != '\0' || errno == ERANGE || parsed < min || parsed > max) {
+		return false;
+	}
+	value = (int)parsed;
+	return true;
+}
+
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+
+// of the sample column, the longest name fits
+const int NAME_WIDTH = 45;
+
+struct FrameStats {
+	double initMs = 0.0;
+	double waitMs = 0.0;
+	double avg = 0.0, min = 0.0, p50 = 0.0, p95 = 0.0, p99 = 0.0, max = 0.0;
+};
+
+FrameStats computeStats(std::vector<double>& frameMs, double initMs) {
+	FrameStats stats;
+	stats.initMs = initMs;
+	if (frameMs.empty()) {
+		return stats;
+	}
+
+	std::sort(frameMs.begin(), frameMs.end());
+	double sum = 0.0;
+	for (double ms : frameMs) {
+		sum += ms;
+	}
+
+	auto percentile = [&](double p) {
+		std::size_t index = (std::size_t)(p * (frameMs.size() - 1) + 0.5);
+		return frameMs[index];
+	};
+
+	stats.avg = sum / frameMs.size();
+	stats.min = frameMs.front();
+	stats.p50 = percentile(0.50);
+	stats.p95 = percentile(0.95);
+	stats.p99 = percentile(0.99);
+	stats.max = frameMs.back();
+	return stats;
+}
+
+// put back the state samples commonly change, so one sample can't affect the next
+void resetState(GLFWwindow* window) {
+	glUseProgram(0);
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+	glDisable(GL_BLEND);
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_CULL_FACE);
+	glClearColor(0.0, 0.0, 0.0, 1.0);
+
+	int width, height;
+	glfwGetFramebufferSize(window, &width, &height);
+	glViewport(0, 0, width, height);
+}
+
+// Runs one sample for frameCount frames and times it. The time from the start
+// to the first next() is the init time, the calls made in it don't count
+// towards the first frame's trace.
+class RunnerLoop : public FrameLoop {
+public:
+	double initMs = 0.0;
+	std::vector<double> frameMs;
+	gltrace::FrameReport lastFrame;
+
+	RunnerLoop(GLFWwindow* window, FramesInFlight& inFlight, int frameCount, bool finishEachFrame, bool trace)
+		: window(window), inFlight(inFlight), frameCount(frameCount), finishEachFrame(finishEachFrame), trace(trace),
+		  start(glfwGetTime()) {
+		frameMs.reserve(frameCount);
+	}
+
+	bool next() override {
+		if (!initDone) {
+			glFinish();
+			initMs = (glfwGetTime() - start) * 1000.0;
+			if (trace) {
+				gltrace::endFrame();
+			}
+			initDone = true;
+			firstFrame = glfwGetTime();
+		}
+		if ((int)frameMs.size() >= frameCount || glfwWindowShouldClose(window)) {
+			return false;
+		}
+		frameStart = glfwGetTime();
+		inFlight.begin();
+		return true;
+	}
+
+	void present() override {
+		inFlight.end();
+		glfwSwapBuffers(window);
+		if (finishEachFrame) {
+			glFinish();
+		}
+		glfwPollEvents();
+
+		frameMs.push_back((glfwGetTime() - frameStart) * 1000.0);
+
+		if (trace) {
+			lastFrame = gltrace::endFrame();
+		}
+	}
+
+	double time() const override {
+		return initDone ? glfwGetTime() - firstFrame : 0.0;
+	}
+
+private:
+	GLFWwindow* window;
+	FramesInFlight& inFlight;
+	int frameCount;
+	bool finishEachFrame;
+	bool trace;
+	double start;
+	bool initDone = false;
+	double firstFrame = 0.0;
+	double frameStart = 0.0;
+};
+
+int main(int argc, char** argv) {
+	int frameCount = 300;
+	int framesInFlight = 2;
+	bool finishEachFrame = false;
+	bool trace = false;
+	bool listOnly = false;
+	std::vector<std::string> only;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+			if (!parseInt(argv[++i], 0, 1000000000, frameCount)) {
+				printf("--frames takes a whole number of frames, 0 or more\n");
+				printUsage();
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "--in-flight") == 0 && i + 1 < argc) {
+			if (!parseInt(argv[++i], 1, (int)FramesInFlight::MAX_FRAMES, framesInFlight)) {
+				printf("--in-flight takes 1 to %u\n", FramesInFlight::MAX_FRAMES);
+				printUsage();
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "--finish") == 0) {
+			finishEachFrame = true;
+		}
+		else if (strcmp(argv[i], "--trace") == 0) {
+			trace = true;
+		}
+		else if (strcmp(argv[i], "--list") == 0) {
+			listOnly = true;
+		}
+		else {
+			only.push_back(argv[i]);
+		}
+	}
+
+	// instantiate samples up front so we can filter and list them by name
+	std::vector<std::unique_ptr<Sample>> samples;
+	for (SampleFactory factory : sampleRegistry()) {
+		std::unique_ptr<Sample> sample = factory();
+		if (only.empty() || std::find(only.begin(), only.end(), sample->name()) != only.end()) {
+			samples.push_back(std::move(sample));
+		}
+	}
+	std::sort(samples.begin(), samples.end(), [](const std::unique_ptr<Sample>& a, const std::unique_ptr<Sample>& b) {
+		return strcmp(a->name(), b->name()) < 0;
+	});
+
+	if (listOnly) {
+		for (const std::unique_ptr<Sample>& sample : samples) {
+			printf("%s (GL %d.%d)\n", sample->name(), sample->requiredMajor(), sample->requiredMinor());
+		}
+		return 0;
+	}
+
+	glfwInit();
+
+	// ask for 4.3 so compute samples can run too, fall back to 3.3
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLDEBUG_ENABLED);
+
+#ifdef __APPLE__
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+	GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Learn OpenGL", NULL, NULL);
+	if (window == NULL) {
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+		window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Learn OpenGL", NULL, NULL);
+	}
+	if (window == NULL) {
+		printf("Failed to create GLFW window\n");
+		glfwTerminate();
+		return -1;
+	}
+
+	glfwMakeContextCurrent(window);
+	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+	// the function table is loaded once and shared by every sample
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+		glfwTerminate();
+		printf("Failed to initialize GLAD\n");
+		return -1;
+	}
+	loadGLExtensions((GLADloadproc)glfwGetProcAddress);
+	if (trace) {
+		gltrace::install();
+	}
+
+	// GL errors are reported by the debug callback as they happen (debug builds)
+	bool debugOutput = gldebug::enable();
+
+	// measure the samples, not the display
+	glfwSwapInterval(0);
+
+	// an explicit limit instead of whatever the driver does in SwapBuffers
+	FramesInFlight inFlight((unsigned int)framesInFlight);
+
+	printf("%s / %s, %d frames per sample, %u in flight%s\n\n", (const char*)glGetString(GL_RENDERER),
+		(const char*)glGetString(GL_VERSION), frameCount, inFlight.count(), finishEachFrame ? ", glFinish per frame" : "");
+	printf("%-*s %9s %9s %9s %9s %9s %9s %9s %9s\n", NAME_WIDTH, "sample", "init ms", "avg ms", "min", "p50", "p95", "p99", "max",
+		"wait");
+
+	for (std::unique_ptr<Sample>& sample : samples) {
+		if (glfwWindowShouldClose(window)) {
+			break;
+		}
+
+		if (!hasGLVersion(sample->requiredMajor(), sample->requiredMinor())) {
+			printf("%-*s skipped, needs GL %d.%d\n", NAME_WIDTH, sample->name(), sample->requiredMajor(), sample->requiredMinor());
+			continue;
+		}
+
+		GLDEBUG_SCOPE(sample->name());
+		resetState(window);
+
+		inFlight.resetStats();
+		RunnerLoop loop(window, inFlight, frameCount, finishEachFrame, trace);
+		bool ok = sample->run(loop);
+		inFlight.finish();
+
+		if (!ok) {
+			printf("%-*s failed to initialize\n", NAME_WIDTH, sample->name());
+			continue;
+		}
+
+		// without debug output, report errors once per sample instead of stalling every frame
+		if (!debugOutput) {
+			GLenum error = glGetError();
+			while (error != GL_NO_ERROR) {
+				printf("  %s left GL error 0x%04X\n", sample->name(), error);
+				error = glGetError();
+			}
+		}
+
+		FrameStats stats = computeStats(loop.frameMs, loop.initMs);
+		stats.waitMs = loop.frameMs.empty() ? 0.0 : inFlight.getStats().waitMs / loop.frameMs.size();
+		printf("%-*s %9.3f %9.3f %9.3f %9.3f %9.3f %9.3f %9.3f %9.3f\n", NAME_WIDTH, sample->name(), stats.initMs,
+			stats.avg, stats.min, stats.p50, stats.p95, stats.p99, stats.max, stats.waitMs);
+		if (trace) {
+			gltrace::printReport(loop.lastFrame, 8);
+		}
+	}
+
+	gldebug::printSummary();
+
+	inFlight.del();
+	glfwTerminate();
+	return 0;
+}
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
+	glViewport(0, 0, width, height);
+}
@@ -0,0 +1,77 @@
+#ifndef SAMPLE_H
+#define SAMPLE_H
+
+#include "gl-ext.h"
+
+#include <memory>
+#include <vector>
+
+// The runner's side of a render loop: it decides when a sample has run for
+// long enough and measures each frame.
+class FrameLoop {
+public:
+    virtual ~FrameLoop() {}
+
+    // at the top of every frame, false once the sample has had its frames
+    virtual bool next() = 0;
+    // after drawing a frame, swaps buffers and polls events
+    virtual void present() = 0;
+    // seconds since the sample's first frame
+    virtual double time() const = 0;
+};
+
+// A sample hosted by the runner. The runner owns the window, the context and
+// the loaded GL function table; a sample only creates its own GL objects in
+// init(), draws one frame per frame() call and deletes everything in shutdown().
+//
+// frame() is called with the default framebuffer bound and the viewport set,
+// the sample clears and draws; the runner swaps buffers.
+//
+// Samples that keep their own render loop (the chapter samples, see
+// tutorial.h) override run() instead.
+class Sample {
+public:
+    virtual ~Sample() {}
+
+    virtual const char* name() const = 0;
+
+    // minimum context version, samples above 3.3 are skipped on older contexts
+    virtual int requiredMajor() const { return 3; }
+    virtual int requiredMinor() const { return 3; }
+
+    // return false if the sample can't run, shutdown() is still called
+    virtual bool init() = 0;
+    virtual void frame(float time) = 0;
+    virtual void shutdown() = 0;
+
+    // init(), frame() until the loop ends and shutdown(), false if init() failed
+    virtual bool run(FrameLoop& loop) {
+        bool ok = init();
+        while (ok && loop.next()) {
+            frame((float)loop.time());
+            loop.present();
+        }
+        shutdown();
+        return ok;
+    }
+};
+
+typedef std::unique_ptr<Sample> (*SampleFactory)();
+
+// every sample translation unit adds itself here during static initialization
+inline std::vector<SampleFactory>& sampleRegistry() {
+    static std::vector<SampleFactory> registry;
+    return registry;
+}
+
+struct SampleRegistrar {
+    explicit SampleRegistrar(SampleFactory factory) {
+        sampleRegistry().push_back(factory);
+    }
+};
+
+// REGISTER_SAMPLE(Particles) at the bottom of the sample's .cpp
+#define REGISTER_SAMPLE(Type) \
+    static SampleRegistrar Type##Registrar([]() -> std::unique_ptr<Sample> { return std::unique_ptr<Sample>(new Type()); })
+
+#endif
@@ -0,0 +1,7 @@
+#include "../tutorial.h"
+
+namespace blinking_red_triangle {
+#include "../../6-shaders/blink/blinking-red-triangle.cpp"
+}
+
+REGISTER_TUTORIAL(blinking_red_triangle, "6-shaders/blink");
@@ -0,0 +1,8 @@
+#include "../tutorial.h"
+
+namespace fragment_interpolation_shader_class {
+TUTORIAL_SHADER_FILES("../6-shaders/fragment-interpolation-shader-class/shader.vs", "../6-shaders/fragment-interpolation-shader-class/shader.fs")
+#include "../../6-shaders/fragment-interpolation-shader-class/triangle-fragment-interpolation-shader-class.cpp"
+}
+
+REGISTER_TUTORIAL(fragment_interpolation_shader_class, "6-shaders/fragment-interpolation-shader-class");
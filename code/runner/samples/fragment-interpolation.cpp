@@ -0,0 +1,7 @@
+#include "../tutorial.h"
+
+namespace fragment_interpolation {
+#include "../../6-shaders/fragment-interpolation/triangle-fragment-interpolation.cpp"
+}
+
+REGISTER_TUTORIAL(fragment_interpolation, "6-shaders/fragment-interpolation");
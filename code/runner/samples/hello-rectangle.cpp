@@ -0,0 +1,7 @@
+#include "../tutorial.h"
+
+namespace hello_rectangle {
+#include "../../5-hello-triangle/hello-rectangle/hello-rectangle.cpp"
+}
+
+REGISTER_TUTORIAL(hello_rectangle, "5-hello-triangle/hello-rectangle");
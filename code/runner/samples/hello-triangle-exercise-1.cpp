@@ -0,0 +1,7 @@
+#include "../tutorial.h"
+
+namespace hello_triangle_exercise_1 {
+#include "../../5-hello-triangle/exercises/1.cpp"
+}
+
+REGISTER_TUTORIAL(hello_triangle_exercise_1, "5-hello-triangle/exercises/1");
@@ -0,0 +1,7 @@
+#include "../tutorial.h"
+
+namespace hello_triangle_exercise_2 {
+#include "../../5-hello-triangle/exercises/2.cpp"
+}
+
+REGISTER_TUTORIAL(hello_triangle_exercise_2, "5-hello-triangle/exercises/2");
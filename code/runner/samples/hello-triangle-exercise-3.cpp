@@ -0,0 +1,7 @@
+#include "../tutorial.h"
+
+namespace hello_triangle_exercise_3 {
+#include "../../5-hello-triangle/exercises/3.cpp"
+}
+
+REGISTER_TUTORIAL(hello_triangle_exercise_3, "5-hello-triangle/exercises/3");
@@ -0,0 +1,7 @@
+#include "../tutorial.h"
+
+namespace hello_triangle {
+#include "../../5-hello-triangle/hello-triangle/hello-triangle.cpp"
+}
+
+REGISTER_TUTORIAL(hello_triangle, "5-hello-triangle/hello-triangle");
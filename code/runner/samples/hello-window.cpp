@@ -0,0 +1,7 @@
+#include "../tutorial.h"
+
+namespace hello_window {
+#include "../../4-hello-window/hello-window.cpp"
+}
+
+REGISTER_TUTORIAL(hello_window, "4-hello-window");
@@ -0,0 +1,34 @@
+#include "../sample.h"
+#include "particles.h"
+
+// code/benchmarks/particles, paths are relative to code/runner
+class Particles : public Sample {
+public:
+	const char* name() const override { return "benchmarks/particles"; }
+	int requiredMajor() const override { return 4; }
+	int requiredMinor() const override { return 3; }
+
+	bool init() override {
+		particles.reset(new ParticleSystem(100000, "../../shaders/"));
+		glClearColor(1.0, 1.0, 1.0, 1.0);
+		return true;
+	}
+
+	void frame(float) override {
+		glClear(GL_COLOR_BUFFER_BIT);
+		particles->update(1.0f / 60.0f, 1000);
+		particles->draw();
+	}
+
+	void shutdown() override {
+		if (particles) {
+			particles->del();
+			particles.reset();
+		}
+	}
+
+private:
+	std::unique_ptr<ParticleSystem> particles;
+};
+
+REGISTER_SAMPLE(Particles);
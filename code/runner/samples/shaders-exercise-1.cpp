@@ -0,0 +1,8 @@
+#include "../tutorial.h"
+
+namespace shaders_exercise_1 {
+TUTORIAL_SHADER_FILES("../6-shaders/exercises/1/1.vs", "../6-shaders/exercises/1/1.fs")
+#include "../../6-shaders/exercises/1/1.cpp"
+}
+
+REGISTER_TUTORIAL(shaders_exercise_1, "6-shaders/exercises/1");
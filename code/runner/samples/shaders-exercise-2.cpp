@@ -0,0 +1,8 @@
+#include "../tutorial.h"
+
+namespace shaders_exercise_2 {
+TUTORIAL_SHADER_FILES("../6-shaders/exercises/2/2.vs", "../6-shaders/exercises/2/2.fs")
+#include "../../6-shaders/exercises/2/2.cpp"
+}
+
+REGISTER_TUTORIAL(shaders_exercise_2, "6-shaders/exercises/2");
@@ -0,0 +1,8 @@
+#include "../tutorial.h"
+
+namespace shaders_exercise_3 {
+TUTORIAL_SHADER_FILES("../6-shaders/exercises/3/3.vs", "../6-shaders/exercises/3/3.fs")
+#include "../../6-shaders/exercises/3/3.cpp"
+}
+
+REGISTER_TUTORIAL(shaders_exercise_3, "6-shaders/exercises/3");
@@ -0,0 +1,130 @@
+#ifndef TUTORIAL_H
+#define TUTORIAL_H
+
+// everything the chapter samples include, so their own includes are no-ops
+// once they sit inside a namespace
+#include "sample.h"
+#include "shader.h"
+#include <GLFW/glfw3.h>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+
+// Hosts the chapter samples (code/4-hello-window, 5-hello-triangle,
+// 6-shaders) in the runner from their own sources, unchanged. Each one is
+// compiled inside a namespace of its own, so its main() and globals don't
+// clash with the others. Like glad does for GL, this header #defines the GLFW
+// calls that matter to the runner's versions, so it must be the last include
+// before the sample:
+//   glfwInit, glfwWindowHint, glfwMakeContextCurrent, glfwTerminate,
+//   gladLoadGLLoader   do nothing, the runner already made and loaded the
+//                      context (and --trace wrapped its function table)
+//   glfwCreateWindow   returns the runner's window
+//   glfwWindowShouldClose  FrameLoop::next(), true once the frames are done
+//   glfwSwapBuffers    FrameLoop::present()
+//   glfwPollEvents     nothing, present() polls
+//   glfwGetTime        FrameLoop::time()
+//   glfwSetFramebufferSizeCallback  nothing, the runner keeps its own
+// The time until the sample first asks glfwWindowShouldClose counts as its
+// init time. In samples/:
+//     namespace hello_triangle {
+//     #include "../../5-hello-triangle/hello-triangle/hello-triangle.cpp"
+//     }
+//     REGISTER_TUTORIAL(hello_triangle, "5-hello-triangle/hello-triangle");
+namespace tutorial {
+
+// the loop of the sample running now
+inline FrameLoop*& currentLoop() {
+    static FrameLoop* loop = NULL;
+    return loop;
+}
+
+inline int glfwInit() {
+    return GLFW_TRUE;
+}
+
+inline void glfwWindowHint(int, int) {}
+
+inline GLFWwindow* glfwCreateWindow(int, int, const char*, GLFWmonitor*, GLFWwindow*) {
+    return ::glfwGetCurrentContext();
+}
+
+inline void glfwMakeContextCurrent(GLFWwindow*) {}
+
+inline int gladLoadGLLoader(GLADloadproc) {
+    return 1;
+}
+
+inline GLFWframebuffersizefun glfwSetFramebufferSizeCallback(GLFWwindow*, GLFWframebuffersizefun) {
+    return NULL;
+}
+
+inline int glfwWindowShouldClose(GLFWwindow*) {
+    return !currentLoop()->next();
+}
+
+inline void glfwSwapBuffers(GLFWwindow*) {
+    currentLoop()->present();
+}
+
+inline void glfwPollEvents() {}
+
+inline double glfwGetTime() {
+    return currentLoop()->time();
+}
+
+inline void glfwTerminate() {}
+
+// A chapter sample: run() calls its main() with the loop in place
+class Sample : public ::Sample {
+public:
+    Sample(const char* sampleName, int (*entry)()) : sampleName(sampleName), entry(entry) {}
+
+    const char* name() const override { return sampleName; }
+
+    bool run(FrameLoop& loop) override {
+        currentLoop() = &loop;
+        int result = entry();
+        currentLoop() = NULL;
+        return result == 0;
+    }
+
+    // main() does all of it
+    bool init() override { return false; }
+    void frame(float) override {}
+    void shutdown() override {}
+
+private:
+    const char* sampleName;
+    int (*entry)();
+};
+
+}
+
+// For the 6-shaders samples, whose shader paths are relative to the Visual
+// Studio project and name files kept elsewhere: their Shader loads these
+// instead, relative to code/runner.
+#define TUTORIAL_SHADER_FILES(vertexPath, fragmentPath) \
+    struct Shader : ::Shader { \
+        Shader(const char*, const char*) : ::Shader(vertexPath, fragmentPath) {} \
+    };
+
+// after the namespace, with the name the runner lists it under
+#define REGISTER_TUTORIAL(Namespace, name) \
+    static SampleRegistrar Namespace##Registrar([]() -> std::unique_ptr<Sample> { \
+        return std::unique_ptr<Sample>(new tutorial::Sample(name, &Namespace::main)); \
+    })
+
+#define glfwInit tutorial::glfwInit
+#define glfwWindowHint tutorial::glfwWindowHint
+#define glfwCreateWindow tutorial::glfwCreateWindow
+#define glfwMakeContextCurrent tutorial::glfwMakeContextCurrent
+#define gladLoadGLLoader tutorial::gladLoadGLLoader
+#define glfwSetFramebufferSizeCallback tutorial::glfwSetFramebufferSizeCallback
+#define glfwWindowShouldClose tutorial::glfwWindowShouldClose
+#define glfwSwapBuffers tutorial::glfwSwapBuffers
+#define glfwPollEvents tutorial::glfwPollEvents
+#define glfwGetTime tutorial::glfwGetTime
+#define glfwTerminate tutorial::glfwTerminate
+
+#endif
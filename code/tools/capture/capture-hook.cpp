@@ -0,0 +1,40 @@
+// Link this file into any sample (no changes to the sample's source) to
+// capture its GL command stream:
+//
+//     g++ hello-rectangle.cpp capture-hook.cpp glad.c ... -o hello-rectangle
+//     GLCAPTURE_FILE=rect.gltrace GLCAPTURE_START=10 GLCAPTURE_FRAMES=3 ./hello-rectangle
+//     replay rect.gltrace
+//
+// glad calls gladLoadGLCallback at the end of gladLoadGLLoader, which starts
+// the capture before the sample creates anything.
+//   GLCAPTURE_FILE    trace to write (default capture.gltrace)
+//   GLCAPTURE_START   frames to skip, they are recorded as setup (default 0)
+//   GLCAPTURE_FRAMES  frames to capture (default 1)
+//
+// Entry points the sample loads itself after glad (loadGLExtensions) are not
+// captured, nor is a sample that loads through loadGLLazy.
+#include "gl-capture.h"
+#include <cstdlib>
+
+extern "C" void (*gladLoadGLCallback)(GLADloadproc load);
+
+namespace {
+	int envInt(const char* name, int fallback) {
+		const char* value = getenv(name);
+		return value != NULL ? atoi(value) : fallback;
+	}
+
+	void startCapture(GLADloadproc) {
+		const char* path = getenv("GLCAPTURE_FILE");
+		if (glcapture::start(path != NULL ? path : "capture.gltrace", envInt("GLCAPTURE_START", 0), envInt("GLCAPTURE_FRAMES", 1))) {
+			// a sample that quits before the last frame still leaves a complete trace
+			atexit(glcapture::stop);
+		}
+	}
+
+	struct Install {
+		Install() {
+			gladLoadGLCallback = startCapture;
+		}
+	} install;
+}
@@ -0,0 +1,125 @@
+// Plays back a trace written by capture-hook.cpp and times it: the setup
+// once, then the captured frames in a loop.
+//
+// usage: replay trace [--loops N] [--finish] [--top K]
+//   --loops N   times to play the captured frames (default 100)
+//   --finish    glFinish after every frame so frame times include GPU work
+//   --top K     entry points to list, most expensive first (default 10)
+#include "gl-capture.h"
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+int main(int argc, char** argv) {
+	const char* path = NULL;
+	int loops = 100;
+	bool finishEachFrame = false;
+	int top = 10;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--loops") == 0 && i + 1 < argc) {
+			loops = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--finish") == 0) {
+			finishEachFrame = true;
+		}
+		else if (strcmp(argv[i], "--top") == 0 && i + 1 < argc) {
+			top = atoi(argv[++i]);
+		}
+		else {
+			path = argv[i];
+		}
+	}
+	if (path == NULL) {
+		printf("usage: replay trace [--loops N] [--finish] [--top K]\n");
+		return -1;
+	}
+
+	glcapture::Replayer replayer;
+	if (!replayer.load(path)) {
+		return -1;
+	}
+
+	glfwInit();
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, replayer.glMajor);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, replayer.glMinor);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+#ifdef __APPLE__
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+	GLFWwindow* window = glfwCreateWindow(replayer.width, replayer.height, "replay", NULL, NULL);
+	if (window == NULL) {
+		printf("Failed to create GLFW window\n");
+		glfwTerminate();
+		return -1;
+	}
+	glfwMakeContextCurrent(window);
+
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+		glfwTerminate();
+		printf("Failed to initialize GLAD\n");
+		return -1;
+	}
+	loadGLExtensions((GLADloadproc)glfwGetProcAddress);
+	glfwSwapInterval(0);
+
+	printf("%s: %zu frame(s), %.1f KB, GL %d.%d %dx%d\n", path, replayer.frameCount(), replayer.traceSize() / 1024.0,
+		replayer.glMajor, replayer.glMinor, replayer.width, replayer.height);
+
+	double setupStart = glfwGetTime();
+	replayer.playSetup();
+	glFinish();
+	printf("setup: %.3f ms\n", (glfwGetTime() - setupStart) * 1000.0);
+
+	if (replayer.frameCount() == 0) {
+		printf("no frames captured\n");
+		glfwTerminate();
+		return 0;
+	}
+
+	std::vector<double> frameMs;
+	frameMs.reserve((size_t)loops * replayer.frameCount());
+	for (int loop = 0; loop < loops; loop++) {
+		for (size_t frame = 0; frame < replayer.frameCount(); frame++) {
+			double frameStart = glfwGetTime();
+			replayer.playFrame(frame);
+			glfwSwapBuffers(window);
+			if (finishEachFrame) {
+				glFinish();
+			}
+			glfwPollEvents();
+			frameMs.push_back((glfwGetTime() - frameStart) * 1000.0);
+		}
+	}
+
+	GLenum error = glGetError();
+	while (error != GL_NO_ERROR) {
+		printf("replay left GL error 0x%04X\n", error);
+		error = glGetError();
+	}
+
+	std::sort(frameMs.begin(), frameMs.end());
+	double sum = 0.0;
+	for (double ms : frameMs) {
+		sum += ms;
+	}
+	printf("frames: %zu, avg %.3f ms, min %.3f, p50 %.3f, p95 %.3f, max %.3f\n", frameMs.size(), sum / frameMs.size(),
+		frameMs.front(), frameMs[frameMs.size() / 2], frameMs[(size_t)(0.95 * (frameMs.size() - 1))], frameMs.back());
+
+	std::vector<glcapture::CallTiming> timings = replayer.callTimings();
+	int shown = 0;
+	for (const glcapture::CallTiming& timing : timings) {
+		if (shown++ == top) {
+			break;
+		}
+		printf("  %-32s %9llu calls %9.3f ms  %.4f ms/call\n", timing.name, timing.calls, timing.ms, timing.ms / timing.calls);
+	}
+
+	glfwTerminate();
+	return 0;
+}
@@ -0,0 +1,65 @@
+#version 430 core
+layout (local_size_x = 128) in;
+
+// view space position and radius, color
+struct Light {
+    vec4 positionRadius;
+    vec4 color;
+};
+layout (std430, binding = 0) readonly buffer Lights { Light lights[]; };
+
+// view space box of every cluster
+struct ClusterBounds {
+    vec4 lo;
+    vec4 hi;
+};
+layout (std430, binding = 1) readonly buffer Bounds { ClusterBounds bounds[]; };
+
+// first index and light count of every cluster, each cluster owns
+// maxLightsPerCluster slots of the index list
+layout (std430, binding = 2) writeonly buffer Grid { uvec2 grid[]; };
+layout (std430, binding = 3) writeonly buffer Indices { uint indices[]; };
+
+uniform uint lightCount;
+uniform uint maxLightsPerCluster;
+uniform uint clusterCount;
+
+const uint BATCH = 128u;
+
+// lights are loaded a batch at a time, one per invocation, and tested by all
+shared vec4 batch[BATCH];
+
+void main() {
+    uint cluster = gl_GlobalInvocationID.x;
+    // no early return past the end, every invocation has to reach the barriers
+    bool inRange = cluster < clusterCount;
+    vec3 lo = vec3(0.0), hi = vec3(0.0);
+    if (inRange) {
+        lo = bounds[cluster].lo.xyz;
+        hi = bounds[cluster].hi.xyz;
+    }
+    uint first = cluster * maxLightsPerCluster;
+    uint count = 0u;
+
+    for (uint base = 0u; base < lightCount; base += BATCH) {
+        uint i = base + gl_LocalInvocationIndex;
+        batch[gl_LocalInvocationIndex] = i < lightCount ? lights[i].positionRadius : vec4(0.0, 0.0, 0.0, -1.0);
+        barrier();
+
+        uint end = min(BATCH, lightCount - base);
+        for (uint j = 0u; inRange && j < end; j++) {
+            vec4 light = batch[j];
+            // distance from the center to the box
+            vec3 d = max(max(lo - light.xyz, light.xyz - hi), vec3(0.0));
+            if (dot(d, d) <= light.w * light.w && count < maxLightsPerCluster) {
+                indices[first + count] = base + j;
+                count++;
+            }
+        }
+        barrier();
+    }
+
+    if (inRange) {
+        grid[cluster] = uvec2(first, count);
+    }
+}
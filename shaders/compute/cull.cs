@@ -0,0 +1,75 @@
+#version 430 core
+layout (local_size_x = 256) in;
+
+// bounding sphere and mesh of every object
+struct CullObject {
+    vec4 sphere;   // center xyz, radius w
+    uvec4 mesh;    // x = index into meshes
+};
+layout (std430, binding = 0) readonly buffer Objects { CullObject objects[]; };
+
+// the draw of each mesh, instanceCount and baseInstance are filled in here
+struct DrawCommand {
+    uint count;
+    uint instanceCount;
+    uint firstIndex;
+    int baseVertex;
+    uint baseInstance;
+};
+layout (std430, binding = 1) readonly buffer Meshes { DrawCommand meshes[]; };
+layout (std430, binding = 2) writeonly buffer Commands { DrawCommand commands[]; };
+
+// number of commands written, read back as the draw count
+layout (std430, binding = 3) buffer DrawCount { uint drawCount; };
+
+uniform vec4 planes[6];
+uniform uint objectCount;
+// true: visible objects are appended with an atomic, false: one command per
+// object, culled ones with instanceCount 0
+uniform bool compact;
+
+// visible objects of the work group, appended with one global atomic per group
+shared uint groupCount;
+shared uint groupBase;
+
+void main() {
+    uint i = gl_GlobalInvocationID.x;
+    if (gl_LocalInvocationIndex == 0u) {
+        groupCount = 0u;
+    }
+    barrier();
+
+    // no early return past the end, every invocation has to reach the barriers
+    bool visible = i < objectCount;
+    DrawCommand command;
+    if (visible) {
+        vec4 sphere = objects[i].sphere;
+        for (int p = 0; p < 6; p++) {
+            visible = visible && dot(planes[p].xyz, sphere.xyz) + planes[p].w > -sphere.w;
+        }
+
+        // baseInstance is the object index, which the vertex shader gets
+        // through an instanced attribute (or gl_BaseInstanceARB)
+        command = meshes[objects[i].mesh.x];
+        command.instanceCount = visible ? 1u : 0u;
+        command.baseInstance = i;
+        if (!compact) {
+            commands[i] = command;
+        }
+    }
+
+    if (compact) {
+        uint slot = 0u;
+        if (visible) {
+            slot = atomicAdd(groupCount, 1u);
+        }
+        barrier();
+        if (gl_LocalInvocationIndex == 0u) {
+            groupBase = atomicAdd(drawCount, groupCount);
+        }
+        barrier();
+        if (visible) {
+            commands[groupBase + slot] = command;
+        }
+    }
+}
@@ -0,0 +1,47 @@
+#version 430 core
+layout (local_size_x = 256) in;
+
+layout (std430, binding = 3) writeonly buffer DstPos { vec2 dstPos[]; };
+layout (std430, binding = 4) writeonly buffer DstVel { vec2 dstVel[]; };
+layout (std430, binding = 5) writeonly buffer DstLife { float dstLife[]; };
+
+layout (binding = 0) uniform atomic_uint dstAlive;
+
+uniform uint emitCount;
+uniform uint capacity;
+uniform uint seed;
+uniform vec2 emitterPos;
+uniform float lifetime;
+
+// PCG hash, good enough randomness without any state
+uint hash(uint v) {
+    uint state = v * 747796405u + 2891336453u;
+    uint word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+    return (word >> 22u) ^ word;
+}
+
+float random01(inout uint h) {
+    h = hash(h);
+    return float(h) / 4294967295.0;
+}
+
+void main() {
+    uint i = gl_GlobalInvocationID.x;
+    if (i >= emitCount) {
+        return;
+    }
+
+    // appended after the survivors, the finish pass clamps the count to capacity
+    uint j = atomicCounterIncrement(dstAlive);
+    if (j >= capacity) {
+        return;
+    }
+
+    uint h = i ^ (seed * 1664525u);
+    float angle = 1.5707963 + (random01(h) - 0.5) * 0.8;
+    float speed = 0.8 + random01(h) * 0.9;
+
+    dstPos[j] = emitterPos + vec2(random01(h) - 0.5, 0.0) * 0.05;
+    dstVel[j] = vec2(cos(angle), sin(angle)) * speed;
+    dstLife[j] = lifetime * (0.5 + 0.5 * random01(h));
+}
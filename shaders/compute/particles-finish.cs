@@ -0,0 +1,37 @@
+#version 430 core
+layout (local_size_x = 1) in;
+
+layout (std430, binding = 6) buffer Counts { uint aliveCount[2]; };
+
+// DispatchIndirectCommand followed by DrawArraysIndirectCommand
+layout (std430, binding = 7) writeonly buffer Indirect {
+    uint dispatchX;
+    uint dispatchY;
+    uint dispatchZ;
+    uint drawCount;
+    uint instanceCount;
+    uint first;
+    uint baseInstance;
+};
+
+uniform uint dstSet;
+uniform uint capacity;
+
+void main() {
+    uint alive = min(aliveCount[dstSet], capacity);
+    aliveCount[dstSet] = alive;
+
+    // the current source set becomes next frame's destination
+    aliveCount[1u - dstSet] = 0u;
+
+    // next update only launches enough groups for the survivors
+    dispatchX = (alive + 255u) / 256u;
+    dispatchY = 1u;
+    dispatchZ = 1u;
+
+    // one instanced quad per particle
+    drawCount = 4u;
+    instanceCount = alive;
+    first = 0u;
+    baseInstance = 0u;
+}
@@ -0,0 +1,41 @@
+#version 430 core
+layout (local_size_x = 256) in;
+
+// particle state is SoA, one buffer per field, two sets that ping-pong
+layout (std430, binding = 0) readonly buffer SrcPos { vec2 srcPos[]; };
+layout (std430, binding = 1) readonly buffer SrcVel { vec2 srcVel[]; };
+layout (std430, binding = 2) readonly buffer SrcLife { float srcLife[]; };
+layout (std430, binding = 3) writeonly buffer DstPos { vec2 dstPos[]; };
+layout (std430, binding = 4) writeonly buffer DstVel { vec2 dstVel[]; };
+layout (std430, binding = 5) writeonly buffer DstLife { float dstLife[]; };
+
+// alive count of both sets, same memory as the atomic counters
+layout (std430, binding = 6) readonly buffer Counts { uint aliveCount[2]; };
+
+// alive count of the destination set
+layout (binding = 0) uniform atomic_uint dstAlive;
+
+uniform uint srcSet;
+uniform float dt;
+uniform vec2 gravity;
+
+void main() {
+    uint i = gl_GlobalInvocationID.x;
+    if (i >= aliveCount[srcSet]) {
+        return;
+    }
+
+    float life = srcLife[i] - dt;
+    vec2 vel = srcVel[i] + gravity * dt;
+    vec2 pos = srcPos[i] + vel * dt;
+
+    // dead particles are simply not copied, which compacts the survivors
+    if (life <= 0.0 || pos.y < -1.1) {
+        return;
+    }
+
+    uint j = atomicCounterIncrement(dstAlive);
+    dstPos[j] = pos;
+    dstVel[j] = vel;
+    dstLife[j] = life;
+}
@@ -0,0 +1,7 @@
+#version 330 core
+// only the depth test matters, color writes are masked off while querying
+out vec4 FragColor;
+
+void main() {
+    FragColor = vec4(1.0);
+}
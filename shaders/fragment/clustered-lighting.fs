@@ -0,0 +1,53 @@
+#version 330 core
+// Diffuse shading by point lights, looking up only the lights of the
+// fragment's cluster (ClusteredLighting::bind sets everything below).
+in vec3 viewPosition;
+in vec3 viewNormal;
+in vec3 albedo;
+
+out vec4 FragColor;
+
+uniform samplerBuffer lights;         // 2 texels per light: position + radius, color
+uniform usamplerBuffer clusterGrid;   // first index, light count
+uniform usamplerBuffer lightIndices;
+uniform uvec3 clusterCount;
+uniform vec2 tileSize;                // in pixels
+uniform vec2 sliceScaleBias;          // slice = log(depth) * x + y
+uniform uint lightCount;
+// false shades with every light, to compare against
+uniform bool clustered;
+uniform vec3 ambient = vec3(0.03);
+
+vec3 shade(uint light, vec3 n) {
+    vec4 positionRadius = texelFetch(lights, int(light * 2u));
+    vec3 color = texelFetch(lights, int(light * 2u + 1u)).rgb;
+    vec3 toLight = positionRadius.xyz - viewPosition;
+    float d = length(toLight);
+    // reaches exactly zero at the radius, so clusters the light misses lose nothing
+    float x = clamp(1.0 - (d * d) / (positionRadius.w * positionRadius.w), 0.0, 1.0);
+    return color * (x * x) * max(dot(n, toLight / max(d, 1e-4)), 0.0);
+}
+
+void main() {
+    vec3 n = normalize(viewNormal);
+    vec3 color = ambient * albedo;
+    vec3 light = vec3(0.0);
+
+    if (clustered) {
+        uvec2 tile = min(uvec2(gl_FragCoord.xy / tileSize), clusterCount.xy - 1u);
+        float slice = log(-viewPosition.z) * sliceScaleBias.x + sliceScaleBias.y;
+        uint z = min(uint(max(slice, 0.0)), clusterCount.z - 1u);
+        uint cluster = (z * clusterCount.y + tile.y) * clusterCount.x + tile.x;
+        uvec2 range = texelFetch(clusterGrid, int(cluster)).xy;
+        for (uint i = 0u; i < range.y; i++) {
+            light += shade(texelFetch(lightIndices, int(range.x + i)).x, n);
+        }
+    }
+    else {
+        for (uint i = 0u; i < lightCount; i++) {
+            light += shade(i, n);
+        }
+    }
+
+    FragColor = vec4(color + light * albedo, 1.0);
+}
@@ -0,0 +1,7 @@
+#version 330 core
+out vec4 FragColor;
+in float fade;
+
+void main() {
+    FragColor = vec4(mix(vec3(0.2, 0.2, 0.2), vec3(1.0, 0.5, 0.0), fade), 1.0f);
+}
@@ -0,0 +1,30 @@
+#version 330 core
+// the rendered corner of source stretched over the viewport, see Upscaler
+in vec2 uv;
+out vec4 FragColor;
+
+uniform sampler2D source;
+uniform vec2 region;      // rendered part of source, in uv
+uniform vec2 texel;       // one texel of source, in uv
+uniform float sharpness;
+
+void main() {
+    // stay half a texel inside the rendered part, what lies beyond is stale
+    vec2 p = clamp(uv * region, texel * 0.5, region - texel * 0.5);
+    vec3 center = texture(source, p).rgb;
+    if (sharpness <= 0.0) {
+        FragColor = vec4(center, 1.0);
+        return;
+    }
+
+    vec2 lo = texel * 0.5, hi = region - texel * 0.5;
+    vec3 left = texture(source, clamp(p - vec2(texel.x, 0.0), lo, hi)).rgb;
+    vec3 right = texture(source, clamp(p + vec2(texel.x, 0.0), lo, hi)).rgb;
+    vec3 down = texture(source, clamp(p - vec2(0.0, texel.y), lo, hi)).rgb;
+    vec3 up = texture(source, clamp(p + vec2(0.0, texel.y), lo, hi)).rgb;
+    vec3 sharpened = center + sharpness * (4.0 * center - left - right - down - up) * 0.25;
+    // never past what the neighbourhood holds, so edges don't get halos
+    vec3 minimum = min(center, min(min(left, right), min(down, up)));
+    vec3 maximum = max(center, max(max(left, right), max(down, up)));
+    FragColor = vec4(clamp(sharpened, minimum, maximum), 1.0);
+}
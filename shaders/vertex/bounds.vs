@@ -0,0 +1,11 @@
+#version 330 core
+// a unit cube ([0, 1] on every axis) stretched over a world space box
+layout (location = 0) in vec3 pos;
+
+uniform mat4 viewProjection;
+uniform vec3 boxMin;
+uniform vec3 boxMax;
+
+void main() {
+    gl_Position = viewProjection * vec4(mix(boxMin, boxMax, pos), 1.0);
+}
@@ -0,0 +1,15 @@
+#version 330 core
+layout (location = 0) in vec2 particlePos;
+layout (location = 1) in float particleLife;
+
+out float fade;
+
+uniform float size;
+uniform float lifetime;
+
+void main() {
+    // quad corners from gl_VertexID, drawn as a 4 vertex triangle strip
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 2.0 - 1.0;
+    gl_Position = vec4(particlePos + corner * size, 0.0, 1.0);
+    fade = clamp(particleLife / lifetime, 0.0, 1.0);
+}